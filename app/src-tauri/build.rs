@@ -5,9 +5,122 @@ fn main() {
         build_swift_library();
     }
 
+    // Build C++ library on Linux
+    #[cfg(target_os = "linux")]
+    {
+        build_cpp_library();
+    }
+
     tauri_build::build()
 }
 
+#[cfg(target_os = "linux")]
+fn build_cpp_library() {
+    use std::env;
+    use std::path::PathBuf;
+    use std::process::Command;
+
+    let manifest_dir = PathBuf::from(env::var("CARGO_MANIFEST_DIR").unwrap());
+    let cpp_dir = manifest_dir.join("cpp");
+
+    if !cpp_dir.exists() {
+        println!("cargo:warning=C++ directory not found, skipping C++ build");
+        return;
+    }
+
+    let profile = env::var("PROFILE").unwrap_or_else(|_| "debug".to_string());
+    let build_type = if profile == "release" {
+        "Release"
+    } else {
+        "Debug"
+    };
+
+    let build_dir = PathBuf::from(env::var("OUT_DIR").unwrap()).join("rigid-cpp");
+
+    println!("cargo:warning=Building C++ library in {} mode...", build_type);
+
+    let status = Command::new("cmake")
+        .args([
+            "-S", cpp_dir.to_str().unwrap(),
+            "-B", build_dir.to_str().unwrap(),
+            &format!("-DCMAKE_BUILD_TYPE={}", build_type),
+            "-DRIGID_BUILD_TESTS=OFF",
+        ])
+        .status()
+        .expect("Failed to execute cmake configure command");
+
+    if !status.success() {
+        panic!("CMake configure failed with status: {}", status);
+    }
+
+    let status = Command::new("cmake")
+        .args([
+            "--build", build_dir.to_str().unwrap(),
+            "--target", "RigidCaptureKit",
+            "--parallel",
+        ])
+        .status()
+        .expect("Failed to execute cmake build command");
+
+    if !status.success() {
+        panic!("C++ build failed with status: {}", status);
+    }
+
+    // Link the C++ library
+    println!("cargo:rustc-link-search=native={}", build_dir.display());
+    println!("cargo:rustc-link-lib=static=RigidCaptureKit");
+    println!("cargo:rustc-link-lib=dylib=stdc++");
+
+    // Link libav the same way CMakeLists.txt finds it. Without it the library
+    // builds with stub media backends and exports fall back to the ffmpeg CLI.
+    let libav_modules = ["libavformat", "libavcodec", "libavutil", "libswscale", "libswresample"];
+    if !link_pkg_config(&libav_modules) {
+        println!("cargo:warning=libav not found, native compositor will fall back to FFmpeg CLI");
+    }
+
+    // Likewise Xlib for screen recording; XFixes only adds the cursor
+    if !link_pkg_config(&["x11", "xext", "xcomposite"]) {
+        println!("cargo:warning=Xlib not found, native screen recording will be unavailable");
+    }
+    link_pkg_config(&["xfixes"]);
+    // libwebp only adds WebP screenshots
+    link_pkg_config(&["libwebp"]);
+
+    // zlib is required (PNG screenshots)
+    if !link_pkg_config(&["zlib"]) {
+        println!("cargo:rustc-link-lib=dylib=z");
+    }
+
+    // Rebuild if C++ sources or the shared header change
+    println!("cargo:rerun-if-changed=cpp/CMakeLists.txt");
+    println!("cargo:rerun-if-changed=cpp/src/");
+    println!("cargo:rerun-if-changed=swift/Sources/RigidCaptureKit/include/RigidCaptureKit.h");
+}
+
+/// Link the libraries pkg-config reports for `modules`; false if any is missing
+#[cfg(target_os = "linux")]
+fn link_pkg_config(modules: &[&str]) -> bool {
+    let libs = std::process::Command::new("pkg-config")
+        .arg("--libs")
+        .args(modules)
+        .output();
+
+    match libs {
+        Ok(output) if output.status.success() => {
+            let flags = String::from_utf8_lossy(&output.stdout);
+            for flag in flags.split_whitespace() {
+                if let Some(path) = flag.strip_prefix("-L") {
+                    println!("cargo:rustc-link-search=native={}", path);
+                } else if let Some(lib) = flag.strip_prefix("-l") {
+                    println!("cargo:rustc-link-lib=dylib={}", lib);
+                }
+            }
+            true
+        }
+        _ => false,
+    }
+}
+
 #[cfg(target_os = "macos")]
 fn build_swift_library() {
     use std::env;
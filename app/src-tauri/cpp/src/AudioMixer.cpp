@@ -0,0 +1,97 @@
+#include "AudioMixer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "MediaDecoder.h"
+
+namespace rigid {
+
+namespace {
+
+int64_t msToSamples(int64_t ms) {
+    return ms * AudioDecoder::kSampleRate / 1000;
+}
+
+} // namespace
+
+AudioMixer::AudioMixer(const CompositorConfig& config) {
+    for (const auto& clip : config.clips) {
+        bool audible = clip.sourceType == ClipSourceType::Audio ||
+                       (clip.sourceType == ClipSourceType::Video && clip.hasAudio.value_or(false));
+        if (!audible || clip.muted.value_or(false) || clip.durationMs <= 0) continue;
+
+        Track track;
+        track.clip = &clip;
+        track.startSample = msToSamples(clip.startTimeMs);
+        track.endSample = msToSamples(clip.startTimeMs + clip.durationMs);
+        track.fadeInSamples = msToSamples(std::max<int64_t>(clip.audioFadeInMs.value_or(0), 0));
+        track.fadeOutSamples = msToSamples(std::max<int64_t>(clip.audioFadeOutMs.value_or(0), 0));
+        tracks_.push_back(std::move(track));
+    }
+}
+
+AudioMixer::~AudioMixer() = default;
+
+float AudioMixer::gainAt(const Track& track, int64_t sample) const {
+    float gain = 1.0f;
+    if (track.fadeInSamples > 0 && sample < track.startSample + track.fadeInSamples) {
+        gain = std::min(gain, static_cast<float>(sample - track.startSample) / track.fadeInSamples);
+    }
+    if (track.fadeOutSamples > 0 && sample > track.endSample - track.fadeOutSamples) {
+        gain = std::min(gain, static_cast<float>(track.endSample - sample) / track.fadeOutSamples);
+    }
+    return std::clamp(gain, 0.0f, 1.0f);
+}
+
+void AudioMixer::mix(int64_t startSample, int frameCount, float* interleaved) {
+    constexpr int channels = AudioDecoder::kChannels;
+    std::fill_n(interleaved, static_cast<size_t>(frameCount) * channels, 0.0f);
+    int64_t endSample = startSample + frameCount;
+
+    for (auto& track : tracks_) {
+        if (track.failed || track.endSample <= startSample || track.startSample >= endSample) {
+            // Release decoders once their clip is behind us
+            if (track.decoder && track.endSample <= startSample) track.decoder.reset();
+            continue;
+        }
+
+        if (!track.decoder) {
+            const CompositorClip& clip = *track.clip;
+            try {
+                // Decoders open at the clip's in-point, so account for any part of
+                // the clip that already lies before this chunk
+                double speed = clip.clampedSpeed();
+                double skippedSec = static_cast<double>(std::max<int64_t>(startSample - track.startSample, 0)) /
+                                    AudioDecoder::kSampleRate;
+                double sourceStart = clip.inPointMs / 1000.0 + skippedSec * speed;
+                track.decoder = std::make_unique<AudioDecoder>(clip.sourcePath, sourceStart, speed);
+            } catch (const MediaError& e) {
+                std::fprintf(stderr, "VideoCompositor: No audio for %s: %s\n", clip.sourcePath.c_str(), e.what());
+                track.failed = true;
+                continue;
+            }
+        }
+
+        int64_t from = std::max(startSample, track.startSample);
+        int64_t to = std::min(endSample, track.endSample);
+        int count = static_cast<int>(to - from);
+
+        scratch_.resize(static_cast<size_t>(count) * channels);
+        int produced = track.decoder->read(scratch_.data(), count);
+
+        float* dst = interleaved + (from - startSample) * channels;
+        for (int i = 0; i < produced; i++) {
+            float gain = gainAt(track, from + i);
+            dst[i * channels] += scratch_[static_cast<size_t>(i) * channels] * gain;
+            dst[i * channels + 1] += scratch_[static_cast<size_t>(i) * channels + 1] * gain;
+        }
+    }
+
+    // Hard clip the sum like AVAudioMix does when tracks overlap
+    for (int i = 0; i < frameCount * channels; i++) {
+        interleaved[i] = std::clamp(interleaved[i], -1.0f, 1.0f);
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CompositorConfig.h"
+
+namespace rigid {
+
+class AudioDecoder;
+
+/// Mixes every audible clip of a config into one 48 kHz stereo stream.
+///
+/// Equivalent of the AVMutableComposition audio tracks plus AVMutableAudioMix
+/// volume ramps in VideoCompositor.swift: video clips with `has_audio` and
+/// audio-only clips contribute, speed is applied, and `audio_fade_in_ms` /
+/// `audio_fade_out_ms` become linear ramps at the clip edges.
+class AudioMixer {
+public:
+    explicit AudioMixer(const CompositorConfig& config);
+    ~AudioMixer();
+
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    /// True if at least one clip contributes audio
+    bool hasAudio() const { return !tracks_.empty(); }
+
+    /// Mix `frameCount` stereo frames starting at timeline sample `startSample`
+    /// into `interleaved` (overwritten, not accumulated)
+    void mix(int64_t startSample, int frameCount, float* interleaved);
+
+private:
+    struct Track {
+        const CompositorClip* clip;
+        int64_t startSample;
+        int64_t endSample;
+        int64_t fadeInSamples;
+        int64_t fadeOutSamples;
+        std::unique_ptr<AudioDecoder> decoder;
+        bool failed = false;
+    };
+
+    std::vector<Track> tracks_;
+    std::vector<float> scratch_;
+
+    float gainAt(const Track& track, int64_t sample) const;
+};
+
+} // namespace rigid
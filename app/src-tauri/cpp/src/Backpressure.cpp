@@ -0,0 +1,99 @@
+#include "Backpressure.h"
+
+#include <algorithm>
+
+namespace rigid {
+
+namespace {
+
+void storeMax(std::atomic<int64_t>& target, int64_t value) {
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+BackpressurePolicy backpressurePolicyFromC(int32_t policy) {
+    switch (policy) {
+    case RIGID_BACKPRESSURE_DROP_OLDEST: return BackpressurePolicy::DropOldest;
+    case RIGID_BACKPRESSURE_ADAPTIVE_FPS: return BackpressurePolicy::AdaptiveFps;
+    default: return BackpressurePolicy::DropNewest;
+    }
+}
+
+// MARK: - FrameRateGovernor
+
+FrameRateGovernor::FrameRateGovernor(int targetFps)
+    : targetFps_(std::max(targetFps, 1)),
+      minFps_(std::max(1, static_cast<int>(targetFps_ * kMinFpsFraction))),
+      currentFps_(targetFps_) {}
+
+bool FrameRateGovernor::frameCaptured(bool dropped) {
+    windowFrames_++;
+    if (dropped) windowDrops_++;
+    if (windowFrames_ < currentFps_) return false;
+
+    const int step = std::max(1, targetFps_ / 4);
+    int next = currentFps_;
+    if (windowDrops_ > windowFrames_ * kDropTolerance) {
+        next = std::max(minFps_, currentFps_ - step);
+    } else if (windowDrops_ == 0) {
+        next = std::min(targetFps_, currentFps_ + step);
+    }
+    windowFrames_ = 0;
+    windowDrops_ = 0;
+
+    if (next == currentFps_) return false;
+    currentFps_ = next;
+    return true;
+}
+
+// MARK: - CaptureStats
+
+void CaptureStats::reset(int fps) {
+    captured_ = 0;
+    encoded_ = 0;
+    dropped_ = 0;
+    currentFps_ = fps;
+    latencyTotalUs_ = 0;
+    latencyMaxUs_ = 0;
+    processingTotalUs_ = 0;
+    processingMaxUs_ = 0;
+}
+
+void CaptureStats::frameCaptured(int64_t processingUs) {
+    captured_.fetch_add(1, std::memory_order_relaxed);
+    processingTotalUs_.fetch_add(processingUs, std::memory_order_relaxed);
+    storeMax(processingMaxUs_, processingUs);
+}
+
+void CaptureStats::frameEncoded(int64_t latencyUs) {
+    encoded_.fetch_add(1, std::memory_order_relaxed);
+    latencyTotalUs_.fetch_add(latencyUs, std::memory_order_relaxed);
+    storeMax(latencyMaxUs_, latencyUs);
+}
+
+void CaptureStats::frameDropped() {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+RigidCaptureStats CaptureStats::snapshot() const {
+    RigidCaptureStats stats{};
+    stats.frames_captured = captured_.load(std::memory_order_relaxed);
+    stats.frames_encoded = encoded_.load(std::memory_order_relaxed);
+    stats.frames_dropped = dropped_.load(std::memory_order_relaxed);
+    stats.current_fps = currentFps_.load(std::memory_order_relaxed);
+    if (stats.frames_encoded > 0) {
+        stats.encoder_latency_avg_ms = latencyTotalUs_.load(std::memory_order_relaxed) / 1000.0 / stats.frames_encoded;
+    }
+    stats.encoder_latency_max_ms = latencyMaxUs_.load(std::memory_order_relaxed) / 1000.0;
+    if (stats.frames_captured > 0) {
+        stats.processing_avg_ms =
+            processingTotalUs_.load(std::memory_order_relaxed) / 1000.0 / stats.frames_captured;
+    }
+    stats.processing_max_ms = processingMaxUs_.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+} // namespace rigid
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "RigidCaptureKit.h"
+
+namespace rigid {
+
+/// What a recording does when the encoder falls behind the capture
+/// (RIGID_BACKPRESSURE_* in RigidCaptureKit.h)
+enum class BackpressurePolicy {
+    /// Skip frames that arrive while the encoder is busy
+    DropNewest = RIGID_BACKPRESSURE_DROP_NEWEST,
+    /// Queue frames for the encoder; a full queue drops its oldest frame
+    DropOldest = RIGID_BACKPRESSURE_DROP_OLDEST,
+    /// Drop like DropNewest and lower the capture rate while drops go on
+    AdaptiveFps = RIGID_BACKPRESSURE_ADAPTIVE_FPS,
+};
+
+/// Policy for a C value; unknown values keep the default (DropNewest)
+BackpressurePolicy backpressurePolicyFromC(int32_t policy);
+
+/// Backpressure settings of a capture engine, applied to its next recording
+struct BackpressureSettings {
+    /// Frames the capture source buffers (the macOS SCStream queueDepth)
+    static constexpr uint32_t kDefaultQueueDepth = 8;
+
+    BackpressurePolicy policy = BackpressurePolicy::DropNewest;
+    uint32_t queueDepth = kDefaultQueueDepth;
+
+    /// Frames DropOldest keeps waiting for the encoder. Fewer than the
+    /// capture queue, so the source always has buffers left to capture into.
+    uint32_t pendingCapacity() const { return queueDepth > 2 ? queueDepth - 2 : 1; }
+};
+
+/// Capture rate controller for BackpressurePolicy::AdaptiveFps.
+///
+/// Frames are judged in windows of about a second at the current rate. A
+/// window that drops more than kDropTolerance of its frames lowers the rate
+/// by a quarter of the target (never below kMinFpsFraction of it); a window
+/// without drops raises it by the same step back toward the target.
+class FrameRateGovernor {
+public:
+    static constexpr double kDropTolerance = 0.05;
+    static constexpr double kMinFpsFraction = 0.25;
+
+    explicit FrameRateGovernor(int targetFps);
+
+    int targetFps() const { return targetFps_; }
+    int currentFps() const { return currentFps_; }
+
+    /// Count a captured frame. Returns true when the rate changed; the
+    /// caller then reconfigures the capture source to currentFps().
+    bool frameCaptured(bool dropped);
+
+private:
+    const int targetFps_;
+    const int minFps_;
+    int currentFps_;
+    int windowFrames_ = 0;
+    int windowDrops_ = 0;
+};
+
+/// Frame counters and timings of one recording, updated on the capture
+/// and encoder threads and read by rigid_capture_get_stats
+class CaptureStats {
+public:
+    void reset(int fps);
+
+    /// A frame arrived from the capture source; `processingUs` is how long
+    /// handling it took on the capture thread
+    void frameCaptured(int64_t processingUs);
+    /// A frame reached the encoder `latencyUs` after it was captured
+    void frameEncoded(int64_t latencyUs);
+    void frameDropped();
+    void setCurrentFps(int fps) { currentFps_ = fps; }
+
+    RigidCaptureStats snapshot() const;
+
+private:
+    std::atomic<uint64_t> captured_{0};
+    std::atomic<uint64_t> encoded_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<int> currentFps_{0};
+    std::atomic<int64_t> latencyTotalUs_{0};
+    std::atomic<int64_t> latencyMaxUs_{0};
+    std::atomic<int64_t> processingTotalUs_{0};
+    std::atomic<int64_t> processingMaxUs_{0};
+};
+
+} // namespace rigid
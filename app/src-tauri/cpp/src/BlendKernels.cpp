@@ -0,0 +1,278 @@
+#include "BlendKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RIGID_BLEND_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define RIGID_BLEND_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rigid {
+
+namespace {
+
+/// Rounded x / 255 for x <= 255 * 255. The vector versions below use the
+/// same formula (or, on NEON, one proven equal over this range).
+inline uint32_t div255(uint32_t x) {
+    return ((x + 128) * 257) >> 16;
+}
+
+// MARK: - Scalar
+
+inline void overPixel(uint8_t* dst, const uint8_t s[4]) {
+    uint32_t inv = 255 - s[3];
+    for (int c = 0; c < 4; c++) {
+        dst[c] = static_cast<uint8_t>(std::min<uint32_t>(255, s[c] + div255(dst[c] * inv)));
+    }
+}
+
+inline void overScaledPixel(uint8_t* dst, const uint8_t* src, uint32_t opacity) {
+    uint8_t s[4];
+    for (int c = 0; c < 4; c++) s[c] = static_cast<uint8_t>(div255(src[c] * opacity));
+    overPixel(dst, s);
+}
+
+void overScalar(uint8_t* dst, const uint8_t* src, int pixels) {
+    for (int i = 0; i < pixels; i++, dst += 4, src += 4) overPixel(dst, src);
+}
+
+void overWithOpacityScalar(uint8_t* dst, const uint8_t* src, int pixels, uint8_t opacity) {
+    for (int i = 0; i < pixels; i++, dst += 4, src += 4) overScaledPixel(dst, src, opacity);
+}
+
+void overMaskedScalar(uint8_t* dst, const uint8_t* src, const uint8_t* mask, int pixels, uint8_t opacity) {
+    for (int i = 0; i < pixels; i++, dst += 4, src += 4) {
+        overScaledPixel(dst, src, div255(mask[i] * static_cast<uint32_t>(opacity)));
+    }
+}
+
+constexpr BlendKernels kScalarKernels{"scalar", overScalar, overWithOpacityScalar, overMaskedScalar};
+
+#if RIGID_BLEND_X86
+
+// MARK: - SSE4.1
+//
+// Four pixels per step. Each half is widened to 16-bit lanes (two pixels),
+// scaled, blended and packed back with unsigned saturation.
+
+#define RIGID_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define RIGID_TARGET_AVX2 __attribute__((target("avx2")))
+
+RIGID_TARGET_SSE41 inline __m128i div255Sse(__m128i x) {
+    return _mm_mulhi_epu16(_mm_add_epi16(x, _mm_set1_epi16(128)), _mm_set1_epi16(257));
+}
+
+/// Premultiplied over on two pixels in 16-bit lanes
+RIGID_TARGET_SSE41 inline __m128i overSse(__m128i s, __m128i d) {
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    return _mm_add_epi16(s, div255Sse(_mm_mullo_epi16(d, inv)));
+}
+
+/// Four mask bytes spread over the four channels of their pixel
+RIGID_TARGET_SSE41 inline __m128i spreadMaskSse(const uint8_t* mask) {
+    int32_t bytes;
+    std::memcpy(&bytes, mask, sizeof(bytes));
+    __m128i m = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+    return _mm_mullo_epi32(m, _mm_set1_epi32(0x01010101));
+}
+
+/// With `Scaled`, the source is first multiplied by per-channel 16-bit factors for each half
+template <bool Scaled>
+RIGID_TARGET_SSE41 inline void blendStepSse(uint8_t* dst, const uint8_t* src, __m128i scaleLo, __m128i scaleHi) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+
+    __m128i sLo = _mm_unpacklo_epi8(s, zero);
+    __m128i sHi = _mm_unpackhi_epi8(s, zero);
+    if (Scaled) {
+        sLo = div255Sse(_mm_mullo_epi16(sLo, scaleLo));
+        sHi = div255Sse(_mm_mullo_epi16(sHi, scaleHi));
+    }
+    __m128i lo = overSse(sLo, _mm_unpacklo_epi8(d, zero));
+    __m128i hi = overSse(sHi, _mm_unpackhi_epi8(d, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+}
+
+RIGID_TARGET_SSE41 void overSse41(uint8_t* dst, const uint8_t* src, int pixels) {
+    int i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        blendStepSse<false>(dst + i * 4, src + i * 4, _mm_setzero_si128(), _mm_setzero_si128());
+    }
+    overScalar(dst + i * 4, src + i * 4, pixels - i);
+}
+
+RIGID_TARGET_SSE41 void overWithOpacitySse41(uint8_t* dst, const uint8_t* src, int pixels, uint8_t opacity) {
+    const __m128i scale = _mm_set1_epi16(opacity);
+    int i = 0;
+    for (; i + 4 <= pixels; i += 4) blendStepSse<true>(dst + i * 4, src + i * 4, scale, scale);
+    overWithOpacityScalar(dst + i * 4, src + i * 4, pixels - i, opacity);
+}
+
+RIGID_TARGET_SSE41 void overMaskedSse41(uint8_t* dst, const uint8_t* src, const uint8_t* mask, int pixels,
+                                        uint8_t opacity) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opacity16 = _mm_set1_epi16(opacity);
+    int i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i m = spreadMaskSse(mask + i);
+        __m128i mLo = div255Sse(_mm_mullo_epi16(_mm_unpacklo_epi8(m, zero), opacity16));
+        __m128i mHi = div255Sse(_mm_mullo_epi16(_mm_unpackhi_epi8(m, zero), opacity16));
+        blendStepSse<true>(dst + i * 4, src + i * 4, mLo, mHi);
+    }
+    overMaskedScalar(dst + i * 4, src + i * 4, mask + i, pixels - i, opacity);
+}
+
+constexpr BlendKernels kSse41Kernels{"sse4.1", overSse41, overWithOpacitySse41, overMaskedSse41};
+
+// MARK: - AVX2
+//
+// Same arithmetic on eight pixels. Unpack and pack both work within 128-bit
+// lanes, so pixel order survives the round trip.
+
+RIGID_TARGET_AVX2 inline __m256i div255Avx(__m256i x) {
+    return _mm256_mulhi_epu16(_mm256_add_epi16(x, _mm256_set1_epi16(128)), _mm256_set1_epi16(257));
+}
+
+RIGID_TARGET_AVX2 inline __m256i overAvx(__m256i s, __m256i d) {
+    __m256i alpha =
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+    return _mm256_add_epi16(s, div255Avx(_mm256_mullo_epi16(d, inv)));
+}
+
+RIGID_TARGET_AVX2 inline __m256i spreadMaskAvx(const uint8_t* mask) {
+    __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask)));
+    return _mm256_mullo_epi32(m, _mm256_set1_epi32(0x01010101));
+}
+
+template <bool Scaled>
+RIGID_TARGET_AVX2 inline void blendStepAvx(uint8_t* dst, const uint8_t* src, __m256i scaleLo, __m256i scaleHi) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+
+    __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+    __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+    if (Scaled) {
+        sLo = div255Avx(_mm256_mullo_epi16(sLo, scaleLo));
+        sHi = div255Avx(_mm256_mullo_epi16(sHi, scaleHi));
+    }
+    __m256i lo = overAvx(sLo, _mm256_unpacklo_epi8(d, zero));
+    __m256i hi = overAvx(sHi, _mm256_unpackhi_epi8(d, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_packus_epi16(lo, hi));
+}
+
+RIGID_TARGET_AVX2 void overAvx2(uint8_t* dst, const uint8_t* src, int pixels) {
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        blendStepAvx<false>(dst + i * 4, src + i * 4, _mm256_setzero_si256(), _mm256_setzero_si256());
+    }
+    overScalar(dst + i * 4, src + i * 4, pixels - i);
+}
+
+RIGID_TARGET_AVX2 void overWithOpacityAvx2(uint8_t* dst, const uint8_t* src, int pixels, uint8_t opacity) {
+    const __m256i scale = _mm256_set1_epi16(opacity);
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) blendStepAvx<true>(dst + i * 4, src + i * 4, scale, scale);
+    overWithOpacityScalar(dst + i * 4, src + i * 4, pixels - i, opacity);
+}
+
+RIGID_TARGET_AVX2 void overMaskedAvx2(uint8_t* dst, const uint8_t* src, const uint8_t* mask, int pixels,
+                                      uint8_t opacity) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i opacity16 = _mm256_set1_epi16(opacity);
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i m = spreadMaskAvx(mask + i);
+        __m256i mLo = div255Avx(_mm256_mullo_epi16(_mm256_unpacklo_epi8(m, zero), opacity16));
+        __m256i mHi = div255Avx(_mm256_mullo_epi16(_mm256_unpackhi_epi8(m, zero), opacity16));
+        blendStepAvx<true>(dst + i * 4, src + i * 4, mLo, mHi);
+    }
+    overMaskedScalar(dst + i * 4, src + i * 4, mask + i, pixels - i, opacity);
+}
+
+constexpr BlendKernels kAvx2Kernels{"avx2", overAvx2, overWithOpacityAvx2, overMaskedAvx2};
+
+#elif RIGID_BLEND_NEON
+
+// MARK: - NEON
+//
+// Eight pixels per step, deinterleaved into channel planes by vld4.
+// vraddhn(x, vrshr(x, 8)) is rounded x / 255 for every x <= 255 * 255.
+
+inline uint8x8_t div255Neon(uint16x8_t x) {
+    return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+}
+
+inline void overNeon(uint8x8x4_t& s, const uint8x8x4_t& d) {
+    uint8x8_t inv = vsub_u8(vdup_n_u8(255), s.val[3]);
+    for (int c = 0; c < 4; c++) {
+        s.val[c] = vqadd_u8(s.val[c], div255Neon(vmull_u8(d.val[c], inv)));
+    }
+}
+
+void overNeonKernel(uint8_t* dst, const uint8_t* src, int pixels) {
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint8x8x4_t s = vld4_u8(src + i * 4);
+        overNeon(s, vld4_u8(dst + i * 4));
+        vst4_u8(dst + i * 4, s);
+    }
+    overScalar(dst + i * 4, src + i * 4, pixels - i);
+}
+
+void overWithOpacityNeon(uint8_t* dst, const uint8_t* src, int pixels, uint8_t opacity) {
+    const uint8x8_t scale = vdup_n_u8(opacity);
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint8x8x4_t s = vld4_u8(src + i * 4);
+        for (int c = 0; c < 4; c++) s.val[c] = div255Neon(vmull_u8(s.val[c], scale));
+        overNeon(s, vld4_u8(dst + i * 4));
+        vst4_u8(dst + i * 4, s);
+    }
+    overWithOpacityScalar(dst + i * 4, src + i * 4, pixels - i, opacity);
+}
+
+void overMaskedNeon(uint8_t* dst, const uint8_t* src, const uint8_t* mask, int pixels, uint8_t opacity) {
+    const uint8x8_t opacity8 = vdup_n_u8(opacity);
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint8x8_t scale = div255Neon(vmull_u8(vld1_u8(mask + i), opacity8));
+        uint8x8x4_t s = vld4_u8(src + i * 4);
+        for (int c = 0; c < 4; c++) s.val[c] = div255Neon(vmull_u8(s.val[c], scale));
+        overNeon(s, vld4_u8(dst + i * 4));
+        vst4_u8(dst + i * 4, s);
+    }
+    overMaskedScalar(dst + i * 4, src + i * 4, mask + i, pixels - i, opacity);
+}
+
+constexpr BlendKernels kNeonKernels{"neon", overNeonKernel, overWithOpacityNeon, overMaskedNeon};
+
+#endif
+
+} // namespace
+
+std::vector<const BlendKernels*> supportedBlendKernels() {
+    std::vector<const BlendKernels*> kernels{&kScalarKernels};
+#if RIGID_BLEND_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1")) kernels.push_back(&kSse41Kernels);
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(&kAvx2Kernels);
+#elif RIGID_BLEND_NEON
+    kernels.push_back(&kNeonKernels);
+#endif
+    return kernels;
+}
+
+const BlendKernels& blendKernels() {
+    static const BlendKernels& best = *supportedBlendKernels().back();
+    return best;
+}
+
+} // namespace rigid
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rigid {
+
+/// Source-over row kernels for premultiplied BGRA.
+///
+/// Every implementation computes exactly the same integers as the scalar
+/// one, so output never depends on the CPU an export ran on:
+///
+///     s'  = s * opacity / 255          (per channel, alpha included)
+///     out = s' + d * (255 - s'.a) / 255
+///
+/// with each division rounded to nearest and the sum saturated at 255.
+struct BlendKernels {
+    /// Instruction set name for logs and tests ("scalar", "sse4.1", "avx2", "neon")
+    const char* name;
+
+    /// dst = src over dst
+    void (*over)(uint8_t* dst, const uint8_t* src, int pixels);
+
+    /// dst = (src * opacity) over dst, for clip opacity and fades
+    void (*overWithOpacity)(uint8_t* dst, const uint8_t* src, int pixels, uint8_t opacity);
+
+    /// dst = (src * mask * opacity) over dst, with one coverage byte per
+    /// pixel in `mask` (rounded corners, soft edges). Opacity applies first.
+    void (*overMasked)(uint8_t* dst, const uint8_t* src, const uint8_t* mask, int pixels, uint8_t opacity);
+};
+
+/// Fastest kernels this CPU supports, picked once at first use
+const BlendKernels& blendKernels();
+
+/// Every kernel set this CPU can run, scalar first and fastest last
+std::vector<const BlendKernels*> supportedBlendKernels();
+
+} // namespace rigid
@@ -0,0 +1,213 @@
+#include "BoxBlur.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#define RIGID_BLUR_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define RIGID_BLUR_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rigid {
+
+namespace {
+
+// MARK: - Pixel sums
+//
+// A running window sum holds one 32-bit lane per BGRA channel. SSE2 and
+// NEON are baseline on the platforms we ship, so no runtime dispatch.
+
+#if RIGID_BLUR_SSE2
+
+using PixelSums = __m128i;
+
+inline PixelSums loadPixel(const uint8_t* p) {
+    int32_t bytes;
+    std::memcpy(&bytes, p, 4);
+    __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+    return _mm_unpacklo_epi16(v, zero);
+}
+
+inline PixelSums loadSums(const int32_t* s) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)); }
+inline void storeSums(int32_t* s, PixelSums v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(s), v); }
+
+/// sums + added - removed
+inline PixelSums slide(PixelSums sums, const uint8_t* added, const uint8_t* removed) {
+    return _mm_add_epi32(sums, _mm_sub_epi32(loadPixel(added), loadPixel(removed)));
+}
+
+/// Rounded sums / window into `dst`
+inline void storeAverage(uint8_t* dst, PixelSums sums, float inverse) {
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sums), _mm_set1_ps(inverse)));
+    q = _mm_packs_epi32(q, q);
+    q = _mm_packus_epi16(q, q);
+    int32_t bytes = _mm_cvtsi128_si32(q);
+    std::memcpy(dst, &bytes, 4);
+}
+
+#elif RIGID_BLUR_NEON
+
+using PixelSums = int32x4_t;
+
+inline PixelSums loadPixel(const uint8_t* p) {
+    uint32_t bytes;
+    std::memcpy(&bytes, p, 4);
+    uint16x8_t wide = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytes)));
+    return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(wide)));
+}
+
+inline PixelSums loadSums(const int32_t* s) { return vld1q_s32(s); }
+inline void storeSums(int32_t* s, PixelSums v) { vst1q_s32(s, v); }
+
+inline PixelSums slide(PixelSums sums, const uint8_t* added, const uint8_t* removed) {
+    return vaddq_s32(sums, vsubq_s32(loadPixel(added), loadPixel(removed)));
+}
+
+inline void storeAverage(uint8_t* dst, PixelSums sums, float inverse) {
+    int32x4_t q = vcvtnq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(sums), inverse));
+    uint8x8_t bytes = vqmovn_u16(vcombine_u16(vqmovun_s32(q), vqmovun_s32(q)));
+    uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    std::memcpy(dst, &packed, 4);
+}
+
+#else
+
+struct PixelSums {
+    int32_t c[4];
+};
+
+inline PixelSums loadSums(const int32_t* s) {
+    PixelSums v;
+    std::memcpy(v.c, s, sizeof(v.c));
+    return v;
+}
+inline void storeSums(int32_t* s, PixelSums v) { std::memcpy(s, v.c, sizeof(v.c)); }
+
+inline PixelSums slide(PixelSums sums, const uint8_t* added, const uint8_t* removed) {
+    for (int i = 0; i < 4; i++) sums.c[i] += added[i] - removed[i];
+    return sums;
+}
+
+inline void storeAverage(uint8_t* dst, PixelSums sums, float inverse) {
+    for (int i = 0; i < 4; i++) {
+        long v = std::lrint(static_cast<float>(sums.c[i]) * inverse);
+        dst[i] = static_cast<uint8_t>(std::min(std::max(v, 0L), 255L));
+    }
+}
+
+#endif
+
+/// Window sum at position 0 with clamped edges: the first pixel counted
+/// radius + 1 times plus pixels 1...radius, where pixels past the end repeat
+/// the last one. `at(i)` returns pixel i; runs in O(min(radius, count)).
+template <typename PixelAt>
+void initialSums(int32_t sums[4], int count, int radius, PixelAt at) {
+    const uint8_t* first = at(0);
+    for (int c = 0; c < 4; c++) sums[c] = first[c] * (radius + 1);
+    int inside = std::min(radius, count - 1);
+    for (int i = 1; i <= inside; i++) {
+        const uint8_t* p = at(i);
+        for (int c = 0; c < 4; c++) sums[c] += p[c];
+    }
+    const uint8_t* last = at(count - 1);
+    for (int c = 0; c < 4; c++) sums[c] += last[c] * (radius - inside);
+}
+
+} // namespace
+
+void gaussianBoxRadii(double sigma, int passes, int* radii) {
+    if (passes <= 0) return;
+    std::fill(radii, radii + passes, 0);
+    if (!(sigma > 0)) return;
+
+    // n boxes of widths wl or wu = wl + 2 whose variances (w^2 - 1) / 12 sum to sigma^2
+    double variance = 12 * sigma * sigma;
+    int lower = static_cast<int>(std::floor(std::sqrt(variance / passes + 1)));
+    if (lower % 2 == 0) lower--;
+    lower = std::max(lower, 1);
+    int upper = lower + 2;
+    double idealLower = (variance - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes) / (-4.0 * lower - 4);
+    int lowerCount = static_cast<int>(std::lround(idealLower));
+
+    for (int i = 0; i < passes; i++) {
+        radii[i] = ((i < lowerCount ? lower : upper) - 1) / 2;
+    }
+}
+
+std::vector<int> gaussianBoxRadii(double sigma, int passes) {
+    std::vector<int> radii(static_cast<size_t>(std::max(passes, 0)), 0);
+    gaussianBoxRadii(sigma, passes, radii.data());
+    return radii;
+}
+
+void BoxBlur::apply(uint8_t* pixels, int width, int height, size_t stride, double sigma) {
+    if (width <= 0 || height <= 0) return;
+    int radii[kPasses];
+    gaussianBoxRadii(sigma, kPasses, radii);
+    for (int radius : radii) {
+        if (radius > 0) blurRows(pixels, width, height, stride, radius);
+    }
+    for (int radius : radii) {
+        if (radius > 0) blurColumns(pixels, width, height, stride, radius);
+    }
+}
+
+void BoxBlur::blurRows(uint8_t* pixels, int width, int height, size_t stride, int radius) {
+    const float inverse = 1.0f / static_cast<float>(2 * radius + 1);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    rowScratch_.resize(rowBytes);
+    const uint8_t* src = rowScratch_.data();
+
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        std::memcpy(rowScratch_.data(), row, rowBytes);
+
+        int32_t start[4];
+        initialSums(start, width, radius, [&](int i) { return src + static_cast<size_t>(i) * 4; });
+        PixelSums sums = loadSums(start);
+
+        for (int x = 0; x < width; x++) {
+            storeAverage(row + static_cast<size_t>(x) * 4, sums, inverse);
+            int added = std::min(x + radius + 1, width - 1);
+            int removed = std::max(x - radius, 0);
+            sums = slide(sums, src + static_cast<size_t>(added) * 4, src + static_cast<size_t>(removed) * 4);
+        }
+    }
+}
+
+void BoxBlur::blurColumns(uint8_t* pixels, int width, int height, size_t stride, int radius) {
+    const float inverse = 1.0f / static_cast<float>(2 * radius + 1);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    regionScratch_.resize(rowBytes * height);
+    for (int y = 0; y < height; y++) {
+        std::memcpy(regionScratch_.data() + rowBytes * y, pixels + static_cast<size_t>(y) * stride, rowBytes);
+    }
+    const uint8_t* src = regionScratch_.data();
+
+    // One running sum per column, advanced a whole row at a time so every
+    // access walks memory in order
+    columnSums_.resize(static_cast<size_t>(width) * 4);
+    for (int x = 0; x < width; x++) {
+        initialSums(columnSums_.data() + static_cast<size_t>(x) * 4, height, radius,
+                    [&](int i) { return src + rowBytes * i + static_cast<size_t>(x) * 4; });
+    }
+
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        const uint8_t* added = src + rowBytes * std::min(y + radius + 1, height - 1);
+        const uint8_t* removed = src + rowBytes * std::max(y - radius, 0);
+        for (int x = 0; x < width; x++) {
+            size_t offset = static_cast<size_t>(x) * 4;
+            PixelSums sums = loadSums(columnSums_.data() + offset);
+            storeAverage(row + offset, sums, inverse);
+            storeSums(columnSums_.data() + offset, slide(sums, added + offset, removed + offset));
+        }
+    }
+}
+
+} // namespace rigid
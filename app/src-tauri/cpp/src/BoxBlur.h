@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rigid {
+
+/// Box radii whose successive application approximates a Gaussian of
+/// standard deviation `sigma` (widths chosen to match its variance).
+std::vector<int> gaussianBoxRadii(double sigma, int passes);
+/// Same, written to `radii[0..passes)` without allocating
+void gaussianBoxRadii(double sigma, int passes, int* radii);
+
+/// In-place Gaussian approximation for BGRA regions, used for redaction blurs.
+///
+/// Three box passes per axis, each a running sum, so the cost per pixel
+/// does not grow with the radius. Edges clamp to the region, matching
+/// CIGaussianBlur on a clamped-to-extent image. Arithmetic is integer plus a
+/// single float multiply per channel, giving identical output with and
+/// without the SIMD path. Reuses its scratch buffers between calls.
+class BoxBlur {
+public:
+    static constexpr int kPasses = 3;
+
+    /// Blur `width` x `height` pixels starting at `pixels`, rows `stride` bytes apart
+    void apply(uint8_t* pixels, int width, int height, size_t stride, double sigma);
+
+private:
+    std::vector<uint8_t> rowScratch_;
+    std::vector<uint8_t> regionScratch_;
+    std::vector<int32_t> columnSums_;
+
+    void blurRows(uint8_t* pixels, int width, int height, size_t stride, int radius);
+    void blurColumns(uint8_t* pixels, int width, int height, size_t stride, int radius);
+};
+
+} // namespace rigid
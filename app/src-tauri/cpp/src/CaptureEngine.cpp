@@ -0,0 +1,331 @@
+#include "CaptureEngine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Json.h"
+#include "MediaDecoder.h"
+#include "MediaEncoder.h"
+#include "RigidCaptureKit.h"
+#include "X11Capture.h"
+
+namespace rigid {
+
+CaptureEngine::~CaptureEngine() {
+    // Cancel, like the Swift engine going away mid-recording
+    cancelRecording();
+}
+
+BackpressureSettings CaptureEngine::backpressure() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return backpressure_;
+}
+
+void CaptureEngine::setBackpressure(const BackpressureSettings& settings) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    backpressure_ = settings;
+}
+
+void CaptureEngine::startRecording(std::unique_ptr<CaptureSource> source, const RecordingRequest& request) {
+    // 4:2:0 needs even dimensions; an odd last row or column is cropped
+    EncoderSettings settings;
+    settings.outputPath = request.outputPath;
+    settings.width = source->width() & ~1;
+    settings.height = source->height() & ~1;
+    settings.frameRate = request.fps;
+    settings.bitrate = request.bitrate;
+    settings.gopFrames = request.keyframeInterval;
+    settings.realtime = true;
+    if (settings.width < 2 || settings.height < 2) {
+        throw CaptureFailure(RIGID_ERROR_INVALID_CONFIG, "Capture area is too small to encode");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (recorder_) throw CaptureFailure(RIGID_ERROR_RECORDING_FAILED, "Already recording");
+    }
+    start(std::move(source), makeEncoderSink(settings), request.fps, request.outputPath);
+}
+
+void CaptureEngine::startRecording(std::unique_ptr<CaptureSource> source, std::unique_ptr<FrameSink> sink,
+                                   int fps) {
+    start(std::move(source), std::move(sink), fps, std::string());
+}
+
+void CaptureEngine::start(std::unique_ptr<CaptureSource> source, std::unique_ptr<FrameSink> sink, int fps,
+                          const std::string& outputPath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (recorder_) throw CaptureFailure(RIGID_ERROR_RECORDING_FAILED, "Already recording");
+
+    RecordingSettings settings;
+    settings.fps = fps;
+    settings.backpressure = backpressure_;
+    auto recorder = std::make_unique<ScreenRecorder>(std::move(source), std::move(sink), frames_, stats_, settings);
+    recorder->start();
+    recorder_ = std::move(recorder);
+    outputPath_ = outputPath;
+}
+
+std::string CaptureEngine::stopRecording() {
+    std::unique_ptr<ScreenRecorder> recorder;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!recorder_) throw CaptureFailure(RIGID_ERROR_NO_RECORDING, "No recording");
+        recorder = std::move(recorder_);
+        path = std::move(outputPath_);
+    }
+    // Draining the queue and finishing the file happen outside the lock, so
+    // status queries do not wait for them
+    recorder->stop();
+    return path;
+}
+
+bool CaptureEngine::cancelRecording() {
+    std::unique_ptr<ScreenRecorder> recorder;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!recorder_) return false;
+        recorder = std::move(recorder_);
+        path = std::move(outputPath_);
+    }
+    recorder->cancel();
+    recorder.reset();
+    if (!path.empty()) std::remove(path.c_str());
+    return true;
+}
+
+bool CaptureEngine::isRecording() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recorder_ && recorder_->isRecording();
+}
+
+int64_t CaptureEngine::recordingDurationMs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recorder_ ? recorder_->durationMs() : 0;
+}
+
+} // namespace rigid
+
+namespace {
+
+using rigid::CaptureEngine;
+
+char* copyString(const std::string& text) {
+    char* copy = static_cast<char*>(std::malloc(text.size() + 1));
+    if (copy) std::memcpy(copy, text.c_str(), text.size() + 1);
+    return copy;
+}
+
+bool validCodec(int32_t codec) {
+    return codec >= RIGID_CODEC_H264 && codec <= RIGID_CODEC_PRORES_422_HQ;
+}
+
+/// Start a recording of whatever `open` returns, mapping failures to the
+/// C API's error codes
+template <typename OpenSource>
+int32_t startRecording(RigidCaptureHandle handle, const char* outputPath, uint32_t fps, uint32_t bitrate,
+                       uint32_t keyframeInterval, int32_t codec, bool captureAudio, OpenSource open) {
+    if (!handle || !outputPath || !validCodec(codec)) return RIGID_ERROR_INVALID_CONFIG;
+    if (codec != RIGID_CODEC_H264) {
+        std::fprintf(stderr, "CaptureEngine: only H.264 is available on Linux, recording H.264\n");
+    }
+    if (captureAudio) {
+        std::fprintf(stderr, "CaptureEngine: audio capture is not available on Linux, recording video only\n");
+    }
+
+    rigid::RecordingRequest request;
+    request.outputPath = outputPath;
+    request.fps = fps > 0 ? static_cast<int>(fps) : 60;
+    request.bitrate = bitrate > 0 ? bitrate : 20000000;
+    request.keyframeInterval = keyframeInterval > 0 ? static_cast<int>(keyframeInterval) : 60;
+
+    try {
+        static_cast<CaptureEngine*>(handle)->startRecording(open(), request);
+        return RIGID_SUCCESS;
+    } catch (const rigid::CaptureFailure& e) {
+        std::fprintf(stderr, "CaptureEngine: %s\n", e.what());
+        return e.code;
+    } catch (const rigid::MediaError& e) {
+        std::fprintf(stderr, "CaptureEngine: %s\n", e.what());
+        return RIGID_ERROR_ENCODING_FAILED;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "CaptureEngine: %s\n", e.what());
+        return RIGID_ERROR_RECORDING_FAILED;
+    }
+}
+
+} // namespace
+
+// MARK: - C API
+
+extern "C" RigidCaptureHandle rigid_capture_create(void) {
+    return new rigid::CaptureEngine();
+}
+
+extern "C" void rigid_capture_destroy(RigidCaptureHandle handle) {
+    delete static_cast<rigid::CaptureEngine*>(handle);
+}
+
+extern "C" bool rigid_capture_check_permission(void) {
+    // X11 has no capture permission; any client may read the screen
+    return true;
+}
+
+extern "C" void rigid_capture_request_permission(void) {}
+
+extern "C" char* rigid_capture_list_windows_json(void) {
+    std::string json = "[";
+    for (const rigid::X11WindowInfo& window : rigid::listX11Windows()) {
+        if (json.size() > 1) json += ',';
+        json += "{\"window_id\":" + std::to_string(window.id) + ",\"title\":" + rigid::jsonQuote(window.title) +
+                ",\"owner_name\":" + rigid::jsonQuote(window.ownerName) + ",\"x\":" + std::to_string(window.x) +
+                ",\"y\":" + std::to_string(window.y) + ",\"width\":" + std::to_string(window.width) +
+                ",\"height\":" + std::to_string(window.height) + ",\"backing_scale_factor\":1.0}";
+    }
+    return copyString(json + "]");
+}
+
+extern "C" char* rigid_capture_list_displays_json(void) {
+    std::string json = "[";
+    for (const rigid::X11DisplayInfo& display : rigid::listX11Displays()) {
+        if (json.size() > 1) json += ',';
+        json += "{\"display_id\":" + std::to_string(display.id) + ",\"name\":" + rigid::jsonQuote(display.name) +
+                ",\"width\":" + std::to_string(display.width) + ",\"height\":" + std::to_string(display.height) +
+                ",\"backing_scale_factor\":1.0,\"is_main\":" + (display.isMain ? "true" : "false") + "}";
+    }
+    return copyString(json + "]");
+}
+
+extern "C" void rigid_free_string(char* str) {
+    std::free(str);
+}
+
+// Linux records at the source's own pixel size: X11 has no separate backing
+// resolution, so width, height and scale_factor are not used, and region
+// coordinates are display pixels.
+
+extern "C" int32_t rigid_capture_start_window_recording(
+    RigidCaptureHandle handle,
+    uint32_t window_id,
+    const char* output_path,
+    uint32_t /*width*/,
+    uint32_t /*height*/,
+    uint32_t fps,
+    uint32_t bitrate,
+    uint32_t keyframe_interval,
+    int32_t codec,
+    bool capture_cursor,
+    bool capture_audio,
+    float /*scale_factor*/
+) {
+    return startRecording(handle, output_path, fps, bitrate, keyframe_interval, codec, capture_audio, [&] {
+        return rigid::X11CaptureSource::openWindow(window_id, capture_cursor);
+    });
+}
+
+extern "C" int32_t rigid_capture_start_display_recording(
+    RigidCaptureHandle handle,
+    uint32_t display_id,
+    const char* output_path,
+    uint32_t /*width*/,
+    uint32_t /*height*/,
+    uint32_t fps,
+    uint32_t bitrate,
+    uint32_t keyframe_interval,
+    int32_t codec,
+    bool capture_cursor,
+    bool capture_audio,
+    float /*scale_factor*/
+) {
+    return startRecording(handle, output_path, fps, bitrate, keyframe_interval, codec, capture_audio, [&] {
+        return rigid::X11CaptureSource::openDisplay(display_id, capture_cursor);
+    });
+}
+
+extern "C" int32_t rigid_capture_start_region_recording(
+    RigidCaptureHandle handle,
+    uint32_t display_id,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    const char* output_path,
+    uint32_t fps,
+    uint32_t bitrate,
+    uint32_t keyframe_interval,
+    int32_t codec,
+    bool capture_cursor,
+    bool capture_audio,
+    float /*scale_factor*/
+) {
+    if (width <= 0 || height <= 0) return RIGID_ERROR_INVALID_CONFIG;
+    return startRecording(handle, output_path, fps, bitrate, keyframe_interval, codec, capture_audio, [&] {
+        return rigid::X11CaptureSource::openRegion(display_id, {x, y, width, height}, capture_cursor);
+    });
+}
+
+extern "C" int32_t rigid_capture_stop_recording(RigidCaptureHandle handle) {
+    if (!handle) return RIGID_ERROR_NO_RECORDING;
+    try {
+        static_cast<CaptureEngine*>(handle)->stopRecording();
+        return RIGID_SUCCESS;
+    } catch (const rigid::CaptureFailure& e) {
+        return e.code;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "CaptureEngine: %s\n", e.what());
+        return RIGID_ERROR_ENCODING_FAILED;
+    }
+}
+
+extern "C" int32_t rigid_capture_cancel_recording(RigidCaptureHandle handle) {
+    if (!handle || !static_cast<CaptureEngine*>(handle)->cancelRecording()) return RIGID_ERROR_NO_RECORDING;
+    return RIGID_SUCCESS;
+}
+
+extern "C" bool rigid_capture_is_recording(RigidCaptureHandle handle) {
+    return handle && static_cast<CaptureEngine*>(handle)->isRecording();
+}
+
+extern "C" int64_t rigid_capture_get_recording_duration_ms(RigidCaptureHandle handle) {
+    return handle ? static_cast<CaptureEngine*>(handle)->recordingDurationMs() : 0;
+}
+
+extern "C" int32_t rigid_capture_set_backpressure(RigidCaptureHandle handle, int32_t policy, uint32_t queue_depth) {
+    if (!handle) return RIGID_ERROR_INVALID_CONFIG;
+    if (policy < RIGID_BACKPRESSURE_DROP_NEWEST || policy > RIGID_BACKPRESSURE_ADAPTIVE_FPS) {
+        return RIGID_ERROR_INVALID_CONFIG;
+    }
+    rigid::BackpressureSettings settings;
+    settings.policy = rigid::backpressurePolicyFromC(policy);
+    if (queue_depth > 0) settings.queueDepth = queue_depth;
+    static_cast<CaptureEngine*>(handle)->setBackpressure(settings);
+    return RIGID_SUCCESS;
+}
+
+extern "C" int32_t rigid_capture_get_stats(RigidCaptureHandle handle, RigidCaptureStats* stats) {
+    if (!handle || !stats) return RIGID_ERROR_INVALID_CONFIG;
+    *stats = static_cast<CaptureEngine*>(handle)->stats().snapshot();
+    return RIGID_SUCCESS;
+}
+
+extern "C" int32_t rigid_capture_subscribe_frames(
+    RigidCaptureHandle handle,
+    RigidFrameCallback callback,
+    void* context,
+    uint64_t* subscription_id
+) {
+    if (!handle || !callback || !subscription_id) return RIGID_ERROR_INVALID_CONFIG;
+    *subscription_id = static_cast<CaptureEngine*>(handle)->frames().subscribe(callback, context);
+    return RIGID_SUCCESS;
+}
+
+extern "C" int32_t rigid_capture_unsubscribe_frames(RigidCaptureHandle handle, uint64_t subscription_id) {
+    if (!handle) return RIGID_ERROR_INVALID_CONFIG;
+    if (!static_cast<CaptureEngine*>(handle)->frames().unsubscribe(subscription_id)) {
+        return RIGID_ERROR_INVALID_CONFIG;
+    }
+    return RIGID_SUCCESS;
+}
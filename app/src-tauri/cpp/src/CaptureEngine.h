@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Backpressure.h"
+#include "CaptureSource.h"
+#include "FrameRing.h"
+#include "ScreenRecorder.h"
+
+namespace rigid {
+
+/// What to record into, from the rigid_capture_start_*_recording parameters
+struct RecordingRequest {
+    std::string outputPath;
+    int fps = 60;
+    int64_t bitrate = 0;
+    /// Frames between keyframes, 0 for the encoder's default
+    int keyframeInterval = 0;
+};
+
+/// Linux counterpart of the Swift CaptureEngine behind RigidCaptureHandle.
+///
+/// Owns the ring live frames are published through and the current
+/// recording. Subscriptions belong to the engine, so they carry over from
+/// one recording to the next; each recording configures the ring for its
+/// own frame size. Backpressure settings likewise apply from the next
+/// recording on, and the stats keep the last recording's numbers until
+/// another one starts.
+class CaptureEngine {
+public:
+    /// Frames a recording can have in flight between capture, encoder and
+    /// subscribers (the queueDepth the macOS recorder gives SCStream)
+    static constexpr size_t kFrameSlots = BackpressureSettings::kDefaultQueueDepth;
+
+    CaptureEngine() : frames_(kFrameSlots) {}
+    ~CaptureEngine();
+
+    CaptureEngine(const CaptureEngine&) = delete;
+    CaptureEngine& operator=(const CaptureEngine&) = delete;
+
+    FrameRing& frames() { return frames_; }
+
+    BackpressureSettings backpressure() const;
+    void setBackpressure(const BackpressureSettings& settings);
+
+    CaptureStats& stats() { return stats_; }
+
+    /// Record `source` into an H.264 file. Throws CaptureFailure when a
+    /// recording is already running and MediaError when the output cannot
+    /// be opened.
+    void startRecording(std::unique_ptr<CaptureSource> source, const RecordingRequest& request);
+
+    /// As startRecording, writing frames to `sink` instead of an encoder
+    void startRecording(std::unique_ptr<CaptureSource> source, std::unique_ptr<FrameSink> sink, int fps);
+
+    /// Stop and finish the file; returns its path. Throws CaptureFailure
+    /// without a recording and MediaError when encoding failed.
+    std::string stopRecording();
+
+    /// Stop and delete the partial file. False without a recording.
+    bool cancelRecording();
+
+    bool isRecording() const;
+    int64_t recordingDurationMs() const;
+
+private:
+    void start(std::unique_ptr<CaptureSource> source, std::unique_ptr<FrameSink> sink, int fps,
+               const std::string& outputPath);
+
+    FrameRing frames_;
+    CaptureStats stats_;
+
+    mutable std::mutex mutex_;
+    BackpressureSettings backpressure_;
+    std::unique_ptr<ScreenRecorder> recorder_;
+    std::string outputPath_;
+};
+
+} // namespace rigid
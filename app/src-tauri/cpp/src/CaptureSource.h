@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Frame.h"
+#include "RigidCaptureKit.h"
+
+namespace rigid {
+
+/// Thrown when a capture target cannot be opened or recorded; `code` is
+/// what the C API reports
+class CaptureFailure : public std::runtime_error {
+public:
+    CaptureFailure(RigidErrorCode code, const std::string& message) : std::runtime_error(message), code(code) {}
+
+    const RigidErrorCode code;
+};
+
+/// Where a ScreenRecorder's pixels come from: a display, a region of one or
+/// a window, at a fixed size for the whole recording
+class CaptureSource {
+public:
+    virtual ~CaptureSource() = default;
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    /// Write the current contents as opaque BGRA (alpha 255) into `pixels`,
+    /// width() x height() with `stride` bytes per row. False once the target
+    /// is gone (the window closed); the recording then ends.
+    virtual bool capture(uint8_t* pixels, int stride) = 0;
+
+    /// As capture(), for `area` only (within width() x height()); `pixels`
+    /// is area.width x area.height. Sources that can read less than their
+    /// whole size override this; by default the whole frame is captured and
+    /// the area copied out.
+    virtual bool captureArea(const PixelRect& area, uint8_t* pixels, int stride) {
+        const int fullStride = width() * 4;
+        std::vector<uint8_t> full(static_cast<size_t>(fullStride) * height());
+        if (!capture(full.data(), fullStride)) return false;
+        for (int y = 0; y < area.height; y++) {
+            std::memcpy(pixels + static_cast<size_t>(y) * stride,
+                        &full[static_cast<size_t>(area.y + y) * fullStride + static_cast<size_t>(area.x) * 4],
+                        static_cast<size_t>(area.width) * 4);
+        }
+        return true;
+    }
+};
+
+} // namespace rigid
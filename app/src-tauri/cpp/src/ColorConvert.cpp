@@ -0,0 +1,276 @@
+#include "ColorConvert.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#define RIGID_CONVERT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define RIGID_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rigid {
+
+namespace {
+
+// MARK: - BT.709 coefficients
+//
+// Limited range: Y in 16-235, Cb/Cr in 16-240. Luma coefficients are in
+// 1/32768 units; chroma works on 2x2 sums, so it shifts by two more bits.
+
+constexpr double kKr = 0.2126;
+constexpr double kKb = 0.0722;
+constexpr double kKg = 1 - kKr - kKb;
+constexpr double kLumaScale = 219.0 / 255.0;
+constexpr double kCbScale = 224.0 / 255.0 / (2 * (1 - kKb));
+constexpr double kCrScale = 224.0 / 255.0 / (2 * (1 - kKr));
+
+constexpr int fixed15(double v) {
+    return static_cast<int>(v * 32768 + (v >= 0 ? 0.5 : -0.5));
+}
+
+constexpr int kYR = fixed15(kLumaScale * kKr);
+constexpr int kYG = fixed15(kLumaScale * kKg);
+constexpr int kYB = fixed15(kLumaScale * kKb);
+constexpr int kUR = fixed15(-kCbScale * kKr);
+constexpr int kUG = fixed15(-kCbScale * kKg);
+constexpr int kUB = fixed15(kCbScale * (1 - kKb));
+constexpr int kVR = fixed15(kCrScale * (1 - kKr));
+constexpr int kVG = fixed15(-kCrScale * kKg);
+constexpr int kVB = fixed15(-kCrScale * kKb);
+
+/// Offset plus rounding half, before the shift
+constexpr int kLumaBias = (16 << 15) + (1 << 14);
+constexpr int kChromaBias = (128 << 17) + (1 << 16);
+
+// MARK: - Scalar
+
+inline uint8_t lumaOf(const uint8_t* p) {
+    return static_cast<uint8_t>((kYB * p[0] + kYG * p[1] + kYR * p[2] + kLumaBias) >> 15);
+}
+
+inline uint8_t chromaOf(int sumB, int sumG, int sumR, int cb, int cg, int cr) {
+    int value = (cb * sumB + cg * sumG + cr * sumR + kChromaBias) >> 17;
+    return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+}
+
+/// Destination rows for one pair of source rows
+struct RowPair {
+    const uint8_t* src0;
+    const uint8_t* src1;  // The row below, or src0 repeated on an odd last row
+    uint8_t* y0;
+    uint8_t* y1;          // nullptr when the second row is outside the rect
+    uint8_t* u;
+    uint8_t* v;
+};
+
+inline void storeChroma(const RowPair& rows, bool interleaved, int chromaIndex, uint8_t u, uint8_t v) {
+    if (interleaved) {
+        rows.u[chromaIndex * 2] = u;
+        rows.u[chromaIndex * 2 + 1] = v;
+    } else {
+        rows.u[chromaIndex] = u;
+        rows.v[chromaIndex] = v;
+    }
+}
+
+/// Columns [x0, x1), x0 even; `frameWidth` bounds the repeated last column
+void convertScalar(const RowPair& rows, bool interleaved, int x0, int x1, int frameWidth) {
+    for (int x = x0; x < x1; x += 2) {
+        int right = std::min(x + 1, frameWidth - 1);
+        const uint8_t* p00 = rows.src0 + static_cast<size_t>(x) * 4;
+        const uint8_t* p01 = rows.src0 + static_cast<size_t>(right) * 4;
+        const uint8_t* p10 = rows.src1 + static_cast<size_t>(x) * 4;
+        const uint8_t* p11 = rows.src1 + static_cast<size_t>(right) * 4;
+
+        rows.y0[x] = lumaOf(p00);
+        if (x + 1 < x1) rows.y0[x + 1] = lumaOf(p01);
+        if (rows.y1) {
+            rows.y1[x] = lumaOf(p10);
+            if (x + 1 < x1) rows.y1[x + 1] = lumaOf(p11);
+        }
+
+        int sumB = p00[0] + p01[0] + p10[0] + p11[0];
+        int sumG = p00[1] + p01[1] + p10[1] + p11[1];
+        int sumR = p00[2] + p01[2] + p10[2] + p11[2];
+        storeChroma(rows, interleaved, x / 2, chromaOf(sumB, sumG, sumR, kUB, kUG, kUR),
+                    chromaOf(sumB, sumG, sumR, kVB, kVG, kVR));
+    }
+}
+
+#if RIGID_CONVERT_SSE2
+
+// MARK: - SSE2
+//
+// Sixteen pixels per step. Pixels widen to 16-bit lanes and madd against
+// (B, G, R, 0) coefficients, giving the same integer sums as the scalar path.
+
+constexpr int kVectorPixels = 16;
+
+/// Four dot products from two registers of two BGRA pixels (or 2x2 sums) each
+inline __m128i dot4(__m128i lo, __m128i hi, __m128i coefficients) {
+    __m128 a = _mm_castsi128_ps(_mm_madd_epi16(lo, coefficients));
+    __m128 b = _mm_castsi128_ps(_mm_madd_epi16(hi, coefficients));
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_add_epi32(even, odd);
+}
+
+inline void luma16(const uint8_t* src, uint8_t* dst) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coefficients = _mm_setr_epi16(kYB, kYG, kYR, 0, kYB, kYG, kYR, 0);
+    const __m128i bias = _mm_set1_epi32(kLumaBias);
+    __m128i y[4];
+    for (int k = 0; k < 4; k++) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k * 16));
+        __m128i sum = dot4(_mm_unpacklo_epi8(px, zero), _mm_unpackhi_epi8(px, zero), coefficients);
+        y[k] = _mm_srai_epi32(_mm_add_epi32(sum, bias), 15);
+    }
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(y[0], y[1]), _mm_packs_epi32(y[2], y[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), packed);
+}
+
+/// Eight chroma samples of one plane from 2x2 block sums
+inline __m128i chroma8(const __m128i blocks[4], __m128i coefficients) {
+    const __m128i bias = _mm_set1_epi32(kChromaBias);
+    __m128i first = _mm_srai_epi32(_mm_add_epi32(dot4(blocks[0], blocks[1], coefficients), bias), 17);
+    __m128i second = _mm_srai_epi32(_mm_add_epi32(dot4(blocks[2], blocks[3], coefficients), bias), 17);
+    __m128i words = _mm_packs_epi32(first, second);
+    return _mm_packus_epi16(words, words);
+}
+
+void convert16(const RowPair& rows, bool interleaved, int x) {
+    const uint8_t* src0 = rows.src0 + static_cast<size_t>(x) * 4;
+    const uint8_t* src1 = rows.src1 + static_cast<size_t>(x) * 4;
+    luma16(src0, rows.y0 + x);
+    if (rows.y1) luma16(src1, rows.y1 + x);
+
+    // 2x2 sums, two blocks per register: (B, G, R, A) for pixels 0-1, then 2-3
+    const __m128i zero = _mm_setzero_si128();
+    __m128i blocks[4];
+    for (int k = 0; k < 4; k++) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + k * 16));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + k * 16));
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+        blocks[k] = _mm_unpacklo_epi64(lo, hi);
+    }
+    __m128i u = chroma8(blocks, _mm_setr_epi16(kUB, kUG, kUR, 0, kUB, kUG, kUR, 0));
+    __m128i v = chroma8(blocks, _mm_setr_epi16(kVB, kVG, kVR, 0, kVB, kVG, kVR, 0));
+
+    int c = x / 2;
+    if (interleaved) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rows.u + c * 2), _mm_unpacklo_epi8(u, v));
+    } else {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(rows.u + c), u);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(rows.v + c), v);
+    }
+}
+
+#elif RIGID_CONVERT_NEON
+
+// MARK: - NEON
+//
+// Eight pixels per step, deinterleaved by vld4 and widened to 16 bits.
+
+constexpr int kVectorPixels = 8;
+
+inline int32x4_t dot(int16x4_t b, int16x4_t g, int16x4_t r, int cb, int cg, int cr) {
+    int32x4_t sum = vmull_n_s16(b, static_cast<int16_t>(cb));
+    sum = vmlal_n_s16(sum, g, static_cast<int16_t>(cg));
+    return vmlal_n_s16(sum, r, static_cast<int16_t>(cr));
+}
+
+inline void luma8(const uint8x8x4_t& px, uint8_t* dst) {
+    int16x8_t b = vreinterpretq_s16_u16(vmovl_u8(px.val[0]));
+    int16x8_t g = vreinterpretq_s16_u16(vmovl_u8(px.val[1]));
+    int16x8_t r = vreinterpretq_s16_u16(vmovl_u8(px.val[2]));
+    int32x4_t bias = vdupq_n_s32(kLumaBias);
+    int32x4_t lo = vaddq_s32(dot(vget_low_s16(b), vget_low_s16(g), vget_low_s16(r), kYB, kYG, kYR), bias);
+    int32x4_t hi = vaddq_s32(dot(vget_high_s16(b), vget_high_s16(g), vget_high_s16(r), kYB, kYG, kYR), bias);
+    vst1_u8(dst, vqmovun_s16(vcombine_s16(vshrn_n_s32(lo, 15), vshrn_n_s32(hi, 15))));
+}
+
+inline void store4(uint8_t* dst, int32x4_t sum) {
+    int16x4_t words = vshrn_n_s32(vaddq_s32(sum, vdupq_n_s32(kChromaBias)), 17);
+    uint8x8_t bytes = vqmovun_s16(vcombine_s16(words, words));
+    uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    std::memcpy(dst, &packed, 4);
+}
+
+void convert8(const RowPair& rows, bool interleaved, int x) {
+    uint8x8x4_t top = vld4_u8(rows.src0 + static_cast<size_t>(x) * 4);
+    uint8x8x4_t bottom = vld4_u8(rows.src1 + static_cast<size_t>(x) * 4);
+    luma8(top, rows.y0 + x);
+    if (rows.y1) luma8(bottom, rows.y1 + x);
+
+    // Vertical sums, then adjacent pairs: four 2x2 block sums per channel
+    auto blockSums = [&](int channel) {
+        uint16x8_t column = vaddl_u8(top.val[channel], bottom.val[channel]);
+        return vreinterpret_s16_u16(vpadd_u16(vget_low_u16(column), vget_high_u16(column)));
+    };
+    int16x4_t b = blockSums(0);
+    int16x4_t g = blockSums(1);
+    int16x4_t r = blockSums(2);
+
+    uint8_t u[4];
+    uint8_t v[4];
+    store4(u, dot(b, g, r, kUB, kUG, kUR));
+    store4(v, dot(b, g, r, kVB, kVG, kVR));
+    for (int i = 0; i < 4; i++) storeChroma(rows, interleaved, x / 2 + i, u[i], v[i]);
+}
+
+#endif
+
+} // namespace
+
+YuvPlanes planesOf(YuvImage& image) {
+    YuvPlanes planes;
+    planes.y = image.y.data();
+    planes.yStride = image.width;
+    planes.u = image.u.data();
+    planes.uStride = image.chromaWidth();
+    planes.v = image.v.data();
+    planes.vStride = image.chromaWidth();
+    return planes;
+}
+
+void convertBgraToYuv420(const uint8_t* pixels, int stride, int width, int height, const PixelRect& rect,
+                         const YuvPlanes& planes) {
+    const int xEnd = rect.x + rect.width;
+    const int yEnd = rect.y + rect.height;
+    for (int y = rect.y; y < yEnd; y += 2) {
+        RowPair rows;
+        rows.src0 = pixels + static_cast<size_t>(y) * stride;
+        rows.src1 = pixels + static_cast<size_t>(std::min(y + 1, height - 1)) * stride;
+        rows.y0 = planes.y + static_cast<size_t>(y) * planes.yStride;
+        rows.y1 = y + 1 < yEnd ? rows.y0 + planes.yStride : nullptr;
+        rows.u = planes.u + static_cast<size_t>(y / 2) * planes.uStride;
+        rows.v = planes.interleaved ? nullptr : planes.v + static_cast<size_t>(y / 2) * planes.vStride;
+
+        int x = rect.x;
+#if RIGID_CONVERT_SSE2
+        for (; x + kVectorPixels <= xEnd; x += kVectorPixels) convert16(rows, planes.interleaved, x);
+#elif RIGID_CONVERT_NEON
+        for (; x + kVectorPixels <= xEnd; x += kVectorPixels) convert8(rows, planes.interleaved, x);
+#endif
+        convertScalar(rows, planes.interleaved, x, xEnd, width);
+    }
+}
+
+void convertBgraToYuv420(const Frame& frame, const PixelRect& rect, const YuvPlanes& planes) {
+    convertBgraToYuv420(frame.pixels.data(), frame.stride, frame.width, frame.height, rect, planes);
+}
+
+void convertBgraToYuv420(Frame& frame) {
+    if (frame.yuv.width != frame.width || frame.yuv.height != frame.height) {
+        frame.yuv.allocate(frame.width, frame.height);
+    }
+    convertBgraToYuv420(frame, {0, 0, frame.width, frame.height}, planesOf(frame.yuv));
+}
+
+} // namespace rigid
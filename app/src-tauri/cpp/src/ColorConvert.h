@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Frame.h"
+
+namespace rigid {
+
+/// Destination planes of a 4:2:0 conversion
+struct YuvPlanes {
+    uint8_t* y = nullptr;
+    int yStride = 0;
+    /// I420: the U plane. NV12: the interleaved UV plane.
+    uint8_t* u = nullptr;
+    int uStride = 0;
+    /// I420 only
+    uint8_t* v = nullptr;
+    int vStride = 0;
+    /// NV12 stores U and V interleaved in `u`
+    bool interleaved = false;
+};
+
+/// Planes of `image` (I420)
+YuvPlanes planesOf(YuvImage& image);
+
+/// Convert `rect` of a BGRA frame to BT.709 limited-range 4:2:0, the same
+/// color properties the macOS recorder tags (AVVideoColorPropertiesKey) and
+/// the encoders write. Premultiplied pixels convert as if over black.
+///
+/// `rect.x` and `rect.y` must be even. Each chroma sample averages a 2x2
+/// block, with the last column or row repeated when a dimension is odd.
+/// Integer arithmetic only, so the SIMD and scalar paths agree exactly.
+void convertBgraToYuv420(const Frame& frame, const PixelRect& rect, const YuvPlanes& planes);
+
+/// Same, for BGRA pixels outside a Frame (a capture buffer), `width` x
+/// `height` with `stride` bytes per row
+void convertBgraToYuv420(const uint8_t* pixels, int stride, int width, int height, const PixelRect& rect,
+                         const YuvPlanes& planes);
+
+/// Convert the whole frame into `frame.yuv`
+void convertBgraToYuv420(Frame& frame);
+
+} // namespace rigid
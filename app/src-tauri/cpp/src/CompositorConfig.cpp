@@ -0,0 +1,192 @@
+#include "CompositorConfig.h"
+
+#include <algorithm>
+
+#include "Json.h"
+
+namespace rigid {
+
+namespace {
+
+ClipSourceType parseSourceType(const std::string& value) {
+    if (value == "video") return ClipSourceType::Video;
+    if (value == "image") return ClipSourceType::Image;
+    if (value == "audio") return ClipSourceType::Audio;
+    throw JsonError("Unknown source_type '" + value + "'");
+}
+
+BackgroundType parseBackgroundType(const std::string& value) {
+    if (value == "solid") return BackgroundType::Solid;
+    if (value == "gradient") return BackgroundType::Gradient;
+    if (value == "image") return BackgroundType::Image;
+    throw JsonError("Unknown background_type '" + value + "'");
+}
+
+CompositorQuality parseQuality(const std::string& value) {
+    if (value == "draft") return CompositorQuality::Draft;
+    if (value == "good") return CompositorQuality::Good;
+    if (value == "high") return CompositorQuality::High;
+    if (value == "max") return CompositorQuality::Max;
+    throw JsonError("Unknown quality '" + value + "'");
+}
+
+std::optional<int> optInt(const JsonValue& json, const char* key) {
+    auto value = json.optInt64(key);
+    if (!value) return std::nullopt;
+    return static_cast<int>(*value);
+}
+
+CompositorBackground parseBackground(const JsonValue& json) {
+    CompositorBackground bg;
+    bg.backgroundType = parseBackgroundType(json.at("background_type").asString());
+    bg.color = json.optString("color");
+    if (const JsonValue* stops = json.find("gradient_stops")) {
+        std::vector<GradientStop> parsed;
+        for (const JsonValue& stop : stops->asArray()) {
+            parsed.push_back({stop.at("color").asString(), stop.at("position").asDouble()});
+        }
+        bg.gradientStops = std::move(parsed);
+    }
+    bg.gradientAngle = optInt(json, "gradient_angle");
+    bg.imageUrl = json.optString("image_url");
+    bg.mediaPath = json.optString("media_path");
+    return bg;
+}
+
+CompositorClip parseClip(const JsonValue& json) {
+    CompositorClip clip;
+    clip.sourcePath = json.at("source_path").asString();
+    clip.sourceType = parseSourceType(json.at("source_type").asString());
+    clip.startTimeMs = json.at("start_time_ms").asInt64();
+    clip.durationMs = json.at("duration_ms").asInt64();
+    clip.inPointMs = json.at("in_point_ms").asInt64();
+    clip.positionX = json.optDouble("position_x");
+    clip.positionY = json.optDouble("position_y");
+    clip.scale = json.optDouble("scale");
+    clip.opacity = json.optDouble("opacity");
+    clip.cornerRadius = optInt(json, "corner_radius");
+    clip.cropTop = optInt(json, "crop_top");
+    clip.cropBottom = optInt(json, "crop_bottom");
+    clip.cropLeft = optInt(json, "crop_left");
+    clip.cropRight = optInt(json, "crop_right");
+    clip.zIndex = static_cast<int>(json.at("z_index").asInt64());
+    clip.hasAudio = json.optBool("has_audio");
+    clip.trackId = json.optString("track_id");
+    clip.muted = json.optBool("muted");
+    clip.speed = json.optDouble("speed");
+    clip.freezeFrame = json.optBool("freeze_frame");
+    clip.freezeFrameTimeMs = json.optInt64("freeze_frame_time_ms");
+    clip.transitionInType = json.optString("transition_in_type");
+    clip.transitionInDurationMs = json.optInt64("transition_in_duration_ms");
+    clip.transitionOutType = json.optString("transition_out_type");
+    clip.transitionOutDurationMs = json.optInt64("transition_out_duration_ms");
+    clip.audioFadeInMs = json.optInt64("audio_fade_in_ms");
+    clip.audioFadeOutMs = json.optInt64("audio_fade_out_ms");
+    return clip;
+}
+
+CompositorZoomClip parseZoomClip(const JsonValue& json) {
+    CompositorZoomClip zoom;
+    zoom.targetTrackId = json.at("target_track_id").asString();
+    zoom.startTimeMs = json.at("start_time_ms").asInt64();
+    zoom.durationMs = json.at("duration_ms").asInt64();
+    zoom.zoomScale = json.at("zoom_scale").asDouble();
+    zoom.zoomCenterX = json.at("zoom_center_x").asDouble();
+    zoom.zoomCenterY = json.at("zoom_center_y").asDouble();
+    zoom.easeInDurationMs = json.at("ease_in_duration_ms").asInt64();
+    zoom.easeOutDurationMs = json.at("ease_out_duration_ms").asInt64();
+    return zoom;
+}
+
+CompositorBlurClip parseBlurClip(const JsonValue& json) {
+    CompositorBlurClip blur;
+    blur.startTimeMs = json.at("start_time_ms").asInt64();
+    blur.durationMs = json.at("duration_ms").asInt64();
+    blur.blurIntensity = json.at("blur_intensity").asDouble();
+    blur.regionX = json.at("region_x").asDouble();
+    blur.regionY = json.at("region_y").asDouble();
+    blur.regionWidth = json.at("region_width").asDouble();
+    blur.regionHeight = json.at("region_height").asDouble();
+    blur.cornerRadius = json.at("corner_radius").asDouble();
+    blur.easeInDurationMs = json.at("ease_in_duration_ms").asInt64();
+    blur.easeOutDurationMs = json.at("ease_out_duration_ms").asInt64();
+    blur.zIndex = static_cast<int>(json.at("z_index").asInt64());
+    return blur;
+}
+
+CompositorPanClip parsePanClip(const JsonValue& json) {
+    CompositorPanClip pan;
+    pan.targetTrackId = json.at("target_track_id").asString();
+    pan.startTimeMs = json.at("start_time_ms").asInt64();
+    pan.durationMs = json.at("duration_ms").asInt64();
+    pan.startX = json.at("start_x").asDouble();
+    pan.startY = json.at("start_y").asDouble();
+    pan.endX = json.at("end_x").asDouble();
+    pan.endY = json.at("end_y").asDouble();
+    pan.easeInDurationMs = json.at("ease_in_duration_ms").asInt64();
+    pan.easeOutDurationMs = json.at("ease_out_duration_ms").asInt64();
+    pan.zIndex = static_cast<int>(json.at("z_index").asInt64());
+    return pan;
+}
+
+template <typename T, typename Parse>
+std::optional<std::vector<T>> parseOptionalArray(const JsonValue& json, const char* key, Parse parse) {
+    const JsonValue* array = json.find(key);
+    if (!array) return std::nullopt;
+    std::vector<T> items;
+    for (const JsonValue& item : array->asArray()) {
+        items.push_back(parse(item));
+    }
+    return items;
+}
+
+} // namespace
+
+double CompositorClip::clampedSpeed() const {
+    return std::min(std::max(speed.value_or(1.0), 0.25), 4.0);
+}
+
+CompositorConfig CompositorConfig::fromJson(const std::string& text) {
+    JsonValue json = JsonValue::parse(text);
+
+    CompositorConfig config;
+    config.width = static_cast<int>(json.at("width").asInt64());
+    config.height = static_cast<int>(json.at("height").asInt64());
+    config.frameRate = static_cast<int>(json.at("frame_rate").asInt64());
+    config.durationMs = json.at("duration_ms").asInt64();
+    config.format = json.at("format").asString();
+    config.quality = parseQuality(json.at("quality").asString());
+    config.outputPath = json.at("output_path").asString();
+    if (const JsonValue* bg = json.find("background")) {
+        config.background = parseBackground(*bg);
+    }
+    for (const JsonValue& clip : json.at("clips").asArray()) {
+        config.clips.push_back(parseClip(clip));
+    }
+    config.zoomClips = parseOptionalArray<CompositorZoomClip>(json, "zoom_clips", parseZoomClip);
+    config.blurClips = parseOptionalArray<CompositorBlurClip>(json, "blur_clips", parseBlurClip);
+    config.panClips = parseOptionalArray<CompositorPanClip>(json, "pan_clips", parsePanClip);
+    config.segmentCacheDir = json.optString("segment_cache_dir");
+
+    if (config.width <= 0 || config.height <= 0 || config.frameRate <= 0) {
+        throw JsonError("width, height and frame_rate must be positive");
+    }
+    return config;
+}
+
+int64_t bitrateForQuality(CompositorQuality quality, int width, int height) {
+    int64_t pixels = static_cast<int64_t>(width) * height;
+    bool is4K = pixels >= 3840 * 2160;
+    bool is1440p = pixels >= 2560 * 1440 && !is4K;
+    int64_t multiplier = is4K ? 4 : (is1440p ? 2 : 1);
+
+    switch (quality) {
+    case CompositorQuality::Draft: return 2'000'000 * multiplier;
+    case CompositorQuality::Good: return 12'000'000 * multiplier;
+    case CompositorQuality::High: return 25'000'000 * multiplier;
+    case CompositorQuality::Max: return 50'000'000 * multiplier;
+    }
+    return 12'000'000 * multiplier;
+}
+
+} // namespace rigid
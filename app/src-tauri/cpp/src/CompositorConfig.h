@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rigid {
+
+class JsonValue;
+
+// MARK: - Data Structures
+//
+// Mirrors the Codable structs in VideoCompositor.swift so both engines accept
+// the exact same CompositorConfig JSON produced by `render_demo_native`.
+
+/// Clip types for rendering
+enum class ClipSourceType { Video, Image, Audio };
+
+/// Background types
+enum class BackgroundType { Solid, Gradient, Image };
+
+/// Gradient stop for gradient backgrounds
+struct GradientStop {
+    std::string color;
+    double position = 0;
+};
+
+/// Background configuration
+struct CompositorBackground {
+    BackgroundType backgroundType = BackgroundType::Solid;
+    std::optional<std::string> color;
+    std::optional<std::vector<GradientStop>> gradientStops;
+    std::optional<int> gradientAngle;
+    std::optional<std::string> imageUrl;
+    std::optional<std::string> mediaPath;
+};
+
+/// Clip configuration
+struct CompositorClip {
+    std::string sourcePath;
+    ClipSourceType sourceType = ClipSourceType::Video;
+    int64_t startTimeMs = 0;
+    int64_t durationMs = 0;
+    int64_t inPointMs = 0;
+    std::optional<double> positionX;
+    std::optional<double> positionY;
+    std::optional<double> scale;
+    std::optional<double> opacity;
+    std::optional<int> cornerRadius;
+    std::optional<int> cropTop;
+    std::optional<int> cropBottom;
+    std::optional<int> cropLeft;
+    std::optional<int> cropRight;
+    int zIndex = 0;
+    std::optional<bool> hasAudio;
+    std::optional<std::string> trackId;
+    std::optional<bool> muted;
+    std::optional<double> speed;  // Playback speed multiplier (e.g., 0.5 = half speed, 2.0 = double speed)
+    // Freeze frame
+    std::optional<bool> freezeFrame;
+    std::optional<int64_t> freezeFrameTimeMs;
+    // Transitions
+    std::optional<std::string> transitionInType;    // fade, slide_up, slide_down, slide_left, slide_right, scale, blur
+    std::optional<int64_t> transitionInDurationMs;
+    std::optional<std::string> transitionOutType;
+    std::optional<int64_t> transitionOutDurationMs;
+    // Audio fade
+    std::optional<int64_t> audioFadeInMs;
+    std::optional<int64_t> audioFadeOutMs;
+
+    /// Speed clamped to the range both engines support (0.25x to 4x)
+    double clampedSpeed() const;
+};
+
+/// Zoom effect configuration
+struct CompositorZoomClip {
+    std::string targetTrackId;
+    int64_t startTimeMs = 0;
+    int64_t durationMs = 0;
+    double zoomScale = 1;
+    double zoomCenterX = 50;
+    double zoomCenterY = 50;
+    int64_t easeInDurationMs = 0;
+    int64_t easeOutDurationMs = 0;
+};
+
+/// Blur effect configuration
+struct CompositorBlurClip {
+    int64_t startTimeMs = 0;
+    int64_t durationMs = 0;
+    double blurIntensity = 0;
+    double regionX = 0;
+    double regionY = 0;
+    double regionWidth = 0;
+    double regionHeight = 0;
+    double cornerRadius = 0;
+    int64_t easeInDurationMs = 0;
+    int64_t easeOutDurationMs = 0;
+    int zIndex = 0;
+};
+
+/// Pan animation configuration
+struct CompositorPanClip {
+    std::string targetTrackId;
+    int64_t startTimeMs = 0;
+    int64_t durationMs = 0;
+    double startX = 0;
+    double startY = 0;
+    double endX = 0;
+    double endY = 0;
+    int64_t easeInDurationMs = 0;
+    int64_t easeOutDurationMs = 0;
+    int zIndex = 0;
+};
+
+/// Quality presets
+enum class CompositorQuality { Draft, Good, High, Max };
+
+/// Full render configuration
+struct CompositorConfig {
+    int width = 0;
+    int height = 0;
+    int frameRate = 0;
+    int64_t durationMs = 0;
+    std::string format;
+    CompositorQuality quality = CompositorQuality::Good;
+    std::string outputPath;
+    std::optional<CompositorBackground> background;
+    std::vector<CompositorClip> clips;
+    std::optional<std::vector<CompositorZoomClip>> zoomClips;
+    std::optional<std::vector<CompositorBlurClip>> blurClips;
+    std::optional<std::vector<CompositorPanClip>> panClips;
+    /// Directory for reusable export segments (Linux engine only). When set,
+    /// a re-export re-encodes only the stretches of timeline that changed.
+    std::optional<std::string> segmentCacheDir;
+
+    /// Decode a config from JSON. Throws JsonError on malformed input or
+    /// missing required keys, matching JSONDecoder's strictness on the Swift side.
+    static CompositorConfig fromJson(const std::string& json);
+
+    int64_t totalFrames() const { return durationMs * frameRate / 1000; }
+};
+
+/// Target bitrate for a quality preset (same table as VideoCompositorEngine.bitrateForQuality)
+int64_t bitrateForQuality(CompositorQuality quality, int width, int height);
+
+} // namespace rigid
@@ -0,0 +1,81 @@
+#include "CornerMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rigid {
+
+CornerMask::CornerMask(int width, int height, double radius)
+    : width_(width), height_(height), radius_(radius), extent_(0) {
+    double clamped = std::min(radius, std::min(width, height) / 2.0);
+    if (clamped <= 0) return;
+    extent_ = static_cast<int>(std::ceil(clamped));
+    tile_.assign(static_cast<size_t>(extent_) * extent_, 255);
+
+    for (int y = 0; y < extent_; y++) {
+        for (int x = 0; x < extent_; x++) {
+            double dx = clamped - (x + 0.5);
+            double dy = clamped - (y + 0.5);
+            if (dx <= 0 || dy <= 0) continue;
+            double distance = std::sqrt(dx * dx + dy * dy);
+            double coverage = std::min(std::max(clamped - distance + 0.5, 0.0), 1.0);
+            tile_[static_cast<size_t>(y) * extent_ + x] = static_cast<uint8_t>(coverage * 255 + 0.5);
+        }
+    }
+}
+
+int CornerMask::tileIndex(int position, int size) const {
+    if (position < extent_) return position;
+    if (position >= size - extent_) return size - 1 - position;
+    return -1;
+}
+
+uint8_t CornerMask::at(int x, int y) const {
+    int tx = tileIndex(x, width_);
+    int ty = tileIndex(y, height_);
+    if (tx < 0 || ty < 0) return 255;
+    return tile_[static_cast<size_t>(ty) * extent_ + tx];
+}
+
+bool CornerMask::touchesRow(double sy) const {
+    if (extent_ == 0) return false;
+    int y0 = static_cast<int>(std::floor(sy));
+    int first = std::min(std::max(y0, 0), height_ - 1);
+    int second = std::min(std::max(y0 + 1, 0), height_ - 1);
+    return tileIndex(first, height_) >= 0 || tileIndex(second, height_) >= 0;
+}
+
+uint8_t CornerMask::sample(double sx, double sy) const {
+    if (extent_ == 0) return 255;
+    double fx = std::floor(sx);
+    double fy = std::floor(sy);
+    int x0 = std::min(std::max(static_cast<int>(fx), 0), width_ - 1);
+    int x1 = std::min(std::max(static_cast<int>(fx) + 1, 0), width_ - 1);
+    if (tileIndex(x0, width_) < 0 && tileIndex(x1, width_) < 0) return 255;
+    int y0 = std::min(std::max(static_cast<int>(fy), 0), height_ - 1);
+    int y1 = std::min(std::max(static_cast<int>(fy) + 1, 0), height_ - 1);
+
+    float ax = static_cast<float>(sx - fx);
+    float ay = static_cast<float>(sy - fy);
+    float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * ax;
+    float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * ax;
+    float coverage = top + (bottom - top) * ay;
+    return static_cast<uint8_t>(std::min(std::max(coverage, 0.0f), 255.0f) + 0.5f);
+}
+
+const CornerMask& CornerMaskCache::maskFor(int width, int height, double radius) {
+    for (auto it = masks_.begin(); it != masks_.end(); ++it) {
+        if (it->width() == width && it->height() == height && it->radius() == radius) {
+            masks_.splice(masks_.begin(), masks_, it);
+            return masks_.front();
+        }
+    }
+    masks_.emplace_front(width, height, radius);
+    return masks_.front();
+}
+
+void CornerMaskCache::trim() {
+    while (masks_.size() > kCapacity) masks_.pop_back();
+}
+
+} // namespace rigid
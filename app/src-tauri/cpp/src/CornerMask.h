@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+namespace rigid {
+
+/// Anti-aliased rounded-rectangle coverage of a width x height image (the
+/// CIRoundedRectangleGenerator mask). Only the top-left corner tile is
+/// stored; the other three corners mirror it and the rest is fully covered.
+class CornerMask {
+public:
+    CornerMask(int width, int height, double radius);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    double radius() const { return radius_; }
+    /// Side of the square corner tiles in pixels (0 when nothing is masked)
+    int extent() const { return extent_; }
+
+    /// Coverage of pixel (x, y), 0-255; 255 outside the corner tiles
+    uint8_t at(int x, int y) const;
+
+    /// Whether a bilinear sample on source row `sy` reads a corner tile row
+    bool touchesRow(double sy) const;
+
+    /// Bilinear coverage at a source position (same addressing as the clip
+    /// sampler, edges clamped). Returns 255 without filtering outside the tiles.
+    uint8_t sample(double sx, double sy) const;
+
+private:
+    int width_;
+    int height_;
+    double radius_;
+    int extent_;
+    /// extent x extent coverage of the top-left corner
+    std::vector<uint8_t> tile_;
+
+    /// Index into the tile along an axis of `size` pixels, or -1 in the uncovered middle
+    int tileIndex(int position, int size) const;
+};
+
+/// Recently used corner masks. Clip size and radius rarely change between
+/// frames, so each mask is built once and reused for the whole export.
+class CornerMaskCache {
+public:
+    /// Mask for a `width` x `height` image with corner `radius`. The
+    /// reference stays valid until the next trim().
+    const CornerMask& maskFor(int width, int height, double radius);
+
+    /// Drop the least recently used masks beyond the capacity
+    void trim();
+
+    size_t size() const { return masks_.size(); }
+
+private:
+    static constexpr size_t kCapacity = 8;
+    /// Most recently used first
+    std::list<CornerMask> masks_;
+};
+
+} // namespace rigid
@@ -0,0 +1,31 @@
+#include "ExportChunks.h"
+
+#include <algorithm>
+
+namespace rigid {
+
+std::vector<FrameRange> planExportChunks(int64_t totalFrames, int64_t gopFrames, int workers,
+                                         int64_t minChunkFrames) {
+    if (totalFrames <= 0) return {};
+    gopFrames = std::max<int64_t>(gopFrames, 1);
+    minChunkFrames = std::max<int64_t>(minChunkFrames, 1);
+
+    int64_t chunkCount = std::min<int64_t>(static_cast<int64_t>(workers) * 2, totalFrames / minChunkFrames);
+    if (workers < 2 || chunkCount < 2) return {{0, totalFrames}};
+
+    // Round up to whole GOPs; the last chunk takes whatever is left
+    int64_t chunkFrames = (totalFrames + chunkCount - 1) / chunkCount;
+    chunkFrames = (chunkFrames + gopFrames - 1) / gopFrames * gopFrames;
+    return splitIntoChunks(totalFrames, chunkFrames);
+}
+
+std::vector<FrameRange> splitIntoChunks(int64_t totalFrames, int64_t chunkFrames) {
+    chunkFrames = std::max<int64_t>(chunkFrames, 1);
+    std::vector<FrameRange> chunks;
+    for (int64_t start = 0; start < totalFrames; start += chunkFrames) {
+        chunks.push_back({start, std::min(start + chunkFrames, totalFrames)});
+    }
+    return chunks;
+}
+
+} // namespace rigid
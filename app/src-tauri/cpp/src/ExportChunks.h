@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rigid {
+
+/// Half-open range of output frames [start, end)
+struct FrameRange {
+    int64_t start = 0;
+    int64_t end = 0;
+
+    int64_t count() const { return end - start; }
+};
+
+/// Split an export of `totalFrames` into chunks that separate encoders can
+/// render in parallel and that are joined afterwards by stream copy.
+///
+/// Every chunk but the last is a whole number of GOPs (`gopFrames`), so the
+/// joined file keeps the keyframe cadence of a single encode. A timeline
+/// shorter than two chunks of `minChunkFrames` stays in one piece. There are
+/// up to two chunks per worker, so a worker that finishes early can take
+/// another instead of idling while one heavy stretch of timeline renders.
+std::vector<FrameRange> planExportChunks(int64_t totalFrames, int64_t gopFrames, int workers,
+                                         int64_t minChunkFrames);
+
+/// Split an export into chunks of `chunkFrames` from frame 0 (the last one
+/// shorter). Boundaries depend only on the chunk length, so they line up
+/// between exports of the same timeline, which the segment cache relies on.
+std::vector<FrameRange> splitIntoChunks(int64_t totalFrames, int64_t chunkFrames);
+
+} // namespace rigid
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rigid {
+
+/// 4:2:0 planes (I420) in BT.709 limited range. Chroma planes are half the
+/// size in each direction, rounded up.
+struct YuvImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+
+    void allocate(int w, int h) {
+        width = w;
+        height = h;
+        y.resize(static_cast<size_t>(w) * h);
+        u.resize(static_cast<size_t>(chromaWidth()) * chromaHeight());
+        v.resize(u.size());
+    }
+
+    bool empty() const { return width <= 0 || height <= 0; }
+    int chromaWidth() const { return (width + 1) / 2; }
+    int chromaHeight() const { return (height + 1) / 2; }
+};
+
+/// A CPU frame in premultiplied BGRA, top-left origin.
+///
+/// This is the common currency between the decoders, the compositor and the
+/// encoder. Rows are tightly packed unless a caller chooses a larger stride.
+struct Frame {
+    int width = 0;
+    int height = 0;
+    int stride = 0;  // Bytes per row
+    std::vector<uint8_t> pixels;
+    /// Every alpha byte is 255. Producers set this when they know it, so
+    /// the compositor can skip whatever an opaque clip covers.
+    bool opaque = false;
+    /// The same pixels as I420, when the producer converted them while it
+    /// wrote them (see FrameCompositor::setYuvOutput). Empty otherwise; the
+    /// encoder then converts on its own.
+    YuvImage yuv;
+
+    Frame() = default;
+    Frame(int w, int h) { allocate(w, h); }
+
+    void allocate(int w, int h) {
+        width = w;
+        height = h;
+        stride = w * 4;
+        pixels.assign(static_cast<size_t>(stride) * h, 0);
+        opaque = false;
+        yuv = YuvImage();
+    }
+
+    bool empty() const { return width <= 0 || height <= 0; }
+
+    uint8_t* row(int y) { return pixels.data() + static_cast<size_t>(y) * stride; }
+    const uint8_t* row(int y) const { return pixels.data() + static_cast<size_t>(y) * stride; }
+
+    uint8_t* pixel(int x, int y) { return row(y) + x * 4; }
+    const uint8_t* pixel(int x, int y) const { return row(y) + x * 4; }
+
+    /// Fill every pixel with an opaque BGRA color
+    void fill(uint8_t b, uint8_t g, uint8_t r, uint8_t a = 255) {
+        for (int y = 0; y < height; y++) {
+            uint8_t* p = row(y);
+            for (int x = 0; x < width; x++, p += 4) {
+                p[0] = b;
+                p[1] = g;
+                p[2] = r;
+                p[3] = a;
+            }
+        }
+        opaque = a == 255;
+    }
+};
+
+/// Integer pixel rectangle
+struct PixelRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool empty() const { return width <= 0 || height <= 0; }
+
+    PixelRect intersection(const PixelRect& other) const {
+        int x0 = x > other.x ? x : other.x;
+        int y0 = y > other.y ? y : other.y;
+        int x1 = (x + width) < (other.x + other.width) ? (x + width) : (other.x + other.width);
+        int y1 = (y + height) < (other.y + other.height) ? (y + height) : (other.y + other.height);
+        if (x1 <= x0 || y1 <= y0) return {};
+        return {x0, y0, x1 - x0, y1 - y0};
+    }
+};
+
+} // namespace rigid
@@ -0,0 +1,753 @@
+#include "FrameCompositor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include "BlendKernels.h"
+#include "ColorConvert.h"
+#include "FramePool.h"
+
+namespace rigid {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+/// Default dark background (matches CIColor(red: 0.1, green: 0.1, blue: 0.18))
+constexpr uint8_t kDefaultBackground[4] = {46, 26, 26, 255};
+
+double easeInOutQuad(double t) {
+    if (t < 0.5) {
+        return 2 * t * t;
+    }
+    return 1 - std::pow(-2 * t + 2, 2) / 2;
+}
+
+/// Visible sub-rectangle of a clip's (cropped) source image, in source pixels.
+/// Pan and zoom both narrow this window; the window is then stretched over
+/// the clip's full box, which is what the scale-then-crop CI chains do.
+struct SourceWindow {
+    double x;
+    double y;
+    double width;
+    double height;
+
+    /// Scale by `factor` about the origin and crop back to the original size,
+    /// keeping the crop anchored at (centerX, centerY) expressed as 0-1 ratios.
+    void zoom(double factor, double centerX, double centerY) {
+        double newWidth = width / factor;
+        double newHeight = height / factor;
+        x += (width - newWidth) * centerX;
+        y += (height - newHeight) * centerY;
+        width = newWidth;
+        height = newHeight;
+    }
+};
+
+/// Transition state for a clip at a point in its lifetime
+struct TransitionState {
+    double opacity = 1.0;
+    double translateX = 0;
+    double translateY = 0;
+    double scale = 1.0;
+};
+
+TransitionState transitionAt(const CompositorClip& clip, double clipTimeSec, int width, int height) {
+    TransitionState state;
+    double clipDurationSec = static_cast<double>(clip.durationMs) / 1000.0;
+
+    // Entrance transition
+    if (clip.transitionInType && clip.transitionInDurationMs.value_or(0) > 0) {
+        double inDurSec = static_cast<double>(*clip.transitionInDurationMs) / 1000.0;
+        if (clipTimeSec < inDurSec) {
+            double progress = clipTimeSec / inDurSec;
+            // Cubic ease-out: 1 - (1-t)^3
+            double eased = 1.0 - std::pow(1.0 - progress, 3.0);
+            const std::string& type = *clip.transitionInType;
+            if (type == "fade") {
+                state.opacity = eased;
+            } else if (type == "slide_up") {
+                state.translateY = (1.0 - eased) * 0.3 * height;
+                state.opacity = eased;
+            } else if (type == "slide_down") {
+                state.translateY = -(1.0 - eased) * 0.3 * height;
+                state.opacity = eased;
+            } else if (type == "slide_left") {
+                state.translateX = (1.0 - eased) * 0.3 * width;
+                state.opacity = eased;
+            } else if (type == "slide_right") {
+                state.translateX = -(1.0 - eased) * 0.3 * width;
+                state.opacity = eased;
+            } else if (type == "scale") {
+                state.scale = 0.8 + 0.2 * eased;
+                state.opacity = eased;
+            } else if (type == "blur") {
+                state.opacity = eased;
+            }
+        }
+    }
+
+    // Exit transition
+    if (clip.transitionOutType && clip.transitionOutDurationMs.value_or(0) > 0) {
+        double outDurSec = static_cast<double>(*clip.transitionOutDurationMs) / 1000.0;
+        double outStartSec = clipDurationSec - outDurSec;
+        if (clipTimeSec >= outStartSec) {
+            double progress = (clipTimeSec - outStartSec) / outDurSec;
+            // Cubic ease-in: t^3
+            double eased = std::pow(progress, 3.0);
+            const std::string& type = *clip.transitionOutType;
+            if (type == "fade") {
+                state.opacity *= (1.0 - eased);
+            } else if (type == "slide_up") {
+                state.translateY -= eased * 0.3 * height;
+                state.opacity *= (1.0 - eased);
+            } else if (type == "slide_down") {
+                state.translateY += eased * 0.3 * height;
+                state.opacity *= (1.0 - eased);
+            } else if (type == "slide_left") {
+                state.translateX -= eased * 0.3 * width;
+                state.opacity *= (1.0 - eased);
+            } else if (type == "slide_right") {
+                state.translateX += eased * 0.3 * width;
+                state.opacity *= (1.0 - eased);
+            } else if (type == "scale") {
+                state.scale *= (1.0 - 0.2 * eased);
+                state.opacity *= (1.0 - eased);
+            } else if (type == "blur") {
+                state.opacity *= (1.0 - eased);
+            }
+        }
+    }
+
+    return state;
+}
+
+/// Bilinear sample with clamp-to-edge addressing (for full-frame backgrounds)
+inline void sampleBilinearClamped(const Frame& image, double sx, double sy, float out[4]) {
+    sx = std::min(std::max(sx, 0.0), static_cast<double>(image.width - 1));
+    sy = std::min(std::max(sy, 0.0), static_cast<double>(image.height - 1));
+    int x0 = static_cast<int>(sx);
+    int y0 = static_cast<int>(sy);
+    int x1 = std::min(x0 + 1, image.width - 1);
+    int y1 = std::min(y0 + 1, image.height - 1);
+    float ax = static_cast<float>(sx - x0);
+    float ay = static_cast<float>(sy - y0);
+
+    const uint8_t* p00 = image.pixel(x0, y0);
+    const uint8_t* p10 = image.pixel(x1, y0);
+    const uint8_t* p01 = image.pixel(x0, y1);
+    const uint8_t* p11 = image.pixel(x1, y1);
+    for (int c = 0; c < 4; c++) {
+        float top = p00[c] + (p10[c] - p00[c]) * ax;
+        float bottom = p01[c] + (p11[c] - p01[c]) * ax;
+        out[c] = top + (bottom - top) * ay;
+    }
+}
+
+inline uint8_t toByte(float v) {
+    if (v <= 0) return 0;
+    if (v >= 255) return 255;
+    return static_cast<uint8_t>(v + 0.5f);
+}
+
+/// Copy `rect` of `src` into the same place in `dst` (frames of equal size)
+void copyRect(const Frame& src, Frame& dst, const PixelRect& rect) {
+    const size_t rowBytes = static_cast<size_t>(rect.width) * 4;
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        std::memcpy(dst.pixel(rect.x, y), src.pixel(rect.x, y), rowBytes);
+    }
+}
+
+} // namespace
+
+void parseHexColor(const std::string& hex, uint8_t bgra[4]) {
+    std::string sanitized;
+    for (char c : hex) {
+        if (c != '#' && c != ' ' && c != '\t' && c != '\n' && c != '\r') sanitized += c;
+    }
+    unsigned long rgb = std::strtoul(sanitized.c_str(), nullptr, 16);
+    bgra[0] = static_cast<uint8_t>(rgb & 0xFF);
+    bgra[1] = static_cast<uint8_t>((rgb >> 8) & 0xFF);
+    bgra[2] = static_cast<uint8_t>((rgb >> 16) & 0xFF);
+    bgra[3] = 255;
+}
+
+namespace {
+
+/// Indices of `items` sorted by z-index (stable, so equal z keeps config order)
+template <typename T>
+std::vector<size_t> zOrder(const std::vector<T>& items) {
+    std::vector<size_t> order(items.size());
+    for (size_t i = 0; i < items.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return items[a].zIndex < items[b].zIndex; });
+    return order;
+}
+
+template <typename T>
+TimelineIndex::Interval intervalOf(const T& item) {
+    double startSec = static_cast<double>(item.startTimeMs) / 1000.0;
+    return {startSec, startSec + static_cast<double>(item.durationMs) / 1000.0};
+}
+
+/// Timeline over `items[order[0]], items[order[1]], ...`
+template <typename T>
+TimelineIndex timelineOf(const std::vector<T>& items, const std::vector<size_t>& order) {
+    std::vector<TimelineIndex::Interval> intervals;
+    intervals.reserve(order.size());
+    for (size_t index : order) intervals.push_back(intervalOf(items[index]));
+    return TimelineIndex(intervals);
+}
+
+} // namespace
+
+FrameCompositor::FrameCompositor(const CompositorConfig& config, ClipFrameSource& source, int threadCount)
+    : config_(config), source_(source), filter_(resampleFilterFor(config.quality)) {
+    if (threadCount > 1) pool_ = std::make_unique<TilePool>(threadCount);
+    scratch_.resize(pool_ ? static_cast<size_t>(pool_->workerCount()) : 1);
+    // Whichever worker first draws a full tile width would grow these mid-export
+    for (TileScratch& scratch : scratch_) {
+        scratch.row.reserve(static_cast<size_t>(kTileSize) * 4);
+        scratch.mask.reserve(kTileSize);
+    }
+
+    clipOrder_ = zOrder(config.clips);
+
+    // Audio clips never draw, so leave them out of the index entirely
+    std::vector<TimelineIndex::Interval> clipIntervals;
+    for (size_t index : clipOrder_) {
+        const CompositorClip& clip = config.clips[index];
+        clipIntervals.push_back(clip.sourceType == ClipSourceType::Audio ? TimelineIndex::Interval{0, 0}
+                                                                         : intervalOf(clip));
+    }
+    clipTimeline_ = TimelineIndex(clipIntervals);
+
+    if (config.panClips) {
+        panOrder_ = zOrder(*config.panClips);
+        panTimeline_ = timelineOf(*config.panClips, panOrder_);
+    }
+    if (config.zoomClips) {
+        std::vector<size_t> configOrder(config.zoomClips->size());
+        for (size_t i = 0; i < configOrder.size(); i++) configOrder[i] = i;
+        zoomTimeline_ = timelineOf(*config.zoomClips, configOrder);
+    }
+    if (config.blurClips) {
+        blurOrder_ = zOrder(*config.blurClips);
+        blurTimeline_ = timelineOf(*config.blurClips, blurOrder_);
+    }
+}
+
+FrameCompositor::~FrameCompositor() {
+    FramePool::shared().release(backgroundLayer_);
+    FramePool::shared().release(previous_);
+}
+
+void FrameCompositor::clipsAt(double timeSec, std::vector<size_t>& clipIndices) const {
+    clipIndices.clear();
+    for (size_t position : clipTimeline_.activeAt(timeSec)) clipIndices.push_back(clipOrder_[position]);
+}
+
+void FrameCompositor::renderFrame(double timeSec, Frame& output) {
+    FramePool& frames = FramePool::shared();
+    if (output.width != config_.width || output.height != config_.height) {
+        frames.acquire(output, config_.width, config_.height);
+    }
+    // The background never changes over the timeline, so render it once
+    if (backgroundLayer_.width != output.width || backgroundLayer_.height != output.height) {
+        frames.acquire(backgroundLayer_, output.width, output.height);
+        renderBackground(backgroundLayer_);
+    }
+
+    // Place every clip first, so the background can skip what an opaque clip covers
+    cornerMasks_.trim();
+    activeClips_.clear();
+    PixelRect occluded;
+    for (size_t position : clipTimeline_.activeAt(timeSec)) {
+        size_t index = clipOrder_[position];
+        const CompositorClip& clip = config_.clips[index];
+
+        const Frame* image = source_.frameForClip(index, timeSec);
+        if (!image || image->empty()) continue;
+
+        ActiveClip active{&clip, image, {}, nullptr, false};
+        if (!placeClip(clip, *image, timeSec, output.width, output.height, active.placement)) continue;
+
+        if (clip.cornerRadius.value_or(0) > 0) {
+            const CornerMask& mask =
+                cornerMasks_.maskFor(active.placement.crop.width, active.placement.crop.height, *clip.cornerRadius);
+            if (mask.extent() > 0) active.corners = &mask;
+        }
+        active.isStatic = clip.sourceType == ClipSourceType::Image || clip.freezeFrame.value_or(false);
+
+        PixelRect opaque = opaqueRegion(clip, *image, active.placement);
+        if (static_cast<int64_t>(opaque.width) * opaque.height >
+            static_cast<int64_t>(occluded.width) * occluded.height) {
+            occluded = opaque;
+        }
+        activeClips_.push_back(active);
+    }
+    collectBlurs(timeSec, output.width, output.height);
+
+    const int columns = (output.width + kTileSize - 1) / kTileSize;
+    const int rows = (output.height + kTileSize - 1) / kTileSize;
+    const size_t tileCount = static_cast<size_t>(columns) * rows;
+    if (previous_.width != output.width || previous_.height != output.height) {
+        frames.acquire(previous_, output.width, output.height);
+        tileSignatures_.assign(tileCount, 0);
+    }
+
+    YuvPlanes yuv;
+    if (yuvOutput_) {
+        frames.acquire(output.yuv, output.width, output.height);
+        yuv = planesOf(output.yuv);
+    } else if (!output.yuv.empty()) {
+        frames.release(output.yuv);
+    }
+
+    const PixelRect frameRect{0, 0, output.width, output.height};
+    auto tileRect = [&](size_t index) {
+        return PixelRect{static_cast<int>(index % columns) * kTileSize, static_cast<int>(index / columns) * kTileSize,
+                         kTileSize, kTileSize}
+            .intersection(frameRect);
+    };
+    auto renderTile = [&](size_t index, int worker) {
+        PixelRect tile = tileRect(index);
+        uint64_t signature = tileSignature(tile);
+        if (signature != 0 && signature == tileSignatures_[index]) {
+            copyRect(previous_, output, tile);
+        } else {
+            compositeTile(tile, occluded, scratch_[worker], output);
+            // Only static tiles can be reused; keeping the rest is a wasted copy
+            if (signature != 0) copyRect(output, previous_, tile);
+            tileSignatures_[index] = signature;
+        }
+        // Tiles under a blur convert once it has run
+        if (yuvOutput_ && !touchesBlur(tile)) convertBgraToYuv420(output, tile, yuv);
+    };
+    runTiles(tileCount, std::ref(renderTile));
+
+    // Blurs read across tile edges, so they run on the finished frame. Tiles
+    // under a blur are never reused, so `previous_` may keep them unblurred.
+    applyBlurEffects(output);
+
+    if (yuvOutput_ && !activeBlurs_.empty()) {
+        auto convertBlurredTile = [&](size_t index, int) {
+            PixelRect tile = tileRect(index);
+            if (touchesBlur(tile)) convertBgraToYuv420(output, tile, yuv);
+        };
+        runTiles(tileCount, std::ref(convertBlurredTile));
+    }
+}
+
+// MARK: - Tiles
+
+void FrameCompositor::runTiles(size_t tileCount, const TilePool::Task& task) {
+    if (pool_) {
+        pool_->run(tileCount, task);
+    } else {
+        for (size_t index = 0; index < tileCount; index++) task(index, 0);
+    }
+}
+
+bool FrameCompositor::touchesBlur(const PixelRect& tile) const {
+    for (const ActiveBlur& blur : activeBlurs_) {
+        if (!blur.rect.intersection(tile).empty()) return true;
+    }
+    return false;
+}
+
+uint64_t FrameCompositor::tileSignature(const PixelRect& tile) const {
+    if (touchesBlur(tile)) return 0;
+
+    // FNV-1a over every layer that reaches the tile, in draw order
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const ActiveClip& active : activeClips_) {
+        const ClipPlacement& p = active.placement;
+        if (p.bounds.intersection(tile).empty()) continue;
+        if (!active.isStatic) return 0;
+
+        size_t index = static_cast<size_t>(active.clip - config_.clips.data());
+        const double geometry[] = {p.windowX, p.windowY, p.windowWidth, p.windowHeight,
+                                   p.boxX,    p.boxY,    p.boxWidth,    p.boxHeight};
+        const int frame[] = {active.image->width, active.image->height, p.crop.x, p.crop.y, p.crop.width,
+                             p.crop.height};
+        mix(&index, sizeof(index));
+        mix(geometry, sizeof(geometry));
+        mix(frame, sizeof(frame));
+        mix(&p.alpha, sizeof(p.alpha));
+    }
+    // 0 means "composite again"
+    return hash == 0 ? 1 : hash;
+}
+
+void FrameCompositor::compositeTile(const PixelRect& tile, const PixelRect& occluded, TileScratch& scratch,
+                                    Frame& output) {
+    copyBackground(output, tile, occluded);
+    for (const ActiveClip& active : activeClips_) {
+        PixelRect area = active.placement.bounds.intersection(tile);
+        if (!area.empty()) drawClip(active, area, scratch, output);
+    }
+}
+
+// MARK: - Background
+
+void FrameCompositor::copyBackground(Frame& output, const PixelRect& area, const PixelRect& occluded) {
+    const PixelRect covered = occluded.intersection(area);
+    const size_t rowBytes = static_cast<size_t>(area.width) * 4;
+    for (int y = area.y; y < area.y + area.height; y++) {
+        const uint8_t* src = backgroundLayer_.pixel(area.x, y);
+        uint8_t* dst = output.pixel(area.x, y);
+        if (covered.empty() || y < covered.y || y >= covered.y + covered.height) {
+            std::memcpy(dst, src, rowBytes);
+            continue;
+        }
+        // Only the parts of the row left and right of the opaque clip show through
+        const size_t leftBytes = static_cast<size_t>(covered.x - area.x) * 4;
+        const size_t rightOffset = static_cast<size_t>(covered.x + covered.width - area.x) * 4;
+        std::memcpy(dst, src, leftBytes);
+        std::memcpy(dst + rightOffset, src + rightOffset, rowBytes - rightOffset);
+    }
+}
+
+void FrameCompositor::renderBackground(Frame& output) {
+    const auto& bg = config_.background;
+    if (!bg) {
+        output.fill(kDefaultBackground[0], kDefaultBackground[1], kDefaultBackground[2]);
+        return;
+    }
+
+    switch (bg->backgroundType) {
+    case BackgroundType::Solid: {
+        uint8_t color[4];
+        parseHexColor(bg->color.value_or("#1a1a2e"), color);
+        output.fill(color[0], color[1], color[2]);
+        return;
+    }
+    case BackgroundType::Gradient:
+        renderGradientBackground(output);
+        return;
+    case BackgroundType::Image:
+        if (const Frame* image = source_.backgroundImage(); image && !image->empty()) {
+            renderImageBackground(*image, output);
+        } else {
+            output.fill(kDefaultBackground[0], kDefaultBackground[1], kDefaultBackground[2]);
+        }
+        return;
+    }
+}
+
+void FrameCompositor::renderGradientBackground(Frame& output) {
+    std::vector<GradientStop> stops = config_.background->gradientStops.value_or(
+        std::vector<GradientStop>{{"#1a1a2e", 0}, {"#2d2d44", 1}});
+    if (stops.size() < 2) {
+        output.fill(kDefaultBackground[0], kDefaultBackground[1], kDefaultBackground[2]);
+        return;
+    }
+
+    uint8_t color0[4];
+    uint8_t color1[4];
+    parseHexColor(stops.front().color, color0);
+    parseHexColor(stops.back().color, color1);
+
+    // Same geometry as CILinearGradient in createGradientBackground: the
+    // gradient runs across the frame diagonal at `angle`, measured with Y up.
+    double angleRad = config_.background->gradientAngle.value_or(180) * kPi / 180.0;
+    double centerX = output.width / 2.0;
+    double centerY = output.height / 2.0;
+    double radius = std::sqrt(static_cast<double>(output.width) * output.width +
+                              static_cast<double>(output.height) * output.height) / 2;
+    double dirX = std::cos(angleRad);
+    double dirY = -std::sin(angleRad);  // Flip to top-left origin
+
+    for (int y = 0; y < output.height; y++) {
+        uint8_t* p = output.row(y);
+        double py = (y + 0.5 - centerY) * dirY;
+        for (int x = 0; x < output.width; x++, p += 4) {
+            double t = 0.5 + ((x + 0.5 - centerX) * dirX + py) / (2 * radius);
+            t = std::min(std::max(t, 0.0), 1.0);
+            for (int c = 0; c < 3; c++) {
+                p[c] = static_cast<uint8_t>(color0[c] + (color1[c] - color0[c]) * t + 0.5);
+            }
+            p[3] = 255;
+        }
+    }
+}
+
+void FrameCompositor::renderImageBackground(const Frame& image, Frame& output) {
+    // Scale to fill, then center crop
+    double scale = std::max(static_cast<double>(output.width) / image.width,
+                            static_cast<double>(output.height) / image.height);
+    double offsetX = (image.width * scale - output.width) / 2;
+    double offsetY = (image.height * scale - output.height) / 2;
+
+    float sample[4];
+    for (int y = 0; y < output.height; y++) {
+        uint8_t* p = output.row(y);
+        double sy = (y + 0.5 + offsetY) / scale - 0.5;
+        for (int x = 0; x < output.width; x++, p += 4) {
+            double sx = (x + 0.5 + offsetX) / scale - 0.5;
+            sampleBilinearClamped(image, sx, sy, sample);
+            p[0] = toByte(sample[0]);
+            p[1] = toByte(sample[1]);
+            p[2] = toByte(sample[2]);
+            p[3] = toByte(sample[3]);
+        }
+    }
+}
+
+// MARK: - Clips
+
+bool FrameCompositor::placeClip(const CompositorClip& clip, const Frame& image, double timeSec,
+                                int outputWidth, int outputHeight, ClipPlacement& placement) const {
+    const double clipStartSec = static_cast<double>(clip.startTimeMs) / 1000.0;
+
+    // Apply crop (percentages of the source, top-left origin)
+    double cropTop = clip.cropTop.value_or(0) / 100.0;
+    double cropBottom = clip.cropBottom.value_or(0) / 100.0;
+    double cropLeft = clip.cropLeft.value_or(0) / 100.0;
+    double cropRight = clip.cropRight.value_or(0) / 100.0;
+
+    PixelRect crop{
+        static_cast<int>(std::lround(image.width * cropLeft)),
+        static_cast<int>(std::lround(image.height * cropTop)),
+        static_cast<int>(std::lround(image.width * (1 - cropLeft - cropRight))),
+        static_cast<int>(std::lround(image.height * (1 - cropTop - cropBottom))),
+    };
+    crop = crop.intersection({0, 0, image.width, image.height});
+    if (crop.empty()) return false;
+
+    SourceWindow window{0, 0, static_cast<double>(crop.width), static_cast<double>(crop.height)};
+
+    // Apply per-clip pan effects (before scaling/positioning)
+    if (config_.panClips && clip.trackId) {
+        for (size_t position : panTimeline_.activeAt(timeSec)) {
+            const CompositorPanClip* pan = &(*config_.panClips)[panOrder_[position]];
+            if (pan->targetTrackId != *clip.trackId) continue;
+
+            double panStartSec = static_cast<double>(pan->startTimeMs) / 1000.0;
+            double panEndSec = panStartSec + static_cast<double>(pan->durationMs) / 1000.0;
+
+            double progress = (timeSec - panStartSec) / (panEndSec - panStartSec);
+            double currentX = pan->startX + (pan->endX - pan->startX) * progress;
+            double currentY = pan->startY + (pan->endY - pan->startY) * progress;
+
+            // Scale up 1.5x and crop at the pan position (same as FFmpeg)
+            window.zoom(1.5, currentX / 100.0, currentY / 100.0);
+        }
+    }
+
+    // Apply per-clip zoom effects (before scaling/positioning)
+    if (config_.zoomClips && clip.trackId) {
+        for (size_t index : zoomTimeline_.activeAt(timeSec)) {
+            const CompositorZoomClip& zoom = (*config_.zoomClips)[index];
+            if (zoom.targetTrackId != *clip.trackId) continue;
+
+            double zoomStartSec = static_cast<double>(zoom.startTimeMs) / 1000.0;
+            double zoomEndSec = zoomStartSec + static_cast<double>(zoom.durationMs) / 1000.0;
+
+            double easeInSec = static_cast<double>(zoom.easeInDurationMs) / 1000.0;
+            double easeOutSec = static_cast<double>(zoom.easeOutDurationMs) / 1000.0;
+
+            double zoomFactor = zoom.zoomScale;
+            if (timeSec < zoomStartSec + easeInSec) {
+                double easeProgress = (timeSec - zoomStartSec) / easeInSec;
+                zoomFactor = 1.0 + (zoom.zoomScale - 1.0) * easeInOutQuad(easeProgress);
+            } else if (timeSec > zoomEndSec - easeOutSec) {
+                double easeProgress = (timeSec - (zoomEndSec - easeOutSec)) / easeOutSec;
+                zoomFactor = zoom.zoomScale - (zoom.zoomScale - 1.0) * easeInOutQuad(easeProgress);
+            }
+            if (zoomFactor <= 0) continue;
+
+            window.zoom(zoomFactor, zoom.zoomCenterX / 100.0, zoom.zoomCenterY / 100.0);
+        }
+    }
+
+    // Apply scale (fit the clip inside scale * output size)
+    double scale = clip.scale.value_or(0.8);
+    double scaleFactor = std::min(static_cast<double>(outputWidth) * scale / crop.width,
+                                  static_cast<double>(outputHeight) * scale / crop.height);
+    double boxWidth = crop.width * scaleFactor;
+    double boxHeight = crop.height * scaleFactor;
+
+    // Position (center of the clip, top-left origin)
+    double centerX = clip.positionX.value_or(outputWidth / 2.0);
+    double centerY = clip.positionY.value_or(outputHeight / 2.0);
+
+    // Transitions: scale about the clip center, then translate
+    TransitionState transition = transitionAt(clip, timeSec - clipStartSec, outputWidth, outputHeight);
+    boxWidth *= transition.scale;
+    boxHeight *= transition.scale;
+    centerX += transition.translateX;
+    centerY += transition.translateY;
+
+    double opacity = clip.opacity.value_or(1.0) * transition.opacity;
+    if (opacity <= 0 || boxWidth <= 0 || boxHeight <= 0) return false;
+
+    double boxX = centerX - boxWidth / 2;
+    double boxY = centerY - boxHeight / 2;
+
+    int x0 = std::max(0, static_cast<int>(std::floor(boxX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(boxY)));
+    int x1 = std::min(outputWidth, static_cast<int>(std::ceil(boxX + boxWidth)));
+    int y1 = std::min(outputHeight, static_cast<int>(std::ceil(boxY + boxHeight)));
+    if (x1 <= x0 || y1 <= y0) return false;
+
+    placement.crop = crop;
+    placement.windowX = window.x;
+    placement.windowY = window.y;
+    placement.windowWidth = window.width;
+    placement.windowHeight = window.height;
+    placement.boxX = boxX;
+    placement.boxY = boxY;
+    placement.boxWidth = boxWidth;
+    placement.boxHeight = boxHeight;
+    placement.alpha = static_cast<float>(std::min(opacity, 1.0));
+    placement.bounds = {x0, y0, x1 - x0, y1 - y0};
+    return true;
+}
+
+PixelRect FrameCompositor::opaqueRegion(const CompositorClip& clip, const Frame& image,
+                                        const ClipPlacement& placement) const {
+    if (!image.opaque || placement.alpha < 1.0f) return {};
+
+    // Source texels untouched by the corner mask; every filter tap must land
+    // inside, since texels past the edge are transparent
+    double stepX = placement.windowWidth / placement.boxWidth;
+    double stepY = placement.windowHeight / placement.boxHeight;
+    int reachX = resampleReach(filter_, stepX);
+    int reachY = resampleReach(filter_, stepY);
+    double inset = std::ceil(std::min(static_cast<double>(clip.cornerRadius.value_or(0)),
+                                      std::min(placement.crop.width, placement.crop.height) / 2.0));
+    double loX = inset + reachX - 1;
+    double loY = inset + reachY - 1;
+    double hiX = placement.crop.width - 1 - inset - reachX;
+    double hiY = placement.crop.height - 1 - inset - reachY;
+    if (hiX < loX || hiY < loY) return {};
+
+    // Destination pixels whose sample position falls in [lo, hi]; see drawClip
+    double uLo = std::max(0.0, (loX + 0.5 - placement.windowX) / stepX);
+    double vLo = std::max(0.0, (loY + 0.5 - placement.windowY) / stepY);
+    double uHi = std::min(placement.boxWidth, (hiX + 0.5 - placement.windowX) / stepX);
+    double vHi = std::min(placement.boxHeight, (hiY + 0.5 - placement.windowY) / stepY);
+
+    // u = x + 0.5 - boxX; the upper bounds are exclusive of the box edge
+    constexpr double kEpsilon = 1e-9;
+    int x0 = static_cast<int>(std::ceil(uLo + placement.boxX - 0.5));
+    int y0 = static_cast<int>(std::ceil(vLo + placement.boxY - 0.5));
+    int x1 = static_cast<int>(std::floor(uHi + placement.boxX - 0.5 - kEpsilon)) + 1;
+    int y1 = static_cast<int>(std::floor(vHi + placement.boxY - 0.5 - kEpsilon)) + 1;
+    if (x1 <= x0 || y1 <= y0) return {};
+
+    return PixelRect{x0, y0, x1 - x0, y1 - y0}.intersection(placement.bounds);
+}
+
+void FrameCompositor::drawClip(const ActiveClip& active, const PixelRect& area, TileScratch& scratch,
+                               Frame& output) const {
+    const ClipPlacement& placement = active.placement;
+    const PixelRect& bounds = area;
+    const float alpha = placement.alpha;
+
+    const Frame& image = *active.image;
+    const uint8_t* base = image.pixel(placement.crop.x, placement.crop.y);
+    const int baseStride = image.stride;
+
+    // Corner radius masks the source as it is sampled, so the (possibly
+    // shared) frame is never copied and rows clear of the corners blend unmasked
+    const CornerMask* corners = active.corners;
+
+    // Map destination pixel centers back into the source window
+    const double stepX = placement.windowWidth / placement.boxWidth;
+    const double stepY = placement.windowHeight / placement.boxHeight;
+
+    // Destination columns whose centers fall inside the box
+    int xBegin = bounds.x;
+    int xEnd = bounds.x + bounds.width;
+    while (xBegin < xEnd && xBegin + 0.5 - placement.boxX < 0) xBegin++;
+    while (xEnd > xBegin && xEnd - 0.5 - placement.boxX >= placement.boxWidth) xEnd--;
+    if (xBegin >= xEnd) return;
+
+    // Resample a row into scratch, then blend it with the vector kernels
+    const BlendKernels& kernels = blendKernels();
+    const uint8_t opacity = toByte(alpha * 255.0f);
+    if (opacity == 0) return;
+    scratch.row.resize(static_cast<size_t>(xEnd - xBegin) * 4);
+    if (corners) scratch.mask.resize(static_cast<size_t>(xEnd - xBegin));
+
+    // Crop, pan, zoom, scale and position collapse into one mapping, so each
+    // clip is resampled exactly once with the quality's filter
+    const double originX = placement.windowX + (xBegin + 0.5 - placement.boxX) * stepX - 0.5;
+    scratch.resampler.setColumns(filter_, originX, stepX, xEnd - xBegin, stepY);
+
+    for (int y = bounds.y; y < bounds.y + bounds.height; y++) {
+        double v = (y + 0.5 - placement.boxY);
+        if (v < 0 || v >= placement.boxHeight) continue;
+        double sy = placement.windowY + v * stepY - 0.5;
+
+        scratch.resampler.resampleRow(base, baseStride, placement.crop.width, placement.crop.height, sy,
+                                      scratch.row.data());
+
+        const bool masked = corners && corners->touchesRow(sy);
+        if (masked) {
+            for (int i = 0; i < xEnd - xBegin; i++) scratch.mask[i] = corners->sample(originX + i * stepX, sy);
+        }
+
+        uint8_t* dst = output.pixel(xBegin, y);
+        if (masked) {
+            kernels.overMasked(dst, scratch.row.data(), scratch.mask.data(), xEnd - xBegin, opacity);
+        } else if (opacity == 255) {
+            kernels.over(dst, scratch.row.data(), xEnd - xBegin);
+        } else {
+            kernels.overWithOpacity(dst, scratch.row.data(), xEnd - xBegin, opacity);
+        }
+    }
+}
+
+// MARK: - Blur
+
+void FrameCompositor::collectBlurs(double timeSec, int outputWidth, int outputHeight) {
+    activeBlurs_.clear();
+    if (!config_.blurClips) return;
+
+    for (size_t position : blurTimeline_.activeAt(timeSec)) {
+        const CompositorBlurClip* blur = &(*config_.blurClips)[blurOrder_[position]];
+
+        double regionX = outputWidth * (blur->regionX / 100.0);
+        double regionY = outputHeight * (blur->regionY / 100.0);
+        double regionW = outputWidth * (blur->regionWidth / 100.0);
+        double regionH = outputHeight * (blur->regionHeight / 100.0);
+
+        PixelRect rect{
+            static_cast<int>(std::lround(regionX - regionW / 2)),
+            static_cast<int>(std::lround(regionY - regionH / 2)),
+            static_cast<int>(std::lround(regionW)),
+            static_cast<int>(std::lround(regionH)),
+        };
+
+        // Clamp blur rect to image bounds
+        rect = rect.intersection({0, 0, outputWidth, outputHeight});
+        if (rect.empty()) continue;
+
+        activeBlurs_.push_back({rect, std::max(blur->blurIntensity * 0.5, 1.0)});
+    }
+}
+
+void FrameCompositor::applyBlurEffects(Frame& output) {
+    for (const ActiveBlur& blur : activeBlurs_) {
+        // Three box passes stand in for the Gaussian of CIGaussianBlur on a
+        // clamped-to-extent image, at a cost that does not grow with intensity
+        blur_.apply(output.pixel(blur.rect.x, blur.rect.y), blur.rect.width, blur.rect.height,
+                    static_cast<size_t>(output.stride), blur.sigma);
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BoxBlur.h"
+#include "CompositorConfig.h"
+#include "CornerMask.h"
+#include "Frame.h"
+#include "Resampler.h"
+#include "TilePool.h"
+#include "TimelineIndex.h"
+
+namespace rigid {
+
+/// Supplies decoded source pixels to the FrameCompositor.
+///
+/// The render engine implements this on top of the libav decoders; tests
+/// implement it with synthetic frames.
+class ClipFrameSource {
+public:
+    virtual ~ClipFrameSource() = default;
+
+    /// Frame for `config.clips[clipIndex]` at the given timeline time, or
+    /// nullptr if no frame is available (the clip is then skipped).
+    virtual const Frame* frameForClip(size_t clipIndex, double timeSec) = 0;
+
+    /// Decoded background image for `BackgroundType::Image`, or nullptr.
+    virtual const Frame* backgroundImage() = 0;
+};
+
+/// CPU port of `createCompositeFrameSync` from VideoCompositor.swift.
+///
+/// Renders one output frame: background, then every active visual clip in
+/// z-order (crop, corner radius, pan, zoom, scale, position, transitions,
+/// opacity), then blur regions. Coordinates are top-left origin, so the
+/// Core Image Y flips in the Swift version disappear here.
+///
+/// Each frame is split into square tiles composited in parallel. A tile
+/// whose layers are all static (background, still images and freeze frames
+/// placed exactly as in the previous frame, no blur) is copied from the
+/// previous frame instead of being composited again.
+class FrameCompositor {
+public:
+    /// `threadCount` threads composite tiles, the calling thread included
+    FrameCompositor(const CompositorConfig& config, ClipFrameSource& source, int threadCount = 1);
+    /// Returns the background and previous frame buffers to the FramePool
+    ~FrameCompositor();
+
+    FrameCompositor(const FrameCompositor&) = delete;
+    FrameCompositor& operator=(const FrameCompositor&) = delete;
+
+    /// Render the frame at `timeSec` into `output`, sized to the config with a
+    /// FramePool buffer if needed. Once sizes and the active clips settle,
+    /// rendering allocates nothing.
+    void renderFrame(double timeSec, Frame& output);
+
+    /// Also write `output.yuv` (I420, BT.709), converting each tile while it
+    /// is still in cache instead of in a separate pass before encoding
+    void setYuvOutput(bool enabled) { yuvOutput_ = enabled; }
+
+    /// Indices into `config.clips` of the visual clips active at `timeSec`,
+    /// in draw order. Only reads immutable state, so a decode stage may call
+    /// it while another thread renders.
+    void clipsAt(double timeSec, std::vector<size_t>& clipIndices) const;
+
+private:
+    const CompositorConfig& config_;
+    ClipFrameSource& source_;
+
+    /// Clip indices sorted by z-index (stable, so equal z keeps config order)
+    std::vector<size_t> clipOrder_;
+    /// Pan and blur indices sorted by z-index; zooms apply in config order
+    std::vector<size_t> panOrder_;
+    std::vector<size_t> blurOrder_;
+
+    /// Active items per time, built once. Each returns positions in the
+    /// matching order vector above (config order for zooms).
+    TimelineIndex clipTimeline_;
+    TimelineIndex panTimeline_;
+    TimelineIndex zoomTimeline_;
+    TimelineIndex blurTimeline_;
+
+    /// Where a clip lands in the output this frame
+    struct ClipPlacement {
+        PixelRect crop;  // Source pixels after cropping
+        /// Part of `crop` left visible by pan and zoom, in crop pixels
+        double windowX, windowY, windowWidth, windowHeight;
+        /// Destination box the window is stretched over
+        double boxX, boxY, boxWidth, boxHeight;
+        float alpha;
+        /// Output pixels the box touches
+        PixelRect bounds;
+    };
+
+    struct ActiveClip {
+        const CompositorClip* clip;
+        const Frame* image;
+        ClipPlacement placement;
+        /// Rounded corners, or nullptr
+        const CornerMask* corners;
+        /// Same pixels every frame (still image or freeze frame)
+        bool isStatic;
+    };
+
+    struct ActiveBlur {
+        PixelRect rect;
+        double sigma;
+    };
+
+    /// Per-thread resampling and blending scratch
+    struct TileScratch {
+        Resampler resampler;
+        /// One resampled clip row, blended into the output in a single kernel call
+        std::vector<uint8_t> row;
+        /// Corner coverage for that row, when it crosses a rounded corner
+        std::vector<uint8_t> mask;
+    };
+
+    /// Side of the square tiles a frame is split into
+    static constexpr int kTileSize = 128;
+
+    /// Clips drawn and regions blurred this frame, reused between frames
+    std::vector<ActiveClip> activeClips_;
+    std::vector<ActiveBlur> activeBlurs_;
+
+    /// The background rendered once at output size
+    Frame backgroundLayer_;
+
+    /// Clip resampling filter for the export quality
+    const ResampleFilter filter_;
+    /// Corner radius masks by clip size, built once and reused across frames
+    CornerMaskCache cornerMasks_;
+    /// Region blur engine, keeps its scratch between frames
+    BoxBlur blur_;
+
+    bool yuvOutput_ = false;
+
+    /// Null when compositing on the calling thread only
+    std::unique_ptr<TilePool> pool_;
+    /// One per pool worker
+    std::vector<TileScratch> scratch_;
+
+    /// The last frame rendered, and per tile a signature of the static
+    /// layers it showed (0 when the tile must be composited again)
+    Frame previous_;
+    std::vector<uint64_t> tileSignatures_;
+
+    /// Signature of the layers covering `tile`, or 0 if any of them changes between frames
+    uint64_t tileSignature(const PixelRect& tile) const;
+    bool touchesBlur(const PixelRect& tile) const;
+    /// Run `task` for every tile, on the pool when there is one. Callers pass
+    /// std::ref(lambda) so building the Task never allocates.
+    void runTiles(size_t tileCount, const TilePool::Task& task);
+    void compositeTile(const PixelRect& tile, const PixelRect& occluded, TileScratch& scratch, Frame& output);
+
+    /// Copy the cached background into `area` of `output`, except inside `occluded`
+    void copyBackground(Frame& output, const PixelRect& area, const PixelRect& occluded);
+    void renderBackground(Frame& output);
+    void renderGradientBackground(Frame& output);
+    void renderImageBackground(const Frame& image, Frame& output);
+
+    /// Crop, pan, zoom, scale, position and transitions. False if nothing is drawn.
+    bool placeClip(const CompositorClip& clip, const Frame& image, double timeSec,
+                   int outputWidth, int outputHeight, ClipPlacement& placement) const;
+    /// Output pixels `clip` is certain to overwrite completely (empty if none)
+    PixelRect opaqueRegion(const CompositorClip& clip, const Frame& image, const ClipPlacement& placement) const;
+    /// Corner radius and premultiplied source-over of a placed clip, limited to `area`
+    void drawClip(const ActiveClip& active, const PixelRect& area, TileScratch& scratch, Frame& output) const;
+    /// Output rectangles of the blur regions active at `timeSec`
+    void collectBlurs(double timeSec, int outputWidth, int outputHeight);
+    void applyBlurEffects(Frame& output);
+};
+
+/// Parse "#rrggbb" into BGRA bytes (opaque). Invalid input yields black.
+void parseHexColor(const std::string& hex, uint8_t bgra[4]);
+
+} // namespace rigid
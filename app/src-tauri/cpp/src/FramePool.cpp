@@ -0,0 +1,129 @@
+#include "FramePool.h"
+
+#include <iterator>
+#include <utility>
+
+namespace rigid {
+
+namespace {
+
+/// A few export pipelines' worth of 1080p and 4K frames
+constexpr size_t kSharedCapacityBytes = 512 * 1024 * 1024;
+
+/// Classes step by a quarter of the power of two below them
+size_t classStep(size_t bytes) {
+    size_t power = 1;
+    while (power <= bytes / 2) power *= 2;
+    return power >= 4 ? power / 4 : 1;
+}
+
+/// Largest class size a buffer of `capacity` bytes can stand in for
+size_t floorClass(size_t capacity) {
+    size_t step = classStep(capacity);
+    return capacity / step * step;
+}
+
+} // namespace
+
+FramePool::FramePool(size_t capacityBytes) : capacityBytes_(capacityBytes) {}
+
+FramePool& FramePool::shared() {
+    static FramePool pool(kSharedCapacityBytes);
+    return pool;
+}
+
+size_t FramePool::sizeClass(size_t bytes) {
+    size_t step = classStep(bytes);
+    return (bytes + step - 1) / step * step;
+}
+
+std::vector<uint8_t> FramePool::take(size_t bytes) {
+    std::vector<uint8_t> buffer;
+    if (bytes == 0) return buffer;
+
+    const size_t size = sizeClass(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = idle_.find(size);
+        if (found != idle_.end()) {
+            buffer = std::move(found->second);
+            idleBytes_ -= buffer.capacity();
+            idle_.erase(found);
+        }
+    }
+    // Shrinking is free and a reused buffer usually has this exact size
+    if (buffer.capacity() < size) buffer.reserve(size);
+    buffer.resize(bytes);
+    return buffer;
+}
+
+void FramePool::give(std::vector<uint8_t>&& buffer) {
+    if (buffer.capacity() == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    idleBytes_ += buffer.capacity();
+    idle_.emplace(floorClass(buffer.capacity()), std::move(buffer));
+    buffer = std::vector<uint8_t>();
+    while (idleBytes_ > capacityBytes_) {
+        auto largest = std::prev(idle_.end());
+        idleBytes_ -= largest->second.capacity();
+        idle_.erase(largest);
+    }
+}
+
+void FramePool::acquire(Frame& frame, int width, int height) {
+    release(frame.yuv);
+    if (frame.width != width || frame.height != height) {
+        give(std::move(frame.pixels));
+        frame.pixels = take(static_cast<size_t>(width) * 4 * height);
+        frame.width = width;
+        frame.height = height;
+        frame.stride = width * 4;
+    }
+    frame.opaque = false;
+}
+
+void FramePool::acquire(YuvImage& image, int width, int height) {
+    if (image.width == width && image.height == height) return;
+    release(image);
+    image.width = width;
+    image.height = height;
+    image.y = take(static_cast<size_t>(width) * height);
+    image.u = take(static_cast<size_t>(image.chromaWidth()) * image.chromaHeight());
+    image.v = take(image.u.size());
+}
+
+void FramePool::release(Frame& frame) {
+    give(std::move(frame.pixels));
+    frame.pixels = std::vector<uint8_t>();
+    frame.width = 0;
+    frame.height = 0;
+    frame.stride = 0;
+    frame.opaque = false;
+    release(frame.yuv);
+}
+
+void FramePool::release(YuvImage& image) {
+    give(std::move(image.y));
+    give(std::move(image.u));
+    give(std::move(image.v));
+    image = YuvImage();
+}
+
+size_t FramePool::idleBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idleBytes_;
+}
+
+size_t FramePool::idleCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+void FramePool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.clear();
+    idleBytes_ = 0;
+}
+
+} // namespace rigid
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Frame.h"
+
+namespace rigid {
+
+/// Pixel buffers recycled between renders.
+///
+/// Every render owns a handful of full-size frames (pipeline buffers, the
+/// compositor's background and previous frame, decoded clip copies). They
+/// used to be allocated when a render started and freed when it ended, so a
+/// chunked export paid for fresh, zeroed pages per chunk and concurrent
+/// exports contended in the allocator. Buffers now come from here and go
+/// back when their owner is done, and frames reuse them as they are, without
+/// clearing.
+///
+/// Idle buffers are grouped by size class (four per power of two), so a
+/// buffer serves any request at most a quarter smaller. Idle bytes beyond
+/// the capacity are freed, largest class first.
+class FramePool {
+public:
+    explicit FramePool(size_t capacityBytes);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /// A buffer of `bytes` bytes. Contents are unspecified.
+    std::vector<uint8_t> take(size_t bytes);
+    /// Return a buffer for reuse (empty buffers are ignored)
+    void give(std::vector<uint8_t>&& buffer);
+
+    /// Size `frame` to width x height with a pooled buffer, returning its
+    /// old buffers first. Pixels are unspecified; `opaque` is cleared and
+    /// `yuv` emptied.
+    void acquire(Frame& frame, int width, int height);
+    /// Size `image` to width x height with pooled planes
+    void acquire(YuvImage& image, int width, int height);
+
+    /// Return the buffers of `frame` (pixels and yuv), leaving it empty
+    void release(Frame& frame);
+    void release(YuvImage& image);
+
+    /// Bytes held by idle buffers
+    size_t idleBytes() const;
+    size_t idleCount() const;
+    void clear();
+
+    /// Smallest class size that holds `bytes`
+    static size_t sizeClass(size_t bytes);
+
+    /// Process-wide pool used by renders
+    static FramePool& shared();
+
+private:
+    const size_t capacityBytes_;
+
+    mutable std::mutex mutex_;
+    /// Idle buffers by class size; each has capacity() >= its class size
+    std::multimap<size_t, std::vector<uint8_t>> idle_;
+    size_t idleBytes_ = 0;
+};
+
+} // namespace rigid
@@ -0,0 +1,147 @@
+#include "FrameRing.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <memory>
+#include <new>
+
+namespace rigid {
+
+/// One mapping and its slots. Owned jointly by the ring and by every slot
+/// in use, so frames still held outlive configure() and ~FrameRing.
+struct SharedFrame::Storage {
+    void* base = MAP_FAILED;
+    size_t length = 0;
+    std::unique_ptr<SharedFrame[]> slots;
+    size_t slotCount = 0;
+    /// The ring, plus one per slot in use
+    std::atomic<int> holders{1};
+    /// Where the next search for a free slot starts
+    size_t nextSlot = 0;
+
+    ~Storage() {
+        if (base != MAP_FAILED) munmap(base, length);
+    }
+
+    void release() {
+        if (holders.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+};
+
+void SharedFrame::release() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) storage_->release();
+}
+
+FrameRing::FrameRing(size_t slotCount) : slotCount_(slotCount > 0 ? slotCount : 1) {}
+
+FrameRing::~FrameRing() {
+    if (storage_) storage_->release();
+}
+
+void FrameRing::configure(int width, int height, size_t slotCount) {
+    if (storage_) {
+        storage_->release();
+        storage_ = nullptr;
+    }
+    if (slotCount > 0) slotCount_ = slotCount;
+    if (width <= 0 || height <= 0) return;
+
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t frameBytes = static_cast<size_t>(width) * 4 * height;
+    const size_t slotBytes = (frameBytes + page - 1) / page * page;
+
+    auto storage = std::make_unique<SharedFrame::Storage>();
+    storage->length = slotBytes * slotCount_;
+    storage->base = mmap(nullptr, storage->length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (storage->base == MAP_FAILED) throw std::bad_alloc();
+
+    storage->slots = std::make_unique<SharedFrame[]>(slotCount_);
+    storage->slotCount = slotCount_;
+    for (size_t i = 0; i < slotCount_; i++) {
+        SharedFrame& slot = storage->slots[i];
+        slot.storage_ = storage.get();
+        slot.pixels_ = static_cast<uint8_t*>(storage->base) + slotBytes * i;
+        slot.width_ = width;
+        slot.height_ = height;
+        slot.stride_ = width * 4;
+    }
+    storage_ = storage.release();
+    nextSequence_ = 0;
+}
+
+SharedFrame* FrameRing::acquire() {
+    if (!storage_) return nullptr;
+    for (size_t n = 0; n < storage_->slotCount; n++) {
+        size_t index = (storage_->nextSlot + n) % storage_->slotCount;
+        SharedFrame& slot = storage_->slots[index];
+        int expected = 0;
+        if (slot.refs_.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+            storage_->holders.fetch_add(1, std::memory_order_relaxed);
+            storage_->nextSlot = index + 1;
+            return &slot;
+        }
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void FrameRing::publish(SharedFrame* frame, int64_t timestampUs) {
+    frame->timestampUs_ = timestampUs;
+    frame->sequence_ = nextSequence_++;
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        for (const Subscriber& subscriber : subscribers_) {
+            subscriber.callback(subscriber.context, static_cast<RigidFrameRef>(frame));
+        }
+    }
+    frame->release();
+}
+
+uint64_t FrameRing::subscribe(Callback callback, void* context) {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    uint64_t id = nextSubscriberId_++;
+    subscribers_.push_back({id, callback, context});
+    return id;
+}
+
+bool FrameRing::unsubscribe(uint64_t id) {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
+        if (it->id == id) {
+            subscribers_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameRing::hasSubscribers() const {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    return !subscribers_.empty();
+}
+
+} // namespace rigid
+
+// MARK: - C API
+
+extern "C" RigidFrameRef rigid_frame_retain(RigidFrameRef frame) {
+    if (frame) static_cast<rigid::SharedFrame*>(frame)->retain();
+    return frame;
+}
+
+extern "C" void rigid_frame_release(RigidFrameRef frame) {
+    if (frame) static_cast<rigid::SharedFrame*>(frame)->release();
+}
+
+extern "C" bool rigid_frame_get_view(RigidFrameRef frame, RigidFrameView* view) {
+    if (!frame || !view) return false;
+    const auto* shared = static_cast<const rigid::SharedFrame*>(frame);
+    view->pixels = shared->pixels();
+    view->width = shared->width();
+    view->height = shared->height();
+    view->stride = shared->stride();
+    view->timestamp_us = shared->timestampUs();
+    view->sequence = shared->sequence();
+    return true;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "RigidCaptureKit.h"
+
+namespace rigid {
+
+/// A captured frame in a FrameRing slot, shared by reference count.
+///
+/// This is what RigidFrameRef points to on Linux. The pixels live in the
+/// ring's mmap'd region; retain() and release() are the only way to keep or
+/// drop them, so no reader ever copies a frame.
+class SharedFrame {
+public:
+    const uint8_t* pixels() const { return pixels_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int stride() const { return stride_; }
+    int64_t timestampUs() const { return timestampUs_; }
+    uint64_t sequence() const { return sequence_; }
+
+    /// Take another reference (the caller must already hold one)
+    void retain() { refs_.fetch_add(1, std::memory_order_relaxed); }
+    /// Drop a reference. The last one frees the slot for the next frame.
+    void release();
+
+private:
+    friend class FrameRing;
+
+    struct Storage;
+
+    Storage* storage_ = nullptr;
+    uint8_t* pixels_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    int stride_ = 0;
+    int64_t timestampUs_ = 0;
+    uint64_t sequence_ = 0;
+    /// 0 while free; the writer holds 1 from acquire() until publish()
+    std::atomic<int> refs_{0};
+};
+
+/// Fixed set of frame buffers a capture source writes into and any number
+/// of subscribers read from, without per-subscriber copies.
+///
+/// The buffers are one MAP_SHARED anonymous mapping, page-aligned per slot.
+/// The writer takes a free slot, fills it and publishes it; every subscriber
+/// sees the same slot and retains it for as long as it needs the pixels.
+/// When every slot is still held the writer gets none and the frame is
+/// dropped, so a slow reader costs frames, never copies or unbounded memory.
+///
+/// configure() replaces the buffers (for a new recording size); frames still
+/// held keep the old mapping alive until their last release.
+class FrameRing {
+public:
+    /// Called on the writer's thread for every published frame, with the
+    /// SharedFrame as its RigidFrameRef
+    using Callback = RigidFrameCallback;
+
+    explicit FrameRing(size_t slotCount);
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    /// Allocate width x height BGRA buffers, `slotCount` of them (0 keeps the
+    /// current count). Throws std::bad_alloc if the mapping fails.
+    void configure(int width, int height, size_t slotCount = 0);
+
+    /// A free slot to write the next frame into, or nullptr if every slot is
+    /// held (or the ring is not configured); the frame is then dropped
+    SharedFrame* acquire();
+    /// Writable pixels of a slot returned by acquire()
+    uint8_t* pixels(SharedFrame* frame) const { return frame->pixels_; }
+
+    /// Hand a written slot to every subscriber, then drop the writer's reference
+    void publish(SharedFrame* frame, int64_t timestampUs);
+
+    /// Subscribers are called in subscription order. They must not
+    /// subscribe or unsubscribe from inside the callback.
+    uint64_t subscribe(Callback callback, void* context);
+    /// False if `id` is not subscribed. No callback for it runs after this returns.
+    bool unsubscribe(uint64_t id);
+    bool hasSubscribers() const;
+
+    size_t slotCount() const { return slotCount_; }
+    /// Frames dropped because every slot was held
+    uint64_t droppedFrames() const { return dropped_; }
+
+private:
+    struct Subscriber {
+        uint64_t id;
+        Callback callback;
+        void* context;
+    };
+
+    size_t slotCount_;
+    SharedFrame::Storage* storage_ = nullptr;
+    uint64_t nextSequence_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+
+    /// Held while dispatching, so unsubscribe() waits out a running callback
+    mutable std::mutex subscribersMutex_;
+    std::vector<Subscriber> subscribers_;
+    uint64_t nextSubscriberId_ = 1;
+};
+
+} // namespace rigid
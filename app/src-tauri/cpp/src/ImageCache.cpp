@@ -0,0 +1,96 @@
+#include "ImageCache.h"
+
+#include "MediaDecoder.h"
+
+namespace rigid {
+
+namespace {
+
+/// Enough for a few dozen 1080p screenshots or a handful of 4K backgrounds
+constexpr size_t kSharedCapacityBytes = 256 * 1024 * 1024;
+
+std::filesystem::file_time_type modificationTime(const std::string& path) {
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    return ec ? std::filesystem::file_time_type::min() : modified;
+}
+
+} // namespace
+
+ImageCache::ImageCache(size_t capacityBytes, Loader loader)
+    : capacityBytes_(capacityBytes), loader_(std::move(loader)) {
+    if (!loader_) loader_ = decodeImageFile;
+}
+
+ImageCache& ImageCache::shared() {
+    static ImageCache cache(kSharedCapacityBytes);
+    return cache;
+}
+
+std::shared_ptr<const Frame> ImageCache::get(const std::string& path) {
+    const auto modified = modificationTime(path);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(path);
+        if (found != index_.end()) {
+            if (found->second->modified == modified) {
+                entries_.splice(entries_.begin(), entries_, found->second);
+                return found->second->frame;
+            }
+            // Changed on disk since it was cached
+            sizeBytes_ -= found->second->bytes;
+            entries_.erase(found->second);
+            index_.erase(found);
+        }
+    }
+
+    // Decode without the lock so other images can be served meanwhile. Two
+    // callers racing on the same path both decode; the later insert wins.
+    auto frame = std::make_shared<const Frame>(loader_(path));
+    const size_t bytes = frame->pixels.size();
+
+    // Larger than the whole cache: hand it out without evicting everything else
+    if (bytes > capacityBytes_) return frame;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(path);
+    if (found != index_.end()) {
+        sizeBytes_ -= found->second->bytes;
+        entries_.erase(found->second);
+        index_.erase(found);
+    }
+    entries_.push_front({path, modified, frame, bytes});
+    index_[path] = entries_.begin();
+    sizeBytes_ += bytes;
+    evictToCapacity();
+    return frame;
+}
+
+size_t ImageCache::sizeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sizeBytes_;
+}
+
+size_t ImageCache::entryCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void ImageCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    sizeBytes_ = 0;
+}
+
+void ImageCache::evictToCapacity() {
+    while (sizeBytes_ > capacityBytes_ && !entries_.empty()) {
+        const Entry& oldest = entries_.back();
+        sizeBytes_ -= oldest.bytes;
+        index_.erase(oldest.path);
+        entries_.pop_back();
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Frame.h"
+
+namespace rigid {
+
+/// Decoded still images shared between clips and renders.
+///
+/// Entries are keyed by path and modification time, so an image edited on
+/// disk is decoded again. The least recently used images are dropped once
+/// the decoded pixels exceed the byte capacity; frames handed out stay alive
+/// for as long as the caller holds them.
+class ImageCache {
+public:
+    using Loader = std::function<Frame(const std::string& path)>;
+
+    /// `loader` defaults to decodeImageFile; tests substitute their own
+    explicit ImageCache(size_t capacityBytes, Loader loader = {});
+
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    /// Decoded image at `path`. Throws MediaError if it cannot be decoded.
+    std::shared_ptr<const Frame> get(const std::string& path);
+
+    /// Bytes of decoded pixels currently cached
+    size_t sizeBytes() const;
+    size_t entryCount() const;
+    void clear();
+
+    /// Process-wide cache used by VideoCompositorEngine
+    static ImageCache& shared();
+
+private:
+    struct Entry {
+        std::string path;
+        std::filesystem::file_time_type modified;
+        std::shared_ptr<const Frame> frame;
+        size_t bytes;
+    };
+
+    const size_t capacityBytes_;
+    Loader loader_;
+
+    mutable std::mutex mutex_;
+    /// Most recently used first
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t sizeBytes_ = 0;
+
+    void evictToCapacity();
+};
+
+} // namespace rigid
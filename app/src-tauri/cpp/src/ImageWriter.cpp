@@ -0,0 +1,209 @@
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+#include "FramePool.h"
+#include "PngWriter.h"
+#include "QoiWriter.h"
+#include "WebPWriter.h"
+
+namespace rigid {
+
+namespace {
+
+int defaultThreadCount() {
+    return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+}
+
+int zlibLevel(Compression compression) {
+    switch (compression) {
+    case Compression::Fast: return 1;
+    case Compression::Smallest: return 9;
+    case Compression::Default: break;
+    }
+    return 6;
+}
+
+/// libwebp's lossless presets run from 0 to 9
+int webPEffort(Compression compression) {
+    switch (compression) {
+    case Compression::Fast: return 1;
+    case Compression::Smallest: return 9;
+    case Compression::Default: break;
+    }
+    return 5;
+}
+
+/// Whether this build has an encoder for the format `path` names
+bool canEncode(const std::string& path) {
+    return imageFormatForPath(path) != ImageFormat::WebP || webPEncoderAvailable();
+}
+
+/// Write `bytes` next to `path` and rename them into place
+void writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    const std::string partial = path + ".part";
+    FILE* file = std::fopen(partial.c_str(), "wb");
+    if (!file) throw std::runtime_error("Cannot open " + path);
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    if (std::fclose(file) != 0 || !written || std::rename(partial.c_str(), path.c_str()) != 0) {
+        std::remove(partial.c_str());
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+} // namespace
+
+ImageFormat imageFormatForPath(const std::string& path) {
+    const size_t dot = path.find_last_of("./");
+    if (dot == std::string::npos || path[dot] != '.') return ImageFormat::Png;
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == "qoi") return ImageFormat::Qoi;
+    if (extension == "webp") return ImageFormat::WebP;
+    return ImageFormat::Png;
+}
+
+ImageWriter::ImageWriter(int threadCount) : pool_(threadCount > 0 ? threadCount : defaultThreadCount()) {
+    worker_ = std::thread([this] { workerLoop(); });
+}
+
+ImageWriter::~ImageWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    worker_.join();
+}
+
+void ImageWriter::setEncoding(Compression compression, bool background) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compression_ = compression;
+    background_ = background;
+}
+
+Compression ImageWriter::compression() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return compression_;
+}
+
+bool ImageWriter::background() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return background_;
+}
+
+void ImageWriter::write(const std::string& path, std::vector<uint8_t>&& pixels, int width, int height) {
+    auto buffer = std::make_shared<std::vector<uint8_t>>(std::move(pixels));
+    write(path, buffer->data(), width * 4, width, height,
+          [buffer] { FramePool::shared().give(std::move(*buffer)); });
+}
+
+void ImageWriter::write(const std::string& path, const uint8_t* pixels, int stride, int width, int height,
+                        std::function<void()> done) {
+    if (!canEncode(path)) {
+        done();
+        throw std::invalid_argument("WebP encoding is not available in this build");
+    }
+
+    Job job{path, pixels, stride, width, height, Compression::Default, std::move(done)};
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job.compression = compression_;
+        if (background_) {
+            changed_.wait(lock, [this] { return queue_.size() < kMaxQueued; });
+            queue_.push_back(std::move(job));
+            changed_.notify_all();
+            return;
+        }
+    }
+    encode(job);
+}
+
+void ImageWriter::writeNow(const std::string& path, const uint8_t* pixels, int stride, int width, int height,
+                           Compression compression) {
+    if (!canEncode(path)) throw std::invalid_argument("WebP encoding is not available in this build");
+
+    Job job{path, pixels, stride, width, height, compression, [] {}};
+    encode(job);
+}
+
+void ImageWriter::waitForWrites() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return queue_.empty() && !busy_; });
+    if (!error_.empty()) {
+        const std::string error = std::move(error_);
+        error_.clear();
+        throw std::runtime_error(error);
+    }
+}
+
+ImageWriter& ImageWriter::shared() {
+    // Constructed first so it outlives the writer, which hands buffers back
+    // to it while draining its queue on exit
+    FramePool::shared();
+    static ImageWriter writer;
+    return writer;
+}
+
+void ImageWriter::encode(Job& job) {
+    std::vector<uint8_t> bytes;
+    {
+        // The pixels are released once encoded, or when encoding fails
+        struct Release {
+            std::function<void()>& done;
+            ~Release() { done(); }
+        } release{job.done};
+
+        std::lock_guard<std::mutex> lock(encodeMutex_);
+        switch (imageFormatForPath(job.path)) {
+        case ImageFormat::Png:
+            bytes = encodePng(job.pixels, job.stride, job.width, job.height, zlibLevel(job.compression), &pool_);
+            break;
+        case ImageFormat::Qoi:
+            bytes = encodeQoi(job.pixels, job.stride, job.width, job.height);
+            break;
+        case ImageFormat::WebP:
+            bytes = encodeWebP(job.pixels, job.stride, job.width, job.height, webPEffort(job.compression));
+            break;
+        }
+    }
+    // The file is written outside the lock, so the next image can encode
+    writeFile(job.path, bytes);
+}
+
+void ImageWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        changed_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        // Stopping still drains the queue, so no captured image is lost
+        if (queue_.empty()) return;
+
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+        changed_.notify_all();
+        lock.unlock();
+
+        std::string failure;
+        try {
+            encode(job);
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (!failure.empty()) {
+            std::fprintf(stderr, "ImageWriter: %s\n", failure.c_str());
+            if (error_.empty()) error_ = failure;
+        }
+        changed_.notify_all();
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TilePool.h"
+
+namespace rigid {
+
+/// Screenshot file formats
+enum class ImageFormat { Png, Qoi, WebP };
+
+/// ".qoi" and ".webp" (in any case) name their formats; anything else is PNG
+ImageFormat imageFormatForPath(const std::string& path);
+
+/// How hard encoders compress; the values are RIGID_COMPRESSION_*
+enum class Compression { Fast = 0, Default = 1, Smallest = 2 };
+
+/// Encodes screenshots into files; the encode stage behind the screenshot
+/// C API.
+///
+/// PNG is deflated in stripes across a TilePool, so a full Retina display
+/// encodes on every core instead of one. In the background, write() only
+/// queues the pixels: the capture that produced them returns at once, and
+/// the next capture is not held up by this one's encode. Either way a file
+/// is written under a temporary name and renamed into place, so nothing
+/// ever reads a partly written image.
+class ImageWriter {
+public:
+    /// Images queued in the background before write() waits for the
+    /// encoder to catch up, which bounds the memory a burst of captures holds
+    static constexpr size_t kMaxQueued = 4;
+
+    /// `threadCount` encoder threads in total, 0 for every hardware thread
+    explicit ImageWriter(int threadCount = 0);
+    /// Finishes queued writes first
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    /// Settings for later writes; images already queued keep theirs
+    void setEncoding(Compression compression, bool background);
+    Compression compression() const;
+    bool background() const;
+
+    /// Write opaque BGRA `pixels` (width * 4 bytes per row) to `path` in
+    /// the format its extension names. The buffer goes back to
+    /// FramePool::shared() once encoded. Throws std::invalid_argument for a
+    /// format this build cannot encode, and std::runtime_error when
+    /// encoding or writing fails; in the background that surfaces from
+    /// waitForWrites instead.
+    void write(const std::string& path, std::vector<uint8_t>&& pixels, int width, int height);
+
+    /// As above, for pixels with `stride` bytes per row that the caller
+    /// keeps alive until `done` runs: once they are encoded (on the encoding
+    /// thread), or when write or the encode fails.
+    void write(const std::string& path, const uint8_t* pixels, int stride, int width, int height,
+               std::function<void()> done);
+
+    /// Write pixels with `stride` bytes per row to `path` at `compression`
+    /// before returning, whatever setEncoding says, for callers that pick
+    /// their own level. Throws as a foreground write does; a failure is the
+    /// caller's alone and never reaches waitForWrites.
+    void writeNow(const std::string& path, const uint8_t* pixels, int stride, int width, int height,
+                  Compression compression);
+
+    /// Wait until every queued image is written. Throws std::runtime_error
+    /// for the first background write that failed since the last call.
+    void waitForWrites();
+
+    /// Process-wide writer used by the screenshot C API
+    static ImageWriter& shared();
+
+private:
+    struct Job {
+        std::string path;
+        const uint8_t* pixels = nullptr;
+        int stride = 0;
+        int width = 0;
+        int height = 0;
+        Compression compression = Compression::Default;
+        /// Releases the pixels
+        std::function<void()> done;
+    };
+
+    /// Encode and write one image, running its `done` once encoded
+    void encode(Job& job);
+    void workerLoop();
+
+    TilePool pool_;
+    /// The pool runs one image at a time
+    std::mutex encodeMutex_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    Compression compression_ = Compression::Default;
+    bool background_ = false;
+    std::deque<Job> queue_;
+    /// The worker holds a job it took off the queue
+    bool busy_ = false;
+    bool stopping_ = false;
+    /// First background failure since the last waitForWrites
+    std::string error_;
+    std::thread worker_;
+};
+
+} // namespace rigid
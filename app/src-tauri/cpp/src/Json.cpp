@@ -0,0 +1,301 @@
+#include "Json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace rigid {
+
+// MARK: - Parser
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    JsonValue parseDocument() {
+        JsonValue value = parseValue();
+        skipWhitespace();
+        if (pos_ != text_.size()) {
+            fail("Trailing characters after JSON document");
+        }
+        return value;
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_ = 0;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw JsonError(message + " at offset " + std::to_string(pos_));
+    }
+
+    void skipWhitespace() {
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+            pos_++;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t len = std::char_traits<char>::length(literal);
+        if (text_.compare(pos_, len, literal) == 0) {
+            pos_ += len;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parseValue() {
+        skipWhitespace();
+        if (pos_ >= text_.size()) fail("Unexpected end of JSON");
+
+        JsonValue value;
+        char c = text_[pos_];
+        if (c == '{') {
+            value.type_ = JsonValue::Type::Object;
+            pos_++;
+            skipWhitespace();
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                pos_++;
+                return value;
+            }
+            while (true) {
+                skipWhitespace();
+                if (pos_ >= text_.size() || text_[pos_] != '"') fail("Expected object key");
+                std::string key = parseString();
+                skipWhitespace();
+                if (pos_ >= text_.size() || text_[pos_] != ':') fail("Expected ':'");
+                pos_++;
+                value.object_[key] = parseValue();
+                skipWhitespace();
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    pos_++;
+                    continue;
+                }
+                if (pos_ < text_.size() && text_[pos_] == '}') {
+                    pos_++;
+                    return value;
+                }
+                fail("Expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            value.type_ = JsonValue::Type::Array;
+            pos_++;
+            skipWhitespace();
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                pos_++;
+                return value;
+            }
+            while (true) {
+                value.array_.push_back(parseValue());
+                skipWhitespace();
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    pos_++;
+                    continue;
+                }
+                if (pos_ < text_.size() && text_[pos_] == ']') {
+                    pos_++;
+                    return value;
+                }
+                fail("Expected ',' or ']'");
+            }
+        }
+        if (c == '"') {
+            value.type_ = JsonValue::Type::String;
+            value.string_ = parseString();
+            return value;
+        }
+        if (consume("true")) {
+            value.type_ = JsonValue::Type::Bool;
+            value.bool_ = true;
+            return value;
+        }
+        if (consume("false")) {
+            value.type_ = JsonValue::Type::Bool;
+            value.bool_ = false;
+            return value;
+        }
+        if (consume("null")) {
+            return value;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            const char* begin = text_.c_str() + pos_;
+            char* end = nullptr;
+            value.type_ = JsonValue::Type::Number;
+            value.number_ = std::strtod(begin, &end);
+            if (end == begin) fail("Invalid number");
+            pos_ += static_cast<size_t>(end - begin);
+            return value;
+        }
+        fail(std::string("Unexpected character '") + c + "'");
+    }
+
+    static void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    uint32_t parseHex4() {
+        if (pos_ + 4 > text_.size()) fail("Truncated unicode escape");
+        uint32_t cp = 0;
+        for (int i = 0; i < 4; i++) {
+            char h = text_[pos_++];
+            cp <<= 4;
+            if (h >= '0' && h <= '9') cp |= static_cast<uint32_t>(h - '0');
+            else if (h >= 'a' && h <= 'f') cp |= static_cast<uint32_t>(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') cp |= static_cast<uint32_t>(h - 'A' + 10);
+            else fail("Invalid unicode escape");
+        }
+        return cp;
+    }
+
+    std::string parseString() {
+        // Caller guarantees text_[pos_] == '"'
+        pos_++;
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) fail("Unterminated string");
+            char c = text_[pos_++];
+            if (c == '"') return out;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) fail("Unterminated escape");
+            char e = text_[pos_++];
+            switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp = parseHex4();
+                // Surrogate pair
+                if (cp >= 0xD800 && cp <= 0xDBFF && text_.compare(pos_, 2, "\\u") == 0) {
+                    pos_ += 2;
+                    uint32_t low = parseHex4();
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                fail("Invalid escape");
+            }
+        }
+    }
+};
+
+// MARK: - JsonValue
+
+JsonValue JsonValue::parse(const std::string& text) {
+    return JsonParser(text).parseDocument();
+}
+
+bool JsonValue::asBool() const {
+    if (type_ != Type::Bool) throw JsonError("Expected boolean");
+    return bool_;
+}
+
+double JsonValue::asDouble() const {
+    if (type_ != Type::Number) throw JsonError("Expected number");
+    return number_;
+}
+
+int64_t JsonValue::asInt64() const {
+    if (type_ != Type::Number) throw JsonError("Expected number");
+    return static_cast<int64_t>(std::llround(number_));
+}
+
+const std::string& JsonValue::asString() const {
+    if (type_ != Type::String) throw JsonError("Expected string");
+    return string_;
+}
+
+const std::vector<JsonValue>& JsonValue::asArray() const {
+    if (type_ != Type::Array) throw JsonError("Expected array");
+    return array_;
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    if (type_ != Type::Object) return nullptr;
+    auto it = object_.find(key);
+    if (it == object_.end() || it->second.isNull()) return nullptr;
+    return &it->second;
+}
+
+const JsonValue& JsonValue::at(const std::string& key) const {
+    const JsonValue* value = find(key);
+    if (!value) throw JsonError("Missing required key '" + key + "'");
+    return *value;
+}
+
+std::optional<bool> JsonValue::optBool(const std::string& key) const {
+    const JsonValue* value = find(key);
+    if (!value) return std::nullopt;
+    return value->asBool();
+}
+
+std::optional<double> JsonValue::optDouble(const std::string& key) const {
+    const JsonValue* value = find(key);
+    if (!value) return std::nullopt;
+    return value->asDouble();
+}
+
+std::optional<int64_t> JsonValue::optInt64(const std::string& key) const {
+    const JsonValue* value = find(key);
+    if (!value) return std::nullopt;
+    return value->asInt64();
+}
+
+std::optional<std::string> JsonValue::optString(const std::string& key) const {
+    const JsonValue* value = find(key);
+    if (!value) return std::nullopt;
+    return value->asString();
+}
+
+// MARK: - Writing
+
+std::string jsonQuote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        switch (c) {
+        case '"': quoted += "\\\""; break;
+        case '\\': quoted += "\\\\"; break;
+        case '\n': quoted += "\\n"; break;
+        case '\r': quoted += "\\r"; break;
+        case '\t': quoted += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                quoted += escape;
+            } else {
+                quoted += c;
+            }
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+} // namespace rigid
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rigid {
+
+/// Minimal JSON document model used to decode the configs passed across the C API.
+///
+/// Only what the compositor needs is supported: objects, arrays, strings, numbers,
+/// booleans and null. Numbers are stored as doubles, which is exact for every
+/// millisecond timestamp we deal with.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+
+    static JsonValue parse(const std::string& text);
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isObject() const { return type_ == Type::Object; }
+    bool isArray() const { return type_ == Type::Array; }
+
+    bool asBool() const;
+    double asDouble() const;
+    int64_t asInt64() const;
+    const std::string& asString() const;
+    const std::vector<JsonValue>& asArray() const;
+
+    /// Returns the member with the given key, or nullptr if missing or null.
+    const JsonValue* find(const std::string& key) const;
+
+    /// Required member accessors - throw JsonError when the key is missing.
+    const JsonValue& at(const std::string& key) const;
+
+    /// Optional member accessors - empty when the key is missing or null.
+    std::optional<bool> optBool(const std::string& key) const;
+    std::optional<double> optDouble(const std::string& key) const;
+    std::optional<int64_t> optInt64(const std::string& key) const;
+    std::optional<std::string> optString(const std::string& key) const;
+
+private:
+    friend class JsonParser;
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0;
+    std::string string_;
+    std::vector<JsonValue> array_;
+    std::map<std::string, JsonValue> object_;
+};
+
+/// `text` as a quoted JSON string, for the JSON the C API hands back
+std::string jsonQuote(const std::string& text);
+
+/// Thrown for malformed JSON and for missing/mistyped required members.
+class JsonError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+} // namespace rigid
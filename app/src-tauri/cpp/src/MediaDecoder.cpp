@@ -0,0 +1,420 @@
+#include "MediaDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswresample/swresample.h>
+#include <libswscale/swscale.h>
+}
+
+namespace rigid {
+
+namespace {
+
+/// Jumps further ahead than this are served by a seek instead of decoding through
+constexpr double kForwardSeekThresholdSec = 2.0;
+
+std::string avErrorString(int code) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(code, buffer, sizeof(buffer));
+    return buffer;
+}
+
+bool hasAlphaChannel(AVPixelFormat format) {
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get(format);
+    return !descriptor || (descriptor->flags & AV_PIX_FMT_FLAG_ALPHA);
+}
+
+/// Owns an opened input file plus a decoder for one of its streams
+struct StreamDecoder {
+    AVFormatContext* format = nullptr;
+    AVCodecContext* codec = nullptr;
+    AVStream* stream = nullptr;
+    AVPacket* packet = nullptr;
+    AVFrame* frame = nullptr;
+    int streamIndex = -1;
+    bool draining = false;
+    bool finished = false;
+
+    StreamDecoder(const std::string& path, AVMediaType type, int threadCount = 0) {
+        int ret = avformat_open_input(&format, path.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            throw MediaError("Failed to open " + path + ": " + avErrorString(ret));
+        }
+        ret = avformat_find_stream_info(format, nullptr);
+        if (ret < 0) {
+            close();
+            throw MediaError("Failed to read stream info for " + path + ": " + avErrorString(ret));
+        }
+
+        const AVCodec* decoder = nullptr;
+        streamIndex = av_find_best_stream(format, type, -1, -1, &decoder, 0);
+        if (streamIndex < 0 || !decoder) {
+            close();
+            throw MediaError("No " + std::string(av_get_media_type_string(type)) + " stream in " + path);
+        }
+        stream = format->streams[streamIndex];
+
+        codec = avcodec_alloc_context3(decoder);
+        if (!codec || avcodec_parameters_to_context(codec, stream->codecpar) < 0) {
+            close();
+            throw MediaError("Failed to configure decoder for " + path);
+        }
+        codec->thread_count = threadCount;  // 0 lets libav pick
+        codec->pkt_timebase = stream->time_base;
+
+        ret = avcodec_open2(codec, decoder, nullptr);
+        if (ret < 0) {
+            close();
+            throw MediaError("Failed to open decoder for " + path + ": " + avErrorString(ret));
+        }
+
+        packet = av_packet_alloc();
+        frame = av_frame_alloc();
+    }
+
+    ~StreamDecoder() { close(); }
+
+    void close() {
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        avcodec_free_context(&codec);
+        avformat_close_input(&format);
+    }
+
+    /// Presentation time of `frame` in seconds from the start of the stream
+    double framePts() const {
+        int64_t ts = frame->best_effort_timestamp;
+        if (ts == AV_NOPTS_VALUE) ts = frame->pts;
+        if (ts == AV_NOPTS_VALUE) return 0;
+        if (stream->start_time != AV_NOPTS_VALUE) ts -= stream->start_time;
+        return static_cast<double>(ts) * av_q2d(stream->time_base);
+    }
+
+    void seek(double sec) {
+        int64_t target = static_cast<int64_t>(sec / av_q2d(stream->time_base));
+        if (stream->start_time != AV_NOPTS_VALUE) target += stream->start_time;
+        av_seek_frame(format, streamIndex, target, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(codec);
+        draining = false;
+        finished = false;
+    }
+
+    /// Decode the next frame into `frame`. Returns false at end of stream.
+    bool decodeNext() {
+        while (!finished) {
+            int ret = avcodec_receive_frame(codec, frame);
+            if (ret == 0) return true;
+            if (ret == AVERROR_EOF) {
+                finished = true;
+                return false;
+            }
+            if (ret != AVERROR(EAGAIN)) {
+                throw MediaError("Decode failed: " + avErrorString(ret));
+            }
+            if (draining) {
+                finished = true;
+                return false;
+            }
+
+            // Feed the decoder another packet from our stream
+            while (true) {
+                ret = av_read_frame(format, packet);
+                if (ret < 0) {
+                    avcodec_send_packet(codec, nullptr);
+                    draining = true;
+                    break;
+                }
+                if (packet->stream_index != streamIndex) {
+                    av_packet_unref(packet);
+                    continue;
+                }
+                ret = avcodec_send_packet(codec, packet);
+                av_packet_unref(packet);
+                if (ret < 0 && ret != AVERROR(EAGAIN)) {
+                    throw MediaError("Failed to send packet: " + avErrorString(ret));
+                }
+                break;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+bool mediaBackendAvailable() {
+    return true;
+}
+
+// MARK: - VideoDecoder
+
+struct VideoDecoder::Impl {
+    StreamDecoder decoder;
+    SwsContext* sws = nullptr;
+    double frameRate = 30;
+
+    /// Decoded frame on screen at the last requested time, converted into
+    /// `current` only when returned
+    AVFrame* shown = nullptr;
+    double shownPts = -1;
+    bool hasShown = false;
+    bool converted = false;
+    Frame current;
+
+    /// The frame after `shown`, left in decoder.frame by peek()
+    double peekedPts = 0;
+    bool hasPeeked = false;
+
+    Impl(const std::string& path, int threadCount) : decoder(path, AVMEDIA_TYPE_VIDEO, threadCount) {
+        AVRational rate = decoder.stream->avg_frame_rate;
+        if (rate.num <= 0 || rate.den <= 0) rate = decoder.stream->r_frame_rate;
+        if (rate.num > 0 && rate.den > 0) frameRate = av_q2d(rate);
+        shown = av_frame_alloc();
+    }
+
+    ~Impl() {
+        av_frame_free(&shown);
+        sws_freeContext(sws);
+    }
+
+    void convertShown() {
+        sws = sws_getCachedContext(sws, shown->width, shown->height, static_cast<AVPixelFormat>(shown->format),
+                                   shown->width, shown->height, AV_PIX_FMT_BGRA,
+                                   SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!sws) throw MediaError("Failed to create pixel format converter");
+
+        if (current.width != shown->width || current.height != shown->height) {
+            current.allocate(shown->width, shown->height);
+        }
+        uint8_t* dst[4] = {current.pixels.data(), nullptr, nullptr, nullptr};
+        int dstStride[4] = {current.stride, 0, 0, 0};
+        sws_scale(sws, shown->data, shown->linesize, 0, shown->height, dst, dstStride);
+        // swscale writes alpha 255 when the source has no alpha channel
+        current.opaque = !hasAlphaChannel(static_cast<AVPixelFormat>(shown->format));
+        converted = true;
+    }
+
+    /// Decode the frame after `shown`, unless it is already waiting. Returns
+    /// false at end of stream.
+    bool peek() {
+        if (hasPeeked) return true;
+        if (!decoder.decodeNext()) return false;
+        peekedPts = decoder.framePts();
+        hasPeeked = true;
+        return true;
+    }
+
+    /// Show the peeked frame
+    void advance() {
+        av_frame_unref(shown);
+        av_frame_move_ref(shown, decoder.frame);
+        shownPts = peekedPts;
+        hasShown = true;
+        hasPeeked = false;
+        converted = false;
+    }
+
+    const Frame* frameAt(double sec) {
+        // A frame stays on screen until the next one's timestamp, not for a
+        // nominal frame duration: recordings skip idle frames, so inside such
+        // a gap the shown frame is still the right one. Seek only when going
+        // backwards from it or jumping far past the next frame.
+        bool sought = !hasShown || sec < shownPts || (peek() && sec > peekedPts + kForwardSeekThresholdSec);
+        if (sought) {
+            decoder.seek(std::max(sec, 0.0));
+            hasPeeked = false;
+        }
+
+        // The first frame after a seek also stands in for earlier times
+        while (peek() && (sought || peekedPts <= sec)) {
+            advance();
+            sought = false;
+        }
+
+        // End of stream holds the last frame produced
+        if (!hasShown) return nullptr;
+        if (!converted) convertShown();
+        return &current;
+    }
+};
+
+VideoDecoder::VideoDecoder(const std::string& path, int threadCount)
+    : impl_(std::make_unique<Impl>(path, threadCount)) {}
+
+VideoDecoder::~VideoDecoder() = default;
+
+const Frame* VideoDecoder::frameAt(double sourceSec) {
+    return impl_->frameAt(sourceSec);
+}
+
+double VideoDecoder::frameRate() const {
+    return impl_->frameRate;
+}
+
+double VideoDecoder::durationSec() const {
+    const AVStream* stream = impl_->decoder.stream;
+    if (stream->duration != AV_NOPTS_VALUE) {
+        return static_cast<double>(stream->duration) * av_q2d(stream->time_base);
+    }
+    if (impl_->decoder.format->duration != AV_NOPTS_VALUE) {
+        return static_cast<double>(impl_->decoder.format->duration) / AV_TIME_BASE;
+    }
+    return 0;
+}
+
+// MARK: - AudioDecoder
+
+struct AudioDecoder::Impl {
+    StreamDecoder decoder;
+    SwrContext* swr = nullptr;
+    double startSec;
+    int outputRate;
+
+    std::vector<float> buffered;  // Interleaved stereo
+    size_t readOffset = 0;
+    bool flushed = false;
+
+    Impl(const std::string& path, double start, double speed)
+        : decoder(path, AVMEDIA_TYPE_AUDIO), startSec(start) {
+        // Resampling to 48k/speed and playing back at 48k applies the speed change
+        outputRate = static_cast<int>(std::lround(kSampleRate / speed));
+
+        AVChannelLayout outLayout = {};
+        av_channel_layout_default(&outLayout, kChannels);
+        AVChannelLayout inLayout = {};
+        if (decoder.codec->ch_layout.nb_channels > 0) {
+            av_channel_layout_copy(&inLayout, &decoder.codec->ch_layout);
+        } else {
+            av_channel_layout_default(&inLayout, kChannels);
+        }
+        int ret = swr_alloc_set_opts2(&swr, &outLayout, AV_SAMPLE_FMT_FLT, outputRate,
+                                      &inLayout, decoder.codec->sample_fmt, decoder.codec->sample_rate,
+                                      0, nullptr);
+        av_channel_layout_uninit(&inLayout);
+        if (ret < 0 || swr_init(swr) < 0) {
+            swr_free(&swr);
+            throw MediaError("Failed to create audio resampler for " + path);
+        }
+
+        if (startSec > 0) decoder.seek(startSec);
+    }
+
+    ~Impl() { swr_free(&swr); }
+
+    size_t available() const { return (buffered.size() - readOffset) / kChannels; }
+
+    void compact() {
+        if (readOffset == 0) return;
+        buffered.erase(buffered.begin(), buffered.begin() + static_cast<std::ptrdiff_t>(readOffset));
+        readOffset = 0;
+    }
+
+    /// Decode one more chunk into `buffered`. Returns false once fully drained.
+    bool fill() {
+        if (flushed) return false;
+
+        if (!decoder.decodeNext()) {
+            // Drain whatever the resampler still holds
+            int pending = swr_get_out_samples(swr, 0);
+            if (pending > 0) {
+                size_t offset = buffered.size();
+                buffered.resize(offset + static_cast<size_t>(pending) * kChannels);
+                uint8_t* out[1] = {reinterpret_cast<uint8_t*>(buffered.data() + offset)};
+                int produced = swr_convert(swr, out, pending, nullptr, 0);
+                buffered.resize(offset + static_cast<size_t>(std::max(produced, 0)) * kChannels);
+            }
+            flushed = true;
+            return false;
+        }
+
+        AVFrame* frame = decoder.frame;
+        double pts = decoder.framePts();
+        double frameSec = static_cast<double>(frame->nb_samples) / frame->sample_rate;
+        if (pts + frameSec <= startSec) {
+            return true;  // Entirely before the in-point
+        }
+
+        int capacity = swr_get_out_samples(swr, frame->nb_samples);
+        size_t offset = buffered.size();
+        buffered.resize(offset + static_cast<size_t>(capacity) * kChannels);
+        uint8_t* out[1] = {reinterpret_cast<uint8_t*>(buffered.data() + offset)};
+        int produced = swr_convert(swr, out, capacity,
+                                   const_cast<const uint8_t**>(frame->extended_data), frame->nb_samples);
+        produced = std::max(produced, 0);
+        buffered.resize(offset + static_cast<size_t>(produced) * kChannels);
+
+        // Trim the part of the first frame that precedes the in-point
+        if (pts < startSec) {
+            size_t skip = static_cast<size_t>((startSec - pts) * outputRate) * kChannels;
+            skip = std::min(skip, buffered.size() - offset);
+            buffered.erase(buffered.begin() + static_cast<std::ptrdiff_t>(offset),
+                           buffered.begin() + static_cast<std::ptrdiff_t>(offset + skip));
+        }
+        return true;
+    }
+
+    int read(float* out, int frameCount) {
+        while (available() < static_cast<size_t>(frameCount) && fill()) {}
+
+        int count = static_cast<int>(std::min(available(), static_cast<size_t>(frameCount)));
+        std::copy_n(buffered.data() + readOffset, static_cast<size_t>(count) * kChannels, out);
+        readOffset += static_cast<size_t>(count) * kChannels;
+        if (readOffset > buffered.size() / 2) compact();
+        return count;
+    }
+};
+
+AudioDecoder::AudioDecoder(const std::string& path, double startSec, double speed)
+    : impl_(std::make_unique<Impl>(path, startSec, speed)) {}
+
+AudioDecoder::~AudioDecoder() = default;
+
+int AudioDecoder::read(float* interleaved, int frameCount) {
+    return impl_->read(interleaved, frameCount);
+}
+
+// MARK: - Images
+
+Frame decodeImageFile(const std::string& path) {
+    StreamDecoder decoder(path, AVMEDIA_TYPE_VIDEO);
+    if (!decoder.decodeNext()) {
+        throw MediaError("No image data in " + path);
+    }
+
+    AVFrame* src = decoder.frame;
+    SwsContext* sws = sws_getContext(src->width, src->height, static_cast<AVPixelFormat>(src->format),
+                                     src->width, src->height, AV_PIX_FMT_BGRA,
+                                     SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws) throw MediaError("Failed to create pixel format converter for " + path);
+
+    Frame image(src->width, src->height);
+    uint8_t* dst[4] = {image.pixels.data(), nullptr, nullptr, nullptr};
+    int dstStride[4] = {image.stride, 0, 0, 0};
+    sws_scale(sws, src->data, src->linesize, 0, src->height, dst, dstStride);
+    sws_freeContext(sws);
+
+    // The compositor works in premultiplied alpha
+    bool opaque = true;
+    for (int y = 0; y < image.height; y++) {
+        uint8_t* p = image.row(y);
+        for (int x = 0; x < image.width; x++, p += 4) {
+            uint8_t a = p[3];
+            if (a == 255) continue;
+            opaque = false;
+            p[0] = static_cast<uint8_t>((p[0] * a + 127) / 255);
+            p[1] = static_cast<uint8_t>((p[1] * a + 127) / 255);
+            p[2] = static_cast<uint8_t>((p[2] * a + 127) / 255);
+        }
+    }
+    image.opaque = opaque;
+    return image;
+}
+
+} // namespace rigid
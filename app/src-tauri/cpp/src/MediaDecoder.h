@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "Frame.h"
+
+namespace rigid {
+
+/// Thrown for any failure to open, decode or encode media
+class MediaError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// True when the library was built against libav* (see CMakeLists.txt).
+/// Without it every decoder/encoder constructor throws MediaError.
+bool mediaBackendAvailable();
+
+/// Decodes the first video stream of a file into BGRA frames.
+///
+/// Frames are read forward in presentation order; the decoder only seeks when
+/// the requested time goes backwards or jumps far ahead of the next frame.
+/// Each frame is shown until the next one's timestamp, so a variable frame
+/// rate recording with gaps decodes forward through them as well.
+class VideoDecoder {
+public:
+    /// `threadCount` limits libav's decoder threads; 0 lets libav decide
+    explicit VideoDecoder(const std::string& path, int threadCount = 0);
+    ~VideoDecoder();
+
+    VideoDecoder(const VideoDecoder&) = delete;
+    VideoDecoder& operator=(const VideoDecoder&) = delete;
+
+    /// Frame displayed at `sourceSec` (relative to the start of the stream).
+    /// Past the end of the stream the last frame is held. Returns nullptr only
+    /// if nothing could be decoded at all.
+    const Frame* frameAt(double sourceSec);
+
+    double frameRate() const;
+    double durationSec() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Decodes the audio stream of a file to 48 kHz interleaved stereo float,
+/// starting at `startSec` and time-scaled by `speed`.
+class AudioDecoder {
+public:
+    static constexpr int kSampleRate = 48000;
+    static constexpr int kChannels = 2;
+
+    AudioDecoder(const std::string& path, double startSec, double speed);
+    ~AudioDecoder();
+
+    AudioDecoder(const AudioDecoder&) = delete;
+    AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+    /// Read up to `frameCount` stereo frames into `interleaved`.
+    /// Returns the number of frames produced; fewer than requested means end of stream.
+    int read(float* interleaved, int frameCount);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Decode a still image (PNG, JPEG, WebP, ...) into a premultiplied BGRA frame
+Frame decodeImageFile(const std::string& path);
+
+} // namespace rigid
@@ -0,0 +1,429 @@
+#include "MediaEncoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ColorConvert.h"
+#include "MediaDecoder.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+}
+
+namespace rigid {
+
+namespace {
+
+constexpr int kAudioSampleRate = 48000;
+constexpr int64_t kAudioBitrate = 320000;
+
+std::string avErrorString(int code) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(code, buffer, sizeof(buffer));
+    return buffer;
+}
+
+/// x264 settings per quality, matching `render_demo_background` in commands/video.rs
+struct X264Preset {
+    const char* crf;
+    const char* preset;
+    bool capBitrate;
+};
+
+X264Preset x264PresetForQuality(CompositorQuality quality) {
+    switch (quality) {
+    case CompositorQuality::Draft: return {"28", "ultrafast", true};
+    case CompositorQuality::Good: return {"18", "fast", true};
+    case CompositorQuality::High: return {"14", "medium", true};
+    case CompositorQuality::Max: return {"8", "slow", false};
+    }
+    return {"18", "fast", true};
+}
+
+/// A finished segment opened for stream copy
+struct SegmentReader {
+    AVFormatContext* format = nullptr;
+    int streamIndex = -1;
+
+    explicit SegmentReader(const std::string& path) {
+        int ret = avformat_open_input(&format, path.c_str(), nullptr, nullptr);
+        if (ret < 0) throw MediaError("Failed to open segment " + path + ": " + avErrorString(ret));
+
+        ret = avformat_find_stream_info(format, nullptr);
+        if (ret >= 0) ret = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (ret < 0) {
+            avformat_close_input(&format);
+            throw MediaError("No video stream in segment " + path);
+        }
+        streamIndex = ret;
+    }
+
+    ~SegmentReader() { avformat_close_input(&format); }
+
+    SegmentReader(const SegmentReader&) = delete;
+    SegmentReader& operator=(const SegmentReader&) = delete;
+
+    AVStream* stream() const { return format->streams[streamIndex]; }
+};
+
+} // namespace
+
+struct MediaEncoder::Impl {
+    EncoderSettings settings;
+
+    AVFormatContext* format = nullptr;
+    AVCodecContext* video = nullptr;
+    AVCodecContext* audio = nullptr;
+    AVStream* videoStream = nullptr;
+    AVStream* audioStream = nullptr;
+    AVFrame* videoFrame = nullptr;
+    AVFrame* audioFrame = nullptr;
+    AVPacket* packet = nullptr;
+
+    std::vector<float> pendingAudio;  // Interleaved stereo not yet encoded
+    int64_t audioSamplesWritten = 0;
+    bool finished = false;
+
+    explicit Impl(const EncoderSettings& s) : settings(s) {
+        try {
+            open();
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    ~Impl() { close(); }
+
+    void close() {
+        av_frame_free(&videoFrame);
+        av_frame_free(&audioFrame);
+        av_packet_free(&packet);
+        avcodec_free_context(&video);
+        avcodec_free_context(&audio);
+        if (format) {
+            if (!(format->oformat->flags & AVFMT_NOFILE)) avio_closep(&format->pb);
+            avformat_free_context(format);
+            format = nullptr;
+        }
+    }
+
+    void open() {
+        const std::string& path = settings.outputPath;
+        int ret = avformat_alloc_output_context2(&format, nullptr, "mp4", path.c_str());
+        if (ret < 0 || !format) {
+            throw MediaError("Failed to create output context: " + avErrorString(ret));
+        }
+
+        if (settings.copyVideoFrom.empty()) {
+            openVideo();
+        } else {
+            openVideoCopy();
+        }
+        if (settings.withAudio) openAudio();
+
+        ret = avio_open(&format->pb, path.c_str(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            throw MediaError("Failed to open " + path + " for writing: " + avErrorString(ret));
+        }
+
+        AVDictionary* options = nullptr;
+        av_dict_set(&options, "movflags", "+faststart", 0);
+        ret = avformat_write_header(format, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            throw MediaError("Failed to write header: " + avErrorString(ret));
+        }
+
+        packet = av_packet_alloc();
+    }
+
+    void openVideo() {
+        const AVCodec* codec = avcodec_find_encoder_by_name("libx264");
+        if (!codec) codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+        if (!codec) throw MediaError("No H.264 encoder available");
+
+        videoStream = avformat_new_stream(format, nullptr);
+        video = avcodec_alloc_context3(codec);
+        if (!videoStream || !video) throw MediaError("Failed to allocate video encoder");
+
+        video->width = settings.width;
+        video->height = settings.height;
+        video->time_base = AVRational{1, settings.frameRate};
+        video->framerate = AVRational{settings.frameRate, 1};
+        video->pix_fmt = AV_PIX_FMT_YUV420P;
+        video->gop_size = settings.keyframeInterval();
+        video->thread_count = settings.threadCount;
+        video->color_range = AVCOL_RANGE_MPEG;
+        video->color_primaries = AVCOL_PRI_BT709;
+        video->color_trc = AVCOL_TRC_BT709;
+        video->colorspace = AVCOL_SPC_BT709;
+        if (format->oformat->flags & AVFMT_GLOBALHEADER) {
+            video->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        X264Preset preset = x264PresetForQuality(settings.quality);
+        AVDictionary* options = nullptr;
+        if (std::string(codec->name) == "libx264" && settings.realtime) {
+            av_dict_set(&options, "preset", "superfast", 0);
+            av_dict_set(&options, "tune", "zerolatency", 0);
+            if (settings.bitrate > 0) {
+                video->bit_rate = settings.bitrate;
+                video->rc_max_rate = settings.bitrate;
+                video->rc_buffer_size = static_cast<int>(settings.bitrate * 2);
+            }
+        } else if (std::string(codec->name) == "libx264") {
+            av_dict_set(&options, "preset", preset.preset, 0);
+            av_dict_set(&options, "crf", preset.crf, 0);
+            if (preset.capBitrate && settings.bitrate > 0) {
+                video->rc_max_rate = settings.bitrate;
+                video->rc_buffer_size = static_cast<int>(settings.bitrate * 2);
+            }
+        } else if (settings.bitrate > 0) {
+            video->bit_rate = settings.bitrate;
+        }
+
+        int ret = avcodec_open2(video, codec, &options);
+        av_dict_free(&options);
+        if (ret < 0) throw MediaError("Failed to open video encoder: " + avErrorString(ret));
+
+        avcodec_parameters_from_context(videoStream->codecpar, video);
+        videoStream->time_base = video->time_base;
+        videoStream->avg_frame_rate = video->framerate;
+
+        videoFrame = av_frame_alloc();
+        videoFrame->format = video->pix_fmt;
+        videoFrame->width = video->width;
+        videoFrame->height = video->height;
+        if (av_frame_get_buffer(videoFrame, 0) < 0) {
+            throw MediaError("Failed to allocate video frame");
+        }
+    }
+
+    /// Video stream for stream-copied segments; no encoder
+    void openVideoCopy() {
+        SegmentReader segment(settings.copyVideoFrom);
+
+        videoStream = avformat_new_stream(format, nullptr);
+        if (!videoStream) throw MediaError("Failed to allocate video stream");
+
+        int ret = avcodec_parameters_copy(videoStream->codecpar, segment.stream()->codecpar);
+        if (ret < 0) throw MediaError("Failed to copy video parameters: " + avErrorString(ret));
+        videoStream->codecpar->codec_tag = 0;
+        videoStream->time_base = AVRational{1, settings.frameRate};
+        videoStream->avg_frame_rate = AVRational{settings.frameRate, 1};
+    }
+
+    void openAudio() {
+        const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+        if (!codec) throw MediaError("No AAC encoder available");
+
+        audioStream = avformat_new_stream(format, nullptr);
+        audio = avcodec_alloc_context3(codec);
+        if (!audioStream || !audio) throw MediaError("Failed to allocate audio encoder");
+
+        audio->sample_fmt = AV_SAMPLE_FMT_FLTP;
+        audio->sample_rate = kAudioSampleRate;
+        audio->bit_rate = kAudioBitrate;
+        audio->time_base = AVRational{1, kAudioSampleRate};
+        av_channel_layout_default(&audio->ch_layout, 2);
+        if (format->oformat->flags & AVFMT_GLOBALHEADER) {
+            audio->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        int ret = avcodec_open2(audio, codec, nullptr);
+        if (ret < 0) throw MediaError("Failed to open audio encoder: " + avErrorString(ret));
+
+        avcodec_parameters_from_context(audioStream->codecpar, audio);
+        audioStream->time_base = audio->time_base;
+
+        audioFrame = av_frame_alloc();
+        audioFrame->format = audio->sample_fmt;
+        audioFrame->sample_rate = audio->sample_rate;
+        audioFrame->nb_samples = audio->frame_size > 0 ? audio->frame_size : 1024;
+        av_channel_layout_copy(&audioFrame->ch_layout, &audio->ch_layout);
+        if (av_frame_get_buffer(audioFrame, 0) < 0) {
+            throw MediaError("Failed to allocate audio frame");
+        }
+    }
+
+    /// Send a frame (or nullptr to flush) and write every packet that comes out
+    void send(AVCodecContext* codec, AVStream* stream, AVFrame* frame) {
+        int ret = avcodec_send_frame(codec, frame);
+        if (ret < 0 && ret != AVERROR_EOF) {
+            throw MediaError("Encode failed: " + avErrorString(ret));
+        }
+        while (true) {
+            ret = avcodec_receive_packet(codec, packet);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) return;
+            if (ret < 0) throw MediaError("Encode failed: " + avErrorString(ret));
+
+            av_packet_rescale_ts(packet, codec->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            ret = av_interleaved_write_frame(format, packet);
+            if (ret < 0) throw MediaError("Failed to write packet: " + avErrorString(ret));
+        }
+    }
+
+    /// Copy `rows` rows of `width` bytes into plane `plane` of the video frame
+    void copyPlane(const uint8_t* src, int srcStride, int width, int rows, int plane) {
+        for (int y = 0; y < rows; y++) {
+            std::memcpy(videoFrame->data[plane] + static_cast<size_t>(y) * videoFrame->linesize[plane],
+                        src + static_cast<size_t>(y) * srcStride, static_cast<size_t>(width));
+        }
+    }
+
+    void encodeVideoFrame(const Frame& frame, int64_t frameIndex) {
+        if (av_frame_make_writable(videoFrame) < 0) {
+            throw MediaError("Video frame not writable");
+        }
+        if (frame.yuv.width == frame.width && frame.yuv.height == frame.height) {
+            // Converted by the compositor as it wrote the frame
+            copyPlane(frame.yuv.y.data(), frame.yuv.width, frame.yuv.width, frame.yuv.height, 0);
+            copyPlane(frame.yuv.u.data(), frame.yuv.chromaWidth(), frame.yuv.chromaWidth(),
+                      frame.yuv.chromaHeight(), 1);
+            copyPlane(frame.yuv.v.data(), frame.yuv.chromaWidth(), frame.yuv.chromaWidth(),
+                      frame.yuv.chromaHeight(), 2);
+        } else {
+            YuvPlanes planes;
+            planes.y = videoFrame->data[0];
+            planes.yStride = videoFrame->linesize[0];
+            planes.u = videoFrame->data[1];
+            planes.uStride = videoFrame->linesize[1];
+            planes.v = videoFrame->data[2];
+            planes.vStride = videoFrame->linesize[2];
+            convertBgraToYuv420(frame, {0, 0, frame.width, frame.height}, planes);
+        }
+        videoFrame->pts = frameIndex;
+        send(video, videoStream, videoFrame);
+    }
+
+    void encodeVideoFrame(const uint8_t* pixels, int stride, int64_t frameIndex) {
+        if (av_frame_make_writable(videoFrame) < 0) {
+            throw MediaError("Video frame not writable");
+        }
+        YuvPlanes planes;
+        planes.y = videoFrame->data[0];
+        planes.yStride = videoFrame->linesize[0];
+        planes.u = videoFrame->data[1];
+        planes.uStride = videoFrame->linesize[1];
+        planes.v = videoFrame->data[2];
+        planes.vStride = videoFrame->linesize[2];
+        convertBgraToYuv420(pixels, stride, settings.width, settings.height,
+                            {0, 0, settings.width, settings.height}, planes);
+        videoFrame->pts = frameIndex;
+        send(video, videoStream, videoFrame);
+    }
+
+    void appendVideoSegment(const std::string& path, int64_t firstFrameIndex,
+                            const std::function<void(int64_t)>& frameCopied) {
+        if (video) throw MediaError("Segments can only be appended to a stream-copy encoder");
+
+        SegmentReader segment(path);
+        AVRational inputTimeBase = segment.stream()->time_base;
+        // The muxer may have picked its own time base when writing the header
+        int64_t offset = av_rescale_q(firstFrameIndex, AVRational{1, settings.frameRate}, videoStream->time_base);
+        int64_t framesWritten = firstFrameIndex;
+
+        while (true) {
+            int ret = av_read_frame(segment.format, packet);
+            if (ret == AVERROR_EOF) break;
+            if (ret < 0) throw MediaError("Failed to read segment " + path + ": " + avErrorString(ret));
+            if (packet->stream_index != segment.streamIndex) {
+                av_packet_unref(packet);
+                continue;
+            }
+
+            av_packet_rescale_ts(packet, inputTimeBase, videoStream->time_base);
+            if (packet->pts != AV_NOPTS_VALUE) packet->pts += offset;
+            if (packet->dts != AV_NOPTS_VALUE) packet->dts += offset;
+            packet->pos = -1;
+            packet->stream_index = videoStream->index;
+            ret = av_interleaved_write_frame(format, packet);
+            if (ret < 0) throw MediaError("Failed to write packet: " + avErrorString(ret));
+
+            framesWritten++;
+            if (frameCopied) frameCopied(framesWritten);
+        }
+    }
+
+    /// Encode one audio frame from the front of `pendingAudio`, zero-padding if short
+    void encodePendingAudioFrame(int available) {
+        int frameSize = audioFrame->nb_samples;
+        if (av_frame_make_writable(audioFrame) < 0) {
+            throw MediaError("Audio frame not writable");
+        }
+        auto* left = reinterpret_cast<float*>(audioFrame->data[0]);
+        auto* right = reinterpret_cast<float*>(audioFrame->data[1]);
+        for (int i = 0; i < frameSize; i++) {
+            bool have = i < available;
+            left[i] = have ? pendingAudio[static_cast<size_t>(i) * 2] : 0.0f;
+            right[i] = have ? pendingAudio[static_cast<size_t>(i) * 2 + 1] : 0.0f;
+        }
+        audioFrame->pts = audioSamplesWritten;
+        audioSamplesWritten += frameSize;
+        send(audio, audioStream, audioFrame);
+
+        size_t consumed = static_cast<size_t>(std::min(available, frameSize)) * 2;
+        pendingAudio.erase(pendingAudio.begin(), pendingAudio.begin() + static_cast<std::ptrdiff_t>(consumed));
+    }
+
+    void encodeAudio(const float* interleaved, int frameCount) {
+        if (!audio || frameCount <= 0) return;
+        pendingAudio.insert(pendingAudio.end(), interleaved, interleaved + static_cast<size_t>(frameCount) * 2);
+
+        int frameSize = audioFrame->nb_samples;
+        while (static_cast<int>(pendingAudio.size() / 2) >= frameSize) {
+            encodePendingAudioFrame(frameSize);
+        }
+    }
+
+    void finish() {
+        if (finished) return;
+        finished = true;
+
+        if (video) send(video, videoStream, nullptr);
+        if (audio) {
+            int remaining = static_cast<int>(pendingAudio.size() / 2);
+            if (remaining > 0) encodePendingAudioFrame(remaining);
+            send(audio, audioStream, nullptr);
+        }
+
+        int ret = av_write_trailer(format);
+        if (ret < 0) throw MediaError("Failed to write trailer: " + avErrorString(ret));
+    }
+};
+
+MediaEncoder::MediaEncoder(const EncoderSettings& settings) : impl_(std::make_unique<Impl>(settings)) {}
+
+MediaEncoder::~MediaEncoder() = default;
+
+void MediaEncoder::encodeVideoFrame(const Frame& frame, int64_t frameIndex) {
+    impl_->encodeVideoFrame(frame, frameIndex);
+}
+
+void MediaEncoder::encodeVideoFrame(const uint8_t* pixels, int stride, int64_t frameIndex) {
+    impl_->encodeVideoFrame(pixels, stride, frameIndex);
+}
+
+void MediaEncoder::encodeAudio(const float* interleaved, int frameCount) {
+    impl_->encodeAudio(interleaved, frameCount);
+}
+
+void MediaEncoder::appendVideoSegment(const std::string& path, int64_t firstFrameIndex,
+                                      const std::function<void(int64_t)>& frameCopied) {
+    impl_->appendVideoSegment(path, firstFrameIndex, frameCopied);
+}
+
+int MediaEncoder::audioFrameSize() const {
+    return impl_->audioFrame ? impl_->audioFrame->nb_samples : 1024;
+}
+
+void MediaEncoder::finish() {
+    impl_->finish();
+}
+
+} // namespace rigid
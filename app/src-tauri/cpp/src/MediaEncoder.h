@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "CompositorConfig.h"
+#include "Frame.h"
+
+namespace rigid {
+
+/// Output settings for MediaEncoder
+struct EncoderSettings {
+    std::string outputPath;
+    int width = 0;
+    int height = 0;
+    int frameRate = 30;
+    int64_t bitrate = 0;
+    CompositorQuality quality = CompositorQuality::Good;
+    bool withAudio = false;
+    /// Encoder threads; 0 lets libx264 decide
+    int threadCount = 0;
+    /// When set, no video encoder is opened: the video stream takes its
+    /// parameters from this segment and its packets from appendVideoSegment
+    std::string copyVideoFrom;
+    /// Frames between keyframes; 0 for two seconds
+    int gopFrames = 0;
+    /// Live capture: the fastest x264 settings with zero-latency tuning,
+    /// averaging `bitrate` rather than holding a CRF quality
+    bool realtime = false;
+
+    /// Frames between keyframes. Chunked exports split on multiples of this.
+    int keyframeInterval() const { return gopFrames > 0 ? gopFrames : frameRate * 2; }
+};
+
+/// H.264 + AAC MP4 writer.
+///
+/// Uses the same x264 settings as the ffmpeg CLI export path
+/// (`build_ffmpeg_args` in commands/video.rs) so both paths produce
+/// comparable files: yuv420p BT.709, CRF/preset per quality, bitrate cap,
+/// AAC 320k 48 kHz stereo and +faststart.
+class MediaEncoder {
+public:
+    /// Opens the output file and writes the header. Throws MediaError.
+    explicit MediaEncoder(const EncoderSettings& settings);
+    ~MediaEncoder();
+
+    MediaEncoder(const MediaEncoder&) = delete;
+    MediaEncoder& operator=(const MediaEncoder&) = delete;
+
+    /// Encode a BGRA frame as output frame `frameIndex`
+    void encodeVideoFrame(const Frame& frame, int64_t frameIndex);
+
+    /// Encode BGRA pixels with `stride` bytes per row, at least the
+    /// encoder's width x height, as output frame `frameIndex`
+    void encodeVideoFrame(const uint8_t* pixels, int stride, int64_t frameIndex);
+
+    /// Queue interleaved stereo 48 kHz float samples. Any count is accepted;
+    /// samples are buffered into encoder-sized frames internally.
+    void encodeAudio(const float* interleaved, int frameCount);
+
+    /// Stream copy the video of a segment written by another MediaEncoder with
+    /// the same settings, starting at output frame `firstFrameIndex`. Only
+    /// valid with `copyVideoFrom`. `frameCopied` runs after every packet with
+    /// the number of output frames written so far, so audio can follow along.
+    void appendVideoSegment(const std::string& path, int64_t firstFrameIndex,
+                            const std::function<void(int64_t framesWritten)>& frameCopied);
+
+    /// Number of stereo frames the audio encoder consumes per packet
+    int audioFrameSize() const;
+
+    /// Flush both encoders and write the trailer
+    void finish();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace rigid
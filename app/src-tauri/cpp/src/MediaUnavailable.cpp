@@ -0,0 +1,49 @@
+// Stand-ins used when the library is built without libav* (see CMakeLists.txt).
+// Every entry point throws MediaError, so the C API reports an encoding
+// failure and the Rust side falls back to the ffmpeg CLI export path.
+
+#include "MediaDecoder.h"
+#include "MediaEncoder.h"
+
+namespace rigid {
+
+namespace {
+
+[[noreturn]] void unavailable() {
+    throw MediaError("RigidCaptureKit was built without libav support");
+}
+
+} // namespace
+
+bool mediaBackendAvailable() {
+    return false;
+}
+
+struct VideoDecoder::Impl {};
+
+VideoDecoder::VideoDecoder(const std::string&, int) { unavailable(); }
+VideoDecoder::~VideoDecoder() = default;
+const Frame* VideoDecoder::frameAt(double) { unavailable(); }
+double VideoDecoder::frameRate() const { unavailable(); }
+double VideoDecoder::durationSec() const { unavailable(); }
+
+struct AudioDecoder::Impl {};
+
+AudioDecoder::AudioDecoder(const std::string&, double, double) { unavailable(); }
+AudioDecoder::~AudioDecoder() = default;
+int AudioDecoder::read(float*, int) { unavailable(); }
+
+Frame decodeImageFile(const std::string&) { unavailable(); }
+
+struct MediaEncoder::Impl {};
+
+MediaEncoder::MediaEncoder(const EncoderSettings&) { unavailable(); }
+MediaEncoder::~MediaEncoder() = default;
+void MediaEncoder::encodeVideoFrame(const Frame&, int64_t) { unavailable(); }
+void MediaEncoder::encodeVideoFrame(const uint8_t*, int, int64_t) { unavailable(); }
+void MediaEncoder::encodeAudio(const float*, int) { unavailable(); }
+void MediaEncoder::appendVideoSegment(const std::string&, int64_t, const std::function<void(int64_t)>&) { unavailable(); }
+int MediaEncoder::audioFrameSize() const { unavailable(); }
+void MediaEncoder::finish() { unavailable(); }
+
+} // namespace rigid
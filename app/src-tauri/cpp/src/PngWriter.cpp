@@ -0,0 +1,166 @@
+#include "PngWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <zlib.h>
+
+#include "TilePool.h"
+
+namespace rigid {
+
+namespace {
+
+constexpr uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+/// PNG filter type for "difference from the pixel to the left"
+constexpr uint8_t kFilterSub = 1;
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size) {
+    putU32(out, static_cast<uint32_t>(size));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) out.insert(out.end(), data, data + size);
+    const uLong crc = crc32(0, out.data() + start, static_cast<uInt>(size + 4));
+    putU32(out, static_cast<uint32_t>(crc));
+}
+
+/// Filtered bytes per stripe. Big enough that the deflate history a stripe
+/// starts without is a small share of it, small enough that a Retina
+/// display splits into a few dozen stripes for the workers to share.
+constexpr size_t kStripeBytes = 256 * 1024;
+
+/// BGRA rows [y0, y1) to Sub-filtered RGB scanlines. Screen content is
+/// mostly flat runs, which Sub turns into zeros for deflate at the cost of
+/// one subtract per byte.
+void filterRows(const uint8_t* pixels, int stride, int width, int y0, int y1, uint8_t* out) {
+    for (int y = y0; y < y1; y++) {
+        const uint8_t* src = pixels + static_cast<size_t>(y) * stride;
+        uint8_t* dst = out;
+        *dst++ = kFilterSub;
+        uint8_t r = 0, g = 0, b = 0;
+        for (int x = 0; x < width; x++, src += 4, dst += 3) {
+            dst[0] = static_cast<uint8_t>(src[2] - r);
+            dst[1] = static_cast<uint8_t>(src[1] - g);
+            dst[2] = static_cast<uint8_t>(src[0] - b);
+            r = src[2];
+            g = src[1];
+            b = src[0];
+        }
+        out += static_cast<size_t>(width) * 3 + 1;
+    }
+}
+
+/// One stripe of the image data: raw deflate output and the Adler-32 of the
+/// filtered bytes it holds
+struct Stripe {
+    std::vector<uint8_t> deflated;
+    uLong adler = 0;
+    size_t length = 0;
+};
+
+/// Filter and deflate rows [y0, y1). The last stripe finishes the deflate
+/// stream; the others end in a sync flush so the next can follow directly.
+Stripe deflateStripe(const uint8_t* pixels, int stride, int width, int y0, int y1, int level, bool last) {
+    Stripe stripe;
+    std::vector<uint8_t> rows((static_cast<size_t>(width) * 3 + 1) * (y1 - y0));
+    filterRows(pixels, stride, width, y0, y1, rows.data());
+    stripe.length = rows.size();
+    stripe.adler = adler32(adler32(0, nullptr, 0), rows.data(), static_cast<uInt>(rows.size()));
+
+    z_stream stream{};
+    // Negative window bits: raw deflate, the zlib wrapper is written once
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("PNG compression failed");
+    }
+    // deflateBound covers a finished stream; a sync flush adds an empty
+    // stored block of at most 5 bytes (plus a partial byte)
+    stripe.deflated.resize(deflateBound(&stream, static_cast<uLong>(rows.size())) + 8);
+    stream.next_in = rows.data();
+    stream.avail_in = static_cast<uInt>(rows.size());
+    stream.next_out = stripe.deflated.data();
+    stream.avail_out = static_cast<uInt>(stripe.deflated.size());
+    const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    const bool complete = last ? result == Z_STREAM_END : result == Z_OK && stream.avail_in == 0;
+    stripe.deflated.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (!complete) throw std::runtime_error("PNG compression failed");
+    return stripe;
+}
+
+/// zlib stream header (RFC 1950) for a deflate stream at `level`
+void putZlibHeader(std::vector<uint8_t>& out, int level) {
+    const uint8_t cmf = 0x78; // deflate, 32 KiB window
+    const int flevel = level == Z_DEFAULT_COMPRESSION ? 2 : level <= 1 ? 0 : level <= 5 ? 1 : level == 6 ? 2 : 3;
+    uint8_t flg = static_cast<uint8_t>(flevel << 6);
+    flg = static_cast<uint8_t>(flg + 31 - (cmf * 256 + flg) % 31);
+    out.push_back(cmf);
+    out.push_back(flg);
+}
+
+} // namespace
+
+std::vector<uint8_t> encodePng(const uint8_t* pixels, int stride, int width, int height, int level,
+                               TilePool* pool) {
+    if (width <= 0 || height <= 0) throw std::runtime_error("Cannot encode an empty image");
+
+    const size_t rowBytes = static_cast<size_t>(width) * 3 + 1;
+    const int rowsPerStripe =
+        pool && pool->workerCount() > 1 ? static_cast<int>(std::max<size_t>(kStripeBytes / rowBytes, 1)) : height;
+    const size_t stripeCount = (static_cast<size_t>(height) + rowsPerStripe - 1) / rowsPerStripe;
+
+    std::vector<Stripe> stripes(stripeCount);
+    auto encodeStripe = [&](size_t index, int) {
+        const int y0 = static_cast<int>(index) * rowsPerStripe;
+        const int y1 = std::min(height, y0 + rowsPerStripe);
+        stripes[index] = deflateStripe(pixels, stride, width, y0, y1, level, index + 1 == stripeCount);
+    };
+    if (stripeCount > 1) {
+        pool->run(stripeCount, encodeStripe);
+    } else {
+        encodeStripe(0, 0);
+    }
+
+    std::vector<uint8_t> compressed;
+    size_t compressedSize = 6;
+    for (const Stripe& stripe : stripes) compressedSize += stripe.deflated.size();
+    compressed.reserve(compressedSize);
+    putZlibHeader(compressed, level);
+    uLong adler = stripes[0].adler;
+    for (size_t i = 0; i < stripes.size(); i++) {
+        compressed.insert(compressed.end(), stripes[i].deflated.begin(), stripes[i].deflated.end());
+        if (i > 0) adler = adler32_combine(adler, stripes[i].adler, static_cast<z_off_t>(stripes[i].length));
+    }
+    putU32(compressed, static_cast<uint32_t>(adler));
+
+    std::vector<uint8_t> png(kSignature, kSignature + sizeof(kSignature));
+    png.reserve(compressed.size() + 64);
+
+    std::vector<uint8_t> header;
+    putU32(header, static_cast<uint32_t>(width));
+    putU32(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, deflate, adaptive filters, no interlace
+    putChunk(png, "IHDR", header.data(), header.size());
+    putChunk(png, "IDAT", compressed.data(), compressed.size());
+    putChunk(png, "IEND", nullptr, 0);
+    return png;
+}
+
+void writePng(const std::string& path, const uint8_t* pixels, int stride, int width, int height, int level) {
+    const std::vector<uint8_t> png = encodePng(pixels, stride, width, height, level);
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::runtime_error("Cannot open " + path);
+    const bool written = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+    if (std::fclose(file) != 0 || !written) throw std::runtime_error("Cannot write " + path);
+}
+
+} // namespace rigid
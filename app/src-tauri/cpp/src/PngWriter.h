@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rigid {
+
+class TilePool;
+
+/// Encode opaque BGRA pixels (the capture layout) as an 8-bit RGB PNG. Alpha
+/// is dropped: captured frames are always opaque. `level` is the zlib level.
+///
+/// With a `pool`, large images are filtered and deflated in horizontal
+/// stripes across its workers. Each stripe is a separate deflate stream
+/// ending on a byte boundary (a sync flush), so the stripes concatenate into
+/// one valid zlib stream; every stripe after the first starts without the
+/// previous 32 KiB as history, which costs a fraction of a percent in size.
+std::vector<uint8_t> encodePng(const uint8_t* pixels, int stride, int width, int height, int level = 6,
+                               TilePool* pool = nullptr);
+
+/// encodePng into `path`. Throws std::runtime_error when it cannot be written.
+void writePng(const std::string& path, const uint8_t* pixels, int stride, int width, int height, int level = 6);
+
+} // namespace rigid
@@ -0,0 +1,107 @@
+#include "QoiWriter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace rigid {
+
+namespace {
+
+constexpr uint8_t kOpIndex = 0x00;
+constexpr uint8_t kOpDiff = 0x40;
+constexpr uint8_t kOpLuma = 0x80;
+constexpr uint8_t kOpRun = 0xc0;
+constexpr uint8_t kOpRgb = 0xfe;
+/// Longest run one QOI_OP_RUN holds (62, since 63 and 64 are the RGB(A) tags)
+constexpr int kMaxRun = 62;
+constexpr uint8_t kEndMarker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+struct Rgb {
+    uint8_t r = 0, g = 0, b = 0;
+    bool operator==(const Rgb& other) const { return r == other.r && g == other.g && b == other.b; }
+};
+
+/// Slot in the running index of seen colors; alpha is always 255
+int indexOf(const Rgb& c) {
+    return (c.r * 3 + c.g * 5 + c.b * 7 + 255 * 11) % 64;
+}
+
+void putU32(uint8_t*& out, uint32_t value) {
+    *out++ = static_cast<uint8_t>(value >> 24);
+    *out++ = static_cast<uint8_t>(value >> 16);
+    *out++ = static_cast<uint8_t>(value >> 8);
+    *out++ = static_cast<uint8_t>(value);
+}
+
+} // namespace
+
+std::vector<uint8_t> encodeQoi(const uint8_t* pixels, int stride, int width, int height) {
+    if (width <= 0 || height <= 0) throw std::runtime_error("Cannot encode an empty image");
+
+    // Worst case is QOI_OP_RGB (4 bytes) for every pixel
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> qoi(14 + pixelCount * 4 + sizeof(kEndMarker));
+    uint8_t* out = qoi.data();
+    std::memcpy(out, "qoif", 4);
+    out += 4;
+    putU32(out, static_cast<uint32_t>(width));
+    putU32(out, static_cast<uint32_t>(height));
+    *out++ = 3; // RGB
+    *out++ = 0; // sRGB with linear alpha
+
+    // Slots start out transparent black, which no opaque pixel matches
+    Rgb index[64];
+    bool filled[64] = {};
+    Rgb previous;
+    int run = 0;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = pixels + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < width; x++, src += 4) {
+            const Rgb pixel{src[2], src[1], src[0]};
+            if (pixel == previous) {
+                if (++run == kMaxRun) {
+                    *out++ = static_cast<uint8_t>(kOpRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                *out++ = static_cast<uint8_t>(kOpRun | (run - 1));
+                run = 0;
+            }
+
+            const int slot = indexOf(pixel);
+            if (filled[slot] && index[slot] == pixel) {
+                *out++ = static_cast<uint8_t>(kOpIndex | slot);
+            } else {
+                index[slot] = pixel;
+                filled[slot] = true;
+                const int dr = static_cast<int8_t>(pixel.r - previous.r);
+                const int dg = static_cast<int8_t>(pixel.g - previous.g);
+                const int db = static_cast<int8_t>(pixel.b - previous.b);
+                const int drDg = dr - dg;
+                const int dbDg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *out++ = static_cast<uint8_t>(kOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                } else if (dg >= -32 && dg <= 31 && drDg >= -8 && drDg <= 7 && dbDg >= -8 && dbDg <= 7) {
+                    *out++ = static_cast<uint8_t>(kOpLuma | (dg + 32));
+                    *out++ = static_cast<uint8_t>((drDg + 8) << 4 | (dbDg + 8));
+                } else {
+                    *out++ = kOpRgb;
+                    *out++ = pixel.r;
+                    *out++ = pixel.g;
+                    *out++ = pixel.b;
+                }
+            }
+            previous = pixel;
+        }
+    }
+    if (run > 0) *out++ = static_cast<uint8_t>(kOpRun | (run - 1));
+
+    std::memcpy(out, kEndMarker, sizeof(kEndMarker));
+    out += sizeof(kEndMarker);
+    qoi.resize(static_cast<size_t>(out - qoi.data()));
+    return qoi;
+}
+
+} // namespace rigid
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rigid {
+
+/// Encode opaque BGRA pixels as a 3-channel sRGB QOI image
+/// (https://qoiformat.org). QOI is lossless like PNG, a single pass with no
+/// entropy coding, so it encodes several times faster at the cost of larger
+/// files.
+std::vector<uint8_t> encodeQoi(const uint8_t* pixels, int stride, int width, int height);
+
+} // namespace rigid
@@ -0,0 +1,125 @@
+#include "RenderPipeline.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace rigid {
+
+StageThreads StageThreads::split(int budget) {
+    StageThreads threads;
+    // A quarter decodes; the encoder and the compositor share the rest
+    threads.decoderPerClip = std::clamp(budget / 4, 1, kMaxDecoderThreadsPerClip);
+    const int rest = std::max(budget - threads.decoderPerClip, 2);
+    threads.encoder = rest / 2;
+    threads.compositor = rest - threads.encoder;
+    return threads;
+}
+
+void runRenderPipeline(int64_t frameCount, size_t depth, const RenderPipelineStages& stages,
+                       const std::atomic<bool>& cancelled) {
+    if (depth == 0) depth = 1;
+
+    // One buffer being written, one being read, and `depth` waiting in between
+    const size_t poolSize = depth + 2;
+    std::vector<DecodedFrameSet> decodedPool(poolSize);
+    // Frame buffers go back to the shared pool however the render ends
+    struct OutputFrames {
+        std::vector<Frame> frames;
+        ~OutputFrames() {
+            for (Frame& frame : frames) FramePool::shared().release(frame);
+        }
+    } outputs{std::vector<Frame>(poolSize)};
+
+    struct Decoded {
+        int64_t frameIndex;
+        DecodedFrameSet* set;
+    };
+    struct Composited {
+        int64_t frameIndex;
+        Frame* frame;
+    };
+
+    // Ready queues carry work downstream; free queues hand buffers back up
+    BoundedQueue<Decoded> decodedQueue(depth);
+    BoundedQueue<Composited> compositedQueue(depth);
+    BoundedQueue<DecodedFrameSet*> freeSets(poolSize);
+    BoundedQueue<Frame*> freeFrames(poolSize);
+    for (DecodedFrameSet& set : decodedPool) freeSets.push(&set);
+    for (Frame& frame : outputs.frames) freeFrames.push(&frame);
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto closeAll = [&] {
+        decodedQueue.close();
+        compositedQueue.close();
+        freeSets.close();
+        freeFrames.close();
+    };
+    // Keep the first failure and stop every stage
+    auto fail = [&](std::exception_ptr exception) {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = exception;
+        }
+        closeAll();
+    };
+
+    std::thread decodeThread([&] {
+        try {
+            for (int64_t i = 0; i < frameCount && !cancelled; i++) {
+                std::optional<DecodedFrameSet*> set = freeSets.pop();
+                if (!set) break;
+                (*set)->clear();
+                stages.decode(i, **set);
+                if (!decodedQueue.push({i, *set})) break;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        decodedQueue.close();
+    });
+
+    std::thread compositeThread;
+    try {
+        compositeThread = std::thread([&] {
+            try {
+                while (std::optional<Decoded> decoded = decodedQueue.pop()) {
+                    if (cancelled) break;
+                    std::optional<Frame*> frame = freeFrames.pop();
+                    if (!frame) break;
+                    stages.composite(decoded->frameIndex, *decoded->set, **frame);
+                    freeSets.push(decoded->set);
+                    if (!compositedQueue.push({decoded->frameIndex, *frame})) break;
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            compositedQueue.close();
+        });
+    } catch (...) {
+        closeAll();
+        decodeThread.join();
+        throw;
+    }
+
+    try {
+        while (std::optional<Composited> composited = compositedQueue.pop()) {
+            if (cancelled) break;
+            stages.encode(composited->frameIndex, *composited->frame);
+            freeFrames.push(composited->frame);
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    // Either every frame went through or something stopped early; both end here
+    closeAll();
+    decodeThread.join();
+    compositeThread.join();
+
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace rigid
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "Frame.h"
+#include "FramePool.h"
+
+namespace rigid {
+
+/// Fixed-capacity FIFO between two pipeline stages.
+///
+/// push blocks while the queue is full and pop while it is empty, which is
+/// what keeps a fast stage from running ahead of a slow one. close() wakes
+/// everyone: pushes then fail and pops drain what is left.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : slots_(capacity > 0 ? capacity : 1) {}
+
+    /// False if the queue was closed (the item is dropped)
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || count_ < slots_.size(); });
+        if (closed_) return false;
+        slots_[(head_ + count_) % slots_.size()] = std::move(item);
+        count_++;
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    /// Next item, or nullopt once the queue is closed and drained
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || count_ > 0; });
+        if (count_ == 0) return std::nullopt;
+        T item = std::move(slots_[head_]);
+        head_ = (head_ + 1) % slots_.size();
+        count_--;
+        notFull_.notify_one();
+        return item;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    /// Ring of `count_` items from `head_`, allocated once so a steady
+    /// pipeline never touches the allocator
+    std::vector<T> slots_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool closed_ = false;
+};
+
+/// Source frames one output frame needs, handed from the decode stage to
+/// the compositor.
+///
+/// Still images are borrowed (they live for the whole render); video frames
+/// are copied because the decoder overwrites its frame as it moves on. The
+/// copies are reused from one output frame to the next, and their buffers
+/// come from and return to the shared FramePool.
+class DecodedFrameSet {
+public:
+    DecodedFrameSet() = default;
+    ~DecodedFrameSet() {
+        for (Frame& frame : copies_) FramePool::shared().release(frame);
+    }
+
+    DecodedFrameSet(const DecodedFrameSet&) = delete;
+    DecodedFrameSet& operator=(const DecodedFrameSet&) = delete;
+
+    void clear() {
+        entries_.clear();
+        copiesUsed_ = 0;
+    }
+
+    void borrow(size_t clipIndex, const Frame* frame) {
+        entries_.push_back({clipIndex, frame, 0});
+    }
+
+    void copy(size_t clipIndex, const Frame& frame) {
+        if (copiesUsed_ == copies_.size()) copies_.emplace_back();
+        Frame& target = copies_[copiesUsed_];
+        FramePool::shared().acquire(target, frame.width, frame.height);
+        for (int y = 0; y < frame.height; y++) {
+            std::memcpy(target.row(y), frame.row(y), static_cast<size_t>(frame.width) * 4);
+        }
+        target.opaque = frame.opaque;
+        entries_.push_back({clipIndex, nullptr, copiesUsed_});
+        copiesUsed_++;
+    }
+
+    /// Frame for a clip, or nullptr if the decode stage had none
+    const Frame* frameFor(size_t clipIndex) const {
+        for (const Entry& entry : entries_) {
+            if (entry.clipIndex == clipIndex) return entry.borrowed ? entry.borrowed : &copies_[entry.copyIndex];
+        }
+        return nullptr;
+    }
+
+private:
+    struct Entry {
+        size_t clipIndex;
+        const Frame* borrowed;
+        size_t copyIndex;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<Frame> copies_;
+    size_t copiesUsed_ = 0;
+};
+
+/// The three stages of an export. Each runs on its own thread and sees frame
+/// indices in order; buffers are recycled, so a stage must fully rewrite its
+/// output.
+struct RenderPipelineStages {
+    std::function<void(int64_t frameIndex, DecodedFrameSet& decoded)> decode;
+    std::function<void(int64_t frameIndex, const DecodedFrameSet& decoded, Frame& output)> composite;
+    std::function<void(int64_t frameIndex, const Frame& output)> encode;
+};
+
+/// Decoder threads per video clip at most. Frame threading buffers a frame
+/// per thread, and a timeline cut from one recording can have many clips.
+constexpr int kMaxDecoderThreadsPerClip = 2;
+
+/// Threads for each stage of one pipeline, split from its render's budget.
+///
+/// The stages run at once, so it is the split, not each stage, that adds up
+/// to the budget. With one thread libav decodes and encodes on its stage's
+/// own thread, and the compositor's count includes the thread it runs on.
+/// Each clip on screen has its own decoder, so overlapping video clips add
+/// their decoder threads beyond the first clip's.
+struct StageThreads {
+    int decoderPerClip = 1;
+    int compositor = 1;
+    int encoder = 1;
+
+    /// A budget of 3 or more is met exactly; below that each stage still
+    /// gets one thread
+    static StageThreads split(int budget);
+};
+
+/// Run `frameCount` frames through decode → composite → encode, with at most
+/// `depth` frames waiting between two stages. Encode runs on the calling
+/// thread. The first exception from any stage is rethrown here after every
+/// stage has stopped; `cancelled` stops all stages between frames.
+void runRenderPipeline(int64_t frameCount, size_t depth, const RenderPipelineStages& stages,
+                       const std::atomic<bool>& cancelled);
+
+} // namespace rigid
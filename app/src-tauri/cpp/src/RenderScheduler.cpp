@@ -0,0 +1,215 @@
+#include "RenderScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Json.h"
+#include "MediaDecoder.h"
+#include "RigidCaptureKit.h"
+
+namespace rigid {
+
+namespace {
+
+const char* kCancelledMessage = "Render cancelled";
+
+} // namespace
+
+RenderScheduler::RenderScheduler(int maxConcurrentJobs, int coreBudget, JobRunner runner)
+    : maxConcurrentJobs_(static_cast<size_t>(std::max(maxConcurrentJobs, 1))),
+      coreBudget_(coreBudget > 0 ? coreBudget : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u))),
+      runner_(std::move(runner)) {
+    if (!runner_) {
+        runner_ = [](const RenderJob& job, VideoCompositorEngine& engine) {
+            return engine.render(job.config, job.progress);
+        };
+    }
+
+    workers_.reserve(maxConcurrentJobs_);
+    for (size_t i = 0; i < maxConcurrentJobs_; i++) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+RenderScheduler::~RenderScheduler() {
+    std::vector<QueuedJob> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        abandoned.swap(queue_);
+        for (auto& running : running_) running.engine->cancel();
+    }
+    wake_.notify_all();
+
+    for (auto& queued : abandoned) {
+        if (queued.job.completion) queued.job.completion(RIGID_ERROR_RECORDING_FAILED, kCancelledMessage);
+    }
+    for (auto& worker : workers_) worker.join();
+}
+
+int RenderScheduler::threadBudgetFor(int coreBudget, size_t concurrentJobs) {
+    if (concurrentJobs == 0) return std::max(coreBudget, 1);
+    return std::max(coreBudget / static_cast<int>(concurrentJobs), 1);
+}
+
+void RenderScheduler::submit(RenderJob job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({std::move(job), nextSequence_++});
+    }
+    wake_.notify_one();
+}
+
+bool RenderScheduler::cancel(const std::string& exportId) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (auto& running : running_) {
+        if (running.exportId == exportId) {
+            running.engine->cancel();
+            return true;
+        }
+    }
+
+    auto queued = std::find_if(queue_.begin(), queue_.end(),
+                               [&](const QueuedJob& q) { return q.job.exportId == exportId; });
+    if (queued == queue_.end()) return false;
+
+    RenderJob job = std::move(queued->job);
+    queue_.erase(queued);
+    lock.unlock();
+
+    if (job.completion) job.completion(RIGID_ERROR_RECORDING_FAILED, kCancelledMessage);
+    return true;
+}
+
+size_t RenderScheduler::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+size_t RenderScheduler::runningCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_.size();
+}
+
+size_t RenderScheduler::nextJobIndex() const {
+    size_t best = 0;
+    for (size_t i = 1; i < queue_.size(); i++) {
+        const QueuedJob& candidate = queue_[i];
+        const QueuedJob& current = queue_[best];
+        if (candidate.job.priority > current.job.priority ||
+            (candidate.job.priority == current.job.priority && candidate.sequence < current.sequence)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void RenderScheduler::workerLoop() {
+    while (true) {
+        RenderJob job;
+        auto engine = std::make_shared<VideoCompositorEngine>();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+
+            size_t index = nextJobIndex();
+            job = std::move(queue_[index].job);
+            queue_.erase(queue_.begin() + static_cast<std::ptrdiff_t>(index));
+
+            // A fixed share, so the renders running at once never exceed the budget
+            engine->setThreadBudget(jobThreadBudget());
+            running_.push_back({job.exportId, engine});
+        }
+
+        std::fprintf(stderr, "VideoCompositor: Starting queued export %s\n", job.exportId.c_str());
+
+        // Signal the start so listeners can tell queued jobs from running ones
+        if (job.progress) job.progress(0, 0, job.config.totalFrames());
+
+        int32_t errorCode = RIGID_SUCCESS;
+        std::string result;
+        try {
+            result = runner_(job, *engine);
+        } catch (const RenderCancelled&) {
+            errorCode = RIGID_ERROR_RECORDING_FAILED;
+            result = kCancelledMessage;
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "VideoCompositor: Render failed: %s\n", e.what());
+            errorCode = RIGID_ERROR_RECORDING_FAILED;
+            result = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.erase(std::remove_if(running_.begin(), running_.end(),
+                                          [&](const RunningJob& r) { return r.engine == engine; }),
+                           running_.end());
+        }
+
+        if (job.completion) job.completion(errorCode, result);
+    }
+}
+
+} // namespace rigid
+
+// MARK: - C API
+
+extern "C" RigidRenderQueueHandle rigid_render_queue_create(int32_t max_concurrent_jobs, int32_t core_budget) {
+    return new rigid::RenderScheduler(max_concurrent_jobs, core_budget);
+}
+
+extern "C" void rigid_render_queue_destroy(RigidRenderQueueHandle queue) {
+    delete static_cast<rigid::RenderScheduler*>(queue);
+}
+
+extern "C" int32_t rigid_render_queue_submit(
+    RigidRenderQueueHandle queue,
+    const char* export_id,
+    const char* config_json,
+    int32_t priority,
+    RigidCompositorProgressCallback progress_callback,
+    RigidCompositorCompletionCallback completion_callback
+) {
+    if (!queue || !export_id || !config_json) return RIGID_ERROR_INVALID_CONFIG;
+
+    rigid::RenderJob job;
+    try {
+        job.config = rigid::CompositorConfig::fromJson(config_json);
+    } catch (const rigid::JsonError& e) {
+        std::fprintf(stderr, "VideoCompositor: Failed to parse config JSON: %s\n", e.what());
+        return RIGID_ERROR_INVALID_CONFIG;
+    }
+
+    // Without libav there is nothing to render with; the caller falls back to ffmpeg
+    if (!rigid::mediaBackendAvailable()) return RIGID_ERROR_ENCODING_FAILED;
+
+    std::string exportId = export_id;
+    job.exportId = exportId;
+    job.priority = priority;
+    job.progress = [exportId, progress_callback](float percent, int64_t current, int64_t total) {
+        if (progress_callback) progress_callback(exportId.c_str(), percent, current, total);
+    };
+    job.completion = [exportId, completion_callback](int32_t errorCode, const std::string& outputOrError) {
+        if (completion_callback) completion_callback(exportId.c_str(), errorCode, outputOrError.c_str());
+    };
+
+    static_cast<rigid::RenderScheduler*>(queue)->submit(std::move(job));
+    return RIGID_SUCCESS;
+}
+
+extern "C" bool rigid_render_queue_cancel(RigidRenderQueueHandle queue, const char* export_id) {
+    if (!queue || !export_id) return false;
+    return static_cast<rigid::RenderScheduler*>(queue)->cancel(export_id);
+}
+
+extern "C" int32_t rigid_render_queue_depth(RigidRenderQueueHandle queue) {
+    if (!queue) return 0;
+    return static_cast<int32_t>(static_cast<rigid::RenderScheduler*>(queue)->queueDepth());
+}
+
+extern "C" int32_t rigid_render_queue_running(RigidRenderQueueHandle queue) {
+    if (!queue) return 0;
+    return static_cast<int32_t>(static_cast<rigid::RenderScheduler*>(queue)->runningCount());
+}
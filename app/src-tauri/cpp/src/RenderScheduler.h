@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CompositorConfig.h"
+#include "VideoCompositor.h"
+
+namespace rigid {
+
+/// One export waiting in (or running from) a RenderScheduler
+struct RenderJob {
+    std::string exportId;
+    CompositorConfig config;
+    /// Higher runs first; equal priorities run in submission order
+    int priority = 0;
+    CompositorProgressCallback progress;
+    /// Called exactly once: 0 and the output path, or an error code and message
+    std::function<void(int32_t errorCode, const std::string& outputOrError)> completion;
+};
+
+/// Runs many exports on a bounded pool of workers.
+///
+/// At most `maxConcurrentJobs` renders run at once. Each render reserves an
+/// equal share of `coreBudget` (coreBudget / maxConcurrentJobs), so two
+/// concurrent exports each get half the cores and the running renders never
+/// add up to more than the budget. The share covers all of a render's
+/// threads (see StageThreads); a render started alone still gets only its
+/// share, leaving room for the next one.
+class RenderScheduler {
+public:
+    /// Executes one job. The default renders `job.config` with the engine;
+    /// tests substitute their own.
+    using JobRunner = std::function<std::string(const RenderJob& job, VideoCompositorEngine& engine)>;
+
+    /// `coreBudget` of 0 uses every hardware thread
+    RenderScheduler(int maxConcurrentJobs, int coreBudget, JobRunner runner = {});
+
+    /// Cancels queued and running jobs and waits for the workers to exit
+    ~RenderScheduler();
+
+    RenderScheduler(const RenderScheduler&) = delete;
+    RenderScheduler& operator=(const RenderScheduler&) = delete;
+
+    void submit(RenderJob job);
+
+    /// Cancel a queued or running job. Returns false if the id is unknown.
+    bool cancel(const std::string& exportId);
+
+    /// Jobs waiting for a worker
+    size_t queueDepth() const;
+    /// Jobs currently rendering
+    size_t runningCount() const;
+
+    int coreBudget() const { return coreBudget_; }
+    /// Threads each render gets: its share of the core budget
+    int jobThreadBudget() const { return threadBudgetFor(coreBudget_, maxConcurrentJobs_); }
+
+    /// Threads each of `concurrentJobs` renders gets from `coreBudget` (at least 1)
+    static int threadBudgetFor(int coreBudget, size_t concurrentJobs);
+
+private:
+    struct QueuedJob {
+        RenderJob job;
+        uint64_t sequence;
+    };
+
+    struct RunningJob {
+        std::string exportId;
+        std::shared_ptr<VideoCompositorEngine> engine;
+    };
+
+    const size_t maxConcurrentJobs_;
+    const int coreBudget_;
+    JobRunner runner_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<QueuedJob> queue_;
+    std::vector<RunningJob> running_;
+    uint64_t nextSequence_ = 0;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+
+    void workerLoop();
+    /// Index of the next job to run; requires a non-empty queue and the lock
+    size_t nextJobIndex() const;
+};
+
+} // namespace rigid
@@ -0,0 +1,213 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#define RIGID_RESAMPLE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define RIGID_RESAMPLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rigid {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double supportOf(ResampleFilter filter) {
+    switch (filter) {
+    case ResampleFilter::Bilinear: return 1;
+    case ResampleFilter::Bicubic: return 2;
+    case ResampleFilter::Lanczos: return 3;
+    }
+    return 1;
+}
+
+/// Kernel width multiplier: bilinear keeps point taps, the others widen to
+/// the source step when minifying
+double widthScale(ResampleFilter filter, double step) {
+    return filter == ResampleFilter::Bilinear ? 1.0 : std::max(1.0, step);
+}
+
+double sinc(double x) {
+    if (x == 0) return 1;
+    return std::sin(kPi * x) / (kPi * x);
+}
+
+double kernelAt(ResampleFilter filter, double x) {
+    x = std::fabs(x);
+    switch (filter) {
+    case ResampleFilter::Bilinear:
+        return x < 1 ? 1 - x : 0;
+    case ResampleFilter::Bicubic:
+        // Catmull-Rom (a = -0.5)
+        if (x < 1) return 1.5 * x * x * x - 2.5 * x * x + 1;
+        if (x < 2) return -0.5 * x * x * x + 2.5 * x * x - 4 * x + 2;
+        return 0;
+    case ResampleFilter::Lanczos:
+        return x < 3 ? sinc(x) * sinc(x / 3) : 0;
+    }
+    return 0;
+}
+
+/// Normalized weights for a sample at `center`; returns the first source index
+int computeTaps(ResampleFilter filter, double center, double step, int taps, float* weights) {
+    double scale = widthScale(filter, step);
+    double radius = supportOf(filter) * scale;
+    int first = static_cast<int>(std::floor(center - radius)) + 1;
+
+    double sum = 0;
+    for (int t = 0; t < taps; t++) {
+        double w = kernelAt(filter, (first + t - center) / scale);
+        weights[t] = static_cast<float>(w);
+        sum += w;
+    }
+    if (sum != 0 && filter != ResampleFilter::Bilinear) {
+        for (int t = 0; t < taps; t++) weights[t] = static_cast<float>(weights[t] / sum);
+    }
+    return first;
+}
+
+// MARK: - Pixel accumulators
+//
+// One float lane per BGRA channel. Bicubic and Lanczos lobes can overshoot,
+// so results clamp to a valid premultiplied pixel (color <= alpha <= 255).
+
+#if RIGID_RESAMPLE_SSE2
+
+using Pixel4 = __m128;
+
+inline Pixel4 zeroPixel() { return _mm_setzero_ps(); }
+inline Pixel4 addWeighted(Pixel4 acc, const float* p, float w) {
+    return _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(w)));
+}
+
+inline void storePixel(uint8_t* dst, Pixel4 v) {
+    __m128 alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_min_ps(_mm_max_ps(alpha, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), alpha);
+    __m128i q = _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+    q = _mm_packs_epi32(q, q);
+    q = _mm_packus_epi16(q, q);
+    int32_t bytes = _mm_cvtsi128_si32(q);
+    std::memcpy(dst, &bytes, 4);
+}
+
+#elif RIGID_RESAMPLE_NEON
+
+using Pixel4 = float32x4_t;
+
+inline Pixel4 zeroPixel() { return vdupq_n_f32(0); }
+inline Pixel4 addWeighted(Pixel4 acc, const float* p, float w) { return vmlaq_n_f32(acc, vld1q_f32(p), w); }
+
+inline void storePixel(uint8_t* dst, Pixel4 v) {
+    float32x4_t alpha = vdupq_laneq_f32(v, 3);
+    alpha = vminq_f32(vmaxq_f32(alpha, vdupq_n_f32(0)), vdupq_n_f32(255.0f));
+    v = vminq_f32(vmaxq_f32(v, vdupq_n_f32(0)), alpha);
+    uint32x4_t q = vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f)));
+    uint16x4_t narrow = vmovn_u32(q);
+    uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+    uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    std::memcpy(dst, &packed, 4);
+}
+
+#else
+
+struct Pixel4 {
+    float c[4];
+};
+
+inline Pixel4 zeroPixel() { return Pixel4{{0, 0, 0, 0}}; }
+inline Pixel4 addWeighted(Pixel4 acc, const float* p, float w) {
+    for (int i = 0; i < 4; i++) acc.c[i] += p[i] * w;
+    return acc;
+}
+
+inline void storePixel(uint8_t* dst, Pixel4 v) {
+    float alpha = std::min(std::max(v.c[3], 0.0f), 255.0f);
+    for (int i = 0; i < 4; i++) {
+        float c = std::min(std::max(v.c[i], 0.0f), alpha);
+        dst[i] = static_cast<uint8_t>(c + 0.5f);
+    }
+}
+
+#endif
+
+} // namespace
+
+ResampleFilter resampleFilterFor(CompositorQuality quality) {
+    switch (quality) {
+    case CompositorQuality::Draft:
+    case CompositorQuality::Good: return ResampleFilter::Bilinear;
+    case CompositorQuality::High: return ResampleFilter::Bicubic;
+    case CompositorQuality::Max: return ResampleFilter::Lanczos;
+    }
+    return ResampleFilter::Bilinear;
+}
+
+int resampleReach(ResampleFilter filter, double step) {
+    return static_cast<int>(std::ceil(supportOf(filter) * widthScale(filter, step)));
+}
+
+void Resampler::setColumns(ResampleFilter filter, double originX, double stepX, int columns, double stepY) {
+    stepY_ = stepY;
+    if (filter == filter_ && originX == originX_ && stepX == stepX_ && columns == columns_) return;
+    filter_ = filter;
+    originX_ = originX;
+    stepX_ = stepX;
+    columns_ = columns;
+
+    tapsPerColumn_ = 2 * resampleReach(filter, stepX);
+    columnFirst_.resize(static_cast<size_t>(columns));
+    columnWeights_.resize(static_cast<size_t>(columns) * tapsPerColumn_);
+    for (int i = 0; i < columns; i++) {
+        columnFirst_[i] = computeTaps(filter, originX + i * stepX, stepX, tapsPerColumn_,
+                                      columnWeights_.data() + static_cast<size_t>(i) * tapsPerColumn_);
+    }
+
+    spanFirst_ = columns > 0 ? *std::min_element(columnFirst_.begin(), columnFirst_.end()) : 0;
+    int spanLast = columns > 0 ? *std::max_element(columnFirst_.begin(), columnFirst_.end()) + tapsPerColumn_ : 0;
+    spanCount_ = spanLast - spanFirst_;
+    filtered_.resize(static_cast<size_t>(spanCount_) * 4);
+}
+
+void Resampler::resampleRow(const uint8_t* base, int stride, int width, int height, double sy, uint8_t* dst) {
+    // Vertical pass over the source columns this row reads
+    const int rowTaps = 2 * resampleReach(filter_, stepY_);
+    rowWeights_.resize(static_cast<size_t>(rowTaps));
+    const int firstRow = computeTaps(filter_, sy, stepY_, rowTaps, rowWeights_.data());
+
+    // Columns outside the source stay zero (transparent)
+    std::fill(filtered_.begin(), filtered_.end(), 0.0f);
+    const int x0 = std::max(spanFirst_, 0);
+    const int x1 = std::min(spanFirst_ + spanCount_, width);
+    if (x1 > x0) {
+        float* out = filtered_.data() + static_cast<size_t>(x0 - spanFirst_) * 4;
+        const size_t values = static_cast<size_t>(x1 - x0) * 4;
+        for (int t = 0; t < rowTaps; t++) {
+            int y = firstRow + t;
+            float w = rowWeights_[t];
+            if (y < 0 || y >= height || w == 0) continue;
+            // Contiguous multiply-add; the compiler vectorizes this loop
+            const uint8_t* src = base + static_cast<size_t>(y) * stride + static_cast<size_t>(x0) * 4;
+            for (size_t i = 0; i < values; i++) out[i] += src[i] * w;
+        }
+    }
+
+    // Horizontal pass with the cached column weights
+    const float* weights = columnWeights_.data();
+    for (int i = 0; i < columns_; i++, weights += tapsPerColumn_, dst += 4) {
+        const float* p = filtered_.data() + static_cast<size_t>(columnFirst_[i] - spanFirst_) * 4;
+        Pixel4 acc = zeroPixel();
+        for (int t = 0; t < tapsPerColumn_; t++, p += 4) {
+            acc = addWeighted(acc, p, weights[t]);
+        }
+        storePixel(dst, acc);
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CompositorConfig.h"
+
+namespace rigid {
+
+/// Reconstruction filter for clip scaling, zoom and pan
+enum class ResampleFilter { Bilinear, Bicubic, Lanczos };
+
+/// Draft and Good keep the bilinear look of earlier exports; High uses
+/// Catmull-Rom bicubic and Max uses Lanczos-3.
+ResampleFilter resampleFilterFor(CompositorQuality quality);
+
+/// Source pixels a sample may read on either side of its position when the
+/// source advances `step` pixels per output pixel. Bicubic and Lanczos
+/// widen with the step when minifying, so downscales do not alias.
+int resampleReach(ResampleFilter filter, double step);
+
+/// Separable resampler for one clip placement: a single pass from source
+/// pixels to output rows, whatever mix of crop, pan, zoom and scale produced
+/// the mapping.
+///
+/// Output column i samples source x = originX + i * stepX (pixel centers at
+/// integers). Column weights are computed once per mapping and kept while it
+/// is unchanged; row weights depend only on the row. Texels outside the
+/// source are transparent, as with the bilinear sampler this replaces.
+class Resampler {
+public:
+    /// Set the filter and horizontal mapping for the rows that follow
+    void setColumns(ResampleFilter filter, double originX, double stepX, int columns, double stepY);
+
+    /// Resample the output row whose samples sit at source y = `sy` into
+    /// `dst` (premultiplied BGRA, one pixel per column)
+    void resampleRow(const uint8_t* base, int stride, int width, int height, double sy, uint8_t* dst);
+
+private:
+    ResampleFilter filter_ = ResampleFilter::Bilinear;
+    double originX_ = 0;
+    double stepX_ = 0;
+    double stepY_ = 0;
+    int columns_ = -1;
+
+    /// First source column and `tapsPerColumn_` weights for every output column
+    std::vector<int> columnFirst_;
+    std::vector<float> columnWeights_;
+    int tapsPerColumn_ = 0;
+    /// Source columns [spanFirst_, spanFirst_ + spanCount_) read by any column
+    int spanFirst_ = 0;
+    int spanCount_ = 0;
+
+    std::vector<float> rowWeights_;
+    /// One vertically filtered source row over the column span, 4 floats per pixel
+    std::vector<float> filtered_;
+};
+
+} // namespace rigid
@@ -0,0 +1,206 @@
+#include "ScreenRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "MediaDecoder.h"
+
+namespace rigid {
+
+namespace {
+
+int64_t microseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+class EncoderSink : public FrameSink {
+public:
+    explicit EncoderSink(const EncoderSettings& settings) : encoder_(settings) {}
+
+    void write(const SharedFrame& frame, int64_t frameIndex) override {
+        encoder_.encodeVideoFrame(frame.pixels(), frame.stride(), frameIndex);
+    }
+
+    void finish() override { encoder_.finish(); }
+
+private:
+    MediaEncoder encoder_;
+};
+
+} // namespace
+
+std::unique_ptr<FrameSink> makeEncoderSink(const EncoderSettings& settings) {
+    return std::make_unique<EncoderSink>(settings);
+}
+
+ScreenRecorder::ScreenRecorder(std::unique_ptr<CaptureSource> source, std::unique_ptr<FrameSink> sink,
+                               FrameRing& frames, CaptureStats& stats, const RecordingSettings& settings)
+    : source_(std::move(source)), sink_(std::move(sink)), frames_(frames), stats_(stats), settings_(settings) {}
+
+ScreenRecorder::~ScreenRecorder() {
+    joinThreads(true);
+}
+
+void ScreenRecorder::start() {
+    // Every queued frame holds a slot, the encoder holds one more and the
+    // capture writes into another
+    const size_t pending = settings_.backpressure.pendingCapacity();
+    frames_.configure(source_->width(), source_->height(),
+                      std::max<size_t>(settings_.backpressure.queueDepth, pending + 2));
+    queue_.assign(pending, nullptr);
+    stats_.reset(settings_.fps);
+
+    subscriptionId_ = frames_.subscribe(onFrame, this);
+    startTime_ = Clock::now();
+    running_ = true;
+    encoderThread_ = std::thread(&ScreenRecorder::encodeLoop, this);
+    captureThread_ = std::thread(&ScreenRecorder::captureLoop, this);
+}
+
+void ScreenRecorder::stop() {
+    joinThreads(false);
+    std::string error = error_;
+    if (error.empty()) {
+        try {
+            sink_->finish();
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }
+    if (!error.empty()) throw MediaError(error);
+}
+
+void ScreenRecorder::cancel() {
+    joinThreads(true);
+}
+
+int64_t ScreenRecorder::durationMs() const {
+    const int64_t stopped = stoppedAfterMs_;
+    if (stopped >= 0) return stopped;
+    if (startTime_ == Clock::time_point()) return 0;
+    return microseconds(Clock::now() - startTime_) / 1000;
+}
+
+void ScreenRecorder::joinThreads(bool discardQueued) {
+    running_ = false;
+    if (captureThread_.joinable()) captureThread_.join();
+    if (subscriptionId_) {
+        frames_.unsubscribe(subscriptionId_);
+        subscriptionId_ = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        closed_ = true;
+        if (discardQueued) {
+            for (; count_ > 0; count_--, head_ = (head_ + 1) % queue_.size()) queue_[head_]->release();
+        }
+    }
+    queueReady_.notify_one();
+    if (encoderThread_.joinable()) {
+        encoderThread_.join();
+        stoppedAfterMs_ = microseconds(Clock::now() - startTime_) / 1000;
+    }
+}
+
+// MARK: - Capture thread
+
+void ScreenRecorder::captureLoop() {
+    const bool adaptive = settings_.backpressure.policy == BackpressurePolicy::AdaptiveFps;
+    FrameRateGovernor governor(settings_.fps);
+    Clock::time_point next = startTime_;
+
+    while (running_) {
+        const Clock::time_point began = Clock::now();
+        bool dropped = false;
+
+        SharedFrame* frame = frames_.acquire();
+        if (!frame) {
+            // Subscribers and the encoder hold every slot
+            stats_.frameDropped();
+            dropped = true;
+        } else if (!source_->capture(frames_.pixels(frame), frame->stride())) {
+            frame->release();
+            std::fprintf(stderr, "ScreenRecorder: capture source went away, ending recording\n");
+            running_ = false;
+            break;
+        } else {
+            publishDropped_ = false;
+            frames_.publish(frame, microseconds(began - startTime_));
+            dropped = publishDropped_;
+        }
+        stats_.frameCaptured(microseconds(Clock::now() - began));
+
+        if (adaptive && governor.frameCaptured(dropped)) {
+            stats_.setCurrentFps(governor.currentFps());
+        }
+
+        // Fixed cadence from the start; after a stall, carry on from now
+        // rather than bursting to catch up
+        next += std::chrono::microseconds(1000000 / governor.currentFps());
+        const Clock::time_point now = Clock::now();
+        if (next < now) next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void ScreenRecorder::onFrame(void* context, RigidFrameRef frame) {
+    static_cast<ScreenRecorder*>(context)->enqueue(static_cast<SharedFrame*>(frame));
+}
+
+void ScreenRecorder::enqueue(SharedFrame* frame) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (closed_) return;
+    if (count_ == queue_.size()) {
+        publishDropped_ = true;
+        stats_.frameDropped();
+        if (settings_.backpressure.policy != BackpressurePolicy::DropOldest) return;
+        queue_[head_]->release();
+        head_ = (head_ + 1) % queue_.size();
+        count_--;
+    }
+    frame->retain();
+    queue_[(head_ + count_) % queue_.size()] = frame;
+    count_++;
+    queueReady_.notify_one();
+}
+
+// MARK: - Encoder thread
+
+void ScreenRecorder::encodeLoop() {
+    int64_t lastIndex = -1;
+    bool failed = false;
+
+    while (true) {
+        SharedFrame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this] { return count_ > 0 || closed_; });
+            if (count_ == 0) break;
+            frame = queue_[head_];
+            head_ = (head_ + 1) % queue_.size();
+            count_--;
+        }
+
+        if (!failed) {
+            try {
+                int64_t index = std::llround(frame->timestampUs() * settings_.fps / 1e6);
+                index = std::max(index, lastIndex + 1);
+                sink_->write(*frame, index);
+                lastIndex = index;
+                stats_.frameEncoded(microseconds(Clock::now() - startTime_) - frame->timestampUs());
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "ScreenRecorder: encoding failed: %s\n", e.what());
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex_);
+                    error_ = e.what();
+                }
+                failed = true;
+                running_ = false;
+            }
+        }
+        frame->release();
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Backpressure.h"
+#include "CaptureSource.h"
+#include "FrameRing.h"
+#include "MediaEncoder.h"
+
+namespace rigid {
+
+/// Where a ScreenRecorder's frames go
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    /// Write a captured frame as output frame `frameIndex`, counted at the
+    /// recording rate from the start (gaps are frames that were dropped or
+    /// not captured). Throws MediaError.
+    virtual void write(const SharedFrame& frame, int64_t frameIndex) = 0;
+
+    /// Flush and close the output. Throws MediaError.
+    virtual void finish() = 0;
+};
+
+/// FrameSink encoding into `settings.outputPath` with MediaEncoder, which
+/// reads the ring's pixels directly. Opens the file; throws MediaError.
+std::unique_ptr<FrameSink> makeEncoderSink(const EncoderSettings& settings);
+
+/// Per-recording settings of a ScreenRecorder
+struct RecordingSettings {
+    int fps = 60;
+    BackpressureSettings backpressure;
+};
+
+/// Records a CaptureSource on two threads, the Linux counterpart of the
+/// Swift ScreenRecorder.
+///
+/// The capture thread paces itself at the recording rate, fills a FrameRing
+/// slot from the source and publishes it, so live subscribers see every
+/// frame the encoder does. The recorder's own subscription queues frames for
+/// the encoder thread by reference, no more than the backpressure settings'
+/// pendingCapacity(); a full queue drops per the policy, and AdaptiveFps
+/// slows the capture while drops go on. Frames are timed by when they were
+/// captured, so a drop leaves a gap instead of speeding the video up.
+class ScreenRecorder {
+public:
+    ScreenRecorder(std::unique_ptr<CaptureSource> source, std::unique_ptr<FrameSink> sink, FrameRing& frames,
+                   CaptureStats& stats, const RecordingSettings& settings);
+    /// Cancels a recording that was not stopped
+    ~ScreenRecorder();
+
+    ScreenRecorder(const ScreenRecorder&) = delete;
+    ScreenRecorder& operator=(const ScreenRecorder&) = delete;
+
+    /// Configure the ring for the source's size and start both threads
+    void start();
+
+    /// Stop capturing, encode every queued frame and finish the output.
+    /// Throws MediaError if encoding failed at any point.
+    void stop();
+
+    /// Stop capturing and drop queued frames; the output is left unfinished
+    void cancel();
+
+    /// False once stopped, or once the recording ended on its own (the
+    /// source went away or the encoder failed); stop() still finishes it
+    bool isRecording() const { return running_; }
+
+    int64_t durationMs() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static void onFrame(void* context, RigidFrameRef frame);
+
+    void captureLoop();
+    void encodeLoop();
+    void enqueue(SharedFrame* frame);
+    void joinThreads(bool discardQueued);
+
+    std::unique_ptr<CaptureSource> source_;
+    std::unique_ptr<FrameSink> sink_;
+    FrameRing& frames_;
+    CaptureStats& stats_;
+    const RecordingSettings settings_;
+
+    std::thread captureThread_;
+    std::thread encoderThread_;
+    std::atomic<bool> running_{false};
+    uint64_t subscriptionId_ = 0;
+    Clock::time_point startTime_;
+    std::atomic<int64_t> stoppedAfterMs_{-1};
+
+    /// Set by enqueue() when the frame being published cost a drop; capture
+    /// thread only
+    bool publishDropped_ = false;
+
+    /// Frames for the encoder, oldest first: a ring of `count_` from `head_`
+    std::mutex queueMutex_;
+    std::condition_variable queueReady_;
+    std::vector<SharedFrame*> queue_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool closed_ = false;
+    std::string error_;
+};
+
+} // namespace rigid
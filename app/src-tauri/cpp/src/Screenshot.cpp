@@ -0,0 +1,298 @@
+#include "Screenshot.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "FramePool.h"
+#include "ImageWriter.h"
+#include "RigidCaptureKit.h"
+#include "WebPWriter.h"
+#include "X11Capture.h"
+
+namespace rigid {
+
+namespace {
+
+/// Fail before capturing when `path` names a format this build cannot write
+void checkFormat(const std::string& path) {
+    if (imageFormatForPath(path) == ImageFormat::WebP && !webPEncoderAvailable()) {
+        throw CaptureFailure(RIGID_ERROR_INVALID_CONFIG, "WebP encoding is not available in this build");
+    }
+}
+
+} // namespace
+
+CapturedImage::~CapturedImage() {
+    FramePool::shared().give(std::move(pixels_));
+}
+
+void CapturedImage::release() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+void CapturedImage::save(const std::string& path) {
+    checkFormat(path);
+    retain();
+    try {
+        ImageWriter::shared().write(path, pixels(), stride(), width_, height_, [this] { release(); });
+    } catch (const std::exception& e) {
+        throw CaptureFailure(RIGID_ERROR_SCREENSHOT_FAILED, e.what());
+    }
+}
+
+void CapturedImage::saveNow(const std::string& path, Compression compression) {
+    checkFormat(path);
+    try {
+        ImageWriter::shared().writeNow(path, pixels(), stride(), width_, height_, compression);
+    } catch (const std::exception& e) {
+        throw CaptureFailure(RIGID_ERROR_SCREENSHOT_FAILED, e.what());
+    }
+}
+
+CapturedImagePtr captureImage(CaptureSource& source) {
+    const int stride = source.width() * 4;
+    std::vector<uint8_t> pixels = FramePool::shared().take(static_cast<size_t>(stride) * source.height());
+    if (!source.capture(pixels.data(), stride)) {
+        FramePool::shared().give(std::move(pixels));
+        throw CaptureFailure(RIGID_ERROR_SCREENSHOT_FAILED, "Capture target went away");
+    }
+    return CapturedImagePtr(new CapturedImage(std::move(pixels), source.width(), source.height()));
+}
+
+void saveScreenshot(CaptureSource& source, const std::string& path) {
+    checkFormat(path);
+    captureImage(source)->save(path);
+}
+
+void ScreenshotSession::capture(const PixelRect& area, const std::string& path) {
+    checkFormat(path);
+    captureImage(area)->save(path);
+}
+
+CapturedImagePtr ScreenshotSession::captureImage(const PixelRect& area) {
+    const PixelRect bounds{0, 0, source_->width(), source_->height()};
+    const PixelRect rect = area.empty() ? bounds : area.intersection(bounds);
+    if (rect.empty()) throw CaptureFailure(RIGID_ERROR_INVALID_CONFIG, "Region lies outside the display");
+
+    const int stride = rect.width * 4;
+    // Pooled, so repeated captures reuse the buffers earlier ones wrote from
+    std::vector<uint8_t> pixels = FramePool::shared().take(static_cast<size_t>(stride) * rect.height);
+    bool captured;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        captured = source_->captureArea(rect, pixels.data(), stride);
+    }
+    if (!captured) {
+        FramePool::shared().give(std::move(pixels));
+        throw CaptureFailure(RIGID_ERROR_SCREENSHOT_FAILED, "Capture target went away");
+    }
+    return CapturedImagePtr(new CapturedImage(std::move(pixels), rect.width, rect.height));
+}
+
+} // namespace rigid
+
+namespace {
+
+/// Run `body`, mapping its failures to the C API's error codes
+template <typename Body>
+int32_t reportFailures(Body body) {
+    try {
+        body();
+        return RIGID_SUCCESS;
+    } catch (const rigid::CaptureFailure& e) {
+        std::fprintf(stderr, "Screenshot: %s\n", e.what());
+        // Opening reports recording failures; here they are screenshot ones
+        return e.code == RIGID_ERROR_RECORDING_FAILED ? RIGID_ERROR_SCREENSHOT_FAILED : e.code;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Screenshot: %s\n", e.what());
+        return RIGID_ERROR_SCREENSHOT_FAILED;
+    }
+}
+
+/// Whether `compression` is one of RIGID_COMPRESSION_*
+bool isCompression(int32_t compression) {
+    return compression >= RIGID_COMPRESSION_FAST && compression <= RIGID_COMPRESSION_SMALLEST;
+}
+
+/// Screenshot whatever `open` returns
+template <typename OpenSource>
+int32_t screenshot(const char* outputPath, OpenSource open) {
+    if (!outputPath) return RIGID_ERROR_INVALID_CONFIG;
+    return reportFailures([&] { rigid::saveScreenshot(*open(), outputPath); });
+}
+
+/// Screenshot whatever `open` returns into memory
+template <typename OpenSource>
+int32_t screenshotToBuffer(RigidImageRef* image, OpenSource open) {
+    if (!image) return RIGID_ERROR_INVALID_CONFIG;
+    return reportFailures([&] { *image = rigid::captureImage(*open()).release(); });
+}
+
+/// Session capture area from the C API's x/y/width/height; width or height
+/// of 0 asks for the whole display
+rigid::PixelRect sessionArea(int32_t x, int32_t y, int32_t width, int32_t height) {
+    return width > 0 && height > 0 ? rigid::PixelRect{x, y, width, height} : rigid::PixelRect{};
+}
+
+} // namespace
+
+// MARK: - C API
+
+// As with recordings, Linux captures at the display's own pixel size, so
+// scale_factor is not used and region coordinates are display pixels.
+
+extern "C" int32_t rigid_capture_screenshot_window(
+    uint32_t window_id,
+    const char* output_path,
+    float /*scale_factor*/,
+    bool capture_cursor
+) {
+    return screenshot(output_path, [&] { return rigid::X11CaptureSource::openWindow(window_id, capture_cursor); });
+}
+
+extern "C" int32_t rigid_capture_screenshot_display(
+    uint32_t display_id,
+    const char* output_path,
+    float /*scale_factor*/,
+    bool capture_cursor
+) {
+    return screenshot(output_path, [&] { return rigid::X11CaptureSource::openDisplay(display_id, capture_cursor); });
+}
+
+extern "C" int32_t rigid_capture_screenshot_region(
+    uint32_t display_id,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    const char* output_path,
+    float /*scale_factor*/,
+    bool capture_cursor
+) {
+    if (width <= 0 || height <= 0) return RIGID_ERROR_INVALID_CONFIG;
+    // Only the region is read from the server, through an XShm image of its size
+    return screenshot(output_path, [&] {
+        return rigid::X11CaptureSource::openRegion(display_id, {x, y, width, height}, capture_cursor);
+    });
+}
+
+extern "C" int32_t rigid_screenshot_session_open(
+    uint32_t display_id,
+    float /*scale_factor*/,
+    bool capture_cursor,
+    RigidScreenshotSessionHandle* session
+) {
+    if (!session) return RIGID_ERROR_INVALID_CONFIG;
+    return reportFailures([&] {
+        *session = new rigid::ScreenshotSession(rigid::X11CaptureSource::openDisplay(display_id, capture_cursor));
+    });
+}
+
+extern "C" int32_t rigid_screenshot_session_capture(
+    RigidScreenshotSessionHandle session,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    const char* output_path
+) {
+    if (!session || !output_path) return RIGID_ERROR_INVALID_CONFIG;
+    const rigid::PixelRect area = sessionArea(x, y, width, height);
+    return reportFailures([&] { static_cast<rigid::ScreenshotSession*>(session)->capture(area, output_path); });
+}
+
+extern "C" void rigid_screenshot_session_close(RigidScreenshotSessionHandle session) {
+    delete static_cast<rigid::ScreenshotSession*>(session);
+}
+
+extern "C" int32_t rigid_screenshot_set_encoding(int32_t compression, bool background) {
+    if (!isCompression(compression)) return RIGID_ERROR_INVALID_CONFIG;
+    rigid::ImageWriter::shared().setEncoding(static_cast<rigid::Compression>(compression), background);
+    return RIGID_SUCCESS;
+}
+
+extern "C" int32_t rigid_screenshot_wait_for_writes(void) {
+    return reportFailures([] { rigid::ImageWriter::shared().waitForWrites(); });
+}
+
+extern "C" int32_t rigid_capture_screenshot_window_to_buffer(
+    uint32_t window_id,
+    float /*scale_factor*/,
+    bool capture_cursor,
+    RigidImageRef* image
+) {
+    return screenshotToBuffer(image, [&] { return rigid::X11CaptureSource::openWindow(window_id, capture_cursor); });
+}
+
+extern "C" int32_t rigid_capture_screenshot_display_to_buffer(
+    uint32_t display_id,
+    float /*scale_factor*/,
+    bool capture_cursor,
+    RigidImageRef* image
+) {
+    return screenshotToBuffer(image,
+                              [&] { return rigid::X11CaptureSource::openDisplay(display_id, capture_cursor); });
+}
+
+extern "C" int32_t rigid_capture_screenshot_region_to_buffer(
+    uint32_t display_id,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    float /*scale_factor*/,
+    bool capture_cursor,
+    RigidImageRef* image
+) {
+    if (width <= 0 || height <= 0) return RIGID_ERROR_INVALID_CONFIG;
+    return screenshotToBuffer(image, [&] {
+        return rigid::X11CaptureSource::openRegion(display_id, {x, y, width, height}, capture_cursor);
+    });
+}
+
+extern "C" int32_t rigid_screenshot_session_capture_to_buffer(
+    RigidScreenshotSessionHandle session,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    RigidImageRef* image
+) {
+    if (!session || !image) return RIGID_ERROR_INVALID_CONFIG;
+    const rigid::PixelRect area = sessionArea(x, y, width, height);
+    return reportFailures(
+        [&] { *image = static_cast<rigid::ScreenshotSession*>(session)->captureImage(area).release(); });
+}
+
+extern "C" RigidImageRef rigid_image_retain(RigidImageRef image) {
+    if (image) static_cast<rigid::CapturedImage*>(image)->retain();
+    return image;
+}
+
+extern "C" void rigid_image_release(RigidImageRef image) {
+    if (image) static_cast<rigid::CapturedImage*>(image)->release();
+}
+
+extern "C" bool rigid_image_get_view(RigidImageRef image, RigidImageView* view) {
+    if (!image || !view) return false;
+    const auto* captured = static_cast<const rigid::CapturedImage*>(image);
+    view->pixels = captured->pixels();
+    view->width = captured->width();
+    view->height = captured->height();
+    view->stride = captured->stride();
+    view->format = RIGID_PIXEL_FORMAT_BGRA8;
+    return true;
+}
+
+extern "C" int32_t rigid_image_save(RigidImageRef image, const char* output_path) {
+    if (!image || !output_path) return RIGID_ERROR_INVALID_CONFIG;
+    return reportFailures([&] { static_cast<rigid::CapturedImage*>(image)->save(output_path); });
+}
+
+extern "C" int32_t rigid_image_save_now(RigidImageRef image, const char* output_path, int32_t compression) {
+    if (!image || !output_path || !isCompression(compression)) return RIGID_ERROR_INVALID_CONFIG;
+    return reportFailures([&] {
+        static_cast<rigid::CapturedImage*>(image)->saveNow(output_path, static_cast<rigid::Compression>(compression));
+    });
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CaptureSource.h"
+#include "Frame.h"
+#include "ImageWriter.h"
+
+namespace rigid {
+
+/// A screenshot kept in memory, shared by reference count; what
+/// RigidImageRef points to on Linux.
+///
+/// Starts with one reference, its creator's. The pixels are opaque BGRA
+/// rows of width * 4 bytes, from FramePool::shared(), and go back there with
+/// the last reference.
+class CapturedImage {
+public:
+    CapturedImage(std::vector<uint8_t>&& pixels, int width, int height)
+        : pixels_(std::move(pixels)), width_(width), height_(height) {}
+
+    CapturedImage(const CapturedImage&) = delete;
+    CapturedImage& operator=(const CapturedImage&) = delete;
+
+    const uint8_t* pixels() const { return pixels_.data(); }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int stride() const { return width_ * 4; }
+
+    /// Take another reference (the caller must already hold one)
+    void retain() { refs_.fetch_add(1, std::memory_order_relaxed); }
+    /// Drop a reference; the last one frees the image
+    void release();
+
+    /// Write the image to `path` through ImageWriter::shared(), which holds
+    /// a reference of its own until it is encoded. Throws CaptureFailure as
+    /// saveScreenshot does.
+    void save(const std::string& path);
+
+    /// Write the image to `path` at `compression` before returning, whatever
+    /// ImageWriter::shared() is set to. Throws CaptureFailure as save does.
+    void saveNow(const std::string& path, Compression compression);
+
+private:
+    ~CapturedImage();
+
+    std::vector<uint8_t> pixels_;
+    const int width_;
+    const int height_;
+    std::atomic<int> refs_{1};
+};
+
+/// Releases its image's reference when destroyed
+struct CapturedImageRelease {
+    void operator()(CapturedImage* image) const { image->release(); }
+};
+
+/// One reference to a CapturedImage
+using CapturedImagePtr = std::unique_ptr<CapturedImage, CapturedImageRelease>;
+
+/// Capture one frame of `source` into memory. Throws
+/// CaptureFailure(RIGID_ERROR_SCREENSHOT_FAILED) when the target is gone.
+CapturedImagePtr captureImage(CaptureSource& source);
+
+/// Capture one frame of `source` and write it to `path` through
+/// ImageWriter::shared(), in the format the path's extension names. Throws
+/// CaptureFailure: INVALID_CONFIG for a format this build cannot write
+/// (checked before capturing), SCREENSHOT_FAILED when the target is gone or
+/// the file cannot be written.
+void saveScreenshot(CaptureSource& source, const std::string& path);
+
+/// A source kept open for repeated screenshots; what
+/// RigidScreenshotSessionHandle points to on Linux.
+///
+/// Opening a source costs a connection to the X server and a shared memory
+/// segment; a session pays for them once, so each capture is a single
+/// XShmGetImage of the requested area into a pooled buffer.
+class ScreenshotSession {
+public:
+    explicit ScreenshotSession(std::unique_ptr<CaptureSource> source) : source_(std::move(source)) {}
+
+    /// Save the whole source, or `area` of it clamped to the source when not
+    /// empty, to `path` as saveScreenshot does. Throws CaptureFailure as
+    /// saveScreenshot, and INVALID_CONFIG for an area outside the source.
+    void capture(const PixelRect& area, const std::string& path);
+
+    /// As capture, into memory
+    CapturedImagePtr captureImage(const PixelRect& area);
+
+private:
+    std::unique_ptr<CaptureSource> source_;
+    /// Held while grabbing only; encoding runs outside it
+    std::mutex mutex_;
+};
+
+} // namespace rigid
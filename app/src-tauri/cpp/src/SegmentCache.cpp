@@ -0,0 +1,309 @@
+#include "SegmentCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+
+#include "MediaEncoder.h"
+
+namespace rigid {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+/// Bump whenever the compositor or encoder would produce different frames
+/// from the same inputs, so segments from older builds are never reused.
+/// 2: SIMD blending, box blurs, separable resampling and BT.709 conversion.
+constexpr int64_t kSegmentFormatVersion = 2;
+
+/// Pending segments left behind by a crashed render are removed after this
+constexpr auto kStalePendingAge = std::chrono::hours(24);
+
+/// 64-bit FNV-1a over typed fields. Each field is followed by a separator so
+/// adjacent strings cannot run together into the same bytes.
+class KeyBuilder {
+public:
+    void add(const std::string& value) {
+        mix(value.data(), value.size());
+        separator();
+    }
+    void add(int64_t value) {
+        mix(&value, sizeof(value));
+        separator();
+    }
+    void add(int value) { add(static_cast<int64_t>(value)); }
+    void add(bool value) { add(static_cast<int64_t>(value)); }
+    void add(double value) {
+        mix(&value, sizeof(value));
+        separator();
+    }
+
+    template <typename T>
+    void add(const std::optional<T>& value) {
+        add(value.has_value());
+        if (value) add(*value);
+    }
+
+    /// Size and modification time, so a re-recorded file with the same name misses
+    void addFile(const std::string& path) {
+        add(path);
+        std::error_code ec;
+        uintmax_t size = fs::file_size(path, ec);
+        add(ec ? int64_t{-1} : static_cast<int64_t>(size));
+        auto modified = fs::last_write_time(path, ec);
+        add(ec ? int64_t{0} : static_cast<int64_t>(modified.time_since_epoch().count()));
+    }
+
+    std::string hex() const {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016" PRIx64, hash_);
+        return buffer;
+    }
+
+private:
+    uint64_t hash_ = 14695981039346656037ull;
+
+    void mix(const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ull;
+        }
+    }
+
+    void separator() {
+        const uint8_t mark = 0xff;
+        mix(&mark, 1);
+    }
+};
+
+/// True if [startMs, startMs + durationMs) shows during [startSec, endSec)
+bool overlaps(int64_t startMs, int64_t durationMs, double startSec, double endSec) {
+    double itemStart = static_cast<double>(startMs) / 1000.0;
+    double itemEnd = static_cast<double>(startMs + durationMs) / 1000.0;
+    return itemEnd > itemStart && itemStart < endSec && itemEnd > startSec;
+}
+
+bool isPending(const fs::path& path) {
+    return path.stem().extension() == ".partial";
+}
+
+} // namespace
+
+SegmentCache::SegmentCache(std::filesystem::path directory, uintmax_t capacityBytes)
+    : directory_(std::move(directory)), capacityBytes_(capacityBytes) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+}
+
+std::string SegmentCache::keyFor(const CompositorConfig& config, const EncoderSettings& settings, FrameRange range) {
+    KeyBuilder key;
+    key.add(kSegmentFormatVersion);
+    key.add(settings.width);
+    key.add(settings.height);
+    key.add(settings.frameRate);
+    key.add(static_cast<int>(settings.quality));
+    key.add(settings.bitrate);
+    key.add(range.start);
+    key.add(range.end);
+
+    if (const auto& bg = config.background) {
+        key.add(static_cast<int>(bg->backgroundType));
+        key.add(bg->color);
+        key.add(bg->gradientAngle);
+        if (bg->gradientStops) {
+            for (const GradientStop& stop : *bg->gradientStops) {
+                key.add(stop.color);
+                key.add(stop.position);
+            }
+        }
+        if (auto path = bg->mediaPath ? bg->mediaPath : bg->imageUrl) key.addFile(*path);
+    }
+
+    const double startSec = static_cast<double>(range.start) / config.frameRate;
+    const double endSec = static_cast<double>(range.end) / config.frameRate;
+
+    // Only what draws during the range counts; audio settings never change frames
+    for (const CompositorClip& clip : config.clips) {
+        if (clip.sourceType == ClipSourceType::Audio) continue;
+        if (!overlaps(clip.startTimeMs, clip.durationMs, startSec, endSec)) continue;
+        key.addFile(clip.sourcePath);
+        key.add(static_cast<int>(clip.sourceType));
+        key.add(clip.startTimeMs);
+        key.add(clip.durationMs);
+        key.add(clip.inPointMs);
+        key.add(clip.positionX);
+        key.add(clip.positionY);
+        key.add(clip.scale);
+        key.add(clip.opacity);
+        key.add(clip.cornerRadius);
+        key.add(clip.cropTop);
+        key.add(clip.cropBottom);
+        key.add(clip.cropLeft);
+        key.add(clip.cropRight);
+        key.add(clip.zIndex);
+        key.add(clip.trackId);
+        key.add(clip.speed);
+        key.add(clip.freezeFrame);
+        key.add(clip.freezeFrameTimeMs);
+        key.add(clip.transitionInType);
+        key.add(clip.transitionInDurationMs);
+        key.add(clip.transitionOutType);
+        key.add(clip.transitionOutDurationMs);
+    }
+
+    if (config.zoomClips) {
+        for (const CompositorZoomClip& zoom : *config.zoomClips) {
+            if (!overlaps(zoom.startTimeMs, zoom.durationMs, startSec, endSec)) continue;
+            key.add(zoom.targetTrackId);
+            key.add(zoom.startTimeMs);
+            key.add(zoom.durationMs);
+            key.add(zoom.zoomScale);
+            key.add(zoom.zoomCenterX);
+            key.add(zoom.zoomCenterY);
+            key.add(zoom.easeInDurationMs);
+            key.add(zoom.easeOutDurationMs);
+        }
+    }
+    if (config.panClips) {
+        for (const CompositorPanClip& pan : *config.panClips) {
+            if (!overlaps(pan.startTimeMs, pan.durationMs, startSec, endSec)) continue;
+            key.add(pan.targetTrackId);
+            key.add(pan.startTimeMs);
+            key.add(pan.durationMs);
+            key.add(pan.startX);
+            key.add(pan.startY);
+            key.add(pan.endX);
+            key.add(pan.endY);
+            key.add(pan.easeInDurationMs);
+            key.add(pan.easeOutDurationMs);
+            key.add(pan.zIndex);
+        }
+    }
+    if (config.blurClips) {
+        for (const CompositorBlurClip& blur : *config.blurClips) {
+            if (!overlaps(blur.startTimeMs, blur.durationMs, startSec, endSec)) continue;
+            key.add(blur.startTimeMs);
+            key.add(blur.durationMs);
+            key.add(blur.blurIntensity);
+            key.add(blur.regionX);
+            key.add(blur.regionY);
+            key.add(blur.regionWidth);
+            key.add(blur.regionHeight);
+            key.add(blur.cornerRadius);
+            key.add(blur.easeInDurationMs);
+            key.add(blur.easeOutDurationMs);
+            key.add(blur.zIndex);
+        }
+    }
+
+    return key.hex();
+}
+
+std::optional<std::string> SegmentCache::acquire(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fs::path path = pathFor(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) return std::nullopt;
+
+    // Recently used segments are the last to be trimmed
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    pins_[key]++;
+    return path.string();
+}
+
+std::string SegmentCache::pendingPathFor(const std::string& key) {
+    uint64_t sequence = nextPending_++;
+    return (directory_ / (key + "." + std::to_string(sequence) + ".partial.mp4")).string();
+}
+
+std::string SegmentCache::commit(const std::string& key, const std::string& pendingPath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fs::path path = pathFor(key);
+    // Atomic, so a render racing on the same key sees the old or new file, never half of one
+    fs::rename(pendingPath, path);
+    pins_[key]++;
+    return path.string();
+}
+
+void SegmentCache::release(const std::vector<std::string>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::string& key : keys) {
+        auto found = pins_.find(key);
+        if (found == pins_.end()) continue;
+        if (--found->second <= 0) pins_.erase(found);
+    }
+    trim();
+}
+
+uintmax_t SegmentCache::sizeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".mp4" || isPending(it->path())) continue;
+        uintmax_t size = it->file_size(ec);
+        if (!ec) total += size;
+    }
+    return total;
+}
+
+SegmentCache& SegmentCache::shared(const std::string& directory) {
+    constexpr uintmax_t kSharedCapacityBytes = uintmax_t{4} * 1024 * 1024 * 1024;
+
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<SegmentCache>> caches;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& cache = caches[directory];
+    if (!cache) cache = std::make_unique<SegmentCache>(directory, kSharedCapacityBytes);
+    return *cache;
+}
+
+fs::path SegmentCache::pathFor(const std::string& key) const {
+    return directory_ / (key + ".mp4");
+}
+
+void SegmentCache::trim() {
+    struct Entry {
+        fs::path path;
+        uintmax_t bytes;
+        fs::file_time_type modified;
+    };
+
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    const auto now = fs::file_time_type::clock::now();
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        const fs::path& path = it->path();
+        if (path.extension() != ".mp4") continue;
+
+        std::error_code statError;
+        auto modified = it->last_write_time(statError);
+        if (statError) continue;
+
+        if (isPending(path)) {
+            if (now - modified > kStalePendingAge) fs::remove(path, statError);
+            continue;
+        }
+
+        uintmax_t bytes = it->file_size(statError);
+        if (statError) continue;
+        total += bytes;
+        if (pins_.count(path.stem().string()) == 0) entries.push_back({path, bytes, modified});
+    }
+
+    // Least recently used first
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.modified < b.modified; });
+    for (const Entry& entry : entries) {
+        if (total <= capacityBytes_) break;
+        std::error_code removeError;
+        if (fs::remove(entry.path, removeError)) total -= entry.bytes;
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CompositorConfig.h"
+#include "ExportChunks.h"
+
+namespace rigid {
+
+struct EncoderSettings;
+
+/// Encoded export segments kept on disk between renders.
+///
+/// A segment is keyed by a hash of everything that can change its frames:
+/// output and encoder settings, the frame range, the background, and every
+/// clip and effect on screen during the range, including the size and
+/// modification time of their source files. Re-exporting after a small edit
+/// then re-encodes only the segments the edit touches.
+///
+/// Segments a render is using are pinned, so another render trimming the
+/// cache to capacity never deletes them; the least recently used of the
+/// rest go first.
+class SegmentCache {
+public:
+    SegmentCache(std::filesystem::path directory, uintmax_t capacityBytes);
+
+    SegmentCache(const SegmentCache&) = delete;
+    SegmentCache& operator=(const SegmentCache&) = delete;
+
+    /// Cache key for the frames of `range`
+    static std::string keyFor(const CompositorConfig& config, const EncoderSettings& settings, FrameRange range);
+
+    /// Path of the cached segment for `key`, pinned until release(), or
+    /// nullopt on a miss
+    std::optional<std::string> acquire(const std::string& key);
+
+    /// Fresh path to encode the segment for `key` into before commit()
+    std::string pendingPathFor(const std::string& key);
+
+    /// Move a finished segment into the cache and return its path, pinned
+    /// until release(). Throws std::filesystem::filesystem_error on failure.
+    std::string commit(const std::string& key, const std::string& pendingPath);
+
+    /// Unpin segments a render no longer needs, then trim to capacity
+    void release(const std::vector<std::string>& keys);
+
+    /// Bytes of segments on disk
+    uintmax_t sizeBytes() const;
+
+    /// Process-wide cache for a directory, shared so pins are seen by every render
+    static SegmentCache& shared(const std::string& directory);
+
+private:
+    const std::filesystem::path directory_;
+    const uintmax_t capacityBytes_;
+
+    mutable std::mutex mutex_;
+    /// Pin count per key
+    std::map<std::string, int> pins_;
+    std::atomic<uint64_t> nextPending_{0};
+
+    std::filesystem::path pathFor(const std::string& key) const;
+    /// Requires the lock
+    void trim();
+};
+
+} // namespace rigid
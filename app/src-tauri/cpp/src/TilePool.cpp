@@ -0,0 +1,78 @@
+#include "TilePool.h"
+
+#include <algorithm>
+
+namespace rigid {
+
+TilePool::TilePool(int threadCount) {
+    for (int worker = 1; worker < std::max(threadCount, 1); worker++) {
+        threads_.emplace_back([this, worker] { workerLoop(worker); });
+    }
+}
+
+TilePool::~TilePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) thread.join();
+}
+
+void TilePool::run(size_t taskCount, const Task& task) {
+    if (taskCount == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        taskCount_ = taskCount;
+        nextTask_ = 0;
+        error_ = nullptr;
+        busyWorkers_ = static_cast<int>(threads_.size());
+        generation_++;
+    }
+    wake_.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busyWorkers_ == 0; });
+    task_ = nullptr;
+    if (error_) std::rethrow_exception(error_);
+}
+
+void TilePool::workerLoop(int worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+
+        drain(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busyWorkers_--;
+        }
+        done_.notify_one();
+    }
+}
+
+void TilePool::drain(int worker) {
+    while (true) {
+        size_t index = nextTask_.fetch_add(1);
+        if (index >= taskCount_) return;
+        try {
+            (*task_)(index, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+            // Skip whatever is left
+            nextTask_ = taskCount_;
+        }
+    }
+}
+
+} // namespace rigid
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rigid {
+
+/// Persistent threads that share out the tiles of one frame at a time.
+///
+/// Workers claim tasks from a shared counter, so a thread that finishes a
+/// cheap tile immediately takes the next one and a few expensive tiles never
+/// hold up the rest. The calling thread works too; `run` returns once every
+/// task has finished.
+class TilePool {
+public:
+    /// Task index and the worker running it (0 is the calling thread)
+    using Task = std::function<void(size_t task, int worker)>;
+
+    /// `threadCount` workers in total, including the caller (at least 1)
+    explicit TilePool(int threadCount);
+    ~TilePool();
+
+    TilePool(const TilePool&) = delete;
+    TilePool& operator=(const TilePool&) = delete;
+
+    int workerCount() const { return static_cast<int>(threads_.size()) + 1; }
+
+    /// Run `task` for 0..taskCount-1. If tasks throw, the remaining ones are
+    /// skipped and the first exception is rethrown here.
+    void run(size_t taskCount, const Task& task);
+
+private:
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    /// Bumped for every run, so sleeping workers know there is new work
+    uint64_t generation_ = 0;
+    int busyWorkers_ = 0;
+    bool stopping_ = false;
+
+    const Task* task_ = nullptr;
+    size_t taskCount_ = 0;
+    std::atomic<size_t> nextTask_{0};
+    std::exception_ptr error_;
+
+    void workerLoop(int worker);
+    /// Claim and run tasks until none are left
+    void drain(int worker);
+};
+
+} // namespace rigid
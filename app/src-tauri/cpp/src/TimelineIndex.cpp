@@ -0,0 +1,38 @@
+#include "TimelineIndex.h"
+
+#include <algorithm>
+
+namespace rigid {
+
+TimelineIndex::TimelineIndex(const std::vector<Interval>& intervals) {
+    for (const Interval& interval : intervals) {
+        if (interval.endSec <= interval.startSec) continue;
+        boundaries_.push_back(interval.startSec);
+        boundaries_.push_back(interval.endSec);
+    }
+    std::sort(boundaries_.begin(), boundaries_.end());
+    boundaries_.erase(std::unique(boundaries_.begin(), boundaries_.end()), boundaries_.end());
+    if (boundaries_.size() < 2) return;
+
+    // Every item covers a contiguous run of segments; no boundary falls inside one
+    segments_.resize(boundaries_.size() - 1);
+    for (size_t item = 0; item < intervals.size(); item++) {
+        const Interval& interval = intervals[item];
+        if (interval.endSec <= interval.startSec) continue;
+
+        auto first = std::lower_bound(boundaries_.begin(), boundaries_.end(), interval.startSec);
+        auto last = std::lower_bound(boundaries_.begin(), boundaries_.end(), interval.endSec);
+        for (auto segment = first; segment != last; ++segment) {
+            segments_[static_cast<size_t>(segment - boundaries_.begin())].push_back(item);
+        }
+    }
+}
+
+const std::vector<size_t>& TimelineIndex::activeAt(double timeSec) const {
+    // First boundary after timeSec; the segment starts at the one before it
+    auto next = std::upper_bound(boundaries_.begin(), boundaries_.end(), timeSec);
+    if (next == boundaries_.begin() || next == boundaries_.end()) return none_;
+    return segments_[static_cast<size_t>(next - boundaries_.begin()) - 1];
+}
+
+} // namespace rigid
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace rigid {
+
+/// Items active over half-open [start, end) time ranges, looked up by time.
+///
+/// Built once per render from every clip or effect interval. The timeline is
+/// cut at each start and end into segments with a fixed set of active items,
+/// so a lookup is a binary search plus the items actually on screen instead
+/// of a scan over the whole config every frame.
+class TimelineIndex {
+public:
+    struct Interval {
+        double startSec;
+        double endSec;
+    };
+
+    TimelineIndex() = default;
+
+    /// `intervals[i]` is item i. Lookups return active items in this order,
+    /// so callers pass intervals already sorted by z-index.
+    explicit TimelineIndex(const std::vector<Interval>& intervals);
+
+    /// Indices of the items with start <= timeSec < end, in input order
+    const std::vector<size_t>& activeAt(double timeSec) const;
+
+    size_t segmentCount() const { return segments_.size(); }
+
+private:
+    /// Sorted, unique interval starts and ends
+    std::vector<double> boundaries_;
+    /// segments_[i] covers [boundaries_[i], boundaries_[i + 1])
+    std::vector<std::vector<size_t>> segments_;
+    std::vector<size_t> none_;
+};
+
+} // namespace rigid
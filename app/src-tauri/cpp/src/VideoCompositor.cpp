@@ -0,0 +1,570 @@
+#include "VideoCompositor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "AudioMixer.h"
+#include "ExportChunks.h"
+#include "FrameCompositor.h"
+#include "ImageCache.h"
+#include "Json.h"
+#include "MediaDecoder.h"
+#include "MediaEncoder.h"
+#include "RenderPipeline.h"
+#include "RigidCaptureKit.h"
+#include "SegmentCache.h"
+
+namespace rigid {
+
+namespace {
+
+/// Decoded pixels for every clip of one render.
+///
+/// Decoders and images are opened the first time a clip becomes active, and
+/// a decoder is closed once its clip has ended (closeEnded), so only the
+/// clips on screen hold a decoder, its threads and its frames. Still images
+/// come from the shared ImageCache, so a title card or screenshot reused
+/// across clips and exports is decoded once. A clip that fails to open is
+/// logged once and then skipped, like a missing track in Swift.
+class MediaClipSource : public ClipFrameSource {
+public:
+    /// `decoderThreads` per video clip, capped at kMaxDecoderThreadsPerClip
+    MediaClipSource(const CompositorConfig& config, int decoderThreads)
+        : config_(config), decoderThreads_(std::clamp(decoderThreads, 1, kMaxDecoderThreadsPerClip)),
+          clips_(config.clips.size()) {}
+
+    const Frame* frameForClip(size_t clipIndex, double timeSec) override {
+        const CompositorClip& clip = config_.clips[clipIndex];
+        ClipState& state = clips_[clipIndex];
+        if (state.failed) return nullptr;
+
+        try {
+            if (clip.sourceType == ClipSourceType::Image) {
+                if (!state.image) state.image = ImageCache::shared().get(clip.sourcePath);
+                return state.image.get();
+            }
+
+            if (!state.decoder) {
+                state.decoder = std::make_unique<VideoDecoder>(clip.sourcePath, decoderThreads_);
+                openDecoders_.push_back(clipIndex);
+            }
+            return state.decoder->frameAt(sourceTime(clip, timeSec));
+        } catch (const MediaError& e) {
+            std::fprintf(stderr, "VideoCompositor: Failed to load %s: %s\n", clip.sourcePath.c_str(), e.what());
+            state.failed = true;
+            return nullptr;
+        }
+    }
+
+    /// Close the decoders of clips missing from `activeClips`, the clips on
+    /// screen at a time no earlier than any before it. A clip is active over
+    /// one interval, so once it drops out it has ended for this render.
+    void closeEnded(const std::vector<size_t>& activeClips) {
+        auto ended = [&](size_t index) {
+            if (std::find(activeClips.begin(), activeClips.end(), index) != activeClips.end()) return false;
+            clips_[index].decoder.reset();
+            return true;
+        };
+        openDecoders_.erase(std::remove_if(openDecoders_.begin(), openDecoders_.end(), ended), openDecoders_.end());
+    }
+
+    const Frame* backgroundImage() override {
+        if (backgroundLoaded_) return background_.get();
+        backgroundLoaded_ = true;
+
+        const auto& bg = config_.background;
+        if (!bg) return nullptr;
+        std::optional<std::string> path = bg->mediaPath ? bg->mediaPath : bg->imageUrl;
+        if (!path) return nullptr;
+
+        try {
+            background_ = ImageCache::shared().get(*path);
+        } catch (const MediaError& e) {
+            std::fprintf(stderr, "VideoCompositor: Failed to load background image: %s\n", e.what());
+        }
+        return background_.get();
+    }
+
+private:
+    struct ClipState {
+        std::unique_ptr<VideoDecoder> decoder;
+        std::shared_ptr<const Frame> image;
+        bool failed = false;
+    };
+
+    const CompositorConfig& config_;
+    const int decoderThreads_;
+    std::vector<ClipState> clips_;
+    /// Clips holding a decoder
+    std::vector<size_t> openDecoders_;
+    std::shared_ptr<const Frame> background_;
+    bool backgroundLoaded_ = false;
+
+    /// Source time for a timeline time (VideoClipSource.getSourceTime in Swift)
+    static double sourceTime(const CompositorClip& clip, double timeSec) {
+        if (clip.freezeFrame.value_or(false)) {
+            return static_cast<double>(clip.freezeFrameTimeMs.value_or(0)) / 1000.0;
+        }
+        double relative = timeSec - static_cast<double>(clip.startTimeMs) / 1000.0;
+        return static_cast<double>(clip.inPointMs) / 1000.0 + relative * clip.clampedSpeed();
+    }
+};
+
+/// Serves the compositor from what the decode stage prepared for the frame
+/// being composited, so decoding and compositing run on separate threads.
+class DecodedClipSource : public ClipFrameSource {
+public:
+    explicit DecodedClipSource(const Frame* background) : background_(background) {}
+
+    void setFrames(const DecodedFrameSet* frames) { frames_ = frames; }
+
+    const Frame* frameForClip(size_t clipIndex, double) override {
+        return frames_ ? frames_->frameFor(clipIndex) : nullptr;
+    }
+
+    const Frame* backgroundImage() override { return background_; }
+
+private:
+    const Frame* background_;
+    const DecodedFrameSet* frames_ = nullptr;
+};
+
+/// Frames allowed to wait between two pipeline stages. Enough to ride out
+/// a slow keyframe or encoder flush without holding many frames in memory.
+constexpr size_t kPipelineDepth = 2;
+
+/// Threads per chunk of a chunked export, all stages together. x264 stops
+/// scaling well past a handful of threads at 1080p, so a big machine is
+/// better used by more chunks than by more threads per encoder.
+constexpr int kThreadsPerChunk = 4;
+
+/// Shortest chunk worth its own encoder. A timeline under two of these
+/// renders as a single pipeline.
+constexpr int kMinChunkSec = 30;
+
+/// Chunk length when segments are cached. Shorter than kMinChunkSec so an
+/// edit invalidates less, at the cost of a few more keyframe-aligned joins.
+constexpr int kCachedChunkSec = 10;
+
+void removeFile(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+/// Feeds the mixed timeline audio to an encoder in step with its video
+class AudioWriter {
+public:
+    AudioWriter(AudioMixer& mixer, MediaEncoder& encoder, int frameRate)
+        : mixer_(mixer), encoder_(encoder), frameRate_(frameRate),
+          chunk_(encoder.audioFrameSize()), buffer_(static_cast<size_t>(chunk_) * AudioDecoder::kChannels) {}
+
+    /// Write audio up to the end of the first `framesWritten` video frames
+    void writeThrough(int64_t framesWritten) {
+        int64_t target = framesWritten * AudioDecoder::kSampleRate / frameRate_;
+        while (samplesWritten_ < target) {
+            int count = static_cast<int>(std::min<int64_t>(chunk_, target - samplesWritten_));
+            mixer_.mix(samplesWritten_, count, buffer_.data());
+            encoder_.encodeAudio(buffer_.data(), count);
+            samplesWritten_ += count;
+        }
+    }
+
+private:
+    AudioMixer& mixer_;
+    MediaEncoder& encoder_;
+    int frameRate_;
+    int chunk_;
+    std::vector<float> buffer_;
+    int64_t samplesWritten_ = 0;
+};
+
+/// Decode, composite and encode the frames of `range` into `encoder`, which
+/// numbers them from 0 and was opened with `threads.encoder` threads. `frameWritten` runs on the calling thread after each
+/// frame with its timeline index.
+void renderRange(const CompositorConfig& config, FrameRange range, const StageThreads& threads, MediaEncoder& encoder,
+                 const std::atomic<bool>& stop, const std::function<void(int64_t frameIndex)>& frameWritten) {
+    MediaClipSource source(config, threads.decoderPerClip);
+    // Loaded here, before the stages start, so only the decode thread touches `source`
+    DecodedClipSource decodedSource(source.backgroundImage());
+    // Tiles of a frame composite in parallel
+    FrameCompositor compositor(config, decodedSource, threads.compositor);
+    compositor.setYuvOutput(true);
+
+    // Decode, composite and encode each run on their own thread, so frame
+    // N+1 is decoding while N composites and N-1 encodes
+    RenderPipelineStages stages;
+    std::vector<size_t> activeClips;
+    stages.decode = [&](int64_t i, DecodedFrameSet& decoded) {
+        double timeSec = static_cast<double>(range.start + i) / config.frameRate;
+        compositor.clipsAt(timeSec, activeClips);
+        source.closeEnded(activeClips);
+        for (size_t index : activeClips) {
+            const Frame* image = source.frameForClip(index, timeSec);
+            if (!image || image->empty()) continue;
+            // Still images live for the whole render; decoder frames are reused
+            if (config.clips[index].sourceType == ClipSourceType::Image) {
+                decoded.borrow(index, image);
+            } else {
+                decoded.copy(index, *image);
+            }
+        }
+    };
+    stages.composite = [&](int64_t i, const DecodedFrameSet& decoded, Frame& frame) {
+        decodedSource.setFrames(&decoded);
+        compositor.renderFrame(static_cast<double>(range.start + i) / config.frameRate, frame);
+    };
+    stages.encode = [&](int64_t i, const Frame& frame) {
+        encoder.encodeVideoFrame(frame, i);
+        if (frameWritten) frameWritten(range.start + i);
+    };
+
+    runRenderPipeline(range.count(), kPipelineDepth, stages, stop);
+}
+
+/// Report progress every 30 frames and on the last one
+void reportProgress(const CompositorProgressCallback& progress, int64_t framesWritten, int64_t totalFrames) {
+    if (progress && (framesWritten % 30 == 0 || framesWritten == totalFrames)) {
+        float percent = static_cast<float>(framesWritten) / static_cast<float>(totalFrames) * 100.0f;  // 0-100 percentage
+        progress(percent, framesWritten, totalFrames);
+    }
+}
+
+/// Temporary segment files of a chunked export, removed however the render ends
+struct SegmentFiles {
+    std::vector<std::string> paths;
+
+    ~SegmentFiles() {
+        for (const std::string& path : paths) removeFile(path);
+    }
+};
+
+/// Cached segments a render holds pinned, released however the render ends
+struct SegmentPins {
+    SegmentCache* cache = nullptr;
+    std::mutex mutex;
+    std::vector<std::string> keys;
+
+    void add(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        keys.push_back(key);
+    }
+
+    ~SegmentPins() {
+        if (cache) cache->release(keys);
+    }
+};
+
+} // namespace
+
+std::string VideoCompositorEngine::render(const CompositorConfig& config, const CompositorProgressCallback& progress) {
+    const int64_t totalFrames = config.totalFrames();
+    if (totalFrames <= 0) {
+        throw MediaError("Composition has no frames to render");
+    }
+
+    // Create parent directory if needed, and remove any existing file
+    std::filesystem::path outputPath(config.outputPath);
+    if (outputPath.has_parent_path()) {
+        std::filesystem::create_directories(outputPath.parent_path());
+    }
+    removeFile(config.outputPath);
+
+    AudioMixer mixer(config);
+
+    EncoderSettings settings;
+    settings.outputPath = config.outputPath;
+    settings.width = config.width;
+    settings.height = config.height;
+    settings.frameRate = config.frameRate;
+    settings.quality = config.quality;
+    settings.bitrate = bitrateForQuality(config.quality, config.width, config.height);
+    settings.withAudio = mixer.hasAudio();
+    const StageThreads threads = StageThreads::split(coreCount());
+    settings.threadCount = threads.encoder;
+
+    // A segment cache needs chunk boundaries that stay put between exports,
+    // so timelines of at least two cached chunks are cut on a fixed grid.
+    // Shorter ones, and renders without a cache directory (other C API
+    // callers), are planned by planExportChunks, which only splits timelines
+    // long enough to pay off; their segments are not cached.
+    SegmentCache* cache = nullptr;
+    std::vector<FrameRange> chunks;
+    const int64_t gop = settings.keyframeInterval();
+    const int64_t cachedChunkFrames = (static_cast<int64_t>(kCachedChunkSec) * config.frameRate + gop - 1) / gop * gop;
+    if (config.segmentCacheDir && totalFrames >= 2 * cachedChunkFrames) {
+        cache = &SegmentCache::shared(*config.segmentCacheDir);
+        chunks = splitIntoChunks(totalFrames, cachedChunkFrames);
+    } else {
+        chunks = planExportChunks(totalFrames, gop, coreCount() / kThreadsPerChunk,
+                                  static_cast<int64_t>(kMinChunkSec) * config.frameRate);
+    }
+
+    std::fprintf(stderr, "VideoCompositor: Rendering %lld frames at %dx%d, %d fps%s",
+                 static_cast<long long>(totalFrames), config.width, config.height, config.frameRate,
+                 settings.withAudio ? " with audio" : "");
+    if (chunks.size() > 1) std::fprintf(stderr, " in %zu chunks", chunks.size());
+    std::fprintf(stderr, "\n");
+
+    try {
+        if (chunks.size() > 1) {
+            renderChunked(config, settings, chunks, mixer, cache, progress);
+        } else {
+            MediaEncoder encoder(settings);
+            AudioWriter audio(mixer, encoder, config.frameRate);
+
+            renderRange(config, {0, totalFrames}, threads, encoder, cancelled_, [&](int64_t i) {
+                // Keep audio level with the video written so far
+                if (settings.withAudio) audio.writeThrough(i + 1);
+                reportProgress(progress, i + 1, totalFrames);
+            });
+            if (cancelled_) throw RenderCancelled();
+
+            encoder.finish();
+        }
+    } catch (...) {
+        // Never leave a truncated file behind
+        removeFile(config.outputPath);
+        throw;
+    }
+
+    std::fprintf(stderr, "VideoCompositor: Export completed: %s\n", config.outputPath.c_str());
+    return config.outputPath;
+}
+
+int VideoCompositorEngine::coreCount() const {
+    if (threadBudget_ > 0) return threadBudget_;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+void VideoCompositorEngine::renderChunked(const CompositorConfig& config, const EncoderSettings& settings,
+                                          const std::vector<FrameRange>& chunks, AudioMixer& mixer,
+                                          SegmentCache* cache, const CompositorProgressCallback& progress) {
+    const int64_t totalFrames = config.totalFrames();
+
+    std::vector<std::string> segmentPaths(chunks.size());
+    std::vector<std::string> keys(chunks.size());
+    std::vector<std::string> renderPaths(chunks.size());
+    std::vector<size_t> pending;
+    int64_t reusedFrames = 0;
+
+    // Segments sit next to the output (or in the cache), so joining them
+    // never crosses filesystems
+    SegmentFiles temporary;
+    SegmentPins pins;
+    pins.cache = cache;
+    for (size_t k = 0; k < chunks.size(); k++) {
+        if (cache) {
+            keys[k] = SegmentCache::keyFor(config, settings, chunks[k]);
+            if (std::optional<std::string> cached = cache->acquire(keys[k])) {
+                pins.add(keys[k]);
+                segmentPaths[k] = *cached;
+                reusedFrames += chunks[k].count();
+                continue;
+            }
+            renderPaths[k] = cache->pendingPathFor(keys[k]);
+        } else {
+            renderPaths[k] = config.outputPath + ".part" + std::to_string(k) + ".mp4";
+        }
+        temporary.paths.push_back(renderPaths[k]);
+        pending.push_back(k);
+    }
+    if (cache) {
+        std::fprintf(stderr, "VideoCompositor: Reusing %zu of %zu cached segments\n",
+                     chunks.size() - pending.size(), chunks.size());
+    }
+
+    // A budget under kThreadsPerChunk runs one worker with all of it
+    const int threadsPerChunk = std::min(kThreadsPerChunk, coreCount());
+    const size_t workerCount =
+        std::min(pending.size(), static_cast<size_t>(std::max(1, coreCount() / threadsPerChunk)));
+    const StageThreads chunkThreads = StageThreads::split(threadsPerChunk);
+
+    std::atomic<size_t> nextPending{0};
+    std::atomic<int64_t> framesRendered{reusedFrames};
+    std::atomic<bool> stop{false};
+    std::mutex mutex;  // Guards `error` and serializes progress callbacks
+    std::exception_ptr error;
+
+    // Each worker takes the next chunk until none are left. Chunks are video
+    // only; audio is mixed once over the whole timeline when they are joined.
+    auto worker = [&] {
+        while (!stop) {
+            size_t next = nextPending++;
+            if (next >= pending.size()) return;
+            size_t k = pending[next];
+            try {
+                EncoderSettings chunkSettings = settings;
+                chunkSettings.outputPath = renderPaths[k];
+                chunkSettings.withAudio = false;
+                chunkSettings.threadCount = chunkThreads.encoder;
+                MediaEncoder encoder(chunkSettings);
+
+                renderRange(config, chunks[k], chunkThreads, encoder, stop, [&](int64_t) {
+                    if (cancelled_) stop = true;
+                    int64_t rendered = ++framesRendered;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    reportProgress(progress, rendered, totalFrames);
+                });
+                if (stop) return;
+                encoder.finish();
+
+                if (cache) {
+                    segmentPaths[k] = cache->commit(keys[k], renderPaths[k]);
+                    pins.add(keys[k]);
+                } else {
+                    segmentPaths[k] = renderPaths[k];
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+                stop = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+        for (size_t w = 0; w < workerCount; w++) workers.emplace_back(worker);
+    } catch (...) {
+        stop = true;
+        for (std::thread& thread : workers) thread.join();
+        throw;
+    }
+    for (std::thread& thread : workers) thread.join();
+
+    if (error) std::rethrow_exception(error);
+    if (cancelled_) throw RenderCancelled();
+    if (reusedFrames == totalFrames) reportProgress(progress, totalFrames, totalFrames);
+
+    // Join the segments in order by stream copy; they all start on a keyframe
+    EncoderSettings joinSettings = settings;
+    joinSettings.copyVideoFrom = segmentPaths.front();
+    MediaEncoder output(joinSettings);
+    AudioWriter audio(mixer, output, config.frameRate);
+
+    for (size_t k = 0; k < chunks.size(); k++) {
+        if (cancelled_) throw RenderCancelled();
+        output.appendVideoSegment(segmentPaths[k], chunks[k].start, [&](int64_t framesWritten) {
+            if (settings.withAudio) audio.writeThrough(framesWritten);
+        });
+    }
+    if (settings.withAudio) audio.writeThrough(totalFrames);
+    output.finish();
+}
+
+} // namespace rigid
+
+// MARK: - C API
+//
+// A handle owns a shared engine. Renders hold their own reference, so a handle
+// can be destroyed while its render finishes on the worker thread.
+
+namespace {
+
+struct CompositorHandle {
+    std::shared_ptr<rigid::VideoCompositorEngine> engine = std::make_shared<rigid::VideoCompositorEngine>();
+};
+
+std::string makeExportId(const char* exportId) {
+    if (exportId) return exportId;
+
+    std::random_device device;
+    std::mt19937_64 rng(device());
+    char buffer[33];
+    std::snprintf(buffer, sizeof(buffer), "%016llx%016llx",
+                  static_cast<unsigned long long>(rng()), static_cast<unsigned long long>(rng()));
+    return buffer;
+}
+
+/// Parse the config, returning nullopt (after logging) if it is not valid
+std::optional<rigid::CompositorConfig> parseConfig(const char* configJson) {
+    try {
+        return rigid::CompositorConfig::fromJson(configJson);
+    } catch (const rigid::JsonError& e) {
+        std::fprintf(stderr, "VideoCompositor: Failed to parse config JSON: %s\n", e.what());
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+extern "C" RigidCompositorHandle rigid_compositor_create(void) {
+    return new CompositorHandle();
+}
+
+extern "C" void rigid_compositor_destroy(RigidCompositorHandle handle) {
+    delete static_cast<CompositorHandle*>(handle);
+}
+
+extern "C" int32_t rigid_compositor_render(
+    RigidCompositorHandle handle,
+    const char* export_id,
+    const char* config_json,
+    RigidCompositorProgressCallback progress_callback
+) {
+    if (!handle || !config_json) return RIGID_ERROR_INVALID_CONFIG;
+
+    std::string exportId = makeExportId(export_id);
+    auto config = parseConfig(config_json);
+    if (!config) return RIGID_ERROR_INVALID_CONFIG;
+
+    // Without libav there is nothing to render with; the caller falls back to ffmpeg
+    if (!rigid::mediaBackendAvailable()) return RIGID_ERROR_ENCODING_FAILED;
+
+    auto engine = static_cast<CompositorHandle*>(handle)->engine;
+    engine->resetCancellation();
+    try {
+        engine->render(*config, [&](float percent, int64_t current, int64_t total) {
+            if (progress_callback) progress_callback(exportId.c_str(), percent, current, total);
+        });
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "VideoCompositor: Render failed: %s\n", e.what());
+        return RIGID_ERROR_RECORDING_FAILED;
+    }
+    return RIGID_SUCCESS;
+}
+
+extern "C" int32_t rigid_compositor_render_async(
+    RigidCompositorHandle handle,
+    const char* export_id,
+    const char* config_json,
+    RigidCompositorProgressCallback progress_callback,
+    RigidCompositorCompletionCallback completion_callback
+) {
+    if (!handle || !config_json) return RIGID_ERROR_INVALID_CONFIG;
+
+    std::string exportId = makeExportId(export_id);
+    auto config = parseConfig(config_json);
+    if (!config) return RIGID_ERROR_INVALID_CONFIG;
+
+    if (!rigid::mediaBackendAvailable()) return RIGID_ERROR_ENCODING_FAILED;
+
+    auto engine = static_cast<CompositorHandle*>(handle)->engine;
+    engine->resetCancellation();
+    std::thread([engine, exportId, config = std::move(*config), progress_callback, completion_callback]() {
+        try {
+            std::string outputPath = engine->render(config, [&](float percent, int64_t current, int64_t total) {
+                if (progress_callback) progress_callback(exportId.c_str(), percent, current, total);
+            });
+            if (completion_callback) completion_callback(exportId.c_str(), RIGID_SUCCESS, outputPath.c_str());
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "VideoCompositor: Render failed: %s\n", e.what());
+            if (completion_callback) completion_callback(exportId.c_str(), RIGID_ERROR_RECORDING_FAILED, e.what());
+        }
+    }).detach();
+
+    return RIGID_SUCCESS;
+}
+
+extern "C" void rigid_compositor_cancel(RigidCompositorHandle handle) {
+    if (!handle) return;
+    static_cast<CompositorHandle*>(handle)->engine->cancel();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CompositorConfig.h"
+
+namespace rigid {
+
+class AudioMixer;
+class SegmentCache;
+struct EncoderSettings;
+struct FrameRange;
+
+/// Thrown out of VideoCompositorEngine::render when cancel() was called
+class RenderCancelled : public std::runtime_error {
+public:
+    RenderCancelled() : std::runtime_error("Render cancelled") {}
+};
+
+/// Progress callback: percent (0-100), frames written, total frames
+using CompositorProgressCallback = std::function<void(float percent, int64_t currentFrame, int64_t totalFrames)>;
+
+/// Linux counterpart of the Swift VideoCompositorEngine.
+///
+/// Decodes every clip with libav, composites each output frame on the CPU
+/// with FrameCompositor, mixes clip audio with AudioMixer and writes an
+/// H.264/AAC MP4 through MediaEncoder. Long timelines on machines with many
+/// cores are split into GOP-aligned chunks that render in parallel and are
+/// joined by stream copy; with `segmentCacheDir` set, unchanged chunks are
+/// reused from earlier exports.
+class VideoCompositorEngine {
+public:
+    /// Render `config` to `config.outputPath` and return that path.
+    /// Throws MediaError on failure and RenderCancelled after cancel().
+    std::string render(const CompositorConfig& config, const CompositorProgressCallback& progress);
+
+    /// Request cancellation; the render stops before the next frame
+    void cancel() { cancelled_ = true; }
+    bool isCancelled() const { return cancelled_; }
+
+    /// Limit the threads a render uses, decoders, compositor and encoder
+    /// together (StageThreads); 0 allows one per core. Set by RenderScheduler
+    /// so concurrent renders share the machine instead of each claiming
+    /// every core.
+    void setThreadBudget(int threads) { threadBudget_ = threads; }
+    int threadBudget() const { return threadBudget_; }
+
+    /// Clear a previous cancel() so the engine can render again. Called on the
+    /// caller's thread before an async render starts, so a cancel() issued
+    /// right after starting is never lost.
+    void resetCancellation() { cancelled_ = false; }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    int threadBudget_ = 0;
+
+    /// Threads this engine may use: the budget, or every core without one
+    int coreCount() const;
+
+    /// Render `chunks` into segments on parallel workers, then join them
+    /// into `settings.outputPath` with the audio mixed once. With a `cache`,
+    /// chunks whose inputs are unchanged reuse the segment from an earlier
+    /// export and new segments are kept for the next one.
+    void renderChunked(const CompositorConfig& config, const EncoderSettings& settings,
+                       const std::vector<FrameRange>& chunks, AudioMixer& mixer, SegmentCache* cache,
+                       const CompositorProgressCallback& progress);
+};
+
+} // namespace rigid
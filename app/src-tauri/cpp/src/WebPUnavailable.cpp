@@ -0,0 +1,19 @@
+// Stand-in used when the library is built without libwebp (see
+// CMakeLists.txt). Screenshots to ".webp" then report
+// RIGID_ERROR_INVALID_CONFIG before capturing anything.
+
+#include "WebPWriter.h"
+
+#include <stdexcept>
+
+namespace rigid {
+
+bool webPEncoderAvailable() {
+    return false;
+}
+
+std::vector<uint8_t> encodeWebP(const uint8_t*, int, int, int, int) {
+    throw std::runtime_error("RigidCaptureKit was built without WebP support");
+}
+
+} // namespace rigid
@@ -0,0 +1,47 @@
+#include "WebPWriter.h"
+
+#include <stdexcept>
+
+#include <webp/encode.h>
+
+namespace rigid {
+
+bool webPEncoderAvailable() {
+    return true;
+}
+
+std::vector<uint8_t> encodeWebP(const uint8_t* pixels, int stride, int width, int height, int effort) {
+    if (width <= 0 || height <= 0) throw std::runtime_error("Cannot encode an empty image");
+
+    WebPConfig config;
+    if (!WebPConfigInit(&config) || !WebPConfigLosslessPreset(&config, effort)) {
+        throw std::runtime_error("WebP configuration failed");
+    }
+    // Let libwebp spread its analysis passes over a second thread
+    config.thread_level = 1;
+
+    WebPPicture picture;
+    if (!WebPPictureInit(&picture)) throw std::runtime_error("WebP configuration failed");
+    picture.use_argb = 1;
+    picture.width = width;
+    picture.height = height;
+    if (!WebPPictureImportBGRX(&picture, pixels, stride)) {
+        WebPPictureFree(&picture);
+        throw std::runtime_error("Out of memory for the WebP encoder");
+    }
+
+    WebPMemoryWriter writer;
+    WebPMemoryWriterInit(&writer);
+    picture.writer = WebPMemoryWrite;
+    picture.custom_ptr = &writer;
+    const bool encoded = WebPEncode(&config, &picture);
+    WebPPictureFree(&picture);
+
+    std::vector<uint8_t> webp;
+    if (encoded) webp.assign(writer.mem, writer.mem + writer.size);
+    WebPMemoryWriterClear(&writer);
+    if (!encoded) throw std::runtime_error("WebP encoding failed");
+    return webp;
+}
+
+} // namespace rigid
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rigid {
+
+/// Whether the library was built with libwebp (see CMakeLists.txt)
+bool webPEncoderAvailable();
+
+/// Encode opaque BGRA pixels as a lossless WebP. `effort` runs from 0
+/// (fastest) to 9 (smallest). Throws std::runtime_error when encoding fails
+/// or libwebp is unavailable.
+std::vector<uint8_t> encodeWebP(const uint8_t* pixels, int stride, int width, int height, int effort);
+
+} // namespace rigid
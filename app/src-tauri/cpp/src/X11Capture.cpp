@@ -0,0 +1,581 @@
+#include "X11Capture.h"
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xcomposite.h>
+#if RIGID_HAVE_XFIXES
+#include <X11/extensions/Xfixes.h>
+#endif
+
+namespace rigid {
+
+namespace {
+
+// MARK: - Errors
+
+/// Xlib reports protocol errors through one process-wide handler, and the
+/// default one exits. Errors raised while a thread holds an ErrorTrap are
+/// recorded instead; any other goes on to the handler installed before ours
+/// (the toolkit's), so the app's own connection behaves as before.
+thread_local bool trapping = false;
+thread_local int trappedError = 0;
+XErrorHandler previousHandler = nullptr;
+
+int handleXError(Display* display, XErrorEvent* event) {
+    if (trapping) {
+        trappedError = event->error_code;
+        return 0;
+    }
+    return previousHandler ? previousHandler(display, event) : 0;
+}
+
+class ErrorTrap {
+public:
+    explicit ErrorTrap(Display* display) : display_(display) {
+        static std::once_flag installed;
+        std::call_once(installed, [] { previousHandler = XSetErrorHandler(handleXError); });
+        trapping = true;
+        trappedError = 0;
+    }
+
+    ~ErrorTrap() {
+        if (!synced_) XSync(display_, False);
+        trapping = false;
+    }
+
+    ErrorTrap(const ErrorTrap&) = delete;
+    ErrorTrap& operator=(const ErrorTrap&) = delete;
+
+    /// Wait for every request so far; true if any of them failed
+    bool failed() {
+        XSync(display_, False);
+        synced_ = true;
+        return trappedError != 0;
+    }
+
+private:
+    Display* display_;
+    bool synced_ = false;
+};
+
+// MARK: - Connection
+
+struct DisplayCloser {
+    void operator()(Display* display) const { XCloseDisplay(display); }
+};
+
+using DisplayPtr = std::unique_ptr<Display, DisplayCloser>;
+
+DisplayPtr openConnection() {
+    DisplayPtr display(XOpenDisplay(nullptr));
+    if (!display) {
+        const char* name = std::getenv("DISPLAY");
+        throw CaptureFailure(RIGID_ERROR_DISPLAY_NOT_FOUND,
+                             std::string("Cannot open X display ") + (name ? name : "(DISPLAY not set)"));
+    }
+    return display;
+}
+
+int screenOf(Display* display, uint32_t displayId) {
+    if (displayId < 1 || displayId > static_cast<uint32_t>(ScreenCount(display))) {
+        throw CaptureFailure(RIGID_ERROR_DISPLAY_NOT_FOUND, "No display " + std::to_string(displayId));
+    }
+    return static_cast<int>(displayId) - 1;
+}
+
+// MARK: - Pixels
+
+/// The layout capture() copies: 8-bit channels at B, G, R, X byte positions
+bool isBgrx(const Visual* visual, Display* display) {
+    return visual->red_mask == 0xff0000 && visual->green_mask == 0xff00 && visual->blue_mask == 0xff &&
+           ImageByteOrder(display) == LSBFirst;
+}
+
+bool isBgrx(const XImage* image) {
+    return image->bits_per_pixel == 32 && image->byte_order == LSBFirst && image->red_mask == 0xff0000 &&
+           image->green_mask == 0xff00 && image->blue_mask == 0xff;
+}
+
+/// Copy BGRX rows out with alpha set to 255. One pass, which the compiler
+/// vectorizes; the alpha byte is whatever the server left there otherwise.
+void copyOpaque(const XImage* image, int width, int height, uint8_t* pixels, int stride) {
+    for (int y = 0; y < height; y++) {
+        const auto* src = reinterpret_cast<const uint32_t*>(image->data + static_cast<size_t>(y) * image->bytes_per_line);
+        auto* dst = reinterpret_cast<uint32_t*>(pixels + static_cast<size_t>(y) * stride);
+        for (int x = 0; x < width; x++) dst[x] = src[x] | 0xff000000u;
+    }
+}
+
+void fillBlack(uint8_t* pixels, int stride, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        auto* dst = reinterpret_cast<uint32_t*>(pixels + static_cast<size_t>(y) * stride);
+        std::fill(dst, dst + width, 0xff000000u);
+    }
+}
+
+#if RIGID_HAVE_XFIXES
+/// Blend the pointer over a frame whose top-left is at (originX, originY)
+/// in root coordinates
+void blendCursor(Display* display, int originX, int originY, uint8_t* pixels, int stride, int width,
+                 int height) {
+    XFixesCursorImage* cursor = XFixesGetCursorImage(display);
+    if (!cursor) return;
+
+    const int left = cursor->x - cursor->xhot - originX;
+    const int top = cursor->y - cursor->yhot - originY;
+    for (int cy = std::max(0, -top); cy < cursor->height && top + cy < height; cy++) {
+        uint8_t* row = pixels + static_cast<size_t>(top + cy) * stride;
+        for (int cx = std::max(0, -left); cx < cursor->width && left + cx < width; cx++) {
+            // Premultiplied ARGB in the low 32 bits of each unsigned long
+            const auto argb = static_cast<uint32_t>(cursor->pixels[cy * cursor->width + cx]);
+            const uint32_t alpha = argb >> 24;
+            if (alpha == 0) continue;
+            const uint32_t inverse = 255 - alpha;
+            uint8_t* p = row + (left + cx) * 4;
+            p[0] = static_cast<uint8_t>((argb & 0xff) + (p[0] * inverse + 127) / 255);
+            p[1] = static_cast<uint8_t>(((argb >> 8) & 0xff) + (p[1] * inverse + 127) / 255);
+            p[2] = static_cast<uint8_t>(((argb >> 16) & 0xff) + (p[2] * inverse + 127) / 255);
+        }
+    }
+    XFree(cursor);
+}
+#endif
+
+// MARK: - Shared memory
+
+/// An XImage in a System V shared memory segment the server writes into
+struct ShmImage {
+    XImage* image = nullptr;
+    XShmSegmentInfo segment{};
+    bool attached = false;
+
+    /// False when the server cannot attach the segment (it is not local)
+    bool create(Display* display, Visual* visual, int depth, int width, int height) {
+        if (!XShmQueryExtension(display)) return false;
+
+        segment.shmid = -1;
+        image = XShmCreateImage(display, visual, static_cast<unsigned>(depth), ZPixmap, nullptr, &segment,
+                                static_cast<unsigned>(width), static_cast<unsigned>(height));
+        if (!image || !isBgrx(image)) {
+            destroy(display);
+            return false;
+        }
+        segment.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(image->bytes_per_line) * image->height,
+                               IPC_CREAT | 0600);
+        if (segment.shmid < 0) {
+            destroy(display);
+            return false;
+        }
+        void* address = shmat(segment.shmid, nullptr, 0);
+        if (address == reinterpret_cast<void*>(-1)) {
+            destroy(display);
+            return false;
+        }
+        segment.shmaddr = image->data = static_cast<char*>(address);
+        segment.readOnly = False;
+
+        ErrorTrap trap(display);
+        attached = XShmAttach(display, &segment) && !trap.failed();
+        // Marked for removal now; the kernel frees it once both sides detach
+        shmctl(segment.shmid, IPC_RMID, nullptr);
+        segment.shmid = -1;
+        if (!attached) {
+            destroy(display);
+            return false;
+        }
+        return true;
+    }
+
+    void destroy(Display* display) {
+        if (attached) {
+            XShmDetach(display, &segment);
+            XSync(display, False);
+            attached = false;
+        }
+        if (image) {
+            image->data = nullptr;
+            XDestroyImage(image);
+            image = nullptr;
+        }
+        if (segment.shmaddr) {
+            shmdt(segment.shmaddr);
+            segment.shmaddr = nullptr;
+        }
+        if (segment.shmid >= 0) {
+            shmctl(segment.shmid, IPC_RMID, nullptr);
+            segment.shmid = -1;
+        }
+    }
+};
+
+// MARK: - Window properties
+
+std::string stringProperty(Display* display, Window window, const char* name, Atom type) {
+    Atom actualType = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char* data = nullptr;
+    std::string text;
+    if (XGetWindowProperty(display, window, XInternAtom(display, name, False), 0, 1024, False, type,
+                           &actualType, &format, &count, &remaining, &data) == Success &&
+        data) {
+        if (actualType == type && format == 8) text.assign(reinterpret_cast<const char*>(data), count);
+        XFree(data);
+    }
+    return text;
+}
+
+/// The window manager's client list (EWMH _NET_CLIENT_LIST), empty without one
+std::vector<Window> clientList(Display* display, Window root) {
+    Atom actualType = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char* data = nullptr;
+    std::vector<Window> windows;
+    if (XGetWindowProperty(display, root, XInternAtom(display, "_NET_CLIENT_LIST", False), 0, 4096, False,
+                           XA_WINDOW, &actualType, &format, &count, &remaining, &data) == Success &&
+        data) {
+        if (actualType == XA_WINDOW && format == 32) {
+            // Format 32 properties come back as longs
+            const auto* ids = reinterpret_cast<const unsigned long*>(data);
+            windows.assign(ids, ids + count);
+        }
+        XFree(data);
+    }
+    return windows;
+}
+
+std::vector<Window> rootChildren(Display* display, Window root) {
+    Window rootReturn = 0;
+    Window parent = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    std::vector<Window> windows;
+    if (XQueryTree(display, root, &rootReturn, &parent, &children, &count) && children) {
+        windows.assign(children, children + count);
+        XFree(children);
+    }
+    return windows;
+}
+
+std::string windowTitle(Display* display, Window window) {
+    std::string title = stringProperty(display, window, "_NET_WM_NAME", XInternAtom(display, "UTF8_STRING", False));
+    if (!title.empty()) return title;
+    char* name = nullptr;
+    if (XFetchName(display, window, &name) && name) {
+        title = name;
+        XFree(name);
+    }
+    return title;
+}
+
+std::string windowOwner(Display* display, Window window) {
+    XClassHint hint{};
+    std::string owner;
+    if (XGetClassHint(display, window, &hint)) {
+        if (hint.res_class) owner = hint.res_class;
+        XFree(hint.res_name);
+        XFree(hint.res_class);
+    }
+    return owner;
+}
+
+} // namespace
+
+// MARK: - Enumeration
+
+std::vector<X11DisplayInfo> listX11Displays() {
+    std::vector<X11DisplayInfo> displays;
+    DisplayPtr display(XOpenDisplay(nullptr));
+    if (!display) return displays;
+
+    Display* d = display.get();
+    for (int screen = 0; screen < ScreenCount(d); screen++) {
+        X11DisplayInfo info;
+        info.id = static_cast<uint32_t>(screen) + 1;
+        info.name = "Screen " + std::to_string(screen) + " (" + DisplayString(d) + ")";
+        info.width = DisplayWidth(d, screen);
+        info.height = DisplayHeight(d, screen);
+        info.isMain = screen == DefaultScreen(d);
+        displays.push_back(std::move(info));
+    }
+    return displays;
+}
+
+std::vector<X11WindowInfo> listX11Windows() {
+    std::vector<X11WindowInfo> windows;
+    DisplayPtr display(XOpenDisplay(nullptr));
+    if (!display) return windows;
+
+    Display* d = display.get();
+    const Window root = DefaultRootWindow(d);
+    std::vector<Window> candidates = clientList(d, root);
+    const bool managed = !candidates.empty();
+    if (!managed) candidates = rootChildren(d, root);
+
+    // Windows can go away while we ask about them
+    ErrorTrap trap(d);
+    for (Window window : candidates) {
+        XWindowAttributes attributes;
+        if (!XGetWindowAttributes(d, window, &attributes)) continue;
+        if (attributes.map_state != IsViewable || attributes.c_class != InputOutput) continue;
+        if (!managed && attributes.override_redirect) continue;
+
+        int x = 0;
+        int y = 0;
+        Window child = 0;
+        if (!XTranslateCoordinates(d, window, root, 0, 0, &x, &y, &child)) continue;
+
+        X11WindowInfo info;
+        info.id = static_cast<uint32_t>(window);
+        info.title = windowTitle(d, window);
+        info.ownerName = windowOwner(d, window);
+        info.x = x;
+        info.y = y;
+        info.width = attributes.width;
+        info.height = attributes.height;
+        windows.push_back(std::move(info));
+    }
+    return windows;
+}
+
+// MARK: - X11CaptureSource
+
+struct X11CaptureSource::Impl {
+    DisplayPtr display;
+    Window root = 0;
+    /// What frames are read from: the root window, or the composite pixmap
+    /// of `window`
+    Drawable drawable = 0;
+    /// Captured window, 0 for a display or region
+    Window window = 0;
+    bool redirected = false;
+    Visual* visual = nullptr;
+    int depth = 0;
+    /// Captured rectangle of `drawable`
+    PixelRect rect;
+    ShmImage shm;
+    bool showCursor = false;
+
+    ~Impl() {
+        Display* d = display.get();
+        shm.destroy(d);
+        if (redirected) {
+            ErrorTrap trap(d);
+            if (drawable) XFreePixmap(d, drawable);
+            XCompositeUnredirectWindow(d, window, CompositeRedirectAutomatic);
+        }
+    }
+
+    /// Set up frame reads, through shared memory if the server allows
+    void prepare(bool cursor) {
+        Display* d = display.get();
+        if (!isBgrx(visual, d) || (depth != 24 && depth != 32)) {
+            throw CaptureFailure(RIGID_ERROR_RECORDING_FAILED,
+                                 "Unsupported X visual (depth " + std::to_string(depth) + "); need 24-bit TrueColor");
+        }
+        shm.create(d, visual, depth, rect.width, rect.height);
+#if RIGID_HAVE_XFIXES
+        int eventBase = 0;
+        int errorBase = 0;
+        showCursor = cursor && XFixesQueryExtension(d, &eventBase, &errorBase);
+#else
+        (void)cursor;
+#endif
+    }
+
+    /// Read `area` of the drawable (within `rect`) into `pixels`. False on a
+    /// protocol error.
+    bool grab(const PixelRect& area, uint8_t* pixels, int stride) {
+        Display* d = display.get();
+        ErrorTrap trap(d);
+        if (shm.image) {
+            if (area.width == rect.width && area.height == rect.height) {
+                if (!XShmGetImage(d, drawable, shm.image, area.x, area.y, AllPlanes) || trap.failed()) return false;
+                copyOpaque(shm.image, area.width, area.height, pixels, stride);
+                return true;
+            }
+            // A smaller image over the start of the same segment, so the
+            // server writes only the area
+            XImage* image = XShmCreateImage(d, visual, static_cast<unsigned>(depth), ZPixmap, shm.segment.shmaddr,
+                                            &shm.segment, static_cast<unsigned>(area.width),
+                                            static_cast<unsigned>(area.height));
+            if (!image) return false;
+            const bool ok = XShmGetImage(d, drawable, image, area.x, area.y, AllPlanes) && !trap.failed();
+            if (ok) copyOpaque(image, area.width, area.height, pixels, stride);
+            image->data = nullptr;
+            XDestroyImage(image);
+            return ok;
+        }
+
+        XImage* image = XGetImage(d, drawable, area.x, area.y, static_cast<unsigned>(area.width),
+                                  static_cast<unsigned>(area.height), AllPlanes, ZPixmap);
+        const bool ok = image && !trap.failed() && isBgrx(image);
+        if (ok) copyOpaque(image, area.width, area.height, pixels, stride);
+        if (image) XDestroyImage(image);
+        return ok;
+    }
+
+    /// Name a fresh composite pixmap for the window; its old one goes stale
+    /// when the window is resized or remapped. False once the window is gone.
+    bool renamePixmap(bool* viewable) {
+        Display* d = display.get();
+        ErrorTrap trap(d);
+        XWindowAttributes attributes;
+        if (!XGetWindowAttributes(d, window, &attributes) || trap.failed()) return false;
+        *viewable = attributes.map_state == IsViewable;
+        if (drawable) XFreePixmap(d, drawable);
+        drawable = *viewable ? XCompositeNameWindowPixmap(d, window) : 0;
+        // The pixmap includes the border
+        rect.x = attributes.border_width;
+        rect.y = attributes.border_width;
+        return true;
+    }
+
+    /// Top-left of the captured pixels in root coordinates
+    void origin(int* x, int* y) {
+        if (!window) {
+            *x = rect.x;
+            *y = rect.y;
+            return;
+        }
+        Window child = 0;
+        if (!XTranslateCoordinates(display.get(), window, root, 0, 0, x, y, &child)) *x = *y = 0;
+    }
+};
+
+X11CaptureSource::X11CaptureSource(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+
+X11CaptureSource::~X11CaptureSource() = default;
+
+std::unique_ptr<X11CaptureSource> X11CaptureSource::openDisplay(uint32_t displayId, bool showCursor) {
+    DisplayPtr display = openConnection();
+    const int screen = screenOf(display.get(), displayId);
+    PixelRect rect{0, 0, DisplayWidth(display.get(), screen), DisplayHeight(display.get(), screen)};
+    display.reset();
+    return openRegion(displayId, rect, showCursor);
+}
+
+std::unique_ptr<X11CaptureSource> X11CaptureSource::openRegion(uint32_t displayId, const PixelRect& rect,
+                                                               bool showCursor) {
+    auto impl = std::make_unique<Impl>();
+    impl->display = openConnection();
+    Display* d = impl->display.get();
+    const int screen = screenOf(d, displayId);
+
+    impl->rect = rect.intersection({0, 0, DisplayWidth(d, screen), DisplayHeight(d, screen)});
+    if (impl->rect.empty()) {
+        throw CaptureFailure(RIGID_ERROR_INVALID_CONFIG, "Region lies outside display " + std::to_string(displayId));
+    }
+    impl->root = RootWindow(d, screen);
+    impl->drawable = impl->root;
+    impl->visual = DefaultVisual(d, screen);
+    impl->depth = DefaultDepth(d, screen);
+    impl->prepare(showCursor);
+    return std::unique_ptr<X11CaptureSource>(new X11CaptureSource(std::move(impl)));
+}
+
+std::unique_ptr<X11CaptureSource> X11CaptureSource::openWindow(uint32_t windowId, bool showCursor) {
+    auto impl = std::make_unique<Impl>();
+    impl->display = openConnection();
+    Display* d = impl->display.get();
+    const Window window = windowId;
+
+    XWindowAttributes attributes;
+    {
+        ErrorTrap trap(d);
+        if (!XGetWindowAttributes(d, window, &attributes) || trap.failed() ||
+            attributes.map_state != IsViewable) {
+            throw CaptureFailure(RIGID_ERROR_WINDOW_NOT_FOUND, "No viewable window " + std::to_string(windowId));
+        }
+    }
+    impl->root = attributes.root;
+
+    int eventBase = 0;
+    int errorBase = 0;
+    if (!XCompositeQueryExtension(d, &eventBase, &errorBase)) {
+        // No composite pixmaps: record the window's rectangle of the screen
+        int x = 0;
+        int y = 0;
+        Window child = 0;
+        XTranslateCoordinates(d, window, attributes.root, 0, 0, &x, &y, &child);
+        const int screen = XScreenNumberOfScreen(attributes.screen);
+        impl.reset();
+        return openRegion(static_cast<uint32_t>(screen) + 1, {x, y, attributes.width, attributes.height},
+                          showCursor);
+    }
+
+    impl->window = window;
+    impl->visual = attributes.visual;
+    impl->depth = attributes.depth;
+    impl->rect = {attributes.border_width, attributes.border_width, attributes.width, attributes.height};
+    {
+        ErrorTrap trap(d);
+        XCompositeRedirectWindow(d, window, CompositeRedirectAutomatic);
+        impl->redirected = true;
+        impl->drawable = XCompositeNameWindowPixmap(d, window);
+        if (trap.failed()) {
+            throw CaptureFailure(RIGID_ERROR_RECORDING_FAILED, "Cannot redirect window " + std::to_string(windowId));
+        }
+    }
+    impl->prepare(showCursor);
+    return std::unique_ptr<X11CaptureSource>(new X11CaptureSource(std::move(impl)));
+}
+
+int X11CaptureSource::width() const {
+    return impl_->rect.width;
+}
+
+int X11CaptureSource::height() const {
+    return impl_->rect.height;
+}
+
+bool X11CaptureSource::usesSharedMemory() const {
+    return impl_->shm.image != nullptr;
+}
+
+bool X11CaptureSource::capture(uint8_t* pixels, int stride) {
+    return captureArea({0, 0, impl_->rect.width, impl_->rect.height}, pixels, stride);
+}
+
+bool X11CaptureSource::captureArea(const PixelRect& area, uint8_t* pixels, int stride) {
+    Impl& s = *impl_;
+    // `rect` moves when a window's pixmap is renamed, so place the area late
+    const auto drawableArea = [&s, &area] {
+        return PixelRect{s.rect.x + area.x, s.rect.y + area.y, area.width, area.height};
+    };
+    if (!s.grab(drawableArea(), pixels, stride)) {
+        // A display that changed size, or a window that was resized,
+        // unmapped or closed
+        if (!s.window) return false;
+        bool viewable = false;
+        if (!s.renamePixmap(&viewable)) return false;
+        if (!viewable || !s.grab(drawableArea(), pixels, stride)) {
+            fillBlack(pixels, stride, area.width, area.height);
+            return true;
+        }
+    }
+#if RIGID_HAVE_XFIXES
+    if (s.showCursor) {
+        int x = 0;
+        int y = 0;
+        s.origin(&x, &y);
+        blendCursor(s.display.get(), x + area.x, y + area.y, pixels, stride, area.width, area.height);
+    }
+#endif
+    return true;
+}
+
+} // namespace rigid
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CaptureSource.h"
+#include "Frame.h"
+
+namespace rigid {
+
+/// A display as rigid_capture_list_displays_json reports it on Linux: one
+/// per X screen of $DISPLAY, with ids counting from 1
+struct X11DisplayInfo {
+    uint32_t id = 0;
+    std::string name;
+    int width = 0;
+    int height = 0;
+    bool isMain = false;
+};
+
+/// A top-level window, positioned in root window coordinates
+struct X11WindowInfo {
+    uint32_t id = 0;
+    std::string title;
+    std::string ownerName;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/// Displays of the X server, empty when none can be opened
+std::vector<X11DisplayInfo> listX11Displays();
+
+/// Viewable top-level windows, in the window manager's client list order
+/// (stacking order of the root's children without one)
+std::vector<X11WindowInfo> listX11Windows();
+
+/// Captures from an X server, through MIT-SHM when the server shares memory
+/// with us and plain XGetImage when it does not (a remote display).
+///
+/// Every source has its own connection, so a recorder's capture thread
+/// never contends with the app's toolkit or with other sources. Pixels
+/// arrive as the server's 32-bit TrueColor layout, which on little-endian
+/// hosts is already BGRX; capture() copies them out with alpha set, in one
+/// pass. With showCursor the XFixes cursor image is blended on top.
+class X11CaptureSource : public CaptureSource {
+public:
+    /// Whole display `displayId` (listX11Displays). Throws CaptureFailure.
+    static std::unique_ptr<X11CaptureSource> openDisplay(uint32_t displayId, bool showCursor);
+
+    /// `rect` of display `displayId`, in its pixels. Only the rectangle is
+    /// transferred from the server. Throws CaptureFailure when it misses
+    /// the display.
+    static std::unique_ptr<X11CaptureSource> openRegion(uint32_t displayId, const PixelRect& rect,
+                                                        bool showCursor);
+
+    /// A window's own contents through XComposite, so overlapping windows do
+    /// not show; without the extension, its rectangle of the screen. The size
+    /// is fixed at open: a window that grows is cropped, one that shrinks
+    /// leaves black. Throws CaptureFailure.
+    static std::unique_ptr<X11CaptureSource> openWindow(uint32_t windowId, bool showCursor);
+
+    ~X11CaptureSource() override;
+
+    X11CaptureSource(const X11CaptureSource&) = delete;
+    X11CaptureSource& operator=(const X11CaptureSource&) = delete;
+
+    int width() const override;
+    int height() const override;
+    bool capture(uint8_t* pixels, int stride) override;
+    /// Reads only `area` from the server, through the same shared memory
+    bool captureArea(const PixelRect& area, uint8_t* pixels, int stride) override;
+
+    /// False when frames come through XGetImage rather than shared memory
+    bool usesSharedMemory() const;
+
+private:
+    struct Impl;
+
+    explicit X11CaptureSource(std::unique_ptr<Impl> impl);
+
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace rigid
@@ -0,0 +1,39 @@
+// Stand-ins used when the library is built without Xlib (see CMakeLists.txt).
+// Nothing is listed and every recording reports RIGID_ERROR_RECORDING_FAILED.
+
+#include "X11Capture.h"
+
+namespace rigid {
+
+namespace {
+
+[[noreturn]] void unavailable() {
+    throw CaptureFailure(RIGID_ERROR_RECORDING_FAILED, "RigidCaptureKit was built without X11 support");
+}
+
+} // namespace
+
+std::vector<X11DisplayInfo> listX11Displays() {
+    return {};
+}
+
+std::vector<X11WindowInfo> listX11Windows() {
+    return {};
+}
+
+struct X11CaptureSource::Impl {};
+
+X11CaptureSource::X11CaptureSource(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+X11CaptureSource::~X11CaptureSource() = default;
+
+std::unique_ptr<X11CaptureSource> X11CaptureSource::openDisplay(uint32_t, bool) { unavailable(); }
+std::unique_ptr<X11CaptureSource> X11CaptureSource::openRegion(uint32_t, const PixelRect&, bool) { unavailable(); }
+std::unique_ptr<X11CaptureSource> X11CaptureSource::openWindow(uint32_t, bool) { unavailable(); }
+
+int X11CaptureSource::width() const { return 0; }
+int X11CaptureSource::height() const { return 0; }
+bool X11CaptureSource::capture(uint8_t*, int) { return false; }
+bool X11CaptureSource::captureArea(const PixelRect&, uint8_t*, int) { return false; }
+bool X11CaptureSource::usesSharedMemory() const { return false; }
+
+} // namespace rigid
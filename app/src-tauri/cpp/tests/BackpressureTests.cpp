@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "Backpressure.h"
+#include "CaptureEngine.h"
+#include "RigidCaptureKit.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Feed one window of `frames` frames, `drops` of them dropped
+bool feedWindow(FrameRateGovernor& governor, int frames, int drops) {
+    bool changed = false;
+    for (int i = 0; i < frames; i++) changed |= governor.frameCaptured(i < drops);
+    return changed;
+}
+
+} // namespace
+
+TEST(BackpressureTests, GovernorLowersRateWhileDroppingAndRecovers) {
+    FrameRateGovernor governor(60);
+    EXPECT_EQ(governor.currentFps(), 60);
+
+    // A drop-free window at the target rate changes nothing
+    EXPECT_FALSE(feedWindow(governor, 60, 0));
+    EXPECT_EQ(governor.currentFps(), 60);
+
+    // Sustained drops step down a quarter at a time, stopping at the floor
+    EXPECT_TRUE(feedWindow(governor, 60, 10));
+    EXPECT_EQ(governor.currentFps(), 45);
+    for (int i = 0; i < 5; i++) feedWindow(governor, governor.currentFps(), 10);
+    EXPECT_EQ(governor.currentFps(), 15);
+
+    // Clean windows climb back to the target, never past it
+    for (int i = 0; i < 5; i++) feedWindow(governor, governor.currentFps(), 0);
+    EXPECT_EQ(governor.currentFps(), 60);
+}
+
+TEST(BackpressureTests, GovernorToleratesOccasionalDrops) {
+    FrameRateGovernor governor(30);
+    ASSERT_TRUE(feedWindow(governor, 30, 10));
+    ASSERT_EQ(governor.currentFps(), 23);
+
+    // A drop within tolerance holds the rate where it is
+    EXPECT_FALSE(feedWindow(governor, 23, 1));
+    EXPECT_EQ(governor.currentFps(), 23);
+    EXPECT_TRUE(feedWindow(governor, 23, 0));
+    EXPECT_EQ(governor.currentFps(), 30);
+    EXPECT_FALSE(feedWindow(governor, 30, 1));
+    EXPECT_EQ(governor.currentFps(), 30);
+}
+
+TEST(BackpressureTests, StatsAverageAndTrackMaximum) {
+    CaptureStats stats;
+    stats.reset(30);
+    stats.frameCaptured(1000);
+    stats.frameCaptured(3000);
+    stats.frameCaptured(2000);
+    stats.frameEncoded(10000);
+    stats.frameEncoded(30000);
+    stats.frameDropped();
+
+    RigidCaptureStats snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.frames_captured, 3u);
+    EXPECT_EQ(snapshot.frames_encoded, 2u);
+    EXPECT_EQ(snapshot.frames_dropped, 1u);
+    EXPECT_DOUBLE_EQ(snapshot.current_fps, 30.0);
+    EXPECT_DOUBLE_EQ(snapshot.processing_avg_ms, 2.0);
+    EXPECT_DOUBLE_EQ(snapshot.processing_max_ms, 3.0);
+    EXPECT_DOUBLE_EQ(snapshot.encoder_latency_avg_ms, 20.0);
+    EXPECT_DOUBLE_EQ(snapshot.encoder_latency_max_ms, 30.0);
+
+    stats.reset(60);
+    snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.frames_captured, 0u);
+    EXPECT_DOUBLE_EQ(snapshot.encoder_latency_avg_ms, 0.0);
+}
+
+TEST(BackpressureTests, SettingsThroughCaptureHandle) {
+    RigidCaptureHandle handle = rigid_capture_create();
+    auto* engine = static_cast<CaptureEngine*>(handle);
+    EXPECT_EQ(engine->backpressure().policy, BackpressurePolicy::DropNewest);
+    EXPECT_EQ(engine->backpressure().queueDepth, BackpressureSettings::kDefaultQueueDepth);
+
+    EXPECT_EQ(rigid_capture_set_backpressure(handle, RIGID_BACKPRESSURE_DROP_OLDEST, 12), RIGID_SUCCESS);
+    EXPECT_EQ(engine->backpressure().policy, BackpressurePolicy::DropOldest);
+    EXPECT_EQ(engine->backpressure().queueDepth, 12u);
+    EXPECT_EQ(engine->backpressure().pendingCapacity(), 10u);
+
+    // 0 restores the default depth; unknown policies are rejected
+    EXPECT_EQ(rigid_capture_set_backpressure(handle, RIGID_BACKPRESSURE_ADAPTIVE_FPS, 0), RIGID_SUCCESS);
+    EXPECT_EQ(engine->backpressure().queueDepth, BackpressureSettings::kDefaultQueueDepth);
+    EXPECT_EQ(rigid_capture_set_backpressure(handle, 7, 0), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(engine->backpressure().policy, BackpressurePolicy::AdaptiveFps);
+
+    RigidCaptureStats stats;
+    ASSERT_EQ(rigid_capture_get_stats(handle, &stats), RIGID_SUCCESS);
+    EXPECT_EQ(stats.frames_captured, 0u);
+    EXPECT_EQ(rigid_capture_get_stats(handle, nullptr), RIGID_ERROR_INVALID_CONFIG);
+
+    rigid_capture_destroy(handle);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "BlendKernels.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Random premultiplied BGRA: every color channel at most alpha
+std::vector<uint8_t> randomPremultiplied(std::mt19937& rng, int pixels) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t> data(static_cast<size_t>(pixels) * 4);
+    for (int i = 0; i < pixels; i++) {
+        int alpha = byte(rng);
+        // Plenty of fully opaque and fully transparent pixels, like real clips
+        if (i % 5 == 0) alpha = 255;
+        if (i % 7 == 0) alpha = 0;
+        std::uniform_int_distribution<int> color(0, alpha);
+        data[i * 4 + 0] = static_cast<uint8_t>(color(rng));
+        data[i * 4 + 1] = static_cast<uint8_t>(color(rng));
+        data[i * 4 + 2] = static_cast<uint8_t>(color(rng));
+        data[i * 4 + 3] = static_cast<uint8_t>(alpha);
+    }
+    return data;
+}
+
+const BlendKernels& scalarKernels() {
+    return *supportedBlendKernels().front();
+}
+
+} // namespace
+
+TEST(BlendKernelsTests, ScalarIsAlwaysSupported) {
+    auto kernels = supportedBlendKernels();
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_STREQ(kernels.front()->name, "scalar");
+    EXPECT_EQ(&blendKernels(), kernels.back());
+}
+
+TEST(BlendKernelsTests, OverMatchesReferenceFormula) {
+    uint8_t dst[8] = {200, 100, 50, 255, 10, 20, 30, 40};
+    const uint8_t src[8] = {60, 0, 0, 128, 0, 0, 0, 0};
+    scalarKernels().over(dst, src, 2);
+
+    // 60 + 200 * 127 / 255, and so on; a transparent source changes nothing
+    EXPECT_EQ(dst[0], 60 + 100);
+    EXPECT_EQ(dst[1], 50);
+    EXPECT_EQ(dst[2], 25);
+    EXPECT_EQ(dst[3], 255);
+    EXPECT_EQ(dst[4], 10);
+    EXPECT_EQ(dst[7], 40);
+}
+
+TEST(BlendKernelsTests, OpacityAndMaskScaleTheSource) {
+    const uint8_t src[4] = {255, 255, 255, 255};
+    uint8_t faded[4] = {0, 0, 0, 255};
+    scalarKernels().overWithOpacity(faded, src, 1, 128);
+    EXPECT_EQ(faded[0], 128);
+    EXPECT_EQ(faded[3], 255);
+
+    const uint8_t mask[2] = {0, 255};
+    uint8_t masked[8] = {0, 0, 0, 255, 0, 0, 0, 255};
+    const uint8_t two[8] = {255, 255, 255, 255, 255, 255, 255, 255};
+    scalarKernels().overMasked(masked, two, mask, 2, 255);
+    EXPECT_EQ(masked[0], 0);
+    EXPECT_EQ(masked[4], 255);
+}
+
+TEST(BlendKernelsTests, EveryKernelSetMatchesScalarExactly) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> byte(0, 255);
+    const BlendKernels& scalar = scalarKernels();
+
+    for (const BlendKernels* kernels : supportedBlendKernels()) {
+        // Lengths around the vector widths exercise the scalar tails
+        for (int pixels : {1, 3, 4, 7, 8, 9, 15, 16, 17, 33, 1440}) {
+            auto src = randomPremultiplied(rng, pixels);
+            auto dst = randomPremultiplied(rng, pixels);
+            std::vector<uint8_t> mask(static_cast<size_t>(pixels));
+            for (uint8_t& m : mask) m = static_cast<uint8_t>(byte(rng));
+            uint8_t opacity = static_cast<uint8_t>(byte(rng));
+
+            auto expected = dst;
+            auto actual = dst;
+            scalar.over(expected.data(), src.data(), pixels);
+            kernels->over(actual.data(), src.data(), pixels);
+            ASSERT_EQ(actual, expected) << kernels->name << " over, " << pixels << " px";
+
+            expected = dst;
+            actual = dst;
+            scalar.overWithOpacity(expected.data(), src.data(), pixels, opacity);
+            kernels->overWithOpacity(actual.data(), src.data(), pixels, opacity);
+            ASSERT_EQ(actual, expected) << kernels->name << " opacity, " << pixels << " px";
+
+            expected = dst;
+            actual = dst;
+            scalar.overMasked(expected.data(), src.data(), mask.data(), pixels, opacity);
+            kernels->overMasked(actual.data(), src.data(), mask.data(), pixels, opacity);
+            ASSERT_EQ(actual, expected) << kernels->name << " masked, " << pixels << " px";
+        }
+    }
+}
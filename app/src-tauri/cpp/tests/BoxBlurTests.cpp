@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "BoxBlur.h"
+#include "Frame.h"
+
+using namespace rigid;
+
+TEST(BoxBlurTests, RadiiMatchGaussianVariance) {
+    for (double sigma : {1.0, 2.5, 10.0, 64.0}) {
+        std::vector<int> radii = gaussianBoxRadii(sigma, BoxBlur::kPasses);
+        ASSERT_EQ(radii.size(), 3u);
+        double variance = 0;
+        for (int radius : radii) {
+            int width = 2 * radius + 1;
+            variance += (width * width - 1) / 12.0;
+        }
+        EXPECT_NEAR(variance, sigma * sigma, sigma * sigma * 0.1 + 1) << "sigma " << sigma;
+    }
+    EXPECT_EQ(gaussianBoxRadii(0, 3), (std::vector<int>{0, 0, 0}));
+}
+
+TEST(BoxBlurTests, UniformRegionIsUnchanged) {
+    Frame frame(64, 32);
+    frame.fill(40, 120, 200);
+    Frame before = frame;
+
+    BoxBlur blur;
+    blur.apply(frame.pixels.data(), frame.width, frame.height, static_cast<size_t>(frame.stride), 12);
+    EXPECT_EQ(frame.pixels, before.pixels);
+}
+
+TEST(BoxBlurTests, ImpulseSpreadsSymmetrically) {
+    Frame frame(41, 41);
+    frame.fill(0, 0, 0);
+    uint8_t* center = frame.pixel(20, 20);
+    center[0] = center[1] = center[2] = 255;
+
+    BoxBlur blur;
+    blur.apply(frame.pixels.data(), frame.width, frame.height, static_cast<size_t>(frame.stride), 1.5);
+
+    EXPECT_LT(frame.pixel(20, 20)[0], 255);
+    EXPECT_GT(frame.pixel(20, 20)[0], frame.pixel(22, 20)[0]);
+    EXPECT_EQ(frame.pixel(18, 20)[0], frame.pixel(22, 20)[0]);
+    EXPECT_EQ(frame.pixel(20, 17)[0], frame.pixel(20, 23)[0]);
+    EXPECT_EQ(frame.pixel(0, 0)[0], 0);
+}
+
+TEST(BoxBlurTests, OnlyTouchesTheRegionAndClampsAtItsEdges) {
+    // Blur a 10x10 window of a frame whose left half is white
+    Frame frame(30, 30);
+    frame.fill(0, 0, 0);
+    for (int y = 0; y < 30; y++) {
+        for (int x = 0; x < 15; x++) {
+            uint8_t* p = frame.pixel(x, y);
+            p[0] = p[1] = p[2] = 255;
+        }
+    }
+
+    BoxBlur blur;
+    // A radius far larger than the region still only averages the region
+    blur.apply(frame.pixel(10, 10), 10, 10, static_cast<size_t>(frame.stride), 200);
+
+    EXPECT_EQ(frame.pixel(9, 10)[0], 255);
+    EXPECT_EQ(frame.pixel(20, 10)[0], 0);
+    int inside = frame.pixel(12, 15)[0];
+    EXPECT_GT(inside, 100);
+    EXPECT_LT(inside, 155);
+    EXPECT_EQ(frame.pixel(12, 15)[3], 255);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "ColorConvert.h"
+#include "Frame.h"
+
+using namespace rigid;
+
+namespace {
+
+Frame randomFrame(int width, int height, unsigned seed) {
+    Frame frame(width, height);
+    std::srand(seed);
+    for (uint8_t& byte : frame.pixels) byte = static_cast<uint8_t>(std::rand() & 0xFF);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) frame.pixel(x, y)[3] = 255;
+    }
+    return frame;
+}
+
+/// Floating-point BT.709 limited range, the reference for the fixed-point paths
+int referenceLuma(const uint8_t* p) {
+    return static_cast<int>(std::lround(16 + 219.0 / 255.0 * (0.2126 * p[2] + 0.7152 * p[1] + 0.0722 * p[0])));
+}
+
+void referenceChroma(const Frame& frame, int cx, int cy, int& u, int& v) {
+    double b = 0, g = 0, r = 0;
+    for (int dy = 0; dy < 2; dy++) {
+        for (int dx = 0; dx < 2; dx++) {
+            const uint8_t* p = frame.pixel(std::min(cx * 2 + dx, frame.width - 1),
+                                           std::min(cy * 2 + dy, frame.height - 1));
+            b += p[0] / 4.0;
+            g += p[1] / 4.0;
+            r += p[2] / 4.0;
+        }
+    }
+    double luma = 0.2126 * r + 0.7152 * g + 0.0722 * b;
+    u = static_cast<int>(std::lround(128 + 224.0 / 255.0 * (b - luma) / 1.8556));
+    v = static_cast<int>(std::lround(128 + 224.0 / 255.0 * (r - luma) / 1.5748));
+}
+
+void expectMatchesReference(const Frame& frame) {
+    for (int y = 0; y < frame.height; y++) {
+        for (int x = 0; x < frame.width; x++) {
+            int expected = referenceLuma(frame.pixel(x, y));
+            int actual = frame.yuv.y[static_cast<size_t>(y) * frame.width + x];
+            ASSERT_LE(std::abs(actual - expected), 1) << "Y at " << x << "," << y;
+        }
+    }
+    for (int cy = 0; cy < frame.yuv.chromaHeight(); cy++) {
+        for (int cx = 0; cx < frame.yuv.chromaWidth(); cx++) {
+            int u = 0, v = 0;
+            referenceChroma(frame, cx, cy, u, v);
+            size_t index = static_cast<size_t>(cy) * frame.yuv.chromaWidth() + cx;
+            ASSERT_LE(std::abs(frame.yuv.u[index] - u), 1) << "U at " << cx << "," << cy;
+            ASSERT_LE(std::abs(frame.yuv.v[index] - v), 1) << "V at " << cx << "," << cy;
+        }
+    }
+}
+
+} // namespace
+
+TEST(ColorConvertTests, PrimariesMapToLimitedRange) {
+    struct Case {
+        uint8_t b, g, r;
+        int y, u, v;
+    };
+    const Case cases[] = {
+        {255, 255, 255, 235, 128, 128},
+        {0, 0, 0, 16, 128, 128},
+        {0, 0, 255, 63, 102, 240},
+        {0, 255, 0, 173, 42, 26},
+        {255, 0, 0, 32, 240, 118},
+    };
+    for (const Case& c : cases) {
+        Frame frame(4, 2);
+        frame.fill(c.b, c.g, c.r);
+        convertBgraToYuv420(frame);
+        EXPECT_EQ(frame.yuv.y[0], c.y) << int(c.b) << "," << int(c.g) << "," << int(c.r);
+        EXPECT_EQ(frame.yuv.u[0], c.u) << int(c.b) << "," << int(c.g) << "," << int(c.r);
+        EXPECT_EQ(frame.yuv.v[0], c.v) << int(c.b) << "," << int(c.g) << "," << int(c.r);
+    }
+}
+
+TEST(ColorConvertTests, VectorAndScalarColumnsMatchReference) {
+    // 37 columns: whole vector steps plus an odd scalar tail
+    for (int height : {6, 7}) {
+        Frame frame = randomFrame(37, height, 11);
+        convertBgraToYuv420(frame);
+        ASSERT_EQ(frame.yuv.chromaWidth(), 19);
+        expectMatchesReference(frame);
+    }
+}
+
+TEST(ColorConvertTests, RectsMatchWholeFrame) {
+    Frame frame = randomFrame(70, 45, 5);
+    convertBgraToYuv420(frame);
+
+    YuvImage tiled;
+    tiled.allocate(frame.width, frame.height);
+    YuvPlanes planes = planesOf(tiled);
+    for (int y = 0; y < frame.height; y += 16) {
+        for (int x = 0; x < frame.width; x += 32) {
+            PixelRect rect = PixelRect{x, y, 32, 16}.intersection({0, 0, frame.width, frame.height});
+            convertBgraToYuv420(frame, rect, planes);
+        }
+    }
+    EXPECT_EQ(tiled.y, frame.yuv.y);
+    EXPECT_EQ(tiled.u, frame.yuv.u);
+    EXPECT_EQ(tiled.v, frame.yuv.v);
+}
+
+TEST(ColorConvertTests, Nv12InterleavesTheI420Planes) {
+    Frame frame = randomFrame(50, 20, 3);
+    convertBgraToYuv420(frame);
+
+    const int chromaWidth = frame.yuv.chromaWidth();
+    std::vector<uint8_t> luma(frame.yuv.y.size());
+    std::vector<uint8_t> uv(static_cast<size_t>(chromaWidth) * 2 * frame.yuv.chromaHeight());
+    YuvPlanes planes;
+    planes.y = luma.data();
+    planes.yStride = frame.width;
+    planes.u = uv.data();
+    planes.uStride = chromaWidth * 2;
+    planes.interleaved = true;
+    convertBgraToYuv420(frame, {0, 0, frame.width, frame.height}, planes);
+
+    EXPECT_EQ(luma, frame.yuv.y);
+    for (size_t i = 0; i < frame.yuv.u.size(); i++) {
+        ASSERT_EQ(uv[i * 2], frame.yuv.u[i]) << i;
+        ASSERT_EQ(uv[i * 2 + 1], frame.yuv.v[i]) << i;
+    }
+}
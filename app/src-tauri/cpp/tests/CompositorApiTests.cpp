@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "MediaDecoder.h"
+#include "RigidCaptureKit.h"
+
+namespace {
+
+const char* kMinimalConfig = R"({
+    "width": 64, "height": 36, "frame_rate": 30, "duration_ms": 100,
+    "format": "mp4", "quality": "draft", "output_path": "/nonexistent/dir/out.mp4",
+    "clips": []
+})";
+
+} // namespace
+
+TEST(CompositorApiTests, HandlesAreIndependent) {
+    RigidCompositorHandle first = rigid_compositor_create();
+    RigidCompositorHandle second = rigid_compositor_create();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+
+    // Cancelling one handle must not affect the other
+    rigid_compositor_cancel(first);
+
+    rigid_compositor_destroy(first);
+    rigid_compositor_destroy(second);
+}
+
+TEST(CompositorApiTests, NullHandleIsRejected) {
+    EXPECT_EQ(rigid_compositor_render(nullptr, "id", kMinimalConfig, nullptr), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_compositor_render_async(nullptr, "id", kMinimalConfig, nullptr, nullptr),
+              RIGID_ERROR_INVALID_CONFIG);
+    rigid_compositor_cancel(nullptr);
+    rigid_compositor_destroy(nullptr);
+}
+
+TEST(CompositorApiTests, InvalidConfigIsRejected) {
+    RigidCompositorHandle handle = rigid_compositor_create();
+    EXPECT_EQ(rigid_compositor_render(handle, "id", "{}", nullptr), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_compositor_render_async(handle, "id", nullptr, nullptr, nullptr), RIGID_ERROR_INVALID_CONFIG);
+    rigid_compositor_destroy(handle);
+}
+
+TEST(CompositorApiTests, ReportsMissingMediaBackend) {
+    if (rigid::mediaBackendAvailable()) GTEST_SKIP() << "Built with libav";
+
+    RigidCompositorHandle handle = rigid_compositor_create();
+    EXPECT_EQ(rigid_compositor_render_async(handle, "id", kMinimalConfig, nullptr, nullptr),
+              RIGID_ERROR_ENCODING_FAILED);
+    rigid_compositor_destroy(handle);
+}
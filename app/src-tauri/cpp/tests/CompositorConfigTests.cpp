@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include "CompositorConfig.h"
+#include "Json.h"
+
+using namespace rigid;
+
+namespace {
+
+// Shape of the JSON built by `render_demo_native` in commands/video.rs,
+// including the explicit nulls serde_json emits for unset options.
+const char* kRenderDemoJson = R"({
+    "width": 1920,
+    "height": 1080,
+    "frame_rate": 30,
+    "duration_ms": 2500,
+    "format": "mp4",
+    "quality": "high",
+    "output_path": "/tmp/out.mp4",
+    "background": {
+        "background_type": "gradient",
+        "color": null,
+        "gradient_stops": [{"color": "#ff0000", "position": 0}, {"color": "#0000ff", "position": 100}],
+        "gradient_angle": 90,
+        "image_url": null,
+        "media_path": null
+    },
+    "clips": [{
+        "source_path": "/tmp/a.mov",
+        "source_type": "video",
+        "start_time_ms": 0,
+        "duration_ms": 2500,
+        "in_point_ms": 500,
+        "position_x": null,
+        "position_y": null,
+        "scale": 0.9,
+        "opacity": null,
+        "corner_radius": 12,
+        "crop_top": null,
+        "crop_bottom": null,
+        "crop_left": null,
+        "crop_right": null,
+        "z_index": 1,
+        "has_audio": true,
+        "track_id": "track-1",
+        "muted": null,
+        "speed": 8.0,
+        "freeze_frame": null,
+        "freeze_frame_time_ms": null,
+        "transition_in_type": "fade",
+        "transition_in_duration_ms": 300,
+        "transition_out_type": null,
+        "transition_out_duration_ms": null,
+        "audio_fade_in_ms": null,
+        "audio_fade_out_ms": 1000
+    }],
+    "zoom_clips": [{
+        "target_track_id": "track-1",
+        "start_time_ms": 100,
+        "duration_ms": 1000,
+        "zoom_scale": 2.0,
+        "zoom_center_x": 25,
+        "zoom_center_y": 75,
+        "ease_in_duration_ms": 200,
+        "ease_out_duration_ms": 200
+    }],
+    "blur_clips": null,
+    "pan_clips": null
+})";
+
+} // namespace
+
+TEST(CompositorConfigTests, ParsesRenderDemoJson) {
+    CompositorConfig config = CompositorConfig::fromJson(kRenderDemoJson);
+
+    EXPECT_EQ(config.width, 1920);
+    EXPECT_EQ(config.height, 1080);
+    EXPECT_EQ(config.frameRate, 30);
+    EXPECT_EQ(config.totalFrames(), 75);
+    EXPECT_EQ(config.quality, CompositorQuality::High);
+
+    ASSERT_TRUE(config.background.has_value());
+    EXPECT_EQ(config.background->backgroundType, BackgroundType::Gradient);
+    ASSERT_TRUE(config.background->gradientStops.has_value());
+    EXPECT_EQ(config.background->gradientStops->size(), 2u);
+    EXPECT_EQ(config.background->gradientAngle, 90);
+    EXPECT_FALSE(config.background->mediaPath.has_value());
+
+    ASSERT_EQ(config.clips.size(), 1u);
+    const CompositorClip& clip = config.clips[0];
+    EXPECT_EQ(clip.sourceType, ClipSourceType::Video);
+    EXPECT_EQ(clip.inPointMs, 500);
+    EXPECT_DOUBLE_EQ(*clip.scale, 0.9);
+    EXPECT_FALSE(clip.positionX.has_value());
+    EXPECT_EQ(clip.transitionInType, "fade");
+    EXPECT_EQ(clip.audioFadeOutMs, 1000);
+    EXPECT_DOUBLE_EQ(clip.clampedSpeed(), 4.0);
+
+    ASSERT_TRUE(config.zoomClips.has_value());
+    EXPECT_DOUBLE_EQ((*config.zoomClips)[0].zoomCenterY, 75);
+    EXPECT_FALSE(config.blurClips.has_value());
+    EXPECT_FALSE(config.panClips.has_value());
+}
+
+TEST(CompositorConfigTests, RejectsMissingRequiredKeys) {
+    EXPECT_THROW(CompositorConfig::fromJson(R"({"width": 100})"), JsonError);
+    EXPECT_THROW(CompositorConfig::fromJson("not json"), JsonError);
+}
+
+TEST(CompositorConfigTests, RejectsUnknownEnumValues) {
+    std::string json = kRenderDemoJson;
+    json.replace(json.find("\"high\""), 6, "\"ultra\"");
+    EXPECT_THROW(CompositorConfig::fromJson(json), JsonError);
+}
+
+TEST(CompositorConfigTests, RejectsNonPositiveDimensions) {
+    std::string json = kRenderDemoJson;
+    json.replace(json.find("1920"), 4, "0");
+    EXPECT_THROW(CompositorConfig::fromJson(json), JsonError);
+}
+
+TEST(CompositorConfigTests, BitrateScalesWithResolution) {
+    EXPECT_EQ(bitrateForQuality(CompositorQuality::Good, 1920, 1080), 12'000'000);
+    EXPECT_EQ(bitrateForQuality(CompositorQuality::Good, 2560, 1440), 24'000'000);
+    EXPECT_EQ(bitrateForQuality(CompositorQuality::Max, 3840, 2160), 200'000'000);
+    EXPECT_EQ(bitrateForQuality(CompositorQuality::Draft, 1280, 720), 2'000'000);
+}
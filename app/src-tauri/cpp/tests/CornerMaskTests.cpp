@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "CornerMask.h"
+
+using namespace rigid;
+
+TEST(CornerMaskTests, ClearsCornersAndKeepsInterior) {
+    CornerMask mask(40, 30, 10);
+    EXPECT_EQ(mask.extent(), 10);
+    EXPECT_EQ(mask.at(0, 0), 0);
+    EXPECT_EQ(mask.at(39, 29), 0);
+    EXPECT_EQ(mask.at(20, 15), 255);
+    EXPECT_EQ(mask.at(20, 0), 255);
+    EXPECT_EQ(mask.at(0, 15), 255);
+
+    // Anti-aliased along the arc, and the four corners mirror each other
+    uint8_t edge = mask.at(2, 3);
+    EXPECT_GT(edge, 0);
+    EXPECT_LT(edge, 255);
+    EXPECT_EQ(mask.at(37, 3), edge);
+    EXPECT_EQ(mask.at(2, 26), edge);
+    EXPECT_EQ(mask.at(37, 26), edge);
+}
+
+TEST(CornerMaskTests, SamplingOutsideTheTilesIsFullyCovered) {
+    CornerMask mask(40, 40, 6);
+    EXPECT_FALSE(mask.touchesRow(20));
+    EXPECT_TRUE(mask.touchesRow(2.5));
+    EXPECT_TRUE(mask.touchesRow(38));
+    EXPECT_EQ(mask.sample(20, 1), 255);
+    EXPECT_EQ(mask.sample(0, 0), 0);
+    EXPECT_EQ(mask.sample(-3, -3), 0);
+}
+
+TEST(CornerMaskTests, RadiusIsClampedToHalfTheShortSide) {
+    CornerMask mask(20, 8, 50);
+    EXPECT_EQ(mask.extent(), 4);
+    EXPECT_EQ(CornerMask(20, 8, 0).extent(), 0);
+    EXPECT_FALSE(CornerMask(20, 8, 0).touchesRow(0));
+}
+
+TEST(CornerMaskTests, CacheReusesMasksForTheSameSize) {
+    CornerMaskCache cache;
+    const CornerMask* first = &cache.maskFor(100, 50, 12);
+    cache.maskFor(80, 50, 12);
+    EXPECT_EQ(&cache.maskFor(100, 50, 12), first);
+    EXPECT_EQ(cache.size(), 2u);
+
+    // Masks handed out stay alive until the cache is trimmed
+    for (int width = 1; width <= 20; width++) cache.maskFor(width, 50, 12);
+    EXPECT_EQ(cache.size(), 22u);
+    cache.trim();
+    EXPECT_EQ(cache.size(), 8u);
+}
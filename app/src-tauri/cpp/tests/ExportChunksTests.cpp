@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ExportChunks.h"
+
+using namespace rigid;
+
+TEST(ExportChunksTests, ShortTimelineStaysWhole) {
+    auto chunks = planExportChunks(1000, 60, 8, 900);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0].start, 0);
+    EXPECT_EQ(chunks[0].end, 1000);
+}
+
+TEST(ExportChunksTests, SingleWorkerStaysWhole) {
+    auto chunks = planExportChunks(100000, 60, 1, 900);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0].end, 100000);
+}
+
+TEST(ExportChunksTests, ChunksAreGopAlignedAndCoverEveryFrame) {
+    // 30 minutes at 30 fps, 2 s GOPs, 30 s minimum chunk
+    const int64_t total = 30 * 60 * 30;
+    auto chunks = planExportChunks(total, 60, 8, 900);
+
+    ASSERT_EQ(chunks.size(), 16u);
+    int64_t expectedStart = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        EXPECT_EQ(chunks[i].start, expectedStart);
+        EXPECT_GT(chunks[i].count(), 0);
+        if (i + 1 < chunks.size()) EXPECT_EQ(chunks[i].count() % 60, 0) << "chunk " << i;
+        expectedStart = chunks[i].end;
+    }
+    EXPECT_EQ(expectedStart, total);
+}
+
+TEST(ExportChunksTests, MinimumChunkLengthLimitsSplits) {
+    // Three minimum-length chunks fit, even though eight workers could take more
+    auto chunks = planExportChunks(2700, 60, 8, 900);
+    ASSERT_EQ(chunks.size(), 3u);
+    EXPECT_EQ(chunks.back().end, 2700);
+}
+
+TEST(ExportChunksTests, EmptyTimelineHasNoChunks) {
+    EXPECT_TRUE(planExportChunks(0, 60, 8, 900).empty());
+}
+
+TEST(ExportChunksTests, FixedChunksDependOnlyOnLength) {
+    auto chunks = splitIntoChunks(1000, 300);
+    ASSERT_EQ(chunks.size(), 4u);
+    EXPECT_EQ(chunks[1].start, 300);
+    EXPECT_EQ(chunks[3].start, 900);
+    EXPECT_EQ(chunks[3].end, 1000);
+
+    // A longer timeline keeps the same leading boundaries
+    auto longer = splitIntoChunks(1300, 300);
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_EQ(longer[i].start, chunks[i].start);
+        EXPECT_EQ(longer[i].end, chunks[i].end);
+    }
+}
@@ -0,0 +1,468 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ColorConvert.h"
+#include "FrameCompositor.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Serves one solid-color frame per clip
+class SolidClipSource : public ClipFrameSource {
+public:
+    void setClipColor(size_t index, int width, int height, uint8_t b, uint8_t g, uint8_t r) {
+        Frame frame(width, height);
+        frame.fill(b, g, r);
+        frames_[index] = std::move(frame);
+    }
+
+    void setClipFrame(size_t index, Frame frame) { frames_[index] = std::move(frame); }
+
+    const Frame* frameForClip(size_t clipIndex, double) override {
+        auto it = frames_.find(clipIndex);
+        return it == frames_.end() ? nullptr : &it->second;
+    }
+
+    const Frame* backgroundImage() override { return nullptr; }
+
+private:
+    std::map<size_t, Frame> frames_;
+};
+
+CompositorConfig makeConfig(int width, int height) {
+    CompositorConfig config;
+    config.width = width;
+    config.height = height;
+    config.frameRate = 30;
+    config.durationMs = 1000;
+    config.format = "mp4";
+    config.outputPath = "/tmp/unused.mp4";
+    return config;
+}
+
+CompositorClip makeClip(int zIndex) {
+    CompositorClip clip;
+    clip.sourcePath = "synthetic";
+    clip.sourceType = ClipSourceType::Video;
+    clip.startTimeMs = 0;
+    clip.durationMs = 1000;
+    clip.zIndex = zIndex;
+    clip.scale = 1.0;
+    return clip;
+}
+
+void expectPixel(const Frame& frame, int x, int y, int b, int g, int r, int tolerance = 1) {
+    const uint8_t* p = frame.pixel(x, y);
+    EXPECT_NEAR(p[0], b, tolerance) << "at " << x << "," << y;
+    EXPECT_NEAR(p[1], g, tolerance) << "at " << x << "," << y;
+    EXPECT_NEAR(p[2], r, tolerance) << "at " << x << "," << y;
+}
+
+/// Opaque frame with a different color in every pixel, so sampling errors show
+Frame patternFrame(int width, int height) {
+    Frame frame(width, height);
+    frame.fill(0, 0, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = frame.pixel(x, y);
+            p[0] = static_cast<uint8_t>(x * 37 + y * 11);
+            p[1] = static_cast<uint8_t>(x * 5 + y * 53);
+            p[2] = static_cast<uint8_t>(x * y);
+        }
+    }
+    return frame;
+}
+
+/// Render `clip` over a gradient into a frame pre-filled with garbage, with
+/// the clip frame flagged opaque or not. The opaque render skips the covered
+/// background, so both must come out identical.
+Frame renderOverGarbage(const CompositorClip& clip, bool opaque, CompositorQuality quality = CompositorQuality::Good) {
+    CompositorConfig config = makeConfig(48, 32);
+    config.quality = quality;
+    config.background = CompositorBackground{};
+    config.background->backgroundType = BackgroundType::Gradient;
+    config.background->gradientStops = std::vector<GradientStop>{{"#000000", 0}, {"#ffffff", 1}};
+    config.background->gradientAngle = 0;
+    config.clips.push_back(clip);
+    if (clip.trackId) {
+        CompositorZoomClip zoom;
+        zoom.targetTrackId = *clip.trackId;
+        zoom.startTimeMs = 0;
+        zoom.durationMs = 1000;
+        zoom.zoomScale = 2.0;
+        zoom.zoomCenterX = 30;
+        zoom.zoomCenterY = 70;
+        zoom.easeInDurationMs = 0;
+        zoom.easeOutDurationMs = 0;
+        config.zoomClips = std::vector<CompositorZoomClip>{zoom};
+    }
+
+    Frame frame = patternFrame(40, 30);
+    frame.opaque = opaque;
+    SolidClipSource source;
+    source.setClipFrame(0, std::move(frame));
+    FrameCompositor compositor(config, source);
+
+    Frame output(48, 32);
+    output.fill(7, 99, 201);
+    compositor.renderFrame(0.5, output);
+    return output;
+}
+
+} // namespace
+
+TEST(FrameCompositorTests, DefaultBackgroundWithoutClips) {
+    CompositorConfig config = makeConfig(16, 8);
+    SolidClipSource source;
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    ASSERT_EQ(output.width, 16);
+    ASSERT_EQ(output.height, 8);
+    expectPixel(output, 0, 0, 46, 26, 26, 0);
+    expectPixel(output, 15, 7, 46, 26, 26, 0);
+}
+
+TEST(FrameCompositorTests, SolidBackgroundColor) {
+    CompositorConfig config = makeConfig(8, 8);
+    config.background = CompositorBackground{};
+    config.background->color = "#ff8000";
+    SolidClipSource source;
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    expectPixel(output, 4, 4, 0x00, 0x80, 0xff, 0);
+}
+
+TEST(FrameCompositorTests, HorizontalGradientRunsLeftToRight) {
+    CompositorConfig config = makeConfig(64, 4);
+    CompositorBackground bg;
+    bg.backgroundType = BackgroundType::Gradient;
+    bg.gradientStops = std::vector<GradientStop>{{"#000000", 0}, {"#ffffff", 100}};
+    bg.gradientAngle = 0;
+    config.background = bg;
+    SolidClipSource source;
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    EXPECT_LT(output.pixel(0, 2)[0], output.pixel(32, 2)[0]);
+    EXPECT_LT(output.pixel(32, 2)[0], output.pixel(63, 2)[0]);
+}
+
+TEST(FrameCompositorTests, FullScaleClipCoversFrame) {
+    CompositorConfig config = makeConfig(32, 18);
+    config.clips.push_back(makeClip(0));
+    SolidClipSource source;
+    source.setClipColor(0, 64, 36, 10, 200, 30);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0.5, output);
+    expectPixel(output, 0, 0, 10, 200, 30);
+    expectPixel(output, 31, 17, 10, 200, 30);
+}
+
+TEST(FrameCompositorTests, ClipOutsideItsTimeRangeIsSkipped) {
+    CompositorConfig config = makeConfig(8, 8);
+    CompositorClip clip = makeClip(0);
+    clip.startTimeMs = 500;
+    clip.durationMs = 200;
+    config.clips.push_back(clip);
+    SolidClipSource source;
+    source.setClipColor(0, 8, 8, 255, 255, 255);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0.1, output);
+    expectPixel(output, 4, 4, 46, 26, 26, 0);
+    compositor.renderFrame(0.6, output);
+    expectPixel(output, 4, 4, 255, 255, 255);
+    compositor.renderFrame(0.7, output);
+    expectPixel(output, 4, 4, 46, 26, 26, 0);
+}
+
+TEST(FrameCompositorTests, HigherZIndexDrawsOnTop) {
+    CompositorConfig config = makeConfig(16, 16);
+    config.clips.push_back(makeClip(5));  // Listed first but on top
+    config.clips.push_back(makeClip(1));
+    SolidClipSource source;
+    source.setClipColor(0, 16, 16, 0, 0, 255);
+    source.setClipColor(1, 16, 16, 255, 0, 0);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    expectPixel(output, 8, 8, 0, 0, 255);
+}
+
+TEST(FrameCompositorTests, OpacityBlendsWithBackground) {
+    CompositorConfig config = makeConfig(8, 8);
+    config.background = CompositorBackground{};
+    config.background->color = "#000000";
+    CompositorClip clip = makeClip(0);
+    clip.opacity = 0.5;
+    config.clips.push_back(clip);
+    SolidClipSource source;
+    source.setClipColor(0, 8, 8, 200, 200, 200);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    expectPixel(output, 4, 4, 100, 100, 100);
+}
+
+TEST(FrameCompositorTests, DefaultScaleLeavesBorder) {
+    CompositorConfig config = makeConfig(100, 100);
+    CompositorClip clip = makeClip(0);
+    clip.scale.reset();  // Default 0.8
+    config.clips.push_back(clip);
+    SolidClipSource source;
+    source.setClipColor(0, 50, 50, 255, 255, 255);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    expectPixel(output, 5, 50, 46, 26, 26, 0);   // Outside the 80px box
+    expectPixel(output, 50, 50, 255, 255, 255);  // Center
+    expectPixel(output, 88, 50, 255, 255, 255);  // Just inside the right edge
+}
+
+TEST(FrameCompositorTests, CornerRadiusClearsCorners) {
+    CompositorConfig config = makeConfig(40, 40);
+    CompositorClip clip = makeClip(0);
+    clip.cornerRadius = 10;
+    config.clips.push_back(clip);
+    SolidClipSource source;
+    source.setClipColor(0, 40, 40, 255, 255, 255);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    expectPixel(output, 0, 0, 46, 26, 26, 2);
+    expectPixel(output, 20, 20, 255, 255, 255);
+    expectPixel(output, 20, 0, 255, 255, 255);
+}
+
+TEST(FrameCompositorTests, FadeInStartsTransparent) {
+    CompositorConfig config = makeConfig(8, 8);
+    CompositorClip clip = makeClip(0);
+    clip.transitionInType = "fade";
+    clip.transitionInDurationMs = 500;
+    config.clips.push_back(clip);
+    SolidClipSource source;
+    source.setClipColor(0, 8, 8, 255, 255, 255);
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    expectPixel(output, 4, 4, 46, 26, 26, 1);
+    compositor.renderFrame(0.6, output);
+    expectPixel(output, 4, 4, 255, 255, 255);
+}
+
+TEST(FrameCompositorTests, BlurSoftensEdgeInsideRegionOnly) {
+    CompositorConfig config = makeConfig(40, 20);
+    CompositorClip clip = makeClip(0);
+    config.clips.push_back(clip);
+    SolidClipSource source;
+    // Left half black, right half white
+    Frame& frame = [&]() -> Frame& {
+        source.setClipColor(0, 40, 20, 0, 0, 0);
+        return *const_cast<Frame*>(source.frameForClip(0, 0));
+    }();
+    for (int y = 0; y < 20; y++) {
+        for (int x = 20; x < 40; x++) {
+            uint8_t* p = frame.pixel(x, y);
+            p[0] = p[1] = p[2] = 255;
+        }
+    }
+
+    CompositorBlurClip blur;
+    blur.startTimeMs = 0;
+    blur.durationMs = 1000;
+    blur.blurIntensity = 20;
+    // Region is given by its center: x 10-30, y 0-10
+    blur.regionX = 50;
+    blur.regionY = 25;
+    blur.regionWidth = 50;
+    blur.regionHeight = 50;
+    config.blurClips = std::vector<CompositorBlurClip>{blur};
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    // Inside the region the hard edge is smeared
+    int nearEdge = output.pixel(19, 5)[0];
+    EXPECT_GT(nearEdge, 10);
+    EXPECT_LT(nearEdge, 245);
+    // Below the region the edge stays sharp
+    expectPixel(output, 19, 15, 0, 0, 0);
+    expectPixel(output, 20, 15, 255, 255, 255);
+}
+
+TEST(FrameCompositorTests, BackgroundIsRestoredEveryFrame) {
+    CompositorConfig config = makeConfig(8, 8);
+    config.background = CompositorBackground{};
+    config.background->color = "#ff8000";
+    SolidClipSource source;
+    FrameCompositor compositor(config, source);
+
+    Frame output;
+    compositor.renderFrame(0, output);
+    output.fill(1, 2, 3);
+    compositor.renderFrame(0.1, output);
+    expectPixel(output, 4, 4, 0, 128, 255, 0);
+}
+
+TEST(FrameCompositorTests, OpaqueClipSkipsOnlyCoveredBackground) {
+    std::vector<CompositorClip> clips;
+
+    CompositorClip fullFrame = makeClip(0);
+    clips.push_back(fullFrame);
+
+    CompositorClip scaledDown = makeClip(0);
+    scaledDown.scale = 0.6;
+    scaledDown.positionX = 20.3;
+    scaledDown.positionY = 13.7;
+    clips.push_back(scaledDown);
+
+    CompositorClip rounded = makeClip(0);
+    rounded.scale = 0.8;
+    rounded.cornerRadius = 6;
+    clips.push_back(rounded);
+
+    CompositorClip cropped = makeClip(0);
+    cropped.cropLeft = 10;
+    cropped.cropTop = 20;
+    clips.push_back(cropped);
+
+    CompositorClip zoomed = makeClip(0);
+    zoomed.trackId = "screen";
+    clips.push_back(zoomed);
+
+    // Wider filters read further from each sample, so the opaque interior shrinks
+    for (CompositorQuality quality : {CompositorQuality::Good, CompositorQuality::Max}) {
+        for (size_t i = 0; i < clips.size(); i++) {
+            SCOPED_TRACE("clip variant " + std::to_string(i) + ", quality " + std::to_string(static_cast<int>(quality)));
+            Frame skipped = renderOverGarbage(clips[i], true, quality);
+            Frame full = renderOverGarbage(clips[i], false, quality);
+            ASSERT_EQ(skipped.pixels.size(), full.pixels.size());
+            size_t mismatches = 0;
+            for (size_t b = 0; b < full.pixels.size(); b++) {
+                if (std::abs(static_cast<int>(skipped.pixels[b]) - full.pixels[b]) > 1) mismatches++;
+            }
+            EXPECT_EQ(mismatches, 0u);
+        }
+    }
+}
+
+TEST(FrameCompositorTests, ThreadedTilesMatchSingleThread) {
+    CompositorConfig config = makeConfig(300, 200);
+    config.quality = CompositorQuality::High;
+    CompositorClip clip = makeClip(0);
+    clip.scale = 0.7;
+    clip.cornerRadius = 12;
+    config.clips.push_back(clip);
+    CompositorBlurClip blur;
+    blur.durationMs = 1000;
+    blur.blurIntensity = 8;
+    blur.regionX = 40;
+    blur.regionY = 50;
+    blur.regionWidth = 30;
+    blur.regionHeight = 30;
+    config.blurClips = std::vector<CompositorBlurClip>{blur};
+
+    SolidClipSource source;
+    source.setClipFrame(0, patternFrame(160, 120));
+    FrameCompositor single(config, source, 1);
+    FrameCompositor threaded(config, source, 4);
+
+    Frame expected;
+    Frame actual;
+    single.renderFrame(0.5, expected);
+    threaded.renderFrame(0.5, actual);
+    EXPECT_EQ(actual.pixels, expected.pixels);
+}
+
+TEST(FrameCompositorTests, StaticTilesAreReusedAndMovingContentIsNot) {
+    // A still image clip in the left half, a video clip in the right half
+    CompositorConfig config = makeConfig(512, 256);
+    CompositorClip still = makeClip(0);
+    still.sourceType = ClipSourceType::Image;
+    still.scale = 0.4;
+    still.positionX = 128;
+    config.clips.push_back(still);
+    CompositorClip video = makeClip(1);
+    video.scale = 0.4;
+    video.positionX = 384;
+    config.clips.push_back(video);
+
+    SolidClipSource source;
+    source.setClipColor(0, 100, 100, 0, 0, 255);
+    source.setClipColor(1, 100, 100, 0, 0, 255);
+    FrameCompositor compositor(config, source, 2);
+
+    Frame output;
+    compositor.renderFrame(0.1, output);
+    expectPixel(output, 128, 128, 0, 0, 255);
+
+    // Change both sources in place: the still image is assumed unchanged and
+    // its tiles come from the previous frame, the video is drawn again
+    source.setClipColor(0, 100, 100, 0, 255, 0);
+    source.setClipColor(1, 100, 100, 0, 255, 0);
+    Frame next;
+    compositor.renderFrame(0.2, next);
+    expectPixel(next, 128, 128, 0, 0, 255);
+    expectPixel(next, 384, 128, 0, 255, 0);
+
+    // Moving the still image invalidates its tiles
+    config.clips[0].positionX = 130;
+    Frame moved;
+    compositor.renderFrame(0.3, moved);
+    expectPixel(moved, 128, 128, 0, 255, 0);
+}
+
+TEST(FrameCompositorTests, YuvOutputMatchesConvertingTheFinishedFrame) {
+    CompositorConfig config = makeConfig(300, 200);
+    CompositorClip clip = makeClip(0);
+    clip.scale = 0.7;
+    clip.cornerRadius = 12;
+    config.clips.push_back(clip);
+    CompositorBlurClip blur;
+    blur.durationMs = 1000;
+    blur.blurIntensity = 8;
+    blur.regionX = 40;
+    blur.regionY = 50;
+    blur.regionWidth = 30;
+    blur.regionHeight = 30;
+    config.blurClips = std::vector<CompositorBlurClip>{blur};
+
+    SolidClipSource source;
+    source.setClipFrame(0, patternFrame(160, 120));
+    FrameCompositor compositor(config, source, 3);
+    compositor.setYuvOutput(true);
+
+    Frame output;
+    compositor.renderFrame(0.5, output);
+    ASSERT_EQ(output.yuv.width, output.width);
+    ASSERT_EQ(output.yuv.height, output.height);
+
+    Frame expected = output;
+    expected.yuv = YuvImage();
+    convertBgraToYuv420(expected);
+    EXPECT_EQ(output.yuv.y, expected.yuv.y);
+    EXPECT_EQ(output.yuv.u, expected.yuv.u);
+    EXPECT_EQ(output.yuv.v, expected.yuv.v);
+
+    compositor.setYuvOutput(false);
+    compositor.renderFrame(0.6, output);
+    EXPECT_TRUE(output.yuv.empty());
+}
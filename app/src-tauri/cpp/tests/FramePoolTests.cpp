@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "FrameCompositor.h"
+#include "FramePool.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Every operator new in the test binary, so a test can check a stretch of
+/// code never reaches the allocator
+std::atomic<size_t> allocationCount{0};
+
+/// Serves the same frame for every clip
+class FixedClipSource : public ClipFrameSource {
+public:
+    explicit FixedClipSource(Frame frame) : frame_(std::move(frame)) {}
+
+    const Frame* frameForClip(size_t, double) override { return &frame_; }
+    const Frame* backgroundImage() override { return nullptr; }
+
+private:
+    Frame frame_;
+};
+
+} // namespace
+
+// Every replaceable form, so no allocation escapes the count and nothing
+// allocated by the library's operators is freed by ours (or the reverse)
+
+namespace {
+
+void* countedAlloc(size_t size) {
+    allocationCount++;
+    return std::malloc(size ? size : 1);
+}
+
+void* countedAlloc(size_t size, std::align_val_t alignment) {
+    allocationCount++;
+    const size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = countedAlloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+TEST(FramePoolTests, SizeClassesStepByQuarters) {
+    EXPECT_EQ(FramePool::sizeClass(1), 1u);
+    EXPECT_EQ(FramePool::sizeClass(1024), 1024u);
+    EXPECT_EQ(FramePool::sizeClass(1025), 1280u);
+    EXPECT_EQ(FramePool::sizeClass(1800), 1792u + 256u);
+    // 1080p BGRA lands in the 8 MiB class, within a quarter of its size
+    const size_t hd = 1920 * 1080 * 4;
+    EXPECT_EQ(FramePool::sizeClass(hd), 8u * 1024 * 1024);
+    EXPECT_EQ(FramePool::sizeClass(1920 * 1088 * 4), FramePool::sizeClass(hd));
+}
+
+TEST(FramePoolTests, ReleasedBuffersAreReused) {
+    FramePool pool(64 * 1024 * 1024);
+    Frame frame;
+    pool.acquire(frame, 640, 352);
+    ASSERT_EQ(frame.pixels.size(), 640u * 352 * 4);
+    EXPECT_EQ(frame.stride, 640 * 4);
+    const uint8_t* buffer = frame.pixels.data();
+
+    pool.release(frame);
+    EXPECT_TRUE(frame.empty());
+    EXPECT_TRUE(frame.pixels.empty());
+    EXPECT_EQ(pool.idleCount(), 1u);
+
+    // A slightly different size in the same class gets the same buffer
+    Frame other;
+    pool.acquire(other, 640, 340);
+    EXPECT_EQ(other.pixels.data(), buffer);
+    EXPECT_EQ(other.pixels.size(), 640u * 340 * 4);
+    EXPECT_EQ(pool.idleCount(), 0u);
+    EXPECT_EQ(pool.idleBytes(), 0u);
+}
+
+TEST(FramePoolTests, AcquireKeepsBufferOfTheSameSize) {
+    FramePool pool(64 * 1024 * 1024);
+    Frame frame;
+    pool.acquire(frame, 100, 100);
+    frame.opaque = true;
+    pool.acquire(frame.yuv, 100, 100);
+    const uint8_t* buffer = frame.pixels.data();
+
+    // Same size: the buffer stays, the yuv planes go back to the pool
+    pool.acquire(frame, 100, 100);
+    EXPECT_EQ(frame.pixels.data(), buffer);
+    EXPECT_FALSE(frame.opaque);
+    EXPECT_TRUE(frame.yuv.empty());
+    EXPECT_EQ(pool.idleCount(), 3u);
+
+    // A new size returns the old buffer before taking one
+    pool.acquire(frame, 200, 100);
+    EXPECT_EQ(frame.pixels.size(), 200u * 100 * 4);
+    EXPECT_EQ(pool.idleCount(), 4u);
+}
+
+TEST(FramePoolTests, IdleBytesStayWithinCapacity) {
+    FramePool pool(3 * 1024 * 1024);
+    std::vector<Frame> frames(4);
+    for (Frame& frame : frames) pool.acquire(frame, 512, 512);  // 1 MiB each
+    for (Frame& frame : frames) pool.release(frame);
+    EXPECT_EQ(pool.idleCount(), 3u);
+    EXPECT_LE(pool.idleBytes(), 3u * 1024 * 1024);
+
+    pool.clear();
+    EXPECT_EQ(pool.idleCount(), 0u);
+    EXPECT_EQ(pool.idleBytes(), 0u);
+}
+
+TEST(FramePoolTests, SteadyStateRenderingDoesNotAllocate) {
+    CompositorConfig config;
+    config.width = 320;
+    config.height = 180;
+    config.frameRate = 30;
+    config.durationMs = 1000;
+    CompositorClip clip;
+    clip.sourcePath = "synthetic";
+    clip.sourceType = ClipSourceType::Video;
+    clip.durationMs = 1000;
+    clip.scale = 0.8;
+    clip.cornerRadius = 10;
+    config.clips.push_back(clip);
+    CompositorBlurClip blur;
+    blur.durationMs = 1000;
+    blur.blurIntensity = 6;
+    blur.regionX = 20;
+    blur.regionY = 20;
+    blur.regionWidth = 40;
+    blur.regionHeight = 40;
+    config.blurClips = std::vector<CompositorBlurClip>{blur};
+
+    Frame source(200, 120);
+    source.fill(30, 60, 90);
+    FixedClipSource clips(std::move(source));
+
+    // One thread, so the scratch sized by the first frames is the only
+    // scratch (pool workers each grow theirs on the first tiles they draw)
+    FrameCompositor compositor(config, clips, 1);
+    compositor.setYuvOutput(true);
+    Frame output;
+    compositor.renderFrame(0.1, output);
+
+    size_t before = allocationCount;
+    for (int i = 2; i < 10; i++) compositor.renderFrame(i / 10.0, output);
+    EXPECT_EQ(allocationCount - before, 0u);
+
+    FramePool::shared().release(output);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "CaptureEngine.h"
+#include "FrameRing.h"
+#include "RigidCaptureKit.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Records every frame it sees, optionally keeping a reference to each
+struct Recorder {
+    bool retain = false;
+    std::vector<RigidFrameView> views;
+    std::vector<RigidFrameRef> held;
+
+    static void onFrame(void* context, RigidFrameRef frame) {
+        auto* self = static_cast<Recorder*>(context);
+        RigidFrameView view;
+        ASSERT_TRUE(rigid_frame_get_view(frame, &view));
+        self->views.push_back(view);
+        if (self->retain) self->held.push_back(rigid_frame_retain(frame));
+    }
+
+    void releaseAll() {
+        for (RigidFrameRef frame : held) rigid_frame_release(frame);
+        held.clear();
+    }
+};
+
+/// Write one frame filled with `value` and publish it
+bool publishFilled(FrameRing& ring, uint8_t value, int64_t timestampUs) {
+    SharedFrame* frame = ring.acquire();
+    if (!frame) return false;
+    std::memset(ring.pixels(frame), value, static_cast<size_t>(frame->stride()) * frame->height());
+    ring.publish(frame, timestampUs);
+    return true;
+}
+
+} // namespace
+
+TEST(FrameRingTests, SubscribersShareOneBuffer) {
+    FrameRing ring(4);
+    ring.configure(64, 32);
+    Recorder encoder;
+    Recorder preview;
+    ring.subscribe(Recorder::onFrame, &encoder);
+    ring.subscribe(Recorder::onFrame, &preview);
+
+    ASSERT_TRUE(publishFilled(ring, 7, 1000));
+    ASSERT_EQ(encoder.views.size(), 1u);
+    ASSERT_EQ(preview.views.size(), 1u);
+    EXPECT_EQ(encoder.views[0].pixels, preview.views[0].pixels);
+    EXPECT_EQ(encoder.views[0].width, 64);
+    EXPECT_EQ(encoder.views[0].height, 32);
+    EXPECT_EQ(encoder.views[0].stride, 64 * 4);
+    EXPECT_EQ(encoder.views[0].timestamp_us, 1000);
+    EXPECT_EQ(encoder.views[0].sequence, 0u);
+    EXPECT_EQ(encoder.views[0].pixels[100], 7);
+}
+
+TEST(FrameRingTests, HeldFramesAreNotOverwrittenAndFullRingDrops) {
+    FrameRing ring(3);
+    ring.configure(16, 16);
+    Recorder slow;
+    slow.retain = true;
+    ring.subscribe(Recorder::onFrame, &slow);
+
+    for (uint8_t i = 0; i < 3; i++) ASSERT_TRUE(publishFilled(ring, i, i));
+    // Every slot is held: the next frame is dropped rather than copied
+    EXPECT_FALSE(publishFilled(ring, 9, 9));
+    EXPECT_EQ(ring.droppedFrames(), 1u);
+    for (uint8_t i = 0; i < 3; i++) EXPECT_EQ(slow.views[i].pixels[0], i);
+
+    // Releasing one frame frees exactly that slot
+    rigid_frame_release(slow.held[1]);
+    slow.held.erase(slow.held.begin() + 1);
+    ASSERT_TRUE(publishFilled(ring, 5, 5));
+    EXPECT_EQ(slow.views.back().pixels, slow.views[1].pixels);
+    EXPECT_EQ(slow.views[0].pixels[0], 0);
+    EXPECT_EQ(slow.views[2].pixels[0], 2);
+    slow.releaseAll();
+}
+
+TEST(FrameRingTests, HeldFramesOutliveReconfigureAndRing) {
+    Recorder holder;
+    holder.retain = true;
+    {
+        FrameRing ring(2);
+        ring.configure(8, 8);
+        ring.subscribe(Recorder::onFrame, &holder);
+        ASSERT_TRUE(publishFilled(ring, 42, 0));
+
+        // A new recording size gets new buffers; the held frame keeps the old ones
+        ring.configure(16, 8);
+        ASSERT_TRUE(publishFilled(ring, 43, 0));
+        EXPECT_EQ(holder.views[1].width, 16);
+    }
+    RigidFrameView view;
+    ASSERT_TRUE(rigid_frame_get_view(holder.held[0], &view));
+    EXPECT_EQ(view.pixels[0], 42);
+    EXPECT_EQ(view.width, 8);
+    holder.releaseAll();
+}
+
+TEST(FrameRingTests, UnsubscribeThroughCaptureHandle) {
+    RigidCaptureHandle handle = rigid_capture_create();
+    Recorder recorder;
+    uint64_t id = 0;
+    ASSERT_EQ(rigid_capture_subscribe_frames(handle, Recorder::onFrame, &recorder, &id), RIGID_SUCCESS);
+
+    FrameRing& ring = static_cast<CaptureEngine*>(handle)->frames();
+    ring.configure(4, 4);
+    ASSERT_TRUE(publishFilled(ring, 1, 0));
+    EXPECT_EQ(recorder.views.size(), 1u);
+
+    EXPECT_EQ(rigid_capture_unsubscribe_frames(handle, id), RIGID_SUCCESS);
+    EXPECT_EQ(rigid_capture_unsubscribe_frames(handle, id), RIGID_ERROR_INVALID_CONFIG);
+    ASSERT_TRUE(publishFilled(ring, 2, 0));
+    EXPECT_EQ(recorder.views.size(), 1u);
+    EXPECT_FALSE(ring.hasSubscribers());
+
+    rigid_capture_destroy(handle);
+}
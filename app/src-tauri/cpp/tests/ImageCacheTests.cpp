@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+
+#include "ImageCache.h"
+#include "MediaDecoder.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Loader that makes a small frame per path and counts decodes
+struct CountingLoader {
+    std::map<std::string, int> decodes;
+    int size = 4;  // 4x4 BGRA = 64 bytes
+
+    ImageCache::Loader loader() {
+        return [this](const std::string& path) {
+            decodes[path]++;
+            if (path == "missing.png") throw MediaError("Could not open " + path);
+            return Frame(size, size);
+        };
+    }
+};
+
+/// A real file so the cache can see its modification time change
+class TempFile {
+public:
+    explicit TempFile(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() / name).string()) {
+        touch();
+    }
+    ~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    const std::string& path() const { return path_; }
+
+    void touch() {
+        std::ofstream(path_) << "x";
+    }
+
+    void bumpModificationTime() {
+        auto modified = std::filesystem::last_write_time(path_);
+        std::filesystem::last_write_time(path_, modified + std::chrono::seconds(5));
+    }
+
+private:
+    std::string path_;
+};
+
+} // namespace
+
+TEST(ImageCacheTests, DecodesEachPathOnce) {
+    CountingLoader counting;
+    ImageCache cache(1024, counting.loader());
+
+    auto first = cache.get("a.png");
+    auto second = cache.get("a.png");
+
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(counting.decodes["a.png"], 1);
+    EXPECT_EQ(cache.entryCount(), 1u);
+    EXPECT_EQ(cache.sizeBytes(), 64u);
+}
+
+TEST(ImageCacheTests, ModifiedFileIsDecodedAgain) {
+    TempFile file("rigid-image-cache-test.png");
+    CountingLoader counting;
+    ImageCache cache(1024, counting.loader());
+
+    cache.get(file.path());
+    file.bumpModificationTime();
+    cache.get(file.path());
+
+    EXPECT_EQ(counting.decodes[file.path()], 2);
+    EXPECT_EQ(cache.entryCount(), 1u);
+}
+
+TEST(ImageCacheTests, EvictsLeastRecentlyUsed) {
+    CountingLoader counting;
+    ImageCache cache(128, counting.loader());  // Room for two images
+
+    cache.get("a.png");
+    cache.get("b.png");
+    cache.get("a.png");  // b is now the oldest
+    cache.get("c.png");
+
+    EXPECT_EQ(cache.entryCount(), 2u);
+    EXPECT_EQ(cache.sizeBytes(), 128u);
+
+    cache.get("a.png");
+    cache.get("b.png");
+    EXPECT_EQ(counting.decodes["a.png"], 1);
+    EXPECT_EQ(counting.decodes["b.png"], 2);
+}
+
+TEST(ImageCacheTests, EvictedFramesStayValidForHolders) {
+    CountingLoader counting;
+    ImageCache cache(64, counting.loader());
+
+    auto held = cache.get("a.png");
+    cache.get("b.png");
+
+    ASSERT_NE(held, nullptr);
+    EXPECT_EQ(held->width, 4);
+    EXPECT_EQ(held->pixels.size(), 64u);
+}
+
+TEST(ImageCacheTests, OversizedImageIsNotCached) {
+    CountingLoader counting;
+    counting.size = 16;  // 1024 bytes
+    ImageCache cache(512, counting.loader());
+
+    auto frame = cache.get("big.png");
+
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(cache.entryCount(), 0u);
+}
+
+TEST(ImageCacheTests, DecodeFailureIsNotCached) {
+    CountingLoader counting;
+    ImageCache cache(1024, counting.loader());
+
+    EXPECT_THROW(cache.get("missing.png"), MediaError);
+    EXPECT_THROW(cache.get("missing.png"), MediaError);
+
+    EXPECT_EQ(counting.decodes["missing.png"], 2);
+    EXPECT_EQ(cache.entryCount(), 0u);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "FramePool.h"
+#include "ImageWriter.h"
+#include "PngWriter.h"
+#include "QoiWriter.h"
+#include "TilePool.h"
+#include "WebPWriter.h"
+
+using namespace rigid;
+
+namespace {
+
+constexpr int kWidth = 31;
+constexpr int kHeight = 12;
+
+std::vector<uint8_t> testPixels() {
+    std::vector<uint8_t> pixels(static_cast<size_t>(kWidth) * kHeight * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i] = static_cast<uint8_t>(i / 4 % kWidth * 8);
+        pixels[i + 1] = static_cast<uint8_t>(i / 4 / kWidth * 20);
+        pixels[i + 2] = 90;
+        pixels[i + 3] = 255;
+    }
+    return pixels;
+}
+
+std::string tempPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+bool exists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+} // namespace
+
+TEST(ImageWriterTests, FormatFollowsTheExtension) {
+    EXPECT_EQ(imageFormatForPath("/tmp/shot.png"), ImageFormat::Png);
+    EXPECT_EQ(imageFormatForPath("/tmp/shot.QOI"), ImageFormat::Qoi);
+    EXPECT_EQ(imageFormatForPath("shot.webp"), ImageFormat::WebP);
+    EXPECT_EQ(imageFormatForPath("/tmp/shot"), ImageFormat::Png);
+    EXPECT_EQ(imageFormatForPath("/tmp/x.qoi/shot"), ImageFormat::Png);
+    EXPECT_EQ(imageFormatForPath("/tmp/shot.jpg"), ImageFormat::Png);
+}
+
+TEST(ImageWriterTests, WritesEachFormatAtTheRequestedLevel) {
+    ImageWriter writer(2);
+    const std::vector<uint8_t> pixels = testPixels();
+
+    const std::string png = tempPath("writer.png");
+    writer.write(png, std::vector<uint8_t>(pixels), kWidth, kHeight);
+    EXPECT_EQ(readFile(png), encodePng(pixels.data(), kWidth * 4, kWidth, kHeight, 6));
+
+    writer.setEncoding(Compression::Fast, false);
+    writer.write(png, std::vector<uint8_t>(pixels), kWidth, kHeight);
+    EXPECT_EQ(readFile(png), encodePng(pixels.data(), kWidth * 4, kWidth, kHeight, 1));
+    EXPECT_FALSE(exists(png + ".part"));
+    std::remove(png.c_str());
+
+    const std::string qoi = tempPath("writer.qoi");
+    writer.write(qoi, std::vector<uint8_t>(pixels), kWidth, kHeight);
+    EXPECT_EQ(readFile(qoi), encodeQoi(pixels.data(), kWidth * 4, kWidth, kHeight));
+    std::remove(qoi.c_str());
+
+    const std::string webp = tempPath("writer.webp");
+    if (webPEncoderAvailable()) {
+        writer.write(webp, std::vector<uint8_t>(pixels), kWidth, kHeight);
+        const std::vector<uint8_t> bytes = readFile(webp);
+        ASSERT_GE(bytes.size(), 12u);
+        EXPECT_EQ(0, std::memcmp(&bytes[8], "WEBP", 4));
+        std::remove(webp.c_str());
+    } else {
+        EXPECT_THROW(writer.write(webp, std::vector<uint8_t>(pixels), kWidth, kHeight), std::invalid_argument);
+        EXPECT_FALSE(exists(webp));
+    }
+}
+
+TEST(ImageWriterTests, BackgroundWritesFinishBeforeWaitReturns) {
+    ImageWriter writer(2);
+    writer.setEncoding(Compression::Default, true);
+    const std::vector<uint8_t> pixels = testPixels();
+
+    // More than the queue holds, so later writes wait for room
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < ImageWriter::kMaxQueued * 2; i++) {
+        paths.push_back(tempPath(("background" + std::to_string(i) + ".png").c_str()));
+        writer.write(paths.back(), std::vector<uint8_t>(pixels), kWidth, kHeight);
+    }
+    writer.waitForWrites();
+
+    const std::vector<uint8_t> expected = encodePng(pixels.data(), kWidth * 4, kWidth, kHeight);
+    for (const std::string& path : paths) {
+        EXPECT_EQ(readFile(path), expected) << path;
+        std::remove(path.c_str());
+    }
+}
+
+TEST(ImageWriterTests, BackgroundFailuresSurfaceOnceFromWait) {
+    ImageWriter writer(1);
+    writer.setEncoding(Compression::Fast, true);
+
+    // Returns at once; the missing directory is only found while writing
+    EXPECT_NO_THROW(writer.write("/nonexistent-dir/shot.png", testPixels(), kWidth, kHeight));
+    EXPECT_THROW(writer.waitForWrites(), std::runtime_error);
+    EXPECT_NO_THROW(writer.waitForWrites());
+}
+
+TEST(ImageWriterTests, DestructionFinishesQueuedWrites) {
+    const std::string path = tempPath("destruction.qoi");
+    std::remove(path.c_str());
+    {
+        ImageWriter writer(1);
+        writer.setEncoding(Compression::Default, true);
+        writer.write(path, testPixels(), kWidth, kHeight);
+    }
+    const std::vector<uint8_t> pixels = testPixels();
+    EXPECT_EQ(readFile(path), encodeQoi(pixels.data(), kWidth * 4, kWidth, kHeight));
+    std::remove(path.c_str());
+}
+
+TEST(ImageWriterTests, BorrowedPixelsAreReleasedOnce) {
+    ImageWriter writer(1);
+    const std::vector<uint8_t> pixels = testPixels();
+
+    // Padded rows, as a borrowed buffer may have
+    const int stride = kWidth * 4 + 16;
+    std::vector<uint8_t> padded(static_cast<size_t>(stride) * kHeight);
+    for (int y = 0; y < kHeight; y++) {
+        std::memcpy(&padded[static_cast<size_t>(y) * stride], &pixels[static_cast<size_t>(y) * kWidth * 4], kWidth * 4);
+    }
+
+    int released = 0;
+    const std::string path = tempPath("borrowed.qoi");
+    writer.write(path, padded.data(), stride, kWidth, kHeight, [&] { released++; });
+    EXPECT_EQ(released, 1);
+    EXPECT_EQ(readFile(path), encodeQoi(pixels.data(), kWidth * 4, kWidth, kHeight));
+    std::remove(path.c_str());
+
+    EXPECT_THROW(writer.write("/nonexistent-dir/shot.png", padded.data(), stride, kWidth, kHeight,
+                              [&] { released++; }),
+                 std::runtime_error);
+    EXPECT_EQ(released, 2);
+
+    writer.setEncoding(Compression::Default, true);
+    writer.write("/nonexistent-dir/shot.png", padded.data(), stride, kWidth, kHeight, [&] { released++; });
+    EXPECT_THROW(writer.waitForWrites(), std::runtime_error);
+    EXPECT_EQ(released, 3);
+}
+
+TEST(ImageWriterTests, WritesNowAtTheCallersLevel) {
+    ImageWriter writer(2);
+    writer.setEncoding(Compression::Smallest, true);
+    const std::vector<uint8_t> pixels = testPixels();
+
+    // On disk when writeNow returns, at its own level rather than the writer's
+    const std::string path = tempPath("now.png");
+    writer.writeNow(path, pixels.data(), kWidth * 4, kWidth, kHeight, Compression::Fast);
+    EXPECT_EQ(readFile(path), encodePng(pixels.data(), kWidth * 4, kWidth, kHeight, 1));
+    std::remove(path.c_str());
+
+    // Failures are thrown to the caller, not left for waitForWrites
+    EXPECT_THROW(writer.writeNow("/nonexistent-dir/shot.png", pixels.data(), kWidth * 4, kWidth, kHeight,
+                                 Compression::Fast),
+                 std::runtime_error);
+    EXPECT_NO_THROW(writer.waitForWrites());
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "MediaDecoder.h"
+#include "MediaEncoder.h"
+
+using namespace rigid;
+
+namespace {
+
+constexpr int kFrameRate = 30;
+
+/// Gray level of the frame written at output frame `index`
+uint8_t levelOf(int index) {
+    return static_cast<uint8_t>(20 + index * 9);
+}
+
+/// Frames 0-2, then nothing until 20-21: a recording that skipped idle
+/// frames, as ScreenRecorder writes them
+const std::vector<int> kFrameIndices = {0, 1, 2, 20, 21};
+
+std::string writeGappedVideo() {
+    const std::string path = ::testing::TempDir() + "gapped.mp4";
+    EncoderSettings settings;
+    settings.outputPath = path;
+    settings.width = 64;
+    settings.height = 64;
+    settings.frameRate = kFrameRate;
+
+    MediaEncoder encoder(settings);
+    for (int index : kFrameIndices) {
+        Frame frame(settings.width, settings.height);
+        for (size_t i = 0; i < frame.pixels.size(); i += 4) {
+            frame.pixels[i] = frame.pixels[i + 1] = frame.pixels[i + 2] = levelOf(index);
+            frame.pixels[i + 3] = 255;
+        }
+        frame.opaque = true;
+        encoder.encodeVideoFrame(frame, index);
+    }
+    encoder.finish();
+    return path;
+}
+
+/// Index of the written frame `frame` shows, or -1
+int shownIndex(const Frame* frame) {
+    if (!frame) return -1;
+    const int level = frame->pixels[(frame->height / 2 * frame->width + frame->width / 2) * 4 + 1];
+    for (int index : kFrameIndices) {
+        if (std::abs(level - levelOf(index)) <= 4) return index;
+    }
+    return -1;
+}
+
+/// Middle of output frame `index`
+double midFrame(double index) {
+    return (index + 0.5) / kFrameRate;
+}
+
+} // namespace
+
+TEST(MediaDecoderTests, HoldsFramesAcrossTimestampGaps) {
+    if (!mediaBackendAvailable()) GTEST_SKIP() << "Built without libav";
+
+    const std::string path = writeGappedVideo();
+    VideoDecoder decoder(path, 1);
+
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(0))), 0);
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(2))), 2);
+
+    // Inside the gap the last frame stays up; the next one is not shown early
+    for (int index = 3; index < 20; index++) {
+        EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(index))), 2) << "frame " << index;
+    }
+
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(20))), 20);
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(21))), 21);
+    // Past the end the last frame is held
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(40))), 21);
+
+    // Backwards seeks land on the frame shown at that time
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(10))), 2);
+    EXPECT_EQ(shownIndex(decoder.frameAt(midFrame(1))), 1);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "PngWriter.h"
+#include "TilePool.h"
+
+using namespace rigid;
+
+namespace {
+
+uint32_t readU32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+struct DecodedPng {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+/// Just enough of a PNG reader for what encodePng writes: checks the chunk
+/// CRCs, inflates IDAT and undoes the row filters (None and Sub)
+DecodedPng decode(const std::vector<uint8_t>& png) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    EXPECT_EQ(0, std::memcmp(png.data(), signature, 8));
+
+    DecodedPng image;
+    std::vector<uint8_t> idat;
+    for (size_t offset = 8; offset + 12 <= png.size();) {
+        const uint32_t size = readU32(&png[offset]);
+        const std::string type(reinterpret_cast<const char*>(&png[offset + 4]), 4);
+        const uint8_t* data = &png[offset + 8];
+        EXPECT_EQ(readU32(data + size), crc32(0, &png[offset + 4], size + 4)) << type;
+        if (type == "IHDR") {
+            image.width = static_cast<int>(readU32(data));
+            image.height = static_cast<int>(readU32(data + 4));
+            EXPECT_EQ(data[8], 8);
+            EXPECT_EQ(data[9], 2);
+        } else if (type == "IDAT") {
+            idat.insert(idat.end(), data, data + size);
+        }
+        offset += size + 12;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(image.width) * 3;
+    std::vector<uint8_t> raw((rowBytes + 1) * image.height);
+    uLongf rawSize = raw.size();
+    EXPECT_EQ(uncompress(raw.data(), &rawSize, idat.data(), idat.size()), Z_OK);
+    EXPECT_EQ(rawSize, raw.size());
+
+    image.rgb.resize(rowBytes * image.height);
+    for (int y = 0; y < image.height; y++) {
+        const uint8_t* line = &raw[(rowBytes + 1) * y];
+        uint8_t* out = &image.rgb[rowBytes * y];
+        EXPECT_LE(line[0], 1) << "row " << y;
+        for (size_t i = 0; i < rowBytes; i++) {
+            out[i] = static_cast<uint8_t>(line[1 + i] + (line[0] == 1 && i >= 3 ? out[i - 3] : 0));
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+TEST(PngWriterTests, RoundTripsBgraAsRgb) {
+    const int width = 7;
+    const int height = 5;
+    const int stride = width * 4 + 8; // padded rows
+    std::vector<uint8_t> bgra(static_cast<size_t>(stride) * height, 0xee);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = &bgra[static_cast<size_t>(y) * stride + x * 4];
+            p[0] = static_cast<uint8_t>(x * 30);
+            p[1] = static_cast<uint8_t>(y * 50);
+            p[2] = static_cast<uint8_t>(x * y * 7);
+            p[3] = 255;
+        }
+    }
+
+    const DecodedPng image = decode(encodePng(bgra.data(), stride, width, height));
+    ASSERT_EQ(image.width, width);
+    ASSERT_EQ(image.height, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t* rgb = &image.rgb[(static_cast<size_t>(y) * width + x) * 3];
+            const uint8_t* p = &bgra[static_cast<size_t>(y) * stride + x * 4];
+            ASSERT_EQ(rgb[0], p[2]) << x << "," << y;
+            ASSERT_EQ(rgb[1], p[1]) << x << "," << y;
+            ASSERT_EQ(rgb[2], p[0]) << x << "," << y;
+        }
+    }
+}
+
+TEST(PngWriterTests, FlatScreensCompressWell) {
+    const int width = 640;
+    const int height = 480;
+    std::vector<uint8_t> bgra(static_cast<size_t>(width) * height * 4, 0x80);
+
+    const std::vector<uint8_t> png = encodePng(bgra.data(), width * 4, width, height);
+    EXPECT_LT(png.size(), 4096u);
+    EXPECT_EQ(decode(png).rgb, std::vector<uint8_t>(static_cast<size_t>(width) * height * 3, 0x80));
+}
+
+TEST(PngWriterTests, StripesDecodeToTheSameImage) {
+    // Large enough for a few dozen stripes, with text-like detail on a flat
+    // background and a partial last stripe
+    const int width = 1000;
+    const int height = 1237;
+    std::vector<uint8_t> bgra(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = &bgra[(static_cast<size_t>(y) * width + x) * 4];
+            const bool ink = (x * 7 + y * 3) % 11 == 0 && y % 20 < 12;
+            p[0] = ink ? 20 : 240;
+            p[1] = ink ? static_cast<uint8_t>(y) : 240;
+            p[2] = ink ? static_cast<uint8_t>(x) : 235;
+            p[3] = 255;
+        }
+    }
+
+    TilePool pool(4);
+    const std::vector<uint8_t> striped = encodePng(bgra.data(), width * 4, width, height, 6, &pool);
+    const std::vector<uint8_t> single = encodePng(bgra.data(), width * 4, width, height, 6);
+    EXPECT_NE(striped, single);
+    EXPECT_EQ(decode(striped).rgb, decode(single).rgb);
+    // Restarting the deflate history per stripe costs little
+    EXPECT_LT(striped.size(), single.size() * 102 / 100);
+}
+
+TEST(PngWriterTests, RejectsEmptyImagesAndBadPaths) {
+    uint8_t pixel[4] = {0, 0, 0, 255};
+    EXPECT_THROW(encodePng(pixel, 4, 0, 1), std::runtime_error);
+    EXPECT_THROW(writePng("/nonexistent-dir/shot.png", pixel, 4, 1, 1), std::runtime_error);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "QoiWriter.h"
+
+using namespace rigid;
+
+namespace {
+
+uint32_t readU32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+struct DecodedQoi {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+/// A QOI decoder following the reference one (qoi.h), for 3-channel images
+DecodedQoi decode(const std::vector<uint8_t>& qoi) {
+    EXPECT_EQ(0, std::memcmp(qoi.data(), "qoif", 4));
+    EXPECT_EQ(qoi[12], 3);
+    EXPECT_EQ(qoi[13], 0);
+
+    DecodedQoi image;
+    image.width = static_cast<int>(readU32(&qoi[4]));
+    image.height = static_cast<int>(readU32(&qoi[8]));
+
+    uint8_t index[64][4] = {};
+    uint8_t px[4] = {0, 0, 0, 255};
+    size_t p = 14;
+    int run = 0;
+    const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    for (size_t i = 0; i < pixelCount; i++) {
+        if (run > 0) {
+            run--;
+        } else {
+            const uint8_t b1 = qoi[p++];
+            if (b1 == 0xfe) {
+                px[0] = qoi[p++];
+                px[1] = qoi[p++];
+                px[2] = qoi[p++];
+            } else if (b1 == 0xff) {
+                std::memcpy(px, &qoi[p], 4);
+                p += 4;
+            } else if ((b1 & 0xc0) == 0x00) {
+                std::memcpy(px, index[b1], 4);
+            } else if ((b1 & 0xc0) == 0x40) {
+                px[0] = static_cast<uint8_t>(px[0] + ((b1 >> 4) & 3) - 2);
+                px[1] = static_cast<uint8_t>(px[1] + ((b1 >> 2) & 3) - 2);
+                px[2] = static_cast<uint8_t>(px[2] + (b1 & 3) - 2);
+            } else if ((b1 & 0xc0) == 0x80) {
+                const uint8_t b2 = qoi[p++];
+                const int dg = (b1 & 0x3f) - 32;
+                px[0] = static_cast<uint8_t>(px[0] + dg - 8 + ((b2 >> 4) & 0x0f));
+                px[1] = static_cast<uint8_t>(px[1] + dg);
+                px[2] = static_cast<uint8_t>(px[2] + dg - 8 + (b2 & 0x0f));
+            } else {
+                run = b1 & 0x3f;
+            }
+            std::memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+        }
+        image.rgb.insert(image.rgb.end(), px, px + 3);
+    }
+
+    static const uint8_t end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    EXPECT_EQ(p + 8, qoi.size());
+    EXPECT_EQ(0, std::memcmp(&qoi[p], end, 8));
+    return image;
+}
+
+std::vector<uint8_t> toRgb(const std::vector<uint8_t>& bgra, int stride, int width, int height) {
+    std::vector<uint8_t> rgb;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t* p = &bgra[static_cast<size_t>(y) * stride + x * 4];
+            rgb.insert(rgb.end(), {p[2], p[1], p[0]});
+        }
+    }
+    return rgb;
+}
+
+} // namespace
+
+TEST(QoiWriterTests, RoundTripsBgraAsRgb) {
+    // Small steps, larger steps, repeats and unrelated colors, to use every op
+    const int width = 67;
+    const int height = 23;
+    const int stride = width * 4 + 12;
+    std::vector<uint8_t> bgra(static_cast<size_t>(stride) * height, 0xee);
+    uint32_t seed = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = &bgra[static_cast<size_t>(y) * stride + x * 4];
+            seed = seed * 1103515245 + 12345;
+            switch (y % 4) {
+            case 0: p[0] = static_cast<uint8_t>(x); p[1] = static_cast<uint8_t>(x * 2); p[2] = 9; break;
+            case 1: p[0] = static_cast<uint8_t>(x * 13); p[1] = static_cast<uint8_t>(x * 17); p[2] = 0; break;
+            case 2: p[0] = p[1] = p[2] = x < 40 ? 0 : 200; break;
+            default: p[0] = static_cast<uint8_t>(seed >> 24); p[1] = static_cast<uint8_t>(seed >> 16);
+                     p[2] = static_cast<uint8_t>(seed >> 8); break;
+            }
+            p[3] = 255;
+        }
+    }
+
+    const DecodedQoi image = decode(encodeQoi(bgra.data(), stride, width, height));
+    ASSERT_EQ(image.width, width);
+    ASSERT_EQ(image.height, height);
+    EXPECT_EQ(image.rgb, toRgb(bgra, stride, width, height));
+}
+
+TEST(QoiWriterTests, FlatScreensCompressWell) {
+    const int width = 640;
+    const int height = 480;
+    std::vector<uint8_t> bgra(static_cast<size_t>(width) * height * 4, 0x80);
+
+    const std::vector<uint8_t> qoi = encodeQoi(bgra.data(), width * 4, width, height);
+    // One RGB op, then runs of 62 pixels a byte
+    EXPECT_LT(qoi.size(), 14 + 4 + width * height / 62 + 2 + 8u);
+    EXPECT_EQ(decode(qoi).rgb, std::vector<uint8_t>(static_cast<size_t>(width) * height * 3, 0x80));
+}
+
+TEST(QoiWriterTests, RejectsEmptyImages) {
+    uint8_t pixel[4] = {0, 0, 0, 255};
+    EXPECT_THROW(encodeQoi(pixel, 4, 1, 0), std::runtime_error);
+}
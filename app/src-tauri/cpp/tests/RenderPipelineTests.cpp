@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "RenderPipeline.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Stages that pass the frame index through every buffer, so a test can
+/// check each frame arrived intact and in order
+RenderPipelineStages passThroughStages(std::vector<int64_t>& encoded) {
+    RenderPipelineStages stages;
+    stages.decode = [](int64_t i, DecodedFrameSet& decoded) {
+        Frame source(2, 2);
+        source.fill(static_cast<uint8_t>(i), 0, 0);
+        decoded.copy(0, source);
+    };
+    stages.composite = [](int64_t, const DecodedFrameSet& decoded, Frame& output) {
+        const Frame* source = decoded.frameFor(0);
+        ASSERT_NE(source, nullptr);
+        output = *source;
+    };
+    stages.encode = [&encoded](int64_t i, const Frame& output) {
+        EXPECT_EQ(output.pixel(1, 1)[0], static_cast<uint8_t>(i));
+        encoded.push_back(i);
+    };
+    return stages;
+}
+
+} // namespace
+
+TEST(RenderPipelineTests, QueueIsFifoAndDrainsAfterClose) {
+    BoundedQueue<int> queue(4);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    queue.close();
+
+    EXPECT_FALSE(queue.push(3));
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), std::nullopt);
+}
+
+TEST(RenderPipelineTests, QueueStaysInOrderAcrossWraparound) {
+    BoundedQueue<int> queue(3);
+    int next = 0;
+    for (int round = 0; round < 5; round++) {
+        EXPECT_TRUE(queue.push(next++));
+        EXPECT_TRUE(queue.push(next++));
+        EXPECT_EQ(queue.pop(), next - 2);
+        EXPECT_EQ(queue.pop(), next - 1);
+    }
+}
+
+TEST(RenderPipelineTests, FullQueueBlocksUntilPopped) {
+    BoundedQueue<int> queue(1);
+    queue.push(1);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        queue.push(2);
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+    EXPECT_EQ(queue.pop(), 1);
+    producer.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_EQ(queue.pop(), 2);
+}
+
+TEST(RenderPipelineTests, DecodedFrameSetBorrowsAndCopies) {
+    Frame still(1, 1);
+    Frame video(1, 1);
+    video.fill(9, 9, 9);
+
+    DecodedFrameSet set;
+    set.borrow(3, &still);
+    set.copy(5, video);
+    video.fill(0, 0, 0);  // The decoder moves on; the copy must not
+
+    EXPECT_EQ(set.frameFor(3), &still);
+    ASSERT_NE(set.frameFor(5), nullptr);
+    EXPECT_EQ(set.frameFor(5)->pixel(0, 0)[0], 9);
+    EXPECT_EQ(set.frameFor(4), nullptr);
+
+    set.clear();
+    EXPECT_EQ(set.frameFor(3), nullptr);
+}
+
+TEST(RenderPipelineTests, EncodesEveryFrameInOrder) {
+    std::vector<int64_t> encoded;
+    std::atomic<bool> cancelled{false};
+    runRenderPipeline(100, 2, passThroughStages(encoded), cancelled);
+
+    ASSERT_EQ(encoded.size(), 100u);
+    for (int64_t i = 0; i < 100; i++) EXPECT_EQ(encoded[static_cast<size_t>(i)], i);
+}
+
+TEST(RenderPipelineTests, StagesOverlap) {
+    // Encode holds frame 0 until decode has moved two frames ahead
+    std::atomic<int64_t> decodedUpTo{-1};
+    std::atomic<bool> overlapped{false};
+    std::atomic<bool> cancelled{false};
+
+    std::vector<int64_t> encoded;
+    RenderPipelineStages stages = passThroughStages(encoded);
+    auto decode = stages.decode;
+    stages.decode = [&, decode](int64_t i, DecodedFrameSet& decoded) {
+        decode(i, decoded);
+        decodedUpTo = i;
+    };
+    auto encode = stages.encode;
+    stages.encode = [&, encode](int64_t i, const Frame& output) {
+        if (i == 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (decodedUpTo < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            overlapped = decodedUpTo >= 2;
+        }
+        encode(i, output);
+    };
+
+    runRenderPipeline(10, 2, stages, cancelled);
+    EXPECT_TRUE(overlapped);
+    EXPECT_EQ(encoded.size(), 10u);
+}
+
+TEST(RenderPipelineTests, RethrowsStageFailure) {
+    for (int failing = 0; failing < 3; failing++) {
+        std::vector<int64_t> encoded;
+        std::atomic<bool> cancelled{false};
+        RenderPipelineStages stages = passThroughStages(encoded);
+
+        auto decode = stages.decode;
+        auto composite = stages.composite;
+        auto encode = stages.encode;
+        if (failing == 0) {
+            stages.decode = [decode](int64_t i, DecodedFrameSet& decoded) {
+                if (i == 5) throw std::runtime_error("decode");
+                decode(i, decoded);
+            };
+        } else if (failing == 1) {
+            stages.composite = [composite](int64_t i, const DecodedFrameSet& decoded, Frame& output) {
+                if (i == 5) throw std::runtime_error("composite");
+                composite(i, decoded, output);
+            };
+        } else {
+            stages.encode = [encode](int64_t i, const Frame& output) {
+                if (i == 5) throw std::runtime_error("encode");
+                encode(i, output);
+            };
+        }
+
+        EXPECT_THROW(runRenderPipeline(50, 2, stages, cancelled), std::runtime_error) << "stage " << failing;
+        // Frames after the failure never reach the encoder
+        EXPECT_LE(encoded.size(), 5u) << "stage " << failing;
+    }
+}
+
+TEST(RenderPipelineTests, CancelStopsEveryStage) {
+    std::vector<int64_t> encoded;
+    std::atomic<bool> cancelled{false};
+    RenderPipelineStages stages = passThroughStages(encoded);
+    auto encode = stages.encode;
+    stages.encode = [&, encode](int64_t i, const Frame& output) {
+        encode(i, output);
+        if (i == 3) cancelled = true;
+    };
+
+    runRenderPipeline(1000, 2, stages, cancelled);
+    EXPECT_EQ(encoded.size(), 4u);
+}
+
+TEST(RenderPipelineTests, StageThreadsStayWithinTheBudget) {
+    for (int budget = 3; budget <= 64; budget++) {
+        StageThreads threads = StageThreads::split(budget);
+        EXPECT_EQ(threads.decoderPerClip + threads.compositor + threads.encoder, budget) << budget;
+        EXPECT_GE(threads.encoder, 1);
+        EXPECT_GE(threads.compositor, 1);
+        EXPECT_LE(threads.decoderPerClip, kMaxDecoderThreadsPerClip);
+    }
+
+    // Too small a budget still gives every stage a thread
+    StageThreads one = StageThreads::split(1);
+    EXPECT_EQ(one.decoderPerClip, 1);
+    EXPECT_EQ(one.compositor, 1);
+    EXPECT_EQ(one.encoder, 1);
+
+    StageThreads eight = StageThreads::split(8);
+    EXPECT_EQ(eight.decoderPerClip, 2);
+    EXPECT_EQ(eight.encoder, 3);
+    EXPECT_EQ(eight.compositor, 3);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RenderScheduler.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Collects completions and lets tests wait for them
+struct CompletionLog {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> order;
+    std::vector<int32_t> codes;
+
+    std::function<void(int32_t, const std::string&)> callbackFor(const std::string& id) {
+        return [this, id](int32_t code, const std::string&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(id);
+            codes.push_back(code);
+            changed.notify_all();
+        };
+    }
+
+    bool waitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(5), [&] { return order.size() >= count; });
+    }
+};
+
+/// Blocks jobs until released, so tests control what is running
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool open = false;
+    int started = 0;
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        changed.notify_all();
+    }
+
+    bool waitForStarted(int count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(5), [&] { return started >= count; });
+    }
+
+    RenderScheduler::JobRunner runner() {
+        return [this](const RenderJob& job, VideoCompositorEngine& engine) {
+            std::unique_lock<std::mutex> lock(mutex);
+            started++;
+            changed.notify_all();
+            while (!open) {
+                if (engine.isCancelled()) throw RenderCancelled();
+                changed.wait_for(lock, std::chrono::milliseconds(5));
+            }
+            return job.exportId;
+        };
+    }
+};
+
+RenderJob makeJob(const std::string& id, int priority, CompletionLog& log) {
+    RenderJob job;
+    job.exportId = id;
+    job.priority = priority;
+    job.config.frameRate = 30;
+    job.config.durationMs = 1000;
+    job.completion = log.callbackFor(id);
+    return job;
+}
+
+} // namespace
+
+TEST(RenderSchedulerTests, ThreadBudgetSplitsCores) {
+    EXPECT_EQ(RenderScheduler::threadBudgetFor(8, 1), 8);
+    EXPECT_EQ(RenderScheduler::threadBudgetFor(8, 2), 4);
+    EXPECT_EQ(RenderScheduler::threadBudgetFor(8, 3), 2);
+    EXPECT_EQ(RenderScheduler::threadBudgetFor(2, 4), 1);
+    EXPECT_EQ(RenderScheduler::threadBudgetFor(4, 0), 4);
+}
+
+TEST(RenderSchedulerTests, ConcurrentJobsStayWithinTheCoreBudget) {
+    std::mutex mutex;
+    std::vector<int> budgets;
+    CompletionLog log;
+    RenderScheduler scheduler(2, 8, [&](const RenderJob& job, VideoCompositorEngine& engine) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budgets.push_back(engine.threadBudget());
+        return job.exportId;
+    });
+
+    // One job alone, then three at once, both leave room for a second render
+    scheduler.submit(makeJob("alone", 0, log));
+    ASSERT_TRUE(log.waitFor(1));
+    for (int i = 0; i < 3; i++) scheduler.submit(makeJob("job-" + std::to_string(i), 0, log));
+    ASSERT_TRUE(log.waitFor(4));
+
+    EXPECT_EQ(scheduler.jobThreadBudget(), 4);
+    EXPECT_EQ(budgets, (std::vector<int>{4, 4, 4, 4}));
+}
+
+TEST(RenderSchedulerTests, RunsHigherPriorityFirst) {
+    Gate gate;
+    CompletionLog log;
+    RenderScheduler scheduler(1, 4, gate.runner());
+
+    // Occupy the only worker so the rest queue up
+    scheduler.submit(makeJob("blocker", 0, log));
+    ASSERT_TRUE(gate.waitForStarted(1));
+
+    scheduler.submit(makeJob("low", 0, log));
+    scheduler.submit(makeJob("high", 10, log));
+    scheduler.submit(makeJob("low-2", 0, log));
+    EXPECT_EQ(scheduler.queueDepth(), 3u);
+    EXPECT_EQ(scheduler.runningCount(), 1u);
+
+    gate.release();
+    ASSERT_TRUE(log.waitFor(4));
+    EXPECT_EQ(log.order, (std::vector<std::string>{"blocker", "high", "low", "low-2"}));
+}
+
+TEST(RenderSchedulerTests, RunsUpToMaxConcurrentJobs) {
+    Gate gate;
+    CompletionLog log;
+    RenderScheduler scheduler(2, 4, gate.runner());
+
+    for (int i = 0; i < 3; i++) scheduler.submit(makeJob("job-" + std::to_string(i), 0, log));
+    ASSERT_TRUE(gate.waitForStarted(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(scheduler.runningCount(), 2u);
+    EXPECT_EQ(scheduler.queueDepth(), 1u);
+
+    gate.release();
+    ASSERT_TRUE(log.waitFor(3));
+}
+
+TEST(RenderSchedulerTests, CancelsQueuedAndRunningJobs) {
+    Gate gate;
+    CompletionLog log;
+    RenderScheduler scheduler(1, 4, gate.runner());
+
+    scheduler.submit(makeJob("running", 0, log));
+    ASSERT_TRUE(gate.waitForStarted(1));
+    scheduler.submit(makeJob("queued", 0, log));
+
+    EXPECT_TRUE(scheduler.cancel("queued"));
+    EXPECT_TRUE(scheduler.cancel("running"));
+    EXPECT_FALSE(scheduler.cancel("unknown"));
+
+    ASSERT_TRUE(log.waitFor(2));
+    EXPECT_EQ(log.codes[0], 3);
+    EXPECT_EQ(log.codes[1], 3);
+}
+
+TEST(RenderSchedulerTests, ReportsStartAsZeroProgress) {
+    CompletionLog log;
+    std::atomic<int> startEvents{0};
+    RenderScheduler scheduler(1, 4, [](const RenderJob& job, VideoCompositorEngine&) { return job.exportId; });
+
+    RenderJob job = makeJob("job", 0, log);
+    job.progress = [&](float percent, int64_t current, int64_t total) {
+        if (percent == 0 && current == 0 && total == 30) startEvents++;
+    };
+    scheduler.submit(std::move(job));
+
+    ASSERT_TRUE(log.waitFor(1));
+    EXPECT_EQ(startEvents.load(), 1);
+    EXPECT_EQ(log.codes[0], 0);
+}
+
+TEST(RenderSchedulerTests, DestroyCancelsOutstandingJobs) {
+    Gate gate;
+    CompletionLog log;
+    {
+        RenderScheduler scheduler(1, 4, gate.runner());
+        scheduler.submit(makeJob("running", 0, log));
+        ASSERT_TRUE(gate.waitForStarted(1));
+        scheduler.submit(makeJob("queued", 0, log));
+    }
+    EXPECT_EQ(log.order.size(), 2u);
+}
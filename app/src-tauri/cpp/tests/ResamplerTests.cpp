@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Frame.h"
+#include "Resampler.h"
+
+using namespace rigid;
+
+namespace {
+
+/// Resample every row of `source` onto `width` x `height` output pixels
+Frame resampleFrame(const Frame& source, ResampleFilter filter, int width, int height) {
+    double stepX = static_cast<double>(source.width) / width;
+    double stepY = static_cast<double>(source.height) / height;
+    Frame output(width, height);
+    Resampler resampler;
+    resampler.setColumns(filter, 0.5 * stepX - 0.5, stepX, width, stepY);
+    for (int y = 0; y < height; y++) {
+        resampler.resampleRow(source.pixels.data(), source.stride, source.width, source.height,
+                              (y + 0.5) * stepY - 0.5, output.row(y));
+    }
+    return output;
+}
+
+} // namespace
+
+TEST(ResamplerTests, QualityPicksTheFilter) {
+    EXPECT_EQ(resampleFilterFor(CompositorQuality::Draft), ResampleFilter::Bilinear);
+    EXPECT_EQ(resampleFilterFor(CompositorQuality::Good), ResampleFilter::Bilinear);
+    EXPECT_EQ(resampleFilterFor(CompositorQuality::High), ResampleFilter::Bicubic);
+    EXPECT_EQ(resampleFilterFor(CompositorQuality::Max), ResampleFilter::Lanczos);
+}
+
+TEST(ResamplerTests, ReachWidensOnlyWhenMinifying) {
+    EXPECT_EQ(resampleReach(ResampleFilter::Bilinear, 4), 1);
+    EXPECT_EQ(resampleReach(ResampleFilter::Bicubic, 0.5), 2);
+    EXPECT_EQ(resampleReach(ResampleFilter::Lanczos, 1), 3);
+    EXPECT_EQ(resampleReach(ResampleFilter::Lanczos, 2), 6);
+}
+
+TEST(ResamplerTests, IdentityMappingCopiesPixels) {
+    Frame source(16, 8);
+    for (size_t i = 0; i < source.pixels.size(); i++) {
+        // Premultiplied: colors never exceed the 255 alpha
+        source.pixels[i] = (i % 4 == 3) ? 255 : static_cast<uint8_t>(i * 37 % 256);
+    }
+    for (ResampleFilter filter : {ResampleFilter::Bilinear, ResampleFilter::Bicubic, ResampleFilter::Lanczos}) {
+        Frame output = resampleFrame(source, filter, 16, 8);
+        EXPECT_EQ(output.pixels, source.pixels) << static_cast<int>(filter);
+    }
+}
+
+TEST(ResamplerTests, FlatColorSurvivesScalingAwayFromEdges) {
+    Frame source(64, 64);
+    source.fill(30, 120, 210);
+    for (ResampleFilter filter : {ResampleFilter::Bilinear, ResampleFilter::Bicubic, ResampleFilter::Lanczos}) {
+        for (int size : {20, 64, 150}) {
+            Frame output = resampleFrame(source, filter, size, size);
+            const uint8_t* center = output.pixel(size / 2, size / 2);
+            EXPECT_NEAR(center[0], 30, 1);
+            EXPECT_NEAR(center[1], 120, 1);
+            EXPECT_NEAR(center[2], 210, 1);
+            EXPECT_EQ(center[3], 255);
+        }
+    }
+}
+
+TEST(ResamplerTests, OvershootIsClampedToValidPremultipliedPixels) {
+    // A hard black/white edge makes the negative lobes ring
+    Frame source(32, 4);
+    source.fill(0, 0, 0);
+    for (int y = 0; y < 4; y++) {
+        for (int x = 16; x < 32; x++) {
+            uint8_t* p = source.pixel(x, y);
+            p[0] = p[1] = p[2] = 255;
+        }
+    }
+    Frame output = resampleFrame(source, ResampleFilter::Lanczos, 77, 4);
+    for (int x = 0; x < output.width; x++) {
+        const uint8_t* p = output.pixel(x, 1);
+        EXPECT_LE(p[0], p[3]);
+        EXPECT_LE(p[2], p[3]);
+    }
+    // Dark side stays dark, light side stays light
+    EXPECT_LT(output.pixel(5, 1)[0], 8);
+    EXPECT_GT(output.pixel(70, 1)[0], 247);
+}
+
+TEST(ResamplerTests, PixelsOutsideTheSourceAreTransparent) {
+    Frame source(8, 8);
+    source.fill(255, 255, 255);
+    Resampler resampler;
+    // Columns 0-3 sample left of the source, 4-11 inside it
+    resampler.setColumns(ResampleFilter::Bicubic, -4, 1, 12, 1);
+    std::vector<uint8_t> row(12 * 4);
+    resampler.resampleRow(source.pixels.data(), source.stride, 8, 8, 4, row.data());
+    EXPECT_EQ(row[0 * 4 + 3], 0);
+    EXPECT_EQ(row[8 * 4 + 3], 255);
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CaptureEngine.h"
+#include "MediaDecoder.h"
+#include "RigidCaptureKit.h"
+#include "ScreenRecorder.h"
+
+using namespace rigid;
+
+namespace {
+
+/// State shared between a test and its source and sink, which the recorder owns
+struct Probe {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool sinkEntered = false;
+    bool gateOpen = true;
+    bool failWrites = false;
+    bool finished = false;
+    /// First pixel byte (the source's frame number) and index of each write
+    std::vector<std::pair<int, int64_t>> written;
+
+    template <typename Predicate>
+    bool waitFor(Predicate predicate) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(5), predicate);
+    }
+
+    void openGate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        gateOpen = true;
+        changed.notify_all();
+    }
+};
+
+/// Numbers its frames 1, 2, ... in the first pixel and goes away after `limit`
+class FakeSource : public CaptureSource {
+public:
+    FakeSource(Probe& probe, int limit, bool holdUntilSinkBusy = false)
+        : probe_(probe), limit_(limit), holdUntilSinkBusy_(holdUntilSinkBusy) {}
+
+    int width() const override { return 16; }
+    int height() const override { return 8; }
+
+    bool capture(uint8_t* pixels, int stride) override {
+        if (captured_ == limit_) return false;
+        // Keep later frames back until the sink is busy with the first, so
+        // the queue fills deterministically
+        if (captured_ == 1 && holdUntilSinkBusy_) probe_.waitFor([this] { return probe_.sinkEntered; });
+        captured_++;
+        std::memset(pixels, 0, static_cast<size_t>(stride) * height());
+        pixels[0] = static_cast<uint8_t>(captured_);
+        return true;
+    }
+
+private:
+    Probe& probe_;
+    const int limit_;
+    const bool holdUntilSinkBusy_;
+    int captured_ = 0;
+};
+
+class FakeSink : public FrameSink {
+public:
+    explicit FakeSink(Probe& probe) : probe_(probe) {}
+
+    void write(const SharedFrame& frame, int64_t frameIndex) override {
+        std::unique_lock<std::mutex> lock(probe_.mutex);
+        probe_.sinkEntered = true;
+        probe_.changed.notify_all();
+        probe_.changed.wait(lock, [this] { return probe_.gateOpen; });
+        if (probe_.failWrites) throw MediaError("disk full");
+        probe_.written.emplace_back(frame.pixels()[0], frameIndex);
+    }
+
+    void finish() override {
+        std::lock_guard<std::mutex> lock(probe_.mutex);
+        probe_.finished = true;
+    }
+
+private:
+    Probe& probe_;
+};
+
+/// Wait for a recording to end on its own, as it does once the source is gone
+bool waitUntilEnded(const ScreenRecorder& recorder) {
+    for (int i = 0; i < 500 && recorder.isRecording(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return !recorder.isRecording();
+}
+
+RecordingSettings settingsFor(BackpressurePolicy policy, uint32_t queueDepth = 8) {
+    RecordingSettings settings;
+    settings.fps = 200;
+    settings.backpressure.policy = policy;
+    settings.backpressure.queueDepth = queueDepth;
+    return settings;
+}
+
+std::vector<int> frameNumbers(const Probe& probe) {
+    std::vector<int> numbers;
+    for (const auto& write : probe.written) numbers.push_back(write.first);
+    return numbers;
+}
+
+} // namespace
+
+TEST(ScreenRecorderTests, WritesEveryFrameInOrder) {
+    Probe probe;
+    FrameRing ring(2);
+    CaptureStats stats;
+    ScreenRecorder recorder(std::make_unique<FakeSource>(probe, 10), std::make_unique<FakeSink>(probe), ring, stats,
+                            settingsFor(BackpressurePolicy::DropNewest));
+    recorder.start();
+    ASSERT_TRUE(waitUntilEnded(recorder));
+    recorder.stop();
+
+    EXPECT_TRUE(probe.finished);
+    EXPECT_EQ(frameNumbers(probe), (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+    for (size_t i = 1; i < probe.written.size(); i++) {
+        EXPECT_GT(probe.written[i].second, probe.written[i - 1].second);
+    }
+    // The ring is sized for the queue, not for what it was created with
+    EXPECT_EQ(ring.slotCount(), 8u);
+
+    const RigidCaptureStats snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.frames_captured, 10u);
+    EXPECT_EQ(snapshot.frames_encoded, 10u);
+    EXPECT_EQ(snapshot.frames_dropped, 0u);
+}
+
+TEST(ScreenRecorderTests, DropNewestKeepsQueuedFrames) {
+    Probe probe;
+    probe.gateOpen = false;
+    FrameRing ring(4);
+    CaptureStats stats;
+    ScreenRecorder recorder(std::make_unique<FakeSource>(probe, 10, true), std::make_unique<FakeSink>(probe), ring,
+                            stats, settingsFor(BackpressurePolicy::DropNewest, 4));
+    recorder.start();
+    ASSERT_TRUE(waitUntilEnded(recorder));
+    probe.openGate();
+    recorder.stop();
+
+    // Frame 1 is being written while 2 and 3 wait in a queue of two
+    EXPECT_EQ(frameNumbers(probe), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(stats.snapshot().frames_dropped, 7u);
+}
+
+TEST(ScreenRecorderTests, DropOldestKeepsLatestFrames) {
+    Probe probe;
+    probe.gateOpen = false;
+    FrameRing ring(4);
+    CaptureStats stats;
+    ScreenRecorder recorder(std::make_unique<FakeSource>(probe, 10, true), std::make_unique<FakeSink>(probe), ring,
+                            stats, settingsFor(BackpressurePolicy::DropOldest, 4));
+    recorder.start();
+    ASSERT_TRUE(waitUntilEnded(recorder));
+    probe.openGate();
+    recorder.stop();
+
+    EXPECT_EQ(frameNumbers(probe), (std::vector<int>{1, 9, 10}));
+    EXPECT_EQ(stats.snapshot().frames_dropped, 7u);
+}
+
+TEST(ScreenRecorderTests, SubscribersSeeRecordedFrames) {
+    Probe probe;
+    FrameRing ring(2);
+    CaptureStats stats;
+    std::vector<int> seen;
+    auto onFrame = [](void* context, RigidFrameRef frame) {
+        RigidFrameView view;
+        ASSERT_TRUE(rigid_frame_get_view(frame, &view));
+        static_cast<std::vector<int>*>(context)->push_back(view.pixels[0]);
+    };
+    ring.subscribe(onFrame, &seen);
+
+    ScreenRecorder recorder(std::make_unique<FakeSource>(probe, 5), std::make_unique<FakeSink>(probe), ring, stats,
+                            settingsFor(BackpressurePolicy::DropNewest));
+    recorder.start();
+    ASSERT_TRUE(waitUntilEnded(recorder));
+    recorder.stop();
+
+    EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 4, 5}));
+}
+
+TEST(ScreenRecorderTests, EncoderFailureEndsRecordingAndSurfacesOnStop) {
+    Probe probe;
+    probe.failWrites = true;
+    FrameRing ring(2);
+    CaptureStats stats;
+    ScreenRecorder recorder(std::make_unique<FakeSource>(probe, 1000), std::make_unique<FakeSink>(probe), ring, stats,
+                            settingsFor(BackpressurePolicy::DropNewest));
+    recorder.start();
+    ASSERT_TRUE(waitUntilEnded(recorder));
+
+    EXPECT_THROW(recorder.stop(), MediaError);
+    EXPECT_FALSE(probe.finished);
+}
+
+TEST(ScreenRecorderTests, AdaptiveFpsSlowsCaptureWhileDropping) {
+    Probe probe;
+    probe.gateOpen = false;
+    FrameRing ring(2);
+    CaptureStats stats;
+    ScreenRecorder recorder(std::make_unique<FakeSource>(probe, 100000), std::make_unique<FakeSink>(probe), ring,
+                            stats, settingsFor(BackpressurePolicy::AdaptiveFps, 4));
+    recorder.start();
+
+    // The governor looks at a second of frames before it steps down
+    for (int i = 0; i < 300 && stats.snapshot().current_fps >= 200; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_LT(stats.snapshot().current_fps, 200);
+
+    probe.openGate();
+    recorder.cancel();
+    EXPECT_FALSE(probe.finished);
+}
+
+TEST(ScreenRecorderTests, EngineRunsOneRecordingAtATime) {
+    Probe probe;
+    probe.gateOpen = false;
+    CaptureEngine engine;
+    engine.startRecording(std::make_unique<FakeSource>(probe, 100000), std::make_unique<FakeSink>(probe), 200);
+    EXPECT_TRUE(engine.isRecording());
+
+    try {
+        engine.startRecording(std::make_unique<FakeSource>(probe, 1), std::make_unique<FakeSink>(probe), 200);
+        ADD_FAILURE() << "second recording started";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_RECORDING_FAILED);
+    }
+
+    probe.openGate();
+    EXPECT_TRUE(engine.cancelRecording());
+    EXPECT_FALSE(engine.isRecording());
+    EXPECT_FALSE(engine.cancelRecording());
+}
+
+TEST(ScreenRecorderTests, CApiRejectsBadRequests) {
+    RigidCaptureHandle handle = rigid_capture_create();
+    EXPECT_EQ(rigid_capture_stop_recording(handle), RIGID_ERROR_NO_RECORDING);
+    EXPECT_EQ(rigid_capture_cancel_recording(handle), RIGID_ERROR_NO_RECORDING);
+    EXPECT_FALSE(rigid_capture_is_recording(handle));
+    EXPECT_EQ(rigid_capture_get_recording_duration_ms(handle), 0);
+
+    EXPECT_EQ(rigid_capture_start_region_recording(handle, 1, 0, 0, 0, 100, "/tmp/out.mp4", 30, 0, 0,
+                                                   RIGID_CODEC_H264, false, false, 1.0f),
+              RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_capture_start_display_recording(handle, 1, "/tmp/out.mp4", 0, 0, 30, 0, 0, 42, false, false, 1.0f),
+              RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_capture_start_display_recording(handle, 1, nullptr, 0, 0, 30, 0, 0, RIGID_CODEC_H264, false, false,
+                                                    1.0f),
+              RIGID_ERROR_INVALID_CONFIG);
+    rigid_capture_destroy(handle);
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PngWriter.h"
+#include "QoiWriter.h"
+#include "RigidCaptureKit.h"
+#include "Screenshot.h"
+
+using namespace rigid;
+
+namespace {
+
+/// A gradient source, or one whose target has gone away
+class FakeSource : public CaptureSource {
+public:
+    explicit FakeSource(bool gone = false) : gone_(gone) {}
+
+    int width() const override { return 9; }
+    int height() const override { return 4; }
+
+    bool capture(uint8_t* pixels, int stride) override {
+        if (gone_) return false;
+        for (int y = 0; y < height(); y++) {
+            for (int x = 0; x < width(); x++) {
+                uint8_t* p = pixels + y * stride + x * 4;
+                p[0] = static_cast<uint8_t>(x * 20);
+                p[1] = static_cast<uint8_t>(y * 60);
+                p[2] = 7;
+                p[3] = 255;
+            }
+        }
+        return true;
+    }
+
+private:
+    const bool gone_;
+};
+
+std::string tempPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+} // namespace
+
+TEST(ScreenshotTests, WritesTheCapturedFrame) {
+    FakeSource source;
+    const std::string path = tempPath("screenshot.png");
+    saveScreenshot(source, path);
+
+    std::vector<uint8_t> pixels(9 * 4 * 4);
+    source.capture(pixels.data(), 9 * 4);
+    EXPECT_EQ(readFile(path), encodePng(pixels.data(), 9 * 4, 9, 4));
+    std::remove(path.c_str());
+}
+
+TEST(ScreenshotTests, ReportsScreenshotFailures) {
+    FakeSource gone(true);
+    try {
+        saveScreenshot(gone, tempPath("gone.png"));
+        ADD_FAILURE() << "screenshot of a closed window";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_SCREENSHOT_FAILED);
+    }
+
+    FakeSource source;
+    try {
+        saveScreenshot(source, "/nonexistent-dir/shot.png");
+        ADD_FAILURE() << "wrote to a missing directory";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_SCREENSHOT_FAILED);
+    }
+}
+
+TEST(ScreenshotTests, CApiRejectsBadRequests) {
+    EXPECT_EQ(rigid_capture_screenshot_region(1, 0, 0, 0, 10, "/tmp/shot.png", 1.0f, false),
+              RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_capture_screenshot_region(1, 0, 0, 10, 10, nullptr, 1.0f, false), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_capture_screenshot_display(1, nullptr, 1.0f, false), RIGID_ERROR_INVALID_CONFIG);
+}
+
+TEST(ScreenshotTests, SessionSavesWholeSourceOrArea) {
+    ScreenshotSession session(std::make_unique<FakeSource>());
+    std::vector<uint8_t> full(9 * 4 * 4);
+    FakeSource().capture(full.data(), 9 * 4);
+
+    const std::string path = tempPath("session.png");
+    session.capture({}, path);
+    EXPECT_EQ(readFile(path), encodePng(full.data(), 9 * 4, 9, 4));
+
+    // Clamped to the source: columns 6-8 of rows 1-3
+    session.capture({6, 1, 10, 10}, path);
+    EXPECT_EQ(readFile(path), encodePng(&full[1 * 9 * 4 + 6 * 4], 9 * 4, 3, 3));
+    std::remove(path.c_str());
+
+    try {
+        session.capture({20, 0, 5, 5}, path);
+        ADD_FAILURE() << "captured outside the source";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_INVALID_CONFIG);
+    }
+}
+
+TEST(ScreenshotTests, SessionCApiRejectsBadRequests) {
+    EXPECT_EQ(rigid_screenshot_session_open(1, 1.0f, false, nullptr), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_screenshot_session_capture(nullptr, 0, 0, 0, 0, "/tmp/shot.png"), RIGID_ERROR_INVALID_CONFIG);
+    rigid_screenshot_session_close(nullptr);
+}
+
+TEST(ScreenshotTests, EncodesInTheBackgroundWhenAsked) {
+    EXPECT_EQ(rigid_screenshot_set_encoding(3, false), RIGID_ERROR_INVALID_CONFIG);
+    ASSERT_EQ(rigid_screenshot_set_encoding(RIGID_COMPRESSION_FAST, true), RIGID_SUCCESS);
+
+    ScreenshotSession session(std::make_unique<FakeSource>());
+    const std::string path = tempPath("background.qoi");
+    session.capture({}, path);
+    EXPECT_EQ(rigid_screenshot_wait_for_writes(), RIGID_SUCCESS);
+
+    std::vector<uint8_t> full(9 * 4 * 4);
+    FakeSource().capture(full.data(), 9 * 4);
+    EXPECT_EQ(readFile(path), encodeQoi(full.data(), 9 * 4, 9, 4));
+    std::remove(path.c_str());
+
+    session.capture({}, "/nonexistent-dir/shot.png");
+    EXPECT_EQ(rigid_screenshot_wait_for_writes(), RIGID_ERROR_SCREENSHOT_FAILED);
+    EXPECT_EQ(rigid_screenshot_wait_for_writes(), RIGID_SUCCESS);
+
+    ASSERT_EQ(rigid_screenshot_set_encoding(RIGID_COMPRESSION_DEFAULT, false), RIGID_SUCCESS);
+}
+
+TEST(ScreenshotTests, CapturesIntoSharedImages) {
+    std::vector<uint8_t> full(9 * 4 * 4);
+    FakeSource().capture(full.data(), 9 * 4);
+
+    FakeSource source;
+    RigidImageRef image = captureImage(source).release();
+    RigidImageView view;
+    ASSERT_TRUE(rigid_image_get_view(image, &view));
+    EXPECT_EQ(view.width, 9);
+    EXPECT_EQ(view.height, 4);
+    EXPECT_EQ(view.stride, 9 * 4);
+    EXPECT_EQ(view.format, RIGID_PIXEL_FORMAT_BGRA8);
+    EXPECT_EQ(std::vector<uint8_t>(view.pixels, view.pixels + full.size()), full);
+
+    EXPECT_EQ(rigid_image_retain(image), image);
+    rigid_image_release(image);
+    EXPECT_TRUE(rigid_image_get_view(image, &view));
+
+    // Saving in the background keeps the image alive past the caller's release
+    ASSERT_EQ(rigid_screenshot_set_encoding(RIGID_COMPRESSION_DEFAULT, true), RIGID_SUCCESS);
+    const std::string path = tempPath("buffer.png");
+    EXPECT_EQ(rigid_image_save(image, path.c_str()), RIGID_SUCCESS);
+    rigid_image_release(image);
+    EXPECT_EQ(rigid_screenshot_wait_for_writes(), RIGID_SUCCESS);
+    ASSERT_EQ(rigid_screenshot_set_encoding(RIGID_COMPRESSION_DEFAULT, false), RIGID_SUCCESS);
+    EXPECT_EQ(readFile(path), encodePng(full.data(), 9 * 4, 9, 4));
+    std::remove(path.c_str());
+}
+
+TEST(ScreenshotTests, SavesImagesNowAtTheirOwnCompression) {
+    std::vector<uint8_t> full(9 * 4 * 4);
+    FakeSource().capture(full.data(), 9 * 4);
+
+    FakeSource source;
+    RigidImageRef image = captureImage(source).release();
+
+    // Neither the process-wide level nor background mode applies
+    ASSERT_EQ(rigid_screenshot_set_encoding(RIGID_COMPRESSION_SMALLEST, true), RIGID_SUCCESS);
+    const std::string path = tempPath("now.png");
+    EXPECT_EQ(rigid_image_save_now(image, path.c_str(), RIGID_COMPRESSION_FAST), RIGID_SUCCESS);
+    EXPECT_EQ(readFile(path), encodePng(full.data(), 9 * 4, 9, 4, 1));
+    std::remove(path.c_str());
+
+    EXPECT_EQ(rigid_image_save_now(image, "/nonexistent-dir/shot.png", RIGID_COMPRESSION_FAST),
+              RIGID_ERROR_SCREENSHOT_FAILED);
+    EXPECT_EQ(rigid_screenshot_wait_for_writes(), RIGID_SUCCESS);
+    ASSERT_EQ(rigid_screenshot_set_encoding(RIGID_COMPRESSION_DEFAULT, false), RIGID_SUCCESS);
+
+    EXPECT_EQ(rigid_image_save_now(image, path.c_str(), 3), RIGID_ERROR_INVALID_CONFIG);
+    rigid_image_release(image);
+}
+
+TEST(ScreenshotTests, SessionCapturesAreasIntoMemory) {
+    ScreenshotSession session(std::make_unique<FakeSource>());
+    std::vector<uint8_t> full(9 * 4 * 4);
+    FakeSource().capture(full.data(), 9 * 4);
+
+    // Clamped to the source: columns 6-8 of rows 1-3
+    CapturedImagePtr image = session.captureImage({6, 1, 10, 10});
+    ASSERT_EQ(image->width(), 3);
+    ASSERT_EQ(image->height(), 3);
+    for (int y = 0; y < 3; y++) {
+        EXPECT_EQ(0, std::memcmp(image->pixels() + y * image->stride(), &full[(y + 1) * 9 * 4 + 6 * 4], 3 * 4))
+            << "row " << y;
+    }
+}
+
+TEST(ScreenshotTests, BufferCApiRejectsBadRequests) {
+    RigidImageRef image = nullptr;
+    EXPECT_EQ(rigid_capture_screenshot_display_to_buffer(1, 1.0f, false, nullptr), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_capture_screenshot_region_to_buffer(1, 0, 0, 10, 0, 1.0f, false, &image),
+              RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_screenshot_session_capture_to_buffer(nullptr, 0, 0, 0, 0, &image), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(image, nullptr);
+
+    RigidImageView view;
+    EXPECT_FALSE(rigid_image_get_view(nullptr, &view));
+    EXPECT_EQ(rigid_image_retain(nullptr), nullptr);
+    rigid_image_release(nullptr);
+    EXPECT_EQ(rigid_image_save(nullptr, "/tmp/shot.png"), RIGID_ERROR_INVALID_CONFIG);
+    EXPECT_EQ(rigid_image_save_now(nullptr, "/tmp/shot.png", RIGID_COMPRESSION_FAST), RIGID_ERROR_INVALID_CONFIG);
+}
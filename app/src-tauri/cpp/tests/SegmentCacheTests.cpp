@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "MediaEncoder.h"
+#include "SegmentCache.h"
+
+using namespace rigid;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+/// Fresh directory under the system temp dir, removed afterwards
+class TempDir {
+public:
+    explicit TempDir(const std::string& name) : path_(fs::temp_directory_path() / name) {
+        fs::remove_all(path_);
+        fs::create_directories(path_);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        fs::remove_all(path_, ec);
+    }
+
+    const fs::path& path() const { return path_; }
+
+private:
+    fs::path path_;
+};
+
+void writeFile(const fs::path& path, size_t bytes) {
+    std::ofstream(path, std::ios::binary) << std::string(bytes, 'x');
+}
+
+/// 60 s at 30 fps with clips at 0-10 s and 20-30 s
+CompositorConfig twoClipConfig(const std::string& sourcePath) {
+    CompositorConfig config;
+    config.width = 1280;
+    config.height = 720;
+    config.frameRate = 30;
+    config.durationMs = 60000;
+
+    CompositorClip first;
+    first.sourcePath = sourcePath;
+    first.startTimeMs = 0;
+    first.durationMs = 10000;
+    config.clips.push_back(first);
+
+    CompositorClip second = first;
+    second.startTimeMs = 20000;
+    config.clips.push_back(second);
+    return config;
+}
+
+EncoderSettings settingsFor(const CompositorConfig& config) {
+    EncoderSettings settings;
+    settings.width = config.width;
+    settings.height = config.height;
+    settings.frameRate = config.frameRate;
+    return settings;
+}
+
+} // namespace
+
+TEST(SegmentCacheTests, KeyChangesOnlyForChunksAnEditTouches) {
+    TempDir dir("rigid-segment-key-test");
+    writeFile(dir.path() / "source.mp4", 16);
+    CompositorConfig config = twoClipConfig((dir.path() / "source.mp4").string());
+    EncoderSettings settings = settingsFor(config);
+
+    FrameRange firstChunk{0, 300};   // 0-10 s, first clip
+    FrameRange secondChunk{600, 900};  // 20-30 s, second clip
+    std::string firstKey = SegmentCache::keyFor(config, settings, firstChunk);
+    std::string secondKey = SegmentCache::keyFor(config, settings, secondChunk);
+    EXPECT_EQ(firstKey, SegmentCache::keyFor(config, settings, firstChunk));
+    EXPECT_NE(firstKey, secondKey);
+
+    config.clips[1].opacity = 0.5;
+    EXPECT_EQ(SegmentCache::keyFor(config, settings, firstChunk), firstKey);
+    EXPECT_NE(SegmentCache::keyFor(config, settings, secondChunk), secondKey);
+
+    // Audio-only settings never change frames
+    config.clips[0].audioFadeInMs = 500;
+    config.clips[0].muted = true;
+    EXPECT_EQ(SegmentCache::keyFor(config, settings, firstChunk), firstKey);
+
+    settings.quality = CompositorQuality::Max;
+    EXPECT_NE(SegmentCache::keyFor(config, settings, firstChunk), firstKey);
+}
+
+TEST(SegmentCacheTests, KeyChangesWhenSourceFileChanges) {
+    TempDir dir("rigid-segment-source-test");
+    fs::path source = dir.path() / "source.mp4";
+    writeFile(source, 16);
+    CompositorConfig config = twoClipConfig(source.string());
+    EncoderSettings settings = settingsFor(config);
+
+    std::string before = SegmentCache::keyFor(config, settings, {0, 300});
+    fs::last_write_time(source, fs::last_write_time(source) + std::chrono::seconds(5));
+    EXPECT_NE(SegmentCache::keyFor(config, settings, {0, 300}), before);
+}
+
+TEST(SegmentCacheTests, CommittedSegmentsAreFoundAgain) {
+    TempDir dir("rigid-segment-commit-test");
+    SegmentCache cache(dir.path(), 1024 * 1024);
+
+    EXPECT_FALSE(cache.acquire("abc").has_value());
+
+    std::string pending = cache.pendingPathFor("abc");
+    EXPECT_NE(pending, cache.pendingPathFor("abc"));
+    writeFile(pending, 100);
+    std::string committed = cache.commit("abc", pending);
+    EXPECT_FALSE(fs::exists(pending));
+    cache.release({"abc"});
+
+    std::optional<std::string> found = cache.acquire("abc");
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(*found, committed);
+    EXPECT_EQ(cache.sizeBytes(), 100u);
+    cache.release({"abc"});
+}
+
+TEST(SegmentCacheTests, TrimsLeastRecentlyUsedButNeverPinned) {
+    TempDir dir("rigid-segment-trim-test");
+    SegmentCache cache(dir.path(), 250);
+
+    auto store = [&](const std::string& key) {
+        std::string pending = cache.pendingPathFor(key);
+        writeFile(pending, 100);
+        cache.commit(key, pending);
+    };
+
+    store("old");
+    store("pinned");
+    cache.release({"old"});
+    // Make "old" the least recently used regardless of timestamp resolution
+    fs::path oldPath = dir.path() / "old.mp4";
+    fs::last_write_time(oldPath, fs::last_write_time(oldPath) - std::chrono::hours(1));
+    fs::path pinnedPath = dir.path() / "pinned.mp4";
+    fs::last_write_time(pinnedPath, fs::last_write_time(pinnedPath) - std::chrono::hours(2));
+
+    // 300 bytes > 250: the oldest unpinned segment goes, the pinned one stays
+    store("new");
+    cache.release({"new"});
+    EXPECT_FALSE(cache.acquire("old").has_value());
+    EXPECT_TRUE(fs::exists(pinnedPath));
+    EXPECT_TRUE(fs::exists(dir.path() / "new.mp4"));
+
+    cache.release({"pinned"});
+    EXPECT_LE(cache.sizeBytes(), 250u);
+}
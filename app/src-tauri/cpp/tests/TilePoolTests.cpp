@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "TilePool.h"
+
+using namespace rigid;
+
+TEST(TilePoolTests, RunsEveryTaskOnce) {
+    TilePool pool(4);
+    EXPECT_EQ(pool.workerCount(), 4);
+
+    // Reused across runs, like one pool per compositor
+    for (int run = 0; run < 20; run++) {
+        std::vector<std::atomic<int>> counts(97);
+        std::atomic<int> badWorker{0};
+        pool.run(counts.size(), [&](size_t task, int worker) {
+            if (worker < 0 || worker >= pool.workerCount()) badWorker++;
+            counts[task]++;
+        });
+        for (auto& count : counts) ASSERT_EQ(count.load(), 1);
+        EXPECT_EQ(badWorker.load(), 0);
+    }
+}
+
+TEST(TilePoolTests, SingleThreadRunsOnCaller) {
+    TilePool pool(1);
+    EXPECT_EQ(pool.workerCount(), 1);
+    int sum = 0;
+    pool.run(10, [&](size_t task, int worker) {
+        EXPECT_EQ(worker, 0);
+        sum += static_cast<int>(task);
+    });
+    EXPECT_EQ(sum, 45);
+}
+
+TEST(TilePoolTests, RethrowsTaskFailure) {
+    TilePool pool(3);
+    EXPECT_THROW(pool.run(50, [](size_t task, int) {
+        if (task == 7) throw std::runtime_error("tile failed");
+    }),
+                 std::runtime_error);
+
+    // Still usable afterwards
+    std::atomic<int> ran{0};
+    pool.run(5, [&](size_t, int) { ran++; });
+    EXPECT_EQ(ran.load(), 5);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "TimelineIndex.h"
+
+using namespace rigid;
+
+namespace {
+
+std::vector<size_t> activeByScan(const std::vector<TimelineIndex::Interval>& intervals, double timeSec) {
+    std::vector<size_t> active;
+    for (size_t i = 0; i < intervals.size(); i++) {
+        if (timeSec >= intervals[i].startSec && timeSec < intervals[i].endSec) active.push_back(i);
+    }
+    return active;
+}
+
+} // namespace
+
+TEST(TimelineIndexTests, EmptyIndexHasNothingActive) {
+    TimelineIndex index;
+    EXPECT_TRUE(index.activeAt(0).empty());
+    EXPECT_TRUE(index.activeAt(10).empty());
+}
+
+TEST(TimelineIndexTests, IntervalsAreHalfOpen) {
+    TimelineIndex index({{1.0, 2.0}});
+
+    EXPECT_TRUE(index.activeAt(0.999).empty());
+    EXPECT_EQ(index.activeAt(1.0), std::vector<size_t>{0});
+    EXPECT_EQ(index.activeAt(1.999), std::vector<size_t>{0});
+    EXPECT_TRUE(index.activeAt(2.0).empty());
+}
+
+TEST(TimelineIndexTests, KeepsInputOrderForOverlaps) {
+    // Input order stands for z-order, so it must survive regardless of start times
+    TimelineIndex index({{2.0, 6.0}, {0.0, 4.0}, {3.0, 5.0}});
+
+    EXPECT_EQ(index.activeAt(1.0), (std::vector<size_t>{1}));
+    EXPECT_EQ(index.activeAt(2.5), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(index.activeAt(3.5), (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(index.activeAt(4.5), (std::vector<size_t>{0, 2}));
+    EXPECT_EQ(index.activeAt(5.5), (std::vector<size_t>{0}));
+}
+
+TEST(TimelineIndexTests, SkipsEmptyIntervals) {
+    TimelineIndex index({{1.0, 1.0}, {0.0, 2.0}, {3.0, 2.0}});
+
+    EXPECT_EQ(index.activeAt(1.0), std::vector<size_t>{1});
+    EXPECT_TRUE(index.activeAt(2.5).empty());
+}
+
+TEST(TimelineIndexTests, MatchesLinearScan) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> startMs(0, 60000);
+    std::uniform_int_distribution<int> durationMs(0, 5000);
+
+    std::vector<TimelineIndex::Interval> intervals;
+    for (int i = 0; i < 300; i++) {
+        double start = startMs(rng) / 1000.0;
+        intervals.push_back({start, start + durationMs(rng) / 1000.0});
+    }
+    TimelineIndex index(intervals);
+
+    for (int frame = 0; frame < 66 * 30; frame++) {
+        double timeSec = frame / 30.0;
+        ASSERT_EQ(index.activeAt(timeSec), activeByScan(intervals, timeSec)) << "at " << timeSec;
+    }
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "X11Capture.h"
+
+using namespace rigid;
+
+// These run against $DISPLAY (CI runs them under Xvfb) and skip without one.
+
+namespace {
+
+bool haveDisplay() {
+    return !listX11Displays().empty();
+}
+
+} // namespace
+
+TEST(X11CaptureTests, CapturesOpaqueDisplayFrames) {
+    if (!haveDisplay()) GTEST_SKIP() << "no X display";
+
+    const X11DisplayInfo display = listX11Displays().front();
+    EXPECT_EQ(display.id, 1u);
+    EXPECT_TRUE(display.isMain);
+
+    auto source = X11CaptureSource::openDisplay(display.id, false);
+    ASSERT_EQ(source->width(), display.width);
+    ASSERT_EQ(source->height(), display.height);
+
+    const int stride = source->width() * 4;
+    std::vector<uint8_t> pixels(static_cast<size_t>(stride) * source->height());
+    ASSERT_TRUE(source->capture(pixels.data(), stride));
+    ASSERT_TRUE(source->capture(pixels.data(), stride));
+    for (size_t i = 3; i < pixels.size(); i += 4) ASSERT_EQ(pixels[i], 255) << "pixel " << i / 4;
+}
+
+TEST(X11CaptureTests, RegionMatchesDisplayPixels) {
+    if (!haveDisplay()) GTEST_SKIP() << "no X display";
+
+    const X11DisplayInfo display = listX11Displays().front();
+    if (display.width < 64 || display.height < 48) GTEST_SKIP() << "display too small";
+
+    auto whole = X11CaptureSource::openDisplay(display.id, false);
+    std::vector<uint8_t> screen(static_cast<size_t>(display.width) * display.height * 4);
+    ASSERT_TRUE(whole->capture(screen.data(), display.width * 4));
+
+    const PixelRect rect{10, 20, 33, 17};
+    auto region = X11CaptureSource::openRegion(display.id, rect, false);
+    ASSERT_EQ(region->width(), rect.width);
+    ASSERT_EQ(region->height(), rect.height);
+
+    // Padded stride: the source must honour it
+    const int stride = rect.width * 4 + 12;
+    std::vector<uint8_t> pixels(static_cast<size_t>(stride) * rect.height);
+    ASSERT_TRUE(region->capture(pixels.data(), stride));
+    for (int y = 0; y < rect.height; y++) {
+        const uint8_t* expected = &screen[(static_cast<size_t>(rect.y + y) * display.width + rect.x) * 4];
+        ASSERT_EQ(0, std::memcmp(&pixels[static_cast<size_t>(y) * stride], expected, rect.width * 4)) << "row " << y;
+    }
+}
+
+TEST(X11CaptureTests, RejectsMissingTargets) {
+    if (!haveDisplay()) GTEST_SKIP() << "no X display";
+
+    try {
+        X11CaptureSource::openDisplay(99, false);
+        ADD_FAILURE() << "opened display 99";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_DISPLAY_NOT_FOUND);
+    }
+    try {
+        X11CaptureSource::openRegion(1, {-500, -500, 10, 10}, false);
+        ADD_FAILURE() << "opened a region off the display";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_INVALID_CONFIG);
+    }
+    try {
+        X11CaptureSource::openWindow(0x7ffffff0, false);
+        ADD_FAILURE() << "opened a missing window";
+    } catch (const CaptureFailure& e) {
+        EXPECT_EQ(e.code, RIGID_ERROR_WINDOW_NOT_FOUND);
+    }
+}
+
+TEST(X11CaptureTests, AreaMatchesWholeCapture) {
+    if (!haveDisplay()) GTEST_SKIP() << "no X display";
+
+    const X11DisplayInfo display = listX11Displays().front();
+    if (display.width < 64 || display.height < 48) GTEST_SKIP() << "display too small";
+
+    auto source = X11CaptureSource::openDisplay(display.id, false);
+    std::vector<uint8_t> screen(static_cast<size_t>(display.width) * display.height * 4);
+    ASSERT_TRUE(source->capture(screen.data(), display.width * 4));
+
+    // Through the display's own shared memory segment, at a smaller size
+    const PixelRect area{5, 7, 21, 13};
+    std::vector<uint8_t> pixels(static_cast<size_t>(area.width) * area.height * 4);
+    ASSERT_TRUE(source->captureArea(area, pixels.data(), area.width * 4));
+    for (int y = 0; y < area.height; y++) {
+        const uint8_t* expected = &screen[(static_cast<size_t>(area.y + y) * display.width + area.x) * 4];
+        ASSERT_EQ(0, std::memcmp(&pixels[static_cast<size_t>(y) * area.width * 4], expected, area.width * 4))
+            << "row " << y;
+    }
+}
@@ -12,11 +12,15 @@ use crate::repositories::{ScreenshotRepository, RecordingRepository};
 // Types used in public function signatures - must be available on all platforms
 use crate::native::{NativeWindowInfo, NativeDisplayInfo};
 
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 use crate::native::{
-    NativeCaptureEngine,
+    ImageCompression, ImageFormat, NativeCaptureEngine, NativeScreenshotSession,
     RecordingConfig as NativeRecordingConfig, ScreenshotConfig as NativeScreenshotConfig,
     VideoCodec,
+};
+
+#[cfg(target_os = "macos")]
+use crate::native::{
     webcam_list_audio_devices, webcam_list_video_devices, webcam_start_recording, webcam_stop_recording,
     WebcamAudioDevice as NativeWebcamAudioDevice,
     WebcamVideoDevice as NativeWebcamVideoDevice,
@@ -1174,36 +1178,44 @@ pub struct NativeRecordingOptions {
 }
 
 /// Native screenshot configuration from frontend
-#[derive(Debug, Clone, Serialize, Deserialize)]
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
 pub struct NativeScreenshotOptions {
     /// Capture at retina resolution (default: true)
     pub retina_capture: Option<bool>,
     /// Include cursor in capture (default: false)
     pub capture_cursor: Option<bool>,
+    /// File format: "png" (default), "qoi" or "webp" (Linux with libwebp only)
+    pub format: Option<String>,
+    /// Compression: "fast", "default" (default) or "smallest"
+    pub compression: Option<String>,
 }
 
 // NativeWindowInfo and NativeDisplayInfo are defined in crate::native and re-exported
 
 /// State for native capture engine
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 pub struct NativeCaptureState {
     pub engine: std::sync::Mutex<Option<NativeCaptureEngine>>,
     pub current_recording_id: Mutex<Option<String>>,
     pub start_time: Mutex<Option<i64>>,
+    /// Open screenshot session, used by capture_native_screenshot for its
+    /// display. Captures clone it out, so the lock is never held across one.
+    pub screenshot_session: std::sync::Mutex<Option<std::sync::Arc<NativeScreenshotSession>>>,
 }
 
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 impl NativeCaptureState {
     pub fn new() -> Self {
         Self {
             engine: std::sync::Mutex::new(NativeCaptureEngine::new()),
             current_recording_id: Mutex::new(None),
             start_time: Mutex::new(None),
+            screenshot_session: std::sync::Mutex::new(None),
         }
     }
 }
 
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 impl Default for NativeCaptureState {
     fn default() -> Self {
         Self::new()
@@ -1213,11 +1225,11 @@ impl Default for NativeCaptureState {
 /// Check if native screen capture permission is granted
 #[tauri::command]
 pub async fn check_native_capture_permission() -> Result<bool, RigidError> {
-    #[cfg(target_os = "macos")]
+    #[cfg(any(target_os = "macos", target_os = "linux"))]
     {
         Ok(NativeCaptureEngine::check_permission())
     }
-    #[cfg(not(target_os = "macos"))]
+    #[cfg(not(any(target_os = "macos", target_os = "linux")))]
     {
         Ok(true)
     }
@@ -1226,7 +1238,7 @@ pub async fn check_native_capture_permission() -> Result<bool, RigidError> {
 /// Request native screen capture permission
 #[tauri::command]
 pub async fn request_native_capture_permission() -> Result<(), RigidError> {
-    #[cfg(target_os = "macos")]
+    #[cfg(any(target_os = "macos", target_os = "linux"))]
     {
         NativeCaptureEngine::request_permission();
     }
@@ -1304,7 +1316,7 @@ pub async fn request_microphone_permission() -> Result<(), RigidError> {
 /// List all windows using native ScreenCaptureKit
 #[tauri::command]
 pub async fn list_windows_native() -> Result<Vec<NativeWindowInfo>, RigidError> {
-    #[cfg(target_os = "macos")]
+    #[cfg(any(target_os = "macos", target_os = "linux"))]
     {
         let windows = NativeCaptureEngine::list_windows()
             .map_err(|e| RigidError::Internal(e.to_string()))?;
@@ -1323,7 +1335,7 @@ pub async fn list_windows_native() -> Result<Vec<NativeWindowInfo>, RigidError>
             })
             .collect())
     }
-    #[cfg(not(target_os = "macos"))]
+    #[cfg(not(any(target_os = "macos", target_os = "linux")))]
     {
         Err(RigidError::Internal("Native capture not supported on this platform".into()))
     }
@@ -1332,7 +1344,7 @@ pub async fn list_windows_native() -> Result<Vec<NativeWindowInfo>, RigidError>
 /// List all displays using native ScreenCaptureKit
 #[tauri::command]
 pub async fn list_displays_native() -> Result<Vec<NativeDisplayInfo>, RigidError> {
-    #[cfg(target_os = "macos")]
+    #[cfg(any(target_os = "macos", target_os = "linux"))]
     {
         let displays = NativeCaptureEngine::list_displays()
             .map_err(|e| RigidError::Internal(e.to_string()))?;
@@ -1349,14 +1361,14 @@ pub async fn list_displays_native() -> Result<Vec<NativeDisplayInfo>, RigidError
             })
             .collect())
     }
-    #[cfg(not(target_os = "macos"))]
+    #[cfg(not(any(target_os = "macos", target_os = "linux")))]
     {
         Err(RigidError::Internal("Native capture not supported on this platform".into()))
     }
 }
 
 /// Start native screen recording with ScreenCaptureKit
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn start_native_recording(
     app_id: Option<String>,
@@ -1510,7 +1522,7 @@ pub async fn start_native_recording(
 }
 
 /// Stop native screen recording
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn stop_native_recording(
     recording_repo: State<'_, RecordingRepository>,
@@ -1562,7 +1574,7 @@ pub async fn stop_native_recording(
 }
 
 /// Cancel native screen recording without saving
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn cancel_native_recording(
     recording_repo: State<'_, RecordingRepository>,
@@ -1593,7 +1605,7 @@ pub async fn cancel_native_recording(
 }
 
 /// Check if native recording is in progress
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn is_native_recording(
     native_state: State<'_, NativeCaptureState>,
@@ -1607,7 +1619,7 @@ pub async fn is_native_recording(
 }
 
 /// Get current native recording ID
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn get_native_recording_id(
     native_state: State<'_, NativeCaptureState>,
@@ -1616,7 +1628,7 @@ pub async fn get_native_recording_id(
 }
 
 /// Get current native recording duration in milliseconds
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn get_native_recording_duration(
     native_state: State<'_, NativeCaptureState>,
@@ -1629,8 +1641,80 @@ pub async fn get_native_recording_duration(
     }
 }
 
+/// Open a screenshot session on a display (the main one by default), so
+/// capture_native_screenshot on it returns without setting up a capture.
+/// Replaces any open session. The display stays captured until the session
+/// is closed, so open one only while a fast screenshot path is wanted.
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+#[tauri::command]
+pub async fn open_native_screenshot_session(
+    display_id: Option<u32>,
+    options: Option<NativeScreenshotOptions>,
+    native_state: State<'_, NativeCaptureState>,
+) -> Result<(), RigidError> {
+    let opts = options.unwrap_or_default();
+
+    let config = NativeScreenshotConfig {
+        scale_factor: if opts.retina_capture.unwrap_or(true) { 2.0 } else { 1.0 },
+        capture_cursor: opts.capture_cursor.unwrap_or(false),
+        ..Default::default()
+    };
+
+    let display_id = match display_id {
+        Some(did) => did,
+        None => {
+            let displays = NativeCaptureEngine::list_displays()
+                .map_err(|e| RigidError::Internal(e.to_string()))?;
+            displays
+                .iter()
+                .find(|d| d.is_main)
+                .or_else(|| displays.first())
+                .map(|d| d.display_id)
+                .ok_or_else(|| RigidError::Internal("No displays found".into()))?
+        }
+    };
+
+    // Close the old session first, so two never capture at once (one still
+    // finishing a capture closes when that capture returns)
+    native_state.screenshot_session.lock().unwrap().take();
+    let session = NativeScreenshotSession::open(display_id, &config)
+        .map_err(|e| RigidError::Internal(e.to_string()))?;
+    *native_state.screenshot_session.lock().unwrap() = Some(std::sync::Arc::new(session));
+    Ok(())
+}
+
+/// Close the open screenshot session, if any
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+#[tauri::command]
+pub async fn close_native_screenshot_session(
+    native_state: State<'_, NativeCaptureState>,
+) -> Result<(), RigidError> {
+    native_state.screenshot_session.lock().unwrap().take();
+    Ok(())
+}
+
+/// Run a native screenshot call, which blocks until the screen is captured
+/// and any file is written, on a blocking thread
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+async fn run_blocking_capture<T, E>(
+    capture: impl FnOnce() -> Result<T, E> + Send + 'static,
+) -> Result<T, RigidError>
+where
+    T: Send + 'static,
+    E: std::fmt::Display + Send + 'static,
+{
+    tauri::async_runtime::spawn_blocking(capture)
+        .await
+        .map_err(|e| RigidError::Internal(e.to_string()))?
+        .map_err(|e| RigidError::Internal(e.to_string()))
+}
+
 /// Capture native screenshot with ScreenCaptureKit
-#[cfg(target_os = "macos")]
+///
+/// An open screenshot session is used only when it is on the requested
+/// display and was opened with the same `capture_cursor` and
+/// `retina_capture` options; otherwise the screenshot is set up from scratch.
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn capture_native_screenshot(
     app_id: Option<String>,
@@ -1642,6 +1726,7 @@ pub async fn capture_native_screenshot(
     options: Option<NativeScreenshotOptions>,
     app: AppHandle,
     screenshot_repo: State<'_, ScreenshotRepository>,
+    native_state: State<'_, NativeCaptureState>,
 ) -> Result<Screenshot, RigidError> {
     let data_dir = app
         .path()
@@ -1651,34 +1736,69 @@ pub async fn capture_native_screenshot(
     let screenshots_dir = data_dir.join("screenshots");
     std::fs::create_dir_all(&screenshots_dir).map_err(RigidError::Io)?;
 
+    let opts = options.unwrap_or_default();
+
+    let format = opts
+        .format
+        .as_deref()
+        .and_then(|f| f.parse::<ImageFormat>().ok())
+        .unwrap_or_default();
+    let compression = opts
+        .compression
+        .as_deref()
+        .and_then(|c| c.parse::<ImageCompression>().ok())
+        .unwrap_or_default();
+
     let timestamp = Utc::now().format("%Y%m%d_%H%M%S").to_string();
-    let filename = format!("screenshot_{}.png", timestamp);
+    let filename = format!("screenshot_{}.{}", timestamp, format.file_extension());
     let screenshot_path = screenshots_dir.join(&filename);
 
-    let opts = options.unwrap_or(NativeScreenshotOptions {
-        retina_capture: None,
-        capture_cursor: None,
-    });
-
+    // Each capture is encoded at its own compression before it returns, so
+    // the record below points at a file already on disk
     let config = NativeScreenshotConfig {
         scale_factor: if opts.retina_capture.unwrap_or(true) { 2.0 } else { 1.0 },
         capture_cursor: opts.capture_cursor.unwrap_or(false),
+        compression,
+    };
+
+    // An open session on the requested display (the main one by default)
+    // captures without setting up a capture first
+    let session = if window_id.is_none() {
+        let session = native_state.screenshot_session.lock().unwrap().clone();
+        session.filter(|session| {
+            let main_display = || {
+                NativeCaptureEngine::list_displays()
+                    .ok()
+                    .and_then(|displays| displays.into_iter().find(|d| d.is_main))
+                    .map(|d| d.display_id)
+            };
+            session.captures_like(&config)
+                && display_id.or_else(main_display) == Some(session.display_id())
+        })
+    } else {
+        None
     };
 
     // Capture screenshot
-    if let Some(wid) = window_id {
-        crate::native::screenshot_window(wid, &screenshot_path, &config)
-            .await
-            .map_err(|e| RigidError::Internal(e.to_string()))?;
+    let output_path = screenshot_path.clone();
+    if let Some(session) = session {
+        let session_region = if display_id.is_some() { region } else { None };
+        run_blocking_capture(move || session.capture(session_region, &output_path, compression))
+            .await?;
+    } else if let Some(wid) = window_id {
+        run_blocking_capture(move || crate::native::screenshot_window(wid, &output_path, &config))
+            .await?;
     } else if let Some(did) = display_id {
         if let Some((x, y, w, h)) = region {
-            crate::native::screenshot_region(did, x, y, w, h, &screenshot_path, &config)
-                .await
-                .map_err(|e| RigidError::Internal(e.to_string()))?;
+            run_blocking_capture(move || {
+                crate::native::screenshot_region(did, x, y, w, h, &output_path, &config)
+            })
+            .await?;
         } else {
-            crate::native::screenshot_display(did, &screenshot_path, &config)
-                .await
-                .map_err(|e| RigidError::Internal(e.to_string()))?;
+            run_blocking_capture(move || {
+                crate::native::screenshot_display(did, &output_path, &config)
+            })
+            .await?;
         }
     } else {
         // Default to main display
@@ -1688,11 +1808,13 @@ pub async fn capture_native_screenshot(
             .iter()
             .find(|d| d.is_main)
             .or_else(|| displays.first())
-            .ok_or_else(|| RigidError::Internal("No displays found".into()))?;
+            .ok_or_else(|| RigidError::Internal("No displays found".into()))?
+            .display_id;
 
-        crate::native::screenshot_display(main_display.display_id, &screenshot_path, &config)
-            .await
-            .map_err(|e| RigidError::Internal(e.to_string()))?;
+        run_blocking_capture(move || {
+            crate::native::screenshot_display(main_display, &output_path, &config)
+        })
+        .await?;
     }
 
     // Create screenshot record
@@ -1706,3 +1828,78 @@ pub async fn capture_native_screenshot(
 
     screenshot_repo.create(new_screenshot).await
 }
+
+/// Width and height as little-endian u32, then the image's RGBA rows
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+fn pixel_bytes(image: &crate::native::NativeImage) -> Vec<u8> {
+    let mut bytes = Vec::with_capacity(8 + image.width() as usize * image.height() as usize * 4);
+    bytes.extend_from_slice(&image.width().to_le_bytes());
+    bytes.extend_from_slice(&image.height().to_le_bytes());
+    bytes.extend_from_slice(&image.to_rgba());
+    bytes
+}
+
+/// Capture a native screenshot into memory and return its pixels, to show
+/// without a PNG written and read back. The response is raw bytes: width
+/// and height as little-endian u32, then RGBA rows.
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+#[tauri::command]
+pub async fn capture_native_screenshot_pixels(
+    window_id: Option<u32>,
+    display_id: Option<u32>,
+    region: Option<(i32, i32, i32, i32)>, // x, y, width, height
+    options: Option<NativeScreenshotOptions>,
+    native_state: State<'_, NativeCaptureState>,
+) -> Result<tauri::ipc::Response, RigidError> {
+    let opts = options.unwrap_or_default();
+
+    let config = NativeScreenshotConfig {
+        scale_factor: if opts.retina_capture.unwrap_or(true) { 2.0 } else { 1.0 },
+        capture_cursor: opts.capture_cursor.unwrap_or(false),
+        ..Default::default()
+    };
+
+    let bytes = if let Some(wid) = window_id {
+        run_blocking_capture(move || {
+            crate::native::screenshot_window_to_buffer(wid, &config).map(|image| pixel_bytes(&image))
+        })
+        .await?
+    } else {
+        // As in capture_native_screenshot, a region applies to an explicit
+        // display only; the main display is captured whole
+        let region = display_id.and(region);
+        let did = match display_id {
+            Some(did) => did,
+            None => {
+                let displays = NativeCaptureEngine::list_displays()
+                    .map_err(|e| RigidError::Internal(e.to_string()))?;
+                displays
+                    .iter()
+                    .find(|d| d.is_main)
+                    .or_else(|| displays.first())
+                    .map(|d| d.display_id)
+                    .ok_or_else(|| RigidError::Internal("No displays found".into()))?
+            }
+        };
+
+        // As in capture_native_screenshot, an open session on the display
+        // with the same options captures from the frame it already has
+        let session = native_state.screenshot_session.lock().unwrap().clone();
+        let session = session
+            .filter(|session| session.display_id() == did && session.captures_like(&config));
+
+        run_blocking_capture(move || {
+            match (session, region) {
+                (Some(session), region) => session.capture_to_buffer(region),
+                (None, Some((x, y, w, h))) => {
+                    crate::native::screenshot_region_to_buffer(did, x, y, w, h, &config)
+                }
+                (None, None) => crate::native::screenshot_display_to_buffer(did, &config),
+            }
+            .map(|image| pixel_bytes(&image))
+        })
+        .await?
+    };
+
+    Ok(tauri::ipc::Response::new(bytes))
+}
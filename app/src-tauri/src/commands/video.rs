@@ -1600,6 +1600,17 @@ pub async fn render_demo_background(
     app: AppHandle,
     export_id: String,
     config: RenderDemoConfig,
+) -> Result<String, RigidError> {
+    start_ffmpeg_render(app, export_id, config, true).await
+}
+
+/// Start an FFmpeg render, announcing it with `export-started` unless the
+/// caller (a native render falling back to FFmpeg) already did
+async fn start_ffmpeg_render(
+    app: AppHandle,
+    export_id: String,
+    config: RenderDemoConfig,
+    emit_started: bool,
 ) -> Result<String, RigidError> {
     use std::process::Stdio;
     use std::time::Instant;
@@ -1611,12 +1622,14 @@ pub async fn render_demo_background(
     let export_id_clone = export_id.clone();
 
     // Emit export started event
-    let _ = app.emit("export-started", ExportStarted {
-        export_id: export_id.clone(),
-        output_path: output_path.clone(),
-        total_frames,
-        duration_ms,
-    });
+    if emit_started {
+        let _ = app.emit("export-started", ExportStarted {
+            export_id: export_id.clone(),
+            output_path: output_path.clone(),
+            total_frames,
+            duration_ms,
+        });
+    }
 
     // Validate output path
     let output_path_buf = PathBuf::from(&config.output_path);
@@ -1644,6 +1657,9 @@ pub async fn render_demo_background(
     let video_bitrate = format!("{}M", base_bitrate * bitrate_multiplier);
     let duration_sec = config.duration_ms as f64 / 1000.0;
 
+    // Claim a share of the cores for as long as this export runs
+    let render_slot = FfmpegRenderSlot::acquire();
+
     // Build FFmpeg arguments (same logic as render_demo but extracted to avoid duplication)
     let ffmpeg_args = build_ffmpeg_args(
         &app,
@@ -1653,6 +1669,7 @@ pub async fn render_demo_background(
         &video_bitrate,
         use_bitrate_cap,
         duration_sec,
+        render_slot.threads(),
     ).await?;
 
     // Log the command for debugging
@@ -1664,6 +1681,7 @@ pub async fn render_demo_background(
         use std::sync::{Arc, Mutex};
         use std::thread;
 
+        let _render_slot = render_slot;
         let start_time = Instant::now();
 
         let mut child = match ffmpeg::ffmpeg_command(&app_clone) {
@@ -1825,7 +1843,40 @@ pub async fn render_demo_background(
     Ok(export_id)
 }
 
+/// FFmpeg background exports currently running
+static ACTIVE_FFMPEG_RENDERS: std::sync::atomic::AtomicUsize = std::sync::atomic::AtomicUsize::new(0);
+
+/// Counts an FFmpeg export as running until dropped
+///
+/// Each export's libx264 thread count is the cores divided by the exports
+/// running when it starts, so parallel exports don't each spawn a thread per
+/// core and thrash the machine.
+struct FfmpegRenderSlot {
+    threads: usize,
+}
+
+impl FfmpegRenderSlot {
+    fn acquire() -> Self {
+        let active = ACTIVE_FFMPEG_RENDERS.fetch_add(1, std::sync::atomic::Ordering::SeqCst) + 1;
+        let cores = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(1);
+        Self { threads: (cores / active).max(1) }
+    }
+
+    fn threads(&self) -> usize {
+        self.threads
+    }
+}
+
+impl Drop for FfmpegRenderSlot {
+    fn drop(&mut self) {
+        ACTIVE_FFMPEG_RENDERS.fetch_sub(1, std::sync::atomic::Ordering::SeqCst);
+    }
+}
+
 /// Helper function to build FFmpeg arguments (shared between sync and async render)
+///
+/// `threads` caps the software encoder's threads; VideoToolbox ignores it.
+#[cfg_attr(target_os = "macos", allow(unused_variables))]
 async fn build_ffmpeg_args(
     app: &AppHandle,
     config: &RenderDemoConfig,
@@ -1834,6 +1885,7 @@ async fn build_ffmpeg_args(
     video_bitrate: &str,
     use_bitrate_cap: bool,
     duration_sec: f64,
+    threads: usize,
 ) -> Result<Vec<String>, RigidError> {
     let mut ffmpeg_args: Vec<String> = vec![
         "-y".to_string(),
@@ -2472,7 +2524,7 @@ async fn build_ffmpeg_args(
                 "-pix_fmt".to_string(), "yuv420p".to_string(),
                 "-crf".to_string(), crf.to_string(),
                 "-preset".to_string(), preset.to_string(),
-                "-threads".to_string(), "0".to_string(), // Use all CPU cores
+                "-threads".to_string(), threads.to_string(),
             ]);
 
             if use_bitrate_cap {
@@ -2521,7 +2573,7 @@ async fn build_ffmpeg_args(
                 "-pix_fmt".to_string(), "yuv420p".to_string(),
                 "-crf".to_string(), crf.to_string(),
                 "-preset".to_string(), preset.to_string(),
-                "-threads".to_string(), "0".to_string(),
+                "-threads".to_string(), threads.to_string(),
             ]);
 
             if use_bitrate_cap {
@@ -2549,9 +2601,154 @@ async fn build_ffmpeg_args(
 // Native AVFoundation Compositor (macOS only)
 // =============================================================================
 
-/// Render using native AVFoundation compositor (macOS only)
-/// This uses GPU-accelerated Core Image and VideoToolbox for much faster rendering
-#[cfg(target_os = "macos")]
+/// A native compositor render in flight
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+struct NativeRender {
+    /// None for exports owned by the render queue
+    compositor: Option<crate::native::NativeCompositor>,
+    /// Set when rendering starts; queued exports wait until their first progress
+    started_at: Option<std::time::Instant>,
+}
+
+/// App handle used by the native compositor callbacks to emit events
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+static NATIVE_RENDER_APP: std::sync::OnceLock<AppHandle> = std::sync::OnceLock::new();
+
+/// Native renders in flight, keyed by export id
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+static NATIVE_RENDERS: std::sync::OnceLock<std::sync::Mutex<std::collections::HashMap<String, NativeRender>>> =
+    std::sync::OnceLock::new();
+
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+fn native_renders() -> &'static std::sync::Mutex<std::collections::HashMap<String, NativeRender>> {
+    NATIVE_RENDERS.get_or_init(Default::default)
+}
+
+/// Export ids name their render for cancel and callbacks, so one already in
+/// flight cannot be reused: the first render's completion would remove the
+/// second's entry and leave it uncancellable
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+fn check_export_id_free(
+    renders: &std::collections::HashMap<String, NativeRender>,
+    export_id: &str,
+) -> Result<(), RigidError> {
+    if renders.contains_key(export_id) {
+        return Err(RigidError::Validation(format!("Export {} is already in progress", export_id)));
+    }
+    Ok(())
+}
+
+/// Exports the shared render queue runs at once
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+const NATIVE_RENDER_QUEUE_CONCURRENCY: i32 = 2;
+
+/// Shared queue for `queue_render_native`; splits all cores between its renders
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+static NATIVE_RENDER_QUEUE: std::sync::OnceLock<Option<crate::native::NativeRenderQueue>> = std::sync::OnceLock::new();
+
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+fn native_render_queue() -> Option<&'static crate::native::NativeRenderQueue> {
+    NATIVE_RENDER_QUEUE
+        .get_or_init(|| crate::native::NativeRenderQueue::new(NATIVE_RENDER_QUEUE_CONCURRENCY, 0))
+        .as_ref()
+}
+
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+fn c_str_to_string(ptr: *const std::os::raw::c_char) -> String {
+    if ptr.is_null() {
+        String::new()
+    } else {
+        unsafe { std::ffi::CStr::from_ptr(ptr).to_string_lossy().to_string() }
+    }
+}
+
+/// Progress callback for native compositor renders
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+extern "C" fn native_render_progress(
+    export_id_ptr: *const std::os::raw::c_char,
+    percent: f32,
+    current_frame: i64,
+    total_frames: i64,
+) {
+    let app = match NATIVE_RENDER_APP.get() {
+        Some(app) => app,
+        None => return,
+    };
+    let export_id_str = c_str_to_string(export_id_ptr);
+
+    // Calculate timing info; the first progress of a queued export marks its start
+    let elapsed_secs = native_renders()
+        .lock()
+        .unwrap()
+        .get_mut(&export_id_str)
+        .map(|render| render.started_at.get_or_insert_with(std::time::Instant::now).elapsed().as_secs_f32())
+        .unwrap_or(0.0);
+
+    let fps = if elapsed_secs > 0.0 {
+        current_frame as f32 / elapsed_secs
+    } else {
+        0.0
+    };
+
+    let estimated_remaining_secs = if fps > 0.0 && current_frame > 0 {
+        let remaining_frames = total_frames - current_frame;
+        Some(remaining_frames as f32 / fps)
+    } else {
+        None
+    };
+
+    let _ = app.emit("export-progress", RenderProgress {
+        export_id: export_id_str,
+        percent,
+        stage: "Encoding".to_string(),
+        current_frame,
+        total_frames,
+        fps,
+        elapsed_secs,
+        estimated_remaining_secs,
+    });
+}
+
+/// Completion callback for native compositor renders
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+extern "C" fn native_render_complete(
+    export_id_ptr: *const std::os::raw::c_char,
+    error_code: i32,
+    output_path_or_error: *const std::os::raw::c_char,
+) {
+    let export_id_str = c_str_to_string(export_id_ptr);
+    let output_or_error = c_str_to_string(output_path_or_error);
+
+    // Release the compositor outside the lock
+    let finished = native_renders().lock().unwrap().remove(&export_id_str);
+    drop(finished);
+
+    let app = match NATIVE_RENDER_APP.get() {
+        Some(app) => app,
+        None => return,
+    };
+
+    if error_code == 0 {
+        let _ = app.emit("export-complete", ExportComplete {
+            export_id: export_id_str,
+            success: true,
+            output_path: Some(output_or_error),
+            error: None,
+        });
+    } else {
+        let _ = app.emit("export-complete", ExportComplete {
+            export_id: export_id_str,
+            success: false,
+            output_path: None,
+            error: Some(output_or_error),
+        });
+    }
+}
+
+/// Render using the native compositor
+/// - macOS: GPU-accelerated Core Image and VideoToolbox via the Swift package
+/// - Linux: libav-based C++ engine, falling back to FFmpeg if it is unavailable
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 #[tauri::command]
 pub async fn render_demo_native(
     app: AppHandle,
@@ -2559,9 +2756,9 @@ pub async fn render_demo_native(
     config: RenderDemoConfig,
 ) -> Result<String, RigidError> {
     use crate::native;
-    use std::ffi::CStr;
-    use std::os::raw::c_char;
-    use std::sync::atomic::{AtomicPtr, Ordering};
+    // Before export-started, which would reach the running export's listeners
+    check_export_id_free(&native_renders().lock().unwrap(), &export_id)?;
+
 
     // Calculate total frames for progress tracking
     let total_frames = (config.duration_ms as f64 / 1000.0 * config.frame_rate as f64) as i64;
@@ -2576,6 +2773,56 @@ pub async fn render_demo_native(
         duration_ms,
     });
 
+    let config_json = native_compositor_config_json(&app, &config).await?;
+
+    let _ = NATIVE_RENDER_APP.set(app.clone());
+
+    // One compositor per export so concurrent exports can be cancelled independently
+    let compositor = native::NativeCompositor::new()
+        .ok_or_else(|| RigidError::Internal("Failed to create native compositor".to_string()))?;
+
+    // Register before starting so the callbacks always find the render
+    let started = {
+        let mut renders = native_renders().lock().unwrap();
+        // Checked again under the lock, against a render started meanwhile
+        check_export_id_free(&renders, &export_id)?;
+        let result = compositor.render_async(
+            &export_id,
+            &config_json,
+            Some(native_render_progress),
+            Some(native_render_complete),
+        );
+        renders.insert(export_id.clone(), NativeRender {
+            compositor: Some(compositor),
+            started_at: Some(std::time::Instant::now()),
+        });
+
+        // The completion callback will never run for this export
+        if result.is_err() {
+            renders.remove(&export_id);
+        }
+        result
+    };
+
+    if let Err(e) = started {
+        // Linux builds without libav report the native engine as unavailable
+        #[cfg(target_os = "linux")]
+        {
+            println!("Native compositor failed to start ({}), falling back to FFmpeg", e);
+            // export-started already went out for this export
+            return start_ffmpeg_render(app, export_id, config, false).await;
+        }
+
+        #[cfg(not(target_os = "linux"))]
+        return Err(RigidError::Internal(e));
+    }
+
+    Ok(export_id)
+}
+
+/// Build the JSON config the native compositor expects from a render config
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+async fn native_compositor_config_json(app: &AppHandle, config: &RenderDemoConfig) -> Result<String, RigidError> {
     // Pre-download external image URLs for background (native compositor can't fetch URLs)
     let resolved_bg_media_path: Option<String> = if let Some(ref bg) = config.background {
         if bg.background_type == "image" {
@@ -2588,7 +2835,7 @@ pub async fn render_demo_native(
                 }
             } else if let Some(ref url) = bg.image_url {
                 // Download external URL to temp file
-                match download_url_to_temp(&app, url).await {
+                match download_url_to_temp(app, url).await {
                     Ok(path) => Some(path.to_string_lossy().to_string()),
                     Err(e) => {
                         println!("Warning: Failed to download background image: {}", e);
@@ -2605,6 +2852,12 @@ pub async fn render_demo_native(
         None
     };
 
+    // Encoded segments kept between exports, so a re-export after a small edit
+    // only re-encodes what changed (used by the Linux engine, which then cuts
+    // exports of two chunks or more into fixed cacheable chunks)
+    let segment_cache_dir = app.path().app_cache_dir().ok()
+        .map(|dir| dir.join("export_segments").to_string_lossy().to_string());
+
     // Convert config to JSON for the native compositor
     let compositor_config = serde_json::json!({
         "width": config.width,
@@ -2686,134 +2939,154 @@ pub async fn render_demo_native(
             "ease_out_duration_ms": pc.ease_out_duration_ms,
             "z_index": pc.z_index,
         })).collect::<Vec<_>>()),
+        "segment_cache_dir": segment_cache_dir,
     });
 
-    let config_json = serde_json::to_string(&compositor_config)
-        .map_err(|e| RigidError::Internal(format!("Failed to serialize config: {}", e)))?;
+    serde_json::to_string(&compositor_config)
+        .map_err(|e| RigidError::Internal(format!("Failed to serialize config: {}", e)))
+}
 
-    // Store app handle and start time for callbacks
-    static APP_HANDLE: AtomicPtr<()> = AtomicPtr::new(std::ptr::null_mut());
-    static START_TIME: std::sync::OnceLock<std::time::Instant> = std::sync::OnceLock::new();
+/// Queue an export on the shared native render queue
+///
+/// At most two exports render at once and they share the CPU cores; the rest
+/// wait, highest `priority` first. `export-progress` reports 0% when a queued
+/// export actually starts rendering.
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+#[tauri::command]
+pub async fn queue_render_native(
+    app: AppHandle,
+    export_id: String,
+    config: RenderDemoConfig,
+    priority: Option<i32>,
+) -> Result<String, RigidError> {
+    // Before export-started, which would reach the running export's listeners
+    check_export_id_free(&native_renders().lock().unwrap(), &export_id)?;
 
-    let app_box = Box::new(app.clone());
-    let app_ptr = Box::into_raw(app_box) as *mut ();
-    APP_HANDLE.store(app_ptr, Ordering::SeqCst);
-    let _ = START_TIME.set(std::time::Instant::now());
+    let total_frames = (config.duration_ms as f64 / 1000.0 * config.frame_rate as f64) as i64;
 
-    // Progress callback
-    extern "C" fn progress_callback(
-        export_id_ptr: *const c_char,
-        percent: f32,
-        current_frame: i64,
-        total_frames: i64,
-    ) {
-        let app_ptr = APP_HANDLE.load(Ordering::SeqCst);
-        if app_ptr.is_null() {
-            return;
-        }
+    let _ = app.emit("export-started", ExportStarted {
+        export_id: export_id.clone(),
+        output_path: config.output_path.clone(),
+        total_frames,
+        duration_ms: config.duration_ms,
+    });
 
-        let export_id_str = if !export_id_ptr.is_null() {
-            unsafe { CStr::from_ptr(export_id_ptr).to_string_lossy().to_string() }
-        } else {
-            String::new()
-        };
+    let config_json = native_compositor_config_json(&app, &config).await?;
 
-        // Get app handle (don't drop it, we're just borrowing)
-        let app: &AppHandle = unsafe { &*(app_ptr as *const AppHandle) };
+    let _ = NATIVE_RENDER_APP.set(app.clone());
 
-        // Calculate timing info
-        let elapsed_secs = START_TIME.get()
-            .map(|start| start.elapsed().as_secs_f32())
-            .unwrap_or(0.0);
+    let queue = native_render_queue()
+        .ok_or_else(|| RigidError::Internal("Failed to create native render queue".to_string()))?;
 
-        let fps = if elapsed_secs > 0.0 {
-            current_frame as f32 / elapsed_secs
-        } else {
-            0.0
-        };
+    // Register before submitting so the callbacks always find the render
+    let submitted = {
+        let mut renders = native_renders().lock().unwrap();
+        // Checked again under the lock, against a render started meanwhile
+        check_export_id_free(&renders, &export_id)?;
+        renders.insert(export_id.clone(), NativeRender {
+            compositor: None,
+            started_at: None,
+        });
 
-        let estimated_remaining_secs = if fps > 0.0 && current_frame > 0 {
-            let remaining_frames = total_frames - current_frame;
-            Some(remaining_frames as f32 / fps)
-        } else {
-            None
-        };
+        let result = queue.submit(
+            &export_id,
+            &config_json,
+            priority.unwrap_or(0),
+            Some(native_render_progress),
+            Some(native_render_complete),
+        );
 
-        let _ = app.emit("export-progress", RenderProgress {
-            export_id: export_id_str,
-            percent,
-            stage: "Encoding".to_string(),
-            current_frame,
-            total_frames,
-            fps,
-            elapsed_secs,
-            estimated_remaining_secs,
-        });
-    }
+        if result.is_err() {
+            renders.remove(&export_id);
+        }
+        result
+    };
 
-    // Completion callback
-    extern "C" fn completion_callback(
-        export_id_ptr: *const c_char,
-        error_code: i32,
-        output_path_or_error: *const c_char,
-    ) {
-        let app_ptr = APP_HANDLE.load(Ordering::SeqCst);
-        if app_ptr.is_null() {
-            return;
+    if let Err(e) = submitted {
+        #[cfg(target_os = "linux")]
+        {
+            println!("Native render queue unavailable ({}), falling back to FFmpeg", e);
+            // export-started already went out for this export
+            return start_ffmpeg_render(app, export_id, config, false).await;
         }
 
-        let export_id_str = if !export_id_ptr.is_null() {
-            unsafe { CStr::from_ptr(export_id_ptr).to_string_lossy().to_string() }
-        } else {
-            String::new()
-        };
+        #[cfg(not(target_os = "linux"))]
+        return Err(RigidError::Internal(e));
+    }
 
-        let output_or_error = if !output_path_or_error.is_null() {
-            unsafe { CStr::from_ptr(output_path_or_error).to_string_lossy().to_string() }
-        } else {
-            String::new()
-        };
+    Ok(export_id)
+}
 
-        // Get app handle and clean up
-        let app: Box<AppHandle> = unsafe { Box::from_raw(app_ptr as *mut AppHandle) };
-        APP_HANDLE.store(std::ptr::null_mut(), Ordering::SeqCst);
-
-        if error_code == 0 {
-            let _ = app.emit("export-complete", ExportComplete {
-                export_id: export_id_str,
-                success: true,
-                output_path: Some(output_or_error),
-                error: None,
-            });
-        } else {
-            let _ = app.emit("export-complete", ExportComplete {
-                export_id: export_id_str,
-                success: false,
-                output_path: None,
-                error: Some(output_or_error),
-            });
+/// Number of queued and running exports on the native render queue
+#[derive(Debug, Clone, Serialize)]
+#[serde(rename_all = "camelCase")]
+pub struct RenderQueueStatus {
+    pub queued: i32,
+    pub running: i32,
+}
+
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+#[tauri::command]
+pub async fn get_render_queue_status() -> Result<RenderQueueStatus, RigidError> {
+    Ok(match native_render_queue() {
+        Some(queue) => RenderQueueStatus { queued: queue.depth(), running: queue.running() },
+        None => RenderQueueStatus { queued: 0, running: 0 },
+    })
+}
+
+/// Cancel a native export started by `render_demo_native` or `queue_render_native`
+///
+/// Returns false if no native render with this id is queued or in progress.
+/// The cancelled export still emits `export-complete` (with an error).
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+#[tauri::command]
+pub async fn cancel_render_native(export_id: String) -> Result<bool, RigidError> {
+    {
+        let renders = native_renders().lock().unwrap();
+        if let Some(NativeRender { compositor: Some(compositor), .. }) = renders.get(&export_id) {
+            compositor.cancel();
+            return Ok(true);
         }
     }
 
-    // Start async render
-    native::compositor_render_async(
-        &export_id,
-        &config_json,
-        Some(progress_callback),
-        Some(completion_callback),
-    ).map_err(|e| RigidError::Internal(e))?;
+    // Cancelling a queued export runs its completion callback, so stay unlocked
+    Ok(native_render_queue().map_or(false, |queue| queue.cancel(&export_id)))
+}
 
-    Ok(export_id)
+/// Fallback for platforms without a native compositor
+#[cfg(not(any(target_os = "macos", target_os = "linux")))]
+#[tauri::command]
+pub async fn cancel_render_native(_export_id: String) -> Result<bool, RigidError> {
+    Ok(false)
+}
+
+/// Fallback for platforms without a native compositor
+#[cfg(not(any(target_os = "macos", target_os = "linux")))]
+#[tauri::command]
+pub async fn queue_render_native(
+    app: AppHandle,
+    export_id: String,
+    config: RenderDemoConfig,
+    _priority: Option<i32>,
+) -> Result<String, RigidError> {
+    render_demo_background(app, export_id, config).await
+}
+
+/// Fallback for platforms without a native compositor
+#[cfg(not(any(target_os = "macos", target_os = "linux")))]
+#[tauri::command]
+pub async fn get_render_queue_status() -> Result<RenderQueueStatus, RigidError> {
+    Ok(RenderQueueStatus { queued: 0, running: 0 })
 }
 
-/// Fallback for non-macOS platforms
-#[cfg(not(target_os = "macos"))]
+/// Fallback for platforms without a native compositor
+#[cfg(not(any(target_os = "macos", target_os = "linux")))]
 #[tauri::command]
 pub async fn render_demo_native(
     app: AppHandle,
     export_id: String,
     config: RenderDemoConfig,
 ) -> Result<String, RigidError> {
-    // On non-macOS, fall back to FFmpeg
+    // No native compositor, fall back to FFmpeg
     render_demo_background(app, export_id, config).await
 }
@@ -12,7 +12,7 @@ mod services;
 mod utils;
 
 use commands::RecordingState;
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "linux"))]
 use commands::NativeCaptureState;
 use repositories::{
     AppRepository, TestRepository, RecordingRepository, IssueRepository,
@@ -71,8 +71,8 @@ pub fn run() {
                 // Initialize recording state
                 app_handle.manage(RecordingState::new());
 
-                // Initialize native capture state (macOS only)
-                #[cfg(target_os = "macos")]
+                // Initialize native capture state (macOS and Linux)
+                #[cfg(any(target_os = "macos", target_os = "linux"))]
                 app_handle.manage(NativeCaptureState::new());
             });
 
@@ -182,20 +182,26 @@ pub fn run() {
             commands::request_native_capture_permission,
             commands::list_windows_native,
             commands::list_displays_native,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::start_native_recording,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::stop_native_recording,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::cancel_native_recording,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::is_native_recording,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::get_native_recording_id,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::get_native_recording_duration,
-            #[cfg(target_os = "macos")]
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
             commands::capture_native_screenshot,
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
+            commands::open_native_screenshot_session,
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
+            commands::close_native_screenshot_session,
+            #[cfg(any(target_os = "macos", target_os = "linux"))]
+            commands::capture_native_screenshot_pixels,
             // Tag commands
             commands::create_tag,
             commands::get_tag,
@@ -231,6 +237,9 @@ pub fn run() {
             commands::render_demo,
             commands::render_demo_background,
             commands::render_demo_native,
+            commands::cancel_render_native,
+            commands::queue_render_native,
+            commands::get_render_queue_status,
             commands::probe_media,
             // Document block commands
             commands::create_document_block,
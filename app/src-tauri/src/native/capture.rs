@@ -0,0 +1,663 @@
+//! Native screen capture FFI shared by macOS and Linux
+//!
+//! Both native libraries export the same `rigid_capture_*` C ABI declared in
+//! RigidCaptureKit.h:
+//! - macOS: ScreenCaptureKit engine in the Swift package
+//! - Linux: X11 engine in the C++ library in `cpp/`
+//!
+//! What only one platform has, such as webcam recording on macOS, stays in
+//! `macos` and `linux`.
+
+use std::ffi::{CStr, CString};
+use std::os::raw::{c_char, c_int, c_void};
+use std::path::Path;
+use std::sync::{Arc, Mutex};
+
+use super::{
+    CaptureError, ImageCompression, NativeDisplayInfo, NativeWindowInfo, RecordingConfig,
+    ScreenshotConfig, VideoCodec,
+};
+
+// Video codec constants matching RigidCaptureKit.h. The Linux encoder records
+// H.264 whichever one is asked for.
+const RIGID_CODEC_H264: i32 = 0;
+const RIGID_CODEC_HEVC: i32 = 1;
+const RIGID_CODEC_PRORES_422: i32 = 2;
+const RIGID_CODEC_PRORES_422_HQ: i32 = 3;
+
+impl VideoCodec {
+    fn to_c(&self) -> i32 {
+        match self {
+            VideoCodec::H264 => RIGID_CODEC_H264,
+            VideoCodec::Hevc => RIGID_CODEC_HEVC,
+            VideoCodec::ProRes422 => RIGID_CODEC_PRORES_422,
+            VideoCodec::ProRes422HQ => RIGID_CODEC_PRORES_422_HQ,
+        }
+    }
+}
+
+// Screenshot compression constants matching RigidCaptureKit.h
+const RIGID_COMPRESSION_FAST: i32 = 0;
+const RIGID_COMPRESSION_DEFAULT: i32 = 1;
+const RIGID_COMPRESSION_SMALLEST: i32 = 2;
+
+impl ImageCompression {
+    fn to_c(&self) -> i32 {
+        match self {
+            ImageCompression::Fast => RIGID_COMPRESSION_FAST,
+            ImageCompression::Default => RIGID_COMPRESSION_DEFAULT,
+            ImageCompression::Smallest => RIGID_COMPRESSION_SMALLEST,
+        }
+    }
+}
+
+// Pixel format constants matching RigidCaptureKit.h
+const RIGID_PIXEL_FORMAT_BGRA8: i32 = 0;
+
+/// RigidImageView in RigidCaptureKit.h
+#[repr(C)]
+struct RigidImageView {
+    pixels: *const u8,
+    width: i32,
+    height: i32,
+    stride: i32,
+    format: i32,
+}
+
+type RigidCaptureHandle = *mut c_void;
+
+extern "C" {
+    fn rigid_capture_create() -> RigidCaptureHandle;
+    fn rigid_capture_destroy(handle: RigidCaptureHandle);
+
+    fn rigid_capture_check_permission() -> bool;
+    fn rigid_capture_request_permission();
+
+    // JSON-based enumeration
+    fn rigid_capture_list_windows_json() -> *mut c_char;
+    fn rigid_capture_list_displays_json() -> *mut c_char;
+    pub(super) fn rigid_free_string(str: *mut c_char);
+
+    fn rigid_capture_start_window_recording(
+        handle: RigidCaptureHandle,
+        window_id: u32,
+        output_path: *const c_char,
+        width: u32,
+        height: u32,
+        fps: u32,
+        bitrate: u32,
+        keyframe_interval: u32,
+        codec: i32,
+        capture_cursor: bool,
+        capture_audio: bool,
+        scale_factor: f32,
+    ) -> c_int;
+
+    fn rigid_capture_start_display_recording(
+        handle: RigidCaptureHandle,
+        display_id: u32,
+        output_path: *const c_char,
+        width: u32,
+        height: u32,
+        fps: u32,
+        bitrate: u32,
+        keyframe_interval: u32,
+        codec: i32,
+        capture_cursor: bool,
+        capture_audio: bool,
+        scale_factor: f32,
+    ) -> c_int;
+
+    fn rigid_capture_start_region_recording(
+        handle: RigidCaptureHandle,
+        display_id: u32,
+        x: i32,
+        y: i32,
+        width: i32,
+        height: i32,
+        output_path: *const c_char,
+        fps: u32,
+        bitrate: u32,
+        keyframe_interval: u32,
+        codec: i32,
+        capture_cursor: bool,
+        capture_audio: bool,
+        scale_factor: f32,
+    ) -> c_int;
+
+    fn rigid_capture_stop_recording(handle: RigidCaptureHandle) -> c_int;
+    fn rigid_capture_cancel_recording(handle: RigidCaptureHandle) -> c_int;
+    fn rigid_capture_is_recording(handle: RigidCaptureHandle) -> bool;
+    fn rigid_capture_get_recording_duration_ms(handle: RigidCaptureHandle) -> i64;
+
+    fn rigid_screenshot_session_open(
+        display_id: u32,
+        scale_factor: f32,
+        capture_cursor: bool,
+        session: *mut *mut c_void,
+    ) -> c_int;
+    fn rigid_screenshot_session_close(session: *mut c_void);
+
+    fn rigid_capture_screenshot_window_to_buffer(
+        window_id: u32,
+        scale_factor: f32,
+        capture_cursor: bool,
+        image: *mut *mut c_void,
+    ) -> c_int;
+    fn rigid_capture_screenshot_display_to_buffer(
+        display_id: u32,
+        scale_factor: f32,
+        capture_cursor: bool,
+        image: *mut *mut c_void,
+    ) -> c_int;
+    fn rigid_capture_screenshot_region_to_buffer(
+        display_id: u32,
+        x: i32,
+        y: i32,
+        width: i32,
+        height: i32,
+        scale_factor: f32,
+        capture_cursor: bool,
+        image: *mut *mut c_void,
+    ) -> c_int;
+    fn rigid_screenshot_session_capture_to_buffer(
+        session: *mut c_void,
+        x: i32,
+        y: i32,
+        width: i32,
+        height: i32,
+        image: *mut *mut c_void,
+    ) -> c_int;
+    fn rigid_image_release(image: *mut c_void);
+    fn rigid_image_get_view(image: *mut c_void, view: *mut RigidImageView) -> bool;
+    fn rigid_image_save_now(
+        image: *mut c_void,
+        output_path: *const c_char,
+        compression: c_int,
+    ) -> c_int;
+}
+
+/// Take ownership of a JSON string from the library and parse it
+fn parse_json_list<T: serde::de::DeserializeOwned>(json_ptr: *mut c_char) -> Vec<T> {
+    if json_ptr.is_null() {
+        return Vec::new();
+    }
+
+    let json_str = unsafe {
+        let s = CStr::from_ptr(json_ptr).to_string_lossy().into_owned();
+        rigid_free_string(json_ptr);
+        s
+    };
+
+    serde_json::from_str(&json_str).unwrap_or_else(|_| Vec::new())
+}
+
+/// Safe wrapper around the native capture engine
+pub struct NativeCaptureEngine {
+    handle: RigidCaptureHandle,
+    recording_path: Arc<Mutex<Option<String>>>,
+}
+
+impl NativeCaptureEngine {
+    /// Create a new capture engine instance
+    pub fn new() -> Option<Self> {
+        let handle = unsafe { rigid_capture_create() };
+        if handle.is_null() {
+            return None;
+        }
+        Some(Self {
+            handle,
+            recording_path: Arc::new(Mutex::new(None)),
+        })
+    }
+
+    /// Check if screen capture permission is granted (always on Linux)
+    pub fn check_permission() -> bool {
+        unsafe { rigid_capture_check_permission() }
+    }
+
+    /// Request screen capture permission (opens the system dialog on macOS,
+    /// no-op on Linux)
+    pub fn request_permission() {
+        unsafe { rigid_capture_request_permission() }
+    }
+
+    /// List all capturable windows
+    pub fn list_windows() -> Result<Vec<NativeWindowInfo>, CaptureError> {
+        Ok(parse_json_list(unsafe {
+            rigid_capture_list_windows_json()
+        }))
+    }
+
+    /// List all displays (one per X screen on Linux)
+    pub fn list_displays() -> Result<Vec<NativeDisplayInfo>, CaptureError> {
+        Ok(parse_json_list(unsafe {
+            rigid_capture_list_displays_json()
+        }))
+    }
+
+    /// Start recording a specific window
+    pub fn start_window_recording(
+        &self,
+        window_id: u32,
+        output_path: &Path,
+        config: &RecordingConfig,
+    ) -> Result<(), CaptureError> {
+        let path_str = output_path
+            .to_str()
+            .ok_or_else(|| CaptureError::InvalidConfig)?;
+        let path_cstr = CString::new(path_str).map_err(|_| CaptureError::InvalidConfig)?;
+
+        let result = unsafe {
+            rigid_capture_start_window_recording(
+                self.handle,
+                window_id,
+                path_cstr.as_ptr(),
+                config.width,
+                config.height,
+                config.fps,
+                config.bitrate,
+                config.keyframe_interval,
+                config.codec.to_c(),
+                config.capture_cursor,
+                config.capture_audio,
+                config.scale_factor,
+            )
+        };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        *self.recording_path.lock().unwrap() = Some(path_str.to_string());
+        Ok(())
+    }
+
+    /// Start recording an entire display
+    pub fn start_display_recording(
+        &self,
+        display_id: u32,
+        output_path: &Path,
+        config: &RecordingConfig,
+    ) -> Result<(), CaptureError> {
+        let path_str = output_path
+            .to_str()
+            .ok_or_else(|| CaptureError::InvalidConfig)?;
+        let path_cstr = CString::new(path_str).map_err(|_| CaptureError::InvalidConfig)?;
+
+        let result = unsafe {
+            rigid_capture_start_display_recording(
+                self.handle,
+                display_id,
+                path_cstr.as_ptr(),
+                config.width,
+                config.height,
+                config.fps,
+                config.bitrate,
+                config.keyframe_interval,
+                config.codec.to_c(),
+                config.capture_cursor,
+                config.capture_audio,
+                config.scale_factor,
+            )
+        };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        *self.recording_path.lock().unwrap() = Some(path_str.to_string());
+        Ok(())
+    }
+
+    /// Start recording a region of a display
+    pub fn start_region_recording(
+        &self,
+        display_id: u32,
+        x: i32,
+        y: i32,
+        width: i32,
+        height: i32,
+        output_path: &Path,
+        config: &RecordingConfig,
+    ) -> Result<(), CaptureError> {
+        let path_str = output_path
+            .to_str()
+            .ok_or_else(|| CaptureError::InvalidConfig)?;
+        let path_cstr = CString::new(path_str).map_err(|_| CaptureError::InvalidConfig)?;
+
+        let result = unsafe {
+            rigid_capture_start_region_recording(
+                self.handle,
+                display_id,
+                x,
+                y,
+                width,
+                height,
+                path_cstr.as_ptr(),
+                config.fps,
+                config.bitrate,
+                config.keyframe_interval,
+                config.codec.to_c(),
+                config.capture_cursor,
+                config.capture_audio,
+                config.scale_factor,
+            )
+        };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        *self.recording_path.lock().unwrap() = Some(path_str.to_string());
+        Ok(())
+    }
+
+    /// Stop the current recording
+    pub fn stop_recording(&self) -> Result<String, CaptureError> {
+        let result = unsafe { rigid_capture_stop_recording(self.handle) };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        let path = self.recording_path.lock().unwrap().take();
+        path.ok_or(CaptureError::NoRecording)
+    }
+
+    /// Cancel the current recording without saving
+    pub fn cancel_recording(&self) -> Result<(), CaptureError> {
+        let result = unsafe { rigid_capture_cancel_recording(self.handle) };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        *self.recording_path.lock().unwrap() = None;
+        Ok(())
+    }
+
+    /// Check if currently recording
+    pub fn is_recording(&self) -> bool {
+        unsafe { rigid_capture_is_recording(self.handle) }
+    }
+
+    /// Get current recording duration in milliseconds
+    pub fn recording_duration_ms(&self) -> i64 {
+        unsafe { rigid_capture_get_recording_duration_ms(self.handle) }
+    }
+}
+
+impl Drop for NativeCaptureEngine {
+    fn drop(&mut self) {
+        unsafe { rigid_capture_destroy(self.handle) };
+    }
+}
+
+// SAFETY: Both engines guard their recording state, with locks in Swift and a
+// mutex in C++
+unsafe impl Send for NativeCaptureEngine {}
+unsafe impl Sync for NativeCaptureEngine {}
+
+/// A display kept ready for repeated screenshots: capturing the screen is set
+/// up once at open, so each capture only saves a frame already in memory
+pub struct NativeScreenshotSession {
+    handle: *mut c_void,
+    display_id: u32,
+    scale_factor: f32,
+    capture_cursor: bool,
+}
+
+impl NativeScreenshotSession {
+    /// Open a session on a display
+    pub fn open(display_id: u32, config: &ScreenshotConfig) -> Result<Self, CaptureError> {
+        let mut handle: *mut c_void = std::ptr::null_mut();
+        let result = unsafe {
+            rigid_screenshot_session_open(
+                display_id,
+                config.scale_factor,
+                config.capture_cursor,
+                &mut handle,
+            )
+        };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        Ok(Self {
+            handle,
+            display_id,
+            scale_factor: config.scale_factor,
+            capture_cursor: config.capture_cursor,
+        })
+    }
+
+    /// Display the session captures
+    pub fn display_id(&self) -> u32 {
+        self.display_id
+    }
+
+    /// Whether the session captures at the scale and with the cursor
+    /// `config` asks for; it keeps the ones it was opened with
+    pub fn captures_like(&self, config: &ScreenshotConfig) -> bool {
+        self.scale_factor == config.scale_factor && self.capture_cursor == config.capture_cursor
+    }
+
+    /// Save the display, or a region (x, y, width, height) of it, in the
+    /// format the path's extension names
+    pub fn capture(
+        &self,
+        region: Option<(i32, i32, i32, i32)>,
+        output_path: &Path,
+        compression: ImageCompression,
+    ) -> Result<(), CaptureError> {
+        self.capture_to_buffer(region)?
+            .save(output_path, compression)
+    }
+
+    /// As capture, into memory
+    pub fn capture_to_buffer(
+        &self,
+        region: Option<(i32, i32, i32, i32)>,
+    ) -> Result<NativeImage, CaptureError> {
+        let (x, y, width, height) = region.unwrap_or((0, 0, 0, 0));
+        NativeImage::capture(|image| unsafe {
+            rigid_screenshot_session_capture_to_buffer(self.handle, x, y, width, height, image)
+        })
+    }
+}
+
+impl Drop for NativeScreenshotSession {
+    fn drop(&mut self) {
+        unsafe { rigid_screenshot_session_close(self.handle) };
+    }
+}
+
+// SAFETY: Sessions serialize captures internally
+unsafe impl Send for NativeScreenshotSession {}
+unsafe impl Sync for NativeScreenshotSession {}
+
+/// A screenshot held in memory by the native library, released on drop
+pub struct NativeImage {
+    handle: *mut c_void,
+    view: RigidImageView,
+}
+
+impl NativeImage {
+    /// Run a *_to_buffer capture and take the image it returns
+    fn capture(capture: impl FnOnce(*mut *mut c_void) -> c_int) -> Result<Self, CaptureError> {
+        let mut handle: *mut c_void = std::ptr::null_mut();
+        let result = capture(&mut handle);
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        // Released on drop, on failure below as well
+        let mut image = Self {
+            handle,
+            view: RigidImageView {
+                pixels: std::ptr::null(),
+                width: 0,
+                height: 0,
+                stride: 0,
+                format: 0,
+            },
+        };
+        if !unsafe { rigid_image_get_view(image.handle, &mut image.view) } {
+            return Err(CaptureError::ScreenshotFailed(
+                "Native screenshot error".into(),
+            ));
+        }
+        debug_assert_eq!(image.view.format, RIGID_PIXEL_FORMAT_BGRA8);
+        Ok(image)
+    }
+
+    pub fn width(&self) -> u32 {
+        self.view.width as u32
+    }
+
+    pub fn height(&self) -> u32 {
+        self.view.height as u32
+    }
+
+    /// Tightly packed RGBA rows, ready for an ImageData; the native pixels
+    /// are BGRA rows with padding
+    pub fn to_rgba(&self) -> Vec<u8> {
+        let width = self.view.width as usize;
+        let stride = self.view.stride as usize;
+        let mut rgba = Vec::with_capacity(width * 4 * self.view.height as usize);
+        for y in 0..self.view.height as usize {
+            // SAFETY: the view describes `height` rows of `stride` bytes, alive
+            // until the image is released
+            let row =
+                unsafe { std::slice::from_raw_parts(self.view.pixels.add(y * stride), width * 4) };
+            for bgra in row.chunks_exact(4) {
+                // Opaque whatever the alpha byte holds
+                rgba.extend_from_slice(&[bgra[2], bgra[1], bgra[0], 255]);
+            }
+        }
+        rgba
+    }
+
+    /// Encode the image to `output_path` at `compression`, in the format the
+    /// path's extension names, and return once it is on disk
+    pub fn save(
+        &self,
+        output_path: &Path,
+        compression: ImageCompression,
+    ) -> Result<(), CaptureError> {
+        let path_str = output_path
+            .to_str()
+            .ok_or_else(|| CaptureError::InvalidConfig)?;
+        let path_cstr = CString::new(path_str).map_err(|_| CaptureError::InvalidConfig)?;
+
+        let result =
+            unsafe { rigid_image_save_now(self.handle, path_cstr.as_ptr(), compression.to_c()) };
+
+        if result != 0 {
+            return Err(CaptureError::from_code(result));
+        }
+
+        Ok(())
+    }
+}
+
+impl Drop for NativeImage {
+    fn drop(&mut self) {
+        unsafe { rigid_image_release(self.handle) };
+    }
+}
+
+// SAFETY: Images are read-only and reference counted atomically
+unsafe impl Send for NativeImage {}
+unsafe impl Sync for NativeImage {}
+
+/// Capture a screenshot of a window and save it at `config.compression`.
+/// Like every screenshot call this blocks until done, so async callers run
+/// it on a blocking thread.
+pub fn screenshot_window(
+    window_id: u32,
+    output_path: &Path,
+    config: &ScreenshotConfig,
+) -> Result<(), CaptureError> {
+    screenshot_window_to_buffer(window_id, config)?.save(output_path, config.compression)
+}
+
+/// Capture a screenshot of a display and save it at `config.compression`
+pub fn screenshot_display(
+    display_id: u32,
+    output_path: &Path,
+    config: &ScreenshotConfig,
+) -> Result<(), CaptureError> {
+    screenshot_display_to_buffer(display_id, config)?.save(output_path, config.compression)
+}
+
+/// Capture a screenshot of a region and save it at `config.compression`;
+/// only the region is read from the screen
+pub fn screenshot_region(
+    display_id: u32,
+    x: i32,
+    y: i32,
+    width: i32,
+    height: i32,
+    output_path: &Path,
+    config: &ScreenshotConfig,
+) -> Result<(), CaptureError> {
+    screenshot_region_to_buffer(display_id, x, y, width, height, config)?
+        .save(output_path, config.compression)
+}
+
+/// As screenshot_window, into memory
+pub fn screenshot_window_to_buffer(
+    window_id: u32,
+    config: &ScreenshotConfig,
+) -> Result<NativeImage, CaptureError> {
+    NativeImage::capture(|image| unsafe {
+        rigid_capture_screenshot_window_to_buffer(
+            window_id,
+            config.scale_factor,
+            config.capture_cursor,
+            image,
+        )
+    })
+}
+
+/// As screenshot_display, into memory
+pub fn screenshot_display_to_buffer(
+    display_id: u32,
+    config: &ScreenshotConfig,
+) -> Result<NativeImage, CaptureError> {
+    NativeImage::capture(|image| unsafe {
+        rigid_capture_screenshot_display_to_buffer(
+            display_id,
+            config.scale_factor,
+            config.capture_cursor,
+            image,
+        )
+    })
+}
+
+/// As screenshot_region, into memory
+pub fn screenshot_region_to_buffer(
+    display_id: u32,
+    x: i32,
+    y: i32,
+    width: i32,
+    height: i32,
+    config: &ScreenshotConfig,
+) -> Result<NativeImage, CaptureError> {
+    NativeImage::capture(|image| unsafe {
+        rigid_capture_screenshot_region_to_buffer(
+            display_id,
+            x,
+            y,
+            width,
+            height,
+            config.scale_factor,
+            config.capture_cursor,
+            image,
+        )
+    })
+}
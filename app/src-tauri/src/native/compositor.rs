@@ -0,0 +1,264 @@
+//! Native video compositor FFI
+//!
+//! Both native libraries export the same `rigid_compositor_*` C ABI declared in
+//! RigidCaptureKit.h:
+//! - macOS: AVFoundation/Core Image engine in the Swift package
+//! - Linux: libav-based C++ engine in `cpp/`
+
+use std::ffi::CString;
+use std::os::raw::{c_char, c_int, c_void};
+
+/// Progress callback type for compositor
+pub type CompositorProgressCallback =
+    extern "C" fn(export_id: *const c_char, percent: f32, current_frame: i64, total_frames: i64);
+
+/// Completion callback type for compositor
+pub type CompositorCompletionCallback =
+    extern "C" fn(export_id: *const c_char, error_code: c_int, output_path_or_error: *const c_char);
+
+type RigidCompositorHandle = *mut c_void;
+
+// FFI declarations for compositor
+extern "C" {
+    fn rigid_compositor_create() -> RigidCompositorHandle;
+    fn rigid_compositor_destroy(handle: RigidCompositorHandle);
+
+    fn rigid_compositor_render(
+        handle: RigidCompositorHandle,
+        export_id: *const c_char,
+        config_json: *const c_char,
+        progress_callback: Option<CompositorProgressCallback>,
+    ) -> c_int;
+
+    fn rigid_compositor_render_async(
+        handle: RigidCompositorHandle,
+        export_id: *const c_char,
+        config_json: *const c_char,
+        progress_callback: Option<CompositorProgressCallback>,
+        completion_callback: Option<CompositorCompletionCallback>,
+    ) -> c_int;
+
+    fn rigid_compositor_cancel(handle: RigidCompositorHandle);
+}
+
+/// Render result from compositor
+#[derive(Debug)]
+pub enum CompositorResult {
+    Success(String),
+    Error(String),
+}
+
+/// Safe wrapper around one native compositor engine
+///
+/// Each instance renders one export at a time. Create one per export to run
+/// several exports concurrently and cancel them independently.
+pub struct NativeCompositor {
+    handle: RigidCompositorHandle,
+}
+
+impl NativeCompositor {
+    /// Create a new compositor instance
+    pub fn new() -> Option<Self> {
+        let handle = unsafe { rigid_compositor_create() };
+        if handle.is_null() {
+            return None;
+        }
+        Some(Self { handle })
+    }
+
+    /// Render a video composition synchronously
+    ///
+    /// # Arguments
+    /// * `export_id` - Unique identifier for this export
+    /// * `config_json` - JSON string containing the render configuration
+    /// * `progress_callback` - Optional callback for progress updates
+    ///
+    /// # Returns
+    /// Result with output path on success, error message on failure
+    pub fn render_sync(
+        &self,
+        export_id: &str,
+        config_json: &str,
+        progress_callback: Option<CompositorProgressCallback>,
+    ) -> Result<String, String> {
+        let export_id_cstr = CString::new(export_id).map_err(|e| e.to_string())?;
+        let config_cstr = CString::new(config_json).map_err(|e| e.to_string())?;
+
+        let result = unsafe {
+            rigid_compositor_render(
+                self.handle,
+                export_id_cstr.as_ptr(),
+                config_cstr.as_ptr(),
+                progress_callback,
+            )
+        };
+
+        match result {
+            0 => Ok(export_id.to_string()),
+            1 => Err("Not authorized".to_string()),
+            2 => Err("Invalid configuration".to_string()),
+            3 => Err("Render failed".to_string()),
+            4 => Err("Native rendering unavailable".to_string()),
+            _ => Err(format!("Unknown error: {}", result)),
+        }
+    }
+
+    /// Render a video composition asynchronously
+    ///
+    /// # Arguments
+    /// * `export_id` - Unique identifier for this export
+    /// * `config_json` - JSON string containing the render configuration
+    /// * `progress_callback` - Optional callback for progress updates
+    /// * `completion_callback` - Optional callback when render completes
+    ///
+    /// # Returns
+    /// Ok(()) if render started successfully, Err with message on failure
+    pub fn render_async(
+        &self,
+        export_id: &str,
+        config_json: &str,
+        progress_callback: Option<CompositorProgressCallback>,
+        completion_callback: Option<CompositorCompletionCallback>,
+    ) -> Result<(), String> {
+        let export_id_cstr = CString::new(export_id).map_err(|e| e.to_string())?;
+        let config_cstr = CString::new(config_json).map_err(|e| e.to_string())?;
+
+        let result = unsafe {
+            rigid_compositor_render_async(
+                self.handle,
+                export_id_cstr.as_ptr(),
+                config_cstr.as_ptr(),
+                progress_callback,
+                completion_callback,
+            )
+        };
+
+        match result {
+            0 => Ok(()),
+            2 => Err("Invalid configuration".to_string()),
+            4 => Err("Native rendering unavailable".to_string()),
+            _ => Err(format!("Failed to start render: {}", result)),
+        }
+    }
+
+    /// Cancel the in-progress render on this compositor
+    pub fn cancel(&self) {
+        unsafe { rigid_compositor_cancel(self.handle) }
+    }
+}
+
+impl Drop for NativeCompositor {
+    fn drop(&mut self) {
+        // A render still in flight keeps its own reference to the engine
+        unsafe { rigid_compositor_destroy(self.handle) };
+    }
+}
+
+// SAFETY: The native engines only share an atomic cancel flag across threads
+unsafe impl Send for NativeCompositor {}
+unsafe impl Sync for NativeCompositor {}
+
+// =============================================================================
+// Render Queue FFI
+// =============================================================================
+
+type RigidRenderQueueHandle = *mut c_void;
+
+extern "C" {
+    fn rigid_render_queue_create(max_concurrent_jobs: i32, core_budget: i32) -> RigidRenderQueueHandle;
+    fn rigid_render_queue_destroy(queue: RigidRenderQueueHandle);
+
+    fn rigid_render_queue_submit(
+        queue: RigidRenderQueueHandle,
+        export_id: *const c_char,
+        config_json: *const c_char,
+        priority: i32,
+        progress_callback: Option<CompositorProgressCallback>,
+        completion_callback: Option<CompositorCompletionCallback>,
+    ) -> c_int;
+
+    fn rigid_render_queue_cancel(queue: RigidRenderQueueHandle, export_id: *const c_char) -> bool;
+    fn rigid_render_queue_depth(queue: RigidRenderQueueHandle) -> i32;
+    fn rigid_render_queue_running(queue: RigidRenderQueueHandle) -> i32;
+}
+
+/// Safe wrapper around a native render queue
+///
+/// Runs at most `max_concurrent_jobs` exports at once and splits
+/// `core_budget` CPU threads between them (0 = all hardware threads).
+pub struct NativeRenderQueue {
+    handle: RigidRenderQueueHandle,
+}
+
+impl NativeRenderQueue {
+    /// Create a new render queue
+    pub fn new(max_concurrent_jobs: i32, core_budget: i32) -> Option<Self> {
+        let handle = unsafe { rigid_render_queue_create(max_concurrent_jobs, core_budget) };
+        if handle.is_null() {
+            return None;
+        }
+        Some(Self { handle })
+    }
+
+    /// Queue an export. Higher priority runs first.
+    ///
+    /// The progress callback reports 0% when the export starts rendering, and
+    /// the completion callback is always called once (including on cancel).
+    pub fn submit(
+        &self,
+        export_id: &str,
+        config_json: &str,
+        priority: i32,
+        progress_callback: Option<CompositorProgressCallback>,
+        completion_callback: Option<CompositorCompletionCallback>,
+    ) -> Result<(), String> {
+        let export_id_cstr = CString::new(export_id).map_err(|e| e.to_string())?;
+        let config_cstr = CString::new(config_json).map_err(|e| e.to_string())?;
+
+        let result = unsafe {
+            rigid_render_queue_submit(
+                self.handle,
+                export_id_cstr.as_ptr(),
+                config_cstr.as_ptr(),
+                priority,
+                progress_callback,
+                completion_callback,
+            )
+        };
+
+        match result {
+            0 => Ok(()),
+            2 => Err("Invalid configuration".to_string()),
+            4 => Err("Native rendering unavailable".to_string()),
+            _ => Err(format!("Failed to queue render: {}", result)),
+        }
+    }
+
+    /// Cancel a queued or running export. Returns false if the id is unknown.
+    pub fn cancel(&self, export_id: &str) -> bool {
+        match CString::new(export_id) {
+            Ok(export_id_cstr) => unsafe { rigid_render_queue_cancel(self.handle, export_id_cstr.as_ptr()) },
+            Err(_) => false,
+        }
+    }
+
+    /// Number of exports waiting for a worker
+    pub fn depth(&self) -> i32 {
+        unsafe { rigid_render_queue_depth(self.handle) }
+    }
+
+    /// Number of exports currently rendering
+    pub fn running(&self) -> i32 {
+        unsafe { rigid_render_queue_running(self.handle) }
+    }
+}
+
+impl Drop for NativeRenderQueue {
+    fn drop(&mut self) {
+        unsafe { rigid_render_queue_destroy(self.handle) };
+    }
+}
+
+// SAFETY: Both native queues guard their state with a lock
+unsafe impl Send for NativeRenderQueue {}
+unsafe impl Sync for NativeRenderQueue {}
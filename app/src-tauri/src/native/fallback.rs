@@ -1,7 +1,7 @@
-//! Fallback capture implementation for non-macOS platforms
+//! Fallback capture implementation for platforms without a native engine
 //!
 //! This module provides basic screen capture using command-line tools
-//! for platforms where native ScreenCaptureKit is not available.
+//! for platforms where neither ScreenCaptureKit nor X11 capture is available.
 
 use std::path::Path;
 use std::sync::Arc;
@@ -13,7 +13,7 @@ use super::{
 
 /// Fallback capture engine that returns platform not supported errors
 ///
-/// On non-macOS platforms, the existing `screencapture` command-based
+/// On platforms other than macOS and Linux, the existing `screencapture` command-based
 /// implementation in `commands/capture.rs` should be used instead.
 pub struct NativeCaptureEngine {
     _recording_path: Arc<Mutex<Option<String>>>,
@@ -105,7 +105,7 @@ impl NativeCaptureEngine {
 }
 
 /// Capture a screenshot of a window
-pub async fn screenshot_window(
+pub fn screenshot_window(
     _window_id: u32,
     _output_path: &Path,
     _config: &ScreenshotConfig,
@@ -114,7 +114,7 @@ pub async fn screenshot_window(
 }
 
 /// Capture a screenshot of a display
-pub async fn screenshot_display(
+pub fn screenshot_display(
     _display_id: u32,
     _output_path: &Path,
     _config: &ScreenshotConfig,
@@ -123,7 +123,7 @@ pub async fn screenshot_display(
 }
 
 /// Capture a screenshot of a region
-pub async fn screenshot_region(
+pub fn screenshot_region(
     _display_id: u32,
     _x: i32,
     _y: i32,
@@ -0,0 +1,10 @@
+//! Linux native capture using X11 via the C++ RigidCaptureKit library
+//!
+//! The C++ library in `cpp/` implements recording and screenshots from
+//! RigidCaptureKit.h on X11:
+//! - Display, region and window capture through MIT-SHM and XComposite
+//! - A bounded frame queue feeding a libav* H.264 encoder thread
+//! - Recording and screenshots at the display's own pixel size (X11 has no
+//!   backing scale); regions are read from the server at their own size
+//!
+//! The Rust wrappers are shared with macOS in `capture`.
@@ -2,7 +2,10 @@
 //!
 //! This module provides high-quality screen capture using platform-native APIs:
 //! - macOS: ScreenCaptureKit via Swift FFI
+//! - Linux: X11 (MIT-SHM/XComposite) via the C++ library in `cpp/`
 //! - Other platforms: Fallback to screencapture CLI tool
+//!
+//! The video compositor is native on macOS (Swift) and Linux (C++ in `cpp/`).
 
 #[cfg(target_os = "macos")]
 pub mod macos;
@@ -10,13 +13,30 @@ pub mod macos;
 #[cfg(target_os = "macos")]
 pub use macos::*;
 
+#[cfg(target_os = "linux")]
+pub mod linux;
+
+// Screen capture - same C ABI from the Swift package and the C++ library
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+pub mod capture;
+
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+pub use capture::*;
+
 // Fallback for other platforms - keeps existing screencapture behavior
-#[cfg(not(target_os = "macos"))]
+#[cfg(not(any(target_os = "macos", target_os = "linux")))]
 pub mod fallback;
 
-#[cfg(not(target_os = "macos"))]
+#[cfg(not(any(target_os = "macos", target_os = "linux")))]
 pub use fallback::*;
 
+// Video compositor - same C ABI from the Swift package and the C++ library
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+pub mod compositor;
+
+#[cfg(any(target_os = "macos", target_os = "linux"))]
+pub use compositor::*;
+
 /// Video codec for recording
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
 pub enum VideoCodec {
@@ -96,6 +116,8 @@ pub struct ScreenshotConfig {
     pub scale_factor: f32,
     /// Show mouse cursor in screenshot
     pub capture_cursor: bool,
+    /// How hard a screenshot saved to a file is compressed
+    pub compression: ImageCompression,
 }
 
 impl Default for ScreenshotConfig {
@@ -103,6 +125,66 @@ impl Default for ScreenshotConfig {
         Self {
             scale_factor: 2.0, // Retina
             capture_cursor: false,
+            compression: ImageCompression::default(),
+        }
+    }
+}
+
+/// Screenshot file format. The native library picks it from the output
+/// path's extension.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ImageFormat {
+    #[default]
+    Png,
+    /// Lossless, several times faster to encode than PNG, larger files
+    Qoi,
+    /// Lossless; only on Linux builds with libwebp
+    WebP,
+}
+
+impl ImageFormat {
+    pub fn file_extension(&self) -> &'static str {
+        match self {
+            ImageFormat::Png => "png",
+            ImageFormat::Qoi => "qoi",
+            ImageFormat::WebP => "webp",
+        }
+    }
+}
+
+impl std::str::FromStr for ImageFormat {
+    type Err = String;
+
+    fn from_str(s: &str) -> Result<Self, Self::Err> {
+        match s.to_lowercase().as_str() {
+            "png" => Ok(ImageFormat::Png),
+            "qoi" => Ok(ImageFormat::Qoi),
+            "webp" => Ok(ImageFormat::WebP),
+            _ => Err(format!("Unknown image format: {}", s)),
+        }
+    }
+}
+
+/// How hard screenshot encoders compress
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ImageCompression {
+    /// Quick to write, larger files
+    Fast,
+    #[default]
+    Default,
+    /// Slowest, smallest files
+    Smallest,
+}
+
+impl std::str::FromStr for ImageCompression {
+    type Err = String;
+
+    fn from_str(s: &str) -> Result<Self, Self::Err> {
+        match s.to_lowercase().as_str() {
+            "fast" => Ok(ImageCompression::Fast),
+            "default" => Ok(ImageCompression::Default),
+            "smallest" | "best" => Ok(ImageCompression::Smallest),
+            _ => Err(format!("Unknown compression: {}", s)),
         }
     }
 }
@@ -157,7 +239,7 @@ pub enum CaptureError {
 }
 
 impl CaptureError {
-    #[cfg(target_os = "macos")]
+    #[cfg(any(target_os = "macos", target_os = "linux"))]
     pub(crate) fn from_code(code: i32) -> Self {
         match code {
             0 => panic!("from_code called with success code"),
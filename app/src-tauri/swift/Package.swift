@@ -26,6 +26,11 @@ let package = Package(
                 .linkedFramework("CoreGraphics"),
                 .linkedFramework("AppKit"),
             ]
+        ),
+        .testTarget(
+            name: "RigidCaptureKitTests",
+            dependencies: ["RigidCaptureKit"],
+            path: "Tests/RigidCaptureKitTests"
         )
     ]
 )
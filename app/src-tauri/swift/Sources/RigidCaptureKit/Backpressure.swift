@@ -0,0 +1,148 @@
+import CoreMedia
+import Foundation
+
+/// What a recording does when the encoder falls behind the capture
+/// (RIGID_BACKPRESSURE_* in RigidCaptureKit.h)
+enum BackpressurePolicy: Int32 {
+    /// Skip frames that arrive while the encoder is busy
+    case dropNewest = 0
+    /// Queue frames for the encoder; a full queue drops its oldest frame
+    case dropOldest = 1
+    /// Drop like dropNewest and lower the capture rate while drops go on
+    case adaptiveFps = 2
+}
+
+/// Backpressure settings of a capture engine, applied to its next recording
+struct BackpressureSettings {
+    /// Frames SCStream buffers for the recorder
+    static let defaultQueueDepth = 8
+
+    var policy: BackpressurePolicy = .dropNewest
+    var queueDepth: Int = BackpressureSettings.defaultQueueDepth
+
+    /// Frames dropOldest keeps waiting for the writer. Each one holds an
+    /// SCStream surface, so fewer than the queue depth, leaving the stream
+    /// buffers to capture into.
+    var pendingCapacity: Int { queueDepth > 2 ? queueDepth - 2 : 1 }
+}
+
+/// Capture rate controller for BackpressurePolicy.adaptiveFps; same rules
+/// as FrameRateGovernor in the Linux library.
+///
+/// Frames are judged in windows of about a second at the current rate. A
+/// window that drops more than dropTolerance of its frames lowers the rate
+/// by a quarter of the target (never below minFpsFraction of it); a window
+/// without drops raises it by the same step back toward the target.
+struct FrameRateGovernor {
+    static let dropTolerance = 0.05
+    static let minFpsFraction = 0.25
+
+    let targetFps: Int
+    private let minFps: Int
+    private(set) var currentFps: Int
+    private var windowFrames = 0
+    private var windowDrops = 0
+
+    init(targetFps: Int) {
+        self.targetFps = max(targetFps, 1)
+        minFps = max(1, Int(Double(self.targetFps) * FrameRateGovernor.minFpsFraction))
+        currentFps = self.targetFps
+    }
+
+    /// Count a captured frame. Returns true when the rate changed; the
+    /// caller then reconfigures the stream to currentFps.
+    mutating func frameCaptured(dropped: Bool) -> Bool {
+        windowFrames += 1
+        if dropped { windowDrops += 1 }
+        guard windowFrames >= currentFps else { return false }
+
+        let step = max(1, targetFps / 4)
+        var next = currentFps
+        if Double(windowDrops) > Double(windowFrames) * FrameRateGovernor.dropTolerance {
+            next = max(minFps, currentFps - step)
+        } else if windowDrops == 0 {
+            next = min(targetFps, currentFps + step)
+        }
+        windowFrames = 0
+        windowDrops = 0
+
+        guard next != currentFps else { return false }
+        currentFps = next
+        return true
+    }
+}
+
+/// Frame counters and timings of one recording, updated on the capture
+/// queue and read by rigid_capture_get_stats
+final class CaptureStats {
+    private let lock = NSLock()
+    private var captured: UInt64 = 0
+    private var encoded: UInt64 = 0
+    private var dropped: UInt64 = 0
+    private var currentFps = 0
+    private var latencyTotal: Double = 0
+    private var latencyMax: Double = 0
+    private var processingTotal: Double = 0
+    private var processingMax: Double = 0
+
+    func reset(fps: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        captured = 0
+        encoded = 0
+        dropped = 0
+        currentFps = fps
+        latencyTotal = 0
+        latencyMax = 0
+        processingTotal = 0
+        processingMax = 0
+    }
+
+    /// A frame arrived from SCStream; handling it took `processingSeconds`
+    func frameCaptured(processingSeconds: Double) {
+        lock.lock()
+        defer { lock.unlock() }
+        captured += 1
+        processingTotal += processingSeconds
+        processingMax = max(processingMax, processingSeconds)
+    }
+
+    /// The writer took a frame captured at host time `presentationTime`
+    func frameEncoded(presentationTime: CMTime) {
+        let now = CMClockGetTime(CMClockGetHostTimeClock())
+        let latency = max(0, CMTimeGetSeconds(CMTimeSubtract(now, presentationTime)))
+        lock.lock()
+        defer { lock.unlock() }
+        encoded += 1
+        latencyTotal += latency
+        latencyMax = max(latencyMax, latency)
+    }
+
+    func frameDropped() {
+        lock.lock()
+        defer { lock.unlock() }
+        dropped += 1
+    }
+
+    func setCurrentFps(_ fps: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        currentFps = fps
+    }
+
+    /// Write the counters into a RigidCaptureStats
+    func write(to stats: UnsafeMutableRawPointer) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        // Field offsets of RigidCaptureStats in RigidCaptureKit.h
+        stats.storeBytes(of: captured, toByteOffset: 0, as: UInt64.self)
+        stats.storeBytes(of: encoded, toByteOffset: 8, as: UInt64.self)
+        stats.storeBytes(of: dropped, toByteOffset: 16, as: UInt64.self)
+        stats.storeBytes(of: Double(currentFps), toByteOffset: 24, as: Double.self)
+        stats.storeBytes(of: encoded > 0 ? latencyTotal * 1000 / Double(encoded) : 0, toByteOffset: 32, as: Double.self)
+        stats.storeBytes(of: latencyMax * 1000, toByteOffset: 40, as: Double.self)
+        stats.storeBytes(of: captured > 0 ? processingTotal * 1000 / Double(captured) : 0, toByteOffset: 48, as: Double.self)
+        stats.storeBytes(of: processingMax * 1000, toByteOffset: 56, as: Double.self)
+    }
+}
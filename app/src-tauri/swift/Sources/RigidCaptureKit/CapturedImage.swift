@@ -0,0 +1,155 @@
+import CoreGraphics
+import CoreVideo
+import Foundation
+import VideoToolbox
+
+/// A screenshot kept in memory; what RigidImageRef points to on macOS (the
+/// Linux engine's equivalent is CapturedImage in Screenshot.h).
+///
+/// Wraps a BGRA pixel buffer, locked read-only for as long as the image
+/// lives, as SharedFrame does. On macOS 14 that is the buffer
+/// ScreenCaptureKit captured into; older paths draw their CGImage into one.
+final class CapturedImage {
+    let pixelBuffer: CVPixelBuffer
+    let baseAddress: UnsafeRawPointer?
+
+    init(pixelBuffer: CVPixelBuffer) {
+        self.pixelBuffer = pixelBuffer
+        CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly)
+        baseAddress = UnsafeRawPointer(CVPixelBufferGetBaseAddress(pixelBuffer))
+    }
+
+    /// Draw `image` into a new pixel buffer
+    convenience init(image: CGImage) throws {
+        self.init(pixelBuffer: try CapturedImage.draw(image))
+    }
+
+    deinit {
+        CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly)
+    }
+
+    /// Write the image to `url` through ScreenshotWriter. The CGImage handed
+    /// to the writer holds the pixel buffer, so a background write outlives
+    /// the caller's last reference.
+    func save(to url: URL) throws {
+        try ScreenshotWriter.checkFormat(url)
+        try ScreenshotWriter.shared.write(try makeCGImage(), to: url)
+    }
+
+    /// Write the image to `url` at `compression` before returning, whatever
+    /// ScreenshotWriter.shared is set to
+    func saveNow(to url: URL, compression: ScreenshotCompression) throws {
+        try ScreenshotWriter.checkFormat(url)
+        try ScreenshotWriter.shared.writeNow(try makeCGImage(), to: url, compression: compression)
+    }
+
+    /// A CGImage over the pixel buffer, which it keeps alive
+    private func makeCGImage() throws -> CGImage {
+        var image: CGImage?
+        guard VTCreateCGImageFromCVPixelBuffer(pixelBuffer, options: nil, imageOut: &image) == noErr,
+              let image = image else {
+            throw ScreenshotError.encodingFailed
+        }
+        return image
+    }
+
+    private static func draw(_ image: CGImage) throws -> CVPixelBuffer {
+        let buffer = try makePixelBuffer(width: image.width, height: image.height)
+
+        CVPixelBufferLockBaseAddress(buffer, [])
+        defer { CVPixelBufferUnlockBaseAddress(buffer, []) }
+        guard let context = CGContext(
+            data: CVPixelBufferGetBaseAddress(buffer),
+            width: image.width,
+            height: image.height,
+            bitsPerComponent: 8,
+            bytesPerRow: CVPixelBufferGetBytesPerRow(buffer),
+            space: image.colorSpace ?? CGColorSpaceCreateDeviceRGB(),
+            bitmapInfo: CGImageAlphaInfo.noneSkipFirst.rawValue | CGBitmapInfo.byteOrder32Little.rawValue
+        ) else {
+            throw ScreenshotError.captureFailed
+        }
+        context.draw(image, in: CGRect(x: 0, y: 0, width: image.width, height: image.height))
+        return buffer
+    }
+
+    /// An IOSurface-backed BGRA buffer, the kind ScreenCaptureKit delivers
+    static func makePixelBuffer(width: Int, height: Int) throws -> CVPixelBuffer {
+        let attributes = [kCVPixelBufferIOSurfacePropertiesKey: [:]] as CFDictionary
+        var buffer: CVPixelBuffer?
+        guard CVPixelBufferCreate(kCFAllocatorDefault, width, height, kCVPixelFormatType_32BGRA,
+                                  attributes, &buffer) == kCVReturnSuccess,
+              let buffer = buffer else {
+            throw ScreenshotError.captureFailed
+        }
+        return buffer
+    }
+}
+
+// MARK: - C API
+
+@_cdecl("rigid_image_retain")
+public func rigidImageRetain(_ image: UnsafeMutableRawPointer?) -> UnsafeMutableRawPointer? {
+    guard let image = image else { return nil }
+    _ = Unmanaged<CapturedImage>.fromOpaque(image).retain()
+    return image
+}
+
+@_cdecl("rigid_image_release")
+public func rigidImageRelease(_ image: UnsafeMutableRawPointer?) {
+    guard let image = image else { return }
+    Unmanaged<CapturedImage>.fromOpaque(image).release()
+}
+
+@_cdecl("rigid_image_get_view")
+public func rigidImageGetView(_ image: UnsafeMutableRawPointer?, _ view: UnsafeMutableRawPointer?) -> Bool {
+    guard let image = image, let view = view else { return false }
+    let captured = Unmanaged<CapturedImage>.fromOpaque(image).takeUnretainedValue()
+
+    // Field offsets of RigidImageView in RigidCaptureKit.h
+    view.storeBytes(of: captured.baseAddress, toByteOffset: 0, as: UnsafeRawPointer?.self)
+    view.storeBytes(of: Int32(CVPixelBufferGetWidth(captured.pixelBuffer)), toByteOffset: 8, as: Int32.self)
+    view.storeBytes(of: Int32(CVPixelBufferGetHeight(captured.pixelBuffer)), toByteOffset: 12, as: Int32.self)
+    view.storeBytes(of: Int32(CVPixelBufferGetBytesPerRow(captured.pixelBuffer)), toByteOffset: 16, as: Int32.self)
+    view.storeBytes(of: Int32(0), toByteOffset: 20, as: Int32.self) // RIGID_PIXEL_FORMAT_BGRA8
+    return true
+}
+
+@_cdecl("rigid_image_save")
+public func rigidImageSave(_ image: UnsafeMutableRawPointer?, _ outputPath: UnsafePointer<CChar>?) -> Int32 {
+    guard let image = image, let outputPath = outputPath else {
+        return 2 // RIGID_ERROR_INVALID_CONFIG
+    }
+
+    let captured = Unmanaged<CapturedImage>.fromOpaque(image).takeUnretainedValue()
+    do {
+        try captured.save(to: URL(fileURLWithPath: String(cString: outputPath)))
+        return 0
+    } catch let error as ScreenshotError {
+        return error.errorCode
+    } catch {
+        return 6
+    }
+}
+
+@_cdecl("rigid_image_save_now")
+public func rigidImageSaveNow(
+    _ image: UnsafeMutableRawPointer?,
+    _ outputPath: UnsafePointer<CChar>?,
+    _ compression: Int32
+) -> Int32 {
+    guard let image = image, let outputPath = outputPath,
+          let compression = ScreenshotCompression(rawValue: compression) else {
+        return 2 // RIGID_ERROR_INVALID_CONFIG
+    }
+
+    let captured = Unmanaged<CapturedImage>.fromOpaque(image).takeUnretainedValue()
+    do {
+        try captured.saveNow(to: URL(fileURLWithPath: String(cString: outputPath)), compression: compression)
+        return 0
+    } catch let error as ScreenshotError {
+        return error.errorCode
+    } catch {
+        return 6
+    }
+}
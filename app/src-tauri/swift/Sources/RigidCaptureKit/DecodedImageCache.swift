@@ -0,0 +1,120 @@
+import CoreImage
+import Foundation
+import ImageIO
+
+/// Decoded still images shared between frames and renders.
+///
+/// Entries are keyed by path and modification time, so an image edited on
+/// disk is decoded again. Images are decoded eagerly when first requested and
+/// the least recently used are dropped once the decoded pixels exceed the
+/// byte capacity. Mirrors the Linux engine's ImageCache.
+final class DecodedImageCache {
+
+    /// Process-wide cache used by the compositor
+    static let shared = DecodedImageCache(capacityBytes: 256 * 1024 * 1024)
+
+    private struct Entry {
+        let modified: Date?
+        let image: CIImage
+        let bytes: Int
+    }
+
+    private let capacityBytes: Int
+    private let lock = NSLock()
+    private var entries: [String: Entry] = [:]
+    /// Least recently used first
+    private var recency: [String] = []
+    private var sizeBytes = 0
+
+    init(capacityBytes: Int) {
+        self.capacityBytes = capacityBytes
+    }
+
+    /// Decoded image at `path`, or nil if it cannot be read
+    func image(atPath path: String) -> CIImage? {
+        let modified = (try? FileManager.default.attributesOfItem(atPath: path))?[.modificationDate] as? Date
+
+        lock.lock()
+        if let entry = entries[path] {
+            if entry.modified == modified {
+                touch(path)
+                lock.unlock()
+                return entry.image
+            }
+            // Changed on disk since it was cached
+            remove(path)
+        }
+        lock.unlock()
+
+        // Decode without the lock so other images can be served meanwhile
+        guard let decoded = DecodedImageCache.decode(path: path) else {
+            return nil
+        }
+        let (cgImage, orientation) = decoded
+        let image = CIImage(cgImage: cgImage).oriented(orientation)
+        let bytes = cgImage.bytesPerRow * cgImage.height
+
+        // Larger than the whole cache: hand it out without evicting everything else
+        guard bytes <= capacityBytes else {
+            return image
+        }
+
+        lock.lock()
+        remove(path)
+        entries[path] = Entry(modified: modified, image: image, bytes: bytes)
+        recency.append(path)
+        sizeBytes += bytes
+        while sizeBytes > capacityBytes, let oldest = recency.first {
+            remove(oldest)
+        }
+        lock.unlock()
+
+        return image
+    }
+
+    func removeAll() {
+        lock.lock()
+        entries.removeAll()
+        recency.removeAll()
+        sizeBytes = 0
+        lock.unlock()
+    }
+
+    // MARK: - Private
+
+    /// Decode now rather than lazily on every Core Image render. The EXIF
+    /// orientation is returned separately since ImageIO does not apply it
+    /// (NSImage, used before, did).
+    private static func decode(path: String) -> (CGImage, CGImagePropertyOrientation)? {
+        let url = URL(fileURLWithPath: path)
+        guard let source = CGImageSourceCreateWithURL(url as CFURL, nil) else {
+            return nil
+        }
+        let options: [CFString: Any] = [kCGImageSourceShouldCacheImmediately: true]
+        guard let cgImage = CGImageSourceCreateImageAtIndex(source, 0, options as CFDictionary) else {
+            return nil
+        }
+
+        let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any]
+        let orientation = (properties?[kCGImagePropertyOrientation] as? UInt32)
+            .flatMap(CGImagePropertyOrientation.init(rawValue:)) ?? .up
+        return (cgImage, orientation)
+    }
+
+    /// Requires the lock
+    private func touch(_ path: String) {
+        if let index = recency.firstIndex(of: path) {
+            recency.remove(at: index)
+        }
+        recency.append(path)
+    }
+
+    /// Requires the lock
+    private func remove(_ path: String) {
+        guard let entry = entries.removeValue(forKey: path) else { return }
+        sizeBytes -= entry.bytes
+        if let index = recency.firstIndex(of: path) {
+            recency.remove(at: index)
+        }
+    }
+}
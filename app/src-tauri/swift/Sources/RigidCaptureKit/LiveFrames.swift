@@ -0,0 +1,116 @@
+import CoreMedia
+import CoreVideo
+import Foundation
+
+/// A captured frame handed to live-frame subscribers; what RigidFrameRef
+/// points to on macOS (the Linux engine's equivalent is SharedFrame in
+/// FrameRing).
+///
+/// Wraps the IOSurface-backed pixel buffer ScreenCaptureKit delivered, locked
+/// read-only for as long as the frame lives. Subscribers read the same memory
+/// the asset writer encodes from; nothing is copied. SCStream recycles the
+/// buffer once every reference is gone.
+final class SharedFrame {
+    let pixelBuffer: CVPixelBuffer
+    let baseAddress: UnsafeRawPointer?
+    let timestampUs: Int64
+    let sequence: UInt64
+
+    init(pixelBuffer: CVPixelBuffer, timestampUs: Int64, sequence: UInt64) {
+        self.pixelBuffer = pixelBuffer
+        self.timestampUs = timestampUs
+        self.sequence = sequence
+        CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly)
+        baseAddress = UnsafeRawPointer(CVPixelBufferGetBaseAddress(pixelBuffer))
+    }
+
+    deinit {
+        CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly)
+    }
+}
+
+/// C callback for live frames: context, frame
+public typealias CFrameCallback = @convention(c) (UnsafeMutableRawPointer?, UnsafeMutableRawPointer?) -> Void
+
+/// Subscribers to a capture engine's live frames.
+///
+/// Same contract as FrameRing on Linux: callbacks run on the capture queue
+/// in subscription order, the lock is held while they run (so unsubscribe
+/// waits out a running callback), and a subscriber that wants a frame after
+/// its callback returns takes a reference with rigid_frame_retain.
+final class FrameSubscribers {
+    private struct Subscriber {
+        let id: UInt64
+        let callback: CFrameCallback
+        let context: UnsafeMutableRawPointer?
+    }
+
+    private let lock = NSLock()
+    private var subscribers: [Subscriber] = []
+    private var nextID: UInt64 = 1
+
+    var isEmpty: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return subscribers.isEmpty
+    }
+
+    func subscribe(callback: @escaping CFrameCallback, context: UnsafeMutableRawPointer?) -> UInt64 {
+        lock.lock()
+        defer { lock.unlock() }
+        let id = nextID
+        nextID += 1
+        subscribers.append(Subscriber(id: id, callback: callback, context: context))
+        return id
+    }
+
+    func unsubscribe(_ id: UInt64) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard let index = subscribers.firstIndex(where: { $0.id == id }) else { return false }
+        subscribers.remove(at: index)
+        return true
+    }
+
+    /// Hand `frame` to every subscriber. The publisher's reference is dropped
+    /// afterwards, so the frame lives on only if a subscriber retained it.
+    func publish(_ frame: SharedFrame) {
+        lock.lock()
+        defer { lock.unlock() }
+        let ref = Unmanaged.passRetained(frame)
+        for subscriber in subscribers {
+            subscriber.callback(subscriber.context, ref.toOpaque())
+        }
+        ref.release()
+    }
+}
+
+// MARK: - C API
+
+@_cdecl("rigid_frame_retain")
+public func rigidFrameRetain(_ frame: UnsafeMutableRawPointer?) -> UnsafeMutableRawPointer? {
+    guard let frame = frame else { return nil }
+    _ = Unmanaged<SharedFrame>.fromOpaque(frame).retain()
+    return frame
+}
+
+@_cdecl("rigid_frame_release")
+public func rigidFrameRelease(_ frame: UnsafeMutableRawPointer?) {
+    guard let frame = frame else { return }
+    Unmanaged<SharedFrame>.fromOpaque(frame).release()
+}
+
+@_cdecl("rigid_frame_get_view")
+public func rigidFrameGetView(_ frame: UnsafeMutableRawPointer?, _ view: UnsafeMutableRawPointer?) -> Bool {
+    guard let frame = frame, let view = view else { return false }
+    let shared = Unmanaged<SharedFrame>.fromOpaque(frame).takeUnretainedValue()
+
+    // Field offsets of RigidFrameView in RigidCaptureKit.h
+    view.storeBytes(of: shared.baseAddress, toByteOffset: 0, as: UnsafeRawPointer?.self)
+    view.storeBytes(of: Int32(CVPixelBufferGetWidth(shared.pixelBuffer)), toByteOffset: 8, as: Int32.self)
+    view.storeBytes(of: Int32(CVPixelBufferGetHeight(shared.pixelBuffer)), toByteOffset: 12, as: Int32.self)
+    view.storeBytes(of: Int32(CVPixelBufferGetBytesPerRow(shared.pixelBuffer)), toByteOffset: 16, as: Int32.self)
+    view.storeBytes(of: shared.timestampUs, toByteOffset: 24, as: Int64.self)
+    view.storeBytes(of: shared.sequence, toByteOffset: 32, as: UInt64.self)
+    return true
+}
@@ -0,0 +1,234 @@
+import Foundation
+
+/// Runs many compositor exports with a bounded number of concurrent renders.
+///
+/// Core Image and VideoToolbox schedule their own GPU and encoder work, so
+/// unlike the Linux engine there is no per-render thread budget here: the
+/// core budget passed to `rigid_render_queue_create` is accepted for ABI
+/// parity and ignored. Limiting concurrent renders is what keeps exports from
+/// starving each other.
+@available(macOS 12.0, *)
+final class RenderQueue {
+
+    private struct Job {
+        let exportId: String
+        let config: CompositorConfig
+        let priority: Int32
+        let sequence: UInt64
+        let progress: CProgressCallback?
+        let completion: CCompletionCallback?
+    }
+
+    private let maxConcurrentJobs: Int
+    private let lock = NSLock()
+    private var queued: [Job] = []
+    private var running: [String: VideoCompositorEngine] = [:]
+    private var nextSequence: UInt64 = 0
+    private var stopped = false
+
+    init(maxConcurrentJobs: Int) {
+        self.maxConcurrentJobs = max(maxConcurrentJobs, 1)
+    }
+
+    var depth: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return queued.count
+    }
+
+    var runningCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return running.count
+    }
+
+    func submit(
+        exportId: String,
+        config: CompositorConfig,
+        priority: Int32,
+        progress: CProgressCallback?,
+        completion: CCompletionCallback?
+    ) {
+        lock.lock()
+        queued.append(Job(
+            exportId: exportId,
+            config: config,
+            priority: priority,
+            sequence: nextSequence,
+            progress: progress,
+            completion: completion
+        ))
+        nextSequence += 1
+        lock.unlock()
+
+        startNextJobs()
+    }
+
+    /// Cancel a queued or running export. Returns false if the id is unknown.
+    func cancel(exportId: String) -> Bool {
+        lock.lock()
+        if let engine = running[exportId] {
+            lock.unlock()
+            engine.cancel()
+            return true
+        }
+        guard let index = queued.firstIndex(where: { $0.exportId == exportId }) else {
+            lock.unlock()
+            return false
+        }
+        let job = queued.remove(at: index)
+        lock.unlock()
+
+        job.completion?(job.exportId, 3, "Render cancelled")
+        return true
+    }
+
+    /// Cancel everything; used when the queue handle is destroyed
+    func shutdown() {
+        lock.lock()
+        stopped = true
+        let abandoned = queued
+        queued.removeAll()
+        let engines = Array(running.values)
+        lock.unlock()
+
+        engines.forEach { $0.cancel() }
+        for job in abandoned {
+            job.completion?(job.exportId, 3, "Render cancelled")
+        }
+    }
+
+    // MARK: - Private
+
+    /// Highest priority first, then submission order
+    private func nextJobIndex() -> Int? {
+        return queued.indices.min { a, b in
+            if queued[a].priority != queued[b].priority {
+                return queued[a].priority > queued[b].priority
+            }
+            return queued[a].sequence < queued[b].sequence
+        }
+    }
+
+    private func startNextJobs() {
+        var toStart: [(Job, VideoCompositorEngine)] = []
+
+        lock.lock()
+        while !stopped && running.count < maxConcurrentJobs, let index = nextJobIndex() {
+            let job = queued.remove(at: index)
+            let engine = VideoCompositorEngine()
+            running[job.exportId] = engine
+            toStart.append((job, engine))
+        }
+        lock.unlock()
+
+        for (job, engine) in toStart {
+            run(job, on: engine)
+        }
+    }
+
+    private func run(_ job: Job, on engine: VideoCompositorEngine) {
+        print("VideoCompositor: Starting queued export \(job.exportId)")
+
+        // Signal the start so listeners can tell queued jobs from running ones
+        let totalFrames = Int64(job.config.durationMs) * Int64(job.config.frameRate) / 1000
+        job.progress?(job.exportId, 0, 0, totalFrames)
+
+        Task {
+            do {
+                let outputPath = try await engine.render(config: job.config) { percent, current, total in
+                    job.progress?(job.exportId, percent, current, total)
+                }
+                job.completion?(job.exportId, 0, outputPath)
+            } catch {
+                print("VideoCompositor: Render failed: \(error)")
+                job.completion?(job.exportId, 3, error.localizedDescription)
+            }
+
+            self.lock.lock()
+            self.running.removeValue(forKey: job.exportId)
+            self.lock.unlock()
+
+            self.startNextJobs()
+        }
+    }
+}
+
+// MARK: - C API
+
+@available(macOS 12.0, *)
+private func renderQueue(from handle: UnsafeMutableRawPointer) -> RenderQueue {
+    return Unmanaged<RenderQueue>.fromOpaque(handle).takeUnretainedValue()
+}
+
+@_cdecl("rigid_render_queue_create")
+public func rigidRenderQueueCreate(_ maxConcurrentJobs: Int32, _ coreBudget: Int32) -> UnsafeMutableRawPointer? {
+    guard #available(macOS 12.0, *) else {
+        return nil
+    }
+    let queue = RenderQueue(maxConcurrentJobs: Int(maxConcurrentJobs))
+    return Unmanaged.passRetained(queue).toOpaque()
+}
+
+@_cdecl("rigid_render_queue_destroy")
+public func rigidRenderQueueDestroy(_ handle: UnsafeMutableRawPointer?) {
+    guard let handle = handle else { return }
+    guard #available(macOS 12.0, *) else { return }
+    let queue = Unmanaged<RenderQueue>.fromOpaque(handle)
+    queue.takeUnretainedValue().shutdown()
+    queue.release()
+}
+
+@_cdecl("rigid_render_queue_submit")
+public func rigidRenderQueueSubmit(
+    _ handle: UnsafeMutableRawPointer?,
+    _ exportId: UnsafePointer<CChar>?,
+    _ configJson: UnsafePointer<CChar>?,
+    _ priority: Int32,
+    _ progressCallback: CProgressCallback?,
+    _ completionCallback: CCompletionCallback?
+) -> Int32 {
+    guard #available(macOS 12.0, *) else {
+        return 2 // RIGID_ERROR_INVALID_CONFIG
+    }
+
+    guard let handle = handle, let exportId = exportId, let configJson = configJson else {
+        return 2
+    }
+
+    guard let configData = String(cString: configJson).data(using: .utf8),
+          let config = try? JSONDecoder().decode(CompositorConfig.self, from: configData) else {
+        print("VideoCompositor: Failed to parse config JSON")
+        return 2
+    }
+
+    renderQueue(from: handle).submit(
+        exportId: String(cString: exportId),
+        config: config,
+        priority: priority,
+        progress: progressCallback,
+        completion: completionCallback
+    )
+    return 0
+}
+
+@_cdecl("rigid_render_queue_cancel")
+public func rigidRenderQueueCancel(_ handle: UnsafeMutableRawPointer?, _ exportId: UnsafePointer<CChar>?) -> Bool {
+    guard let handle = handle, let exportId = exportId else { return false }
+    guard #available(macOS 12.0, *) else { return false }
+    return renderQueue(from: handle).cancel(exportId: String(cString: exportId))
+}
+
+@_cdecl("rigid_render_queue_depth")
+public func rigidRenderQueueDepth(_ handle: UnsafeMutableRawPointer?) -> Int32 {
+    guard let handle = handle else { return 0 }
+    guard #available(macOS 12.0, *) else { return 0 }
+    return Int32(renderQueue(from: handle).depth)
+}
+
+@_cdecl("rigid_render_queue_running")
+public func rigidRenderQueueRunning(_ handle: UnsafeMutableRawPointer?) -> Int32 {
+    guard let handle = handle else { return 0 }
+    guard #available(macOS 12.0, *) else { return 0 }
+    return Int32(renderQueue(from: handle).runningCount)
+}
@@ -0,0 +1,63 @@
+import CoreVideo
+import Foundation
+
+/// Composited frames waiting for the asset writer.
+///
+/// The export composites on its own queue and pushes frames here while the
+/// writer input pulls them off, so Core Image rendering and VideoToolbox
+/// encoding overlap instead of taking turns. The capacity bounds how far
+/// compositing runs ahead, and with it how many pool buffers are in flight.
+/// Mirrors the bounded queues of the Linux engine's RenderPipeline.
+final class RenderedFrameQueue {
+
+    struct RenderedFrame {
+        let frameIndex: Int64
+        /// nil when compositing failed; the frame is counted but not written
+        let pixelBuffer: CVPixelBuffer?
+    }
+
+    private let capacity: Int
+    private let condition = NSCondition()
+    private var frames: [RenderedFrame] = []
+    private var closed = false
+
+    init(capacity: Int) {
+        self.capacity = max(capacity, 1)
+    }
+
+    /// Blocks while the queue is full. Returns false (dropping the frame) once closed.
+    func push(_ frame: RenderedFrame) -> Bool {
+        condition.lock()
+        defer { condition.unlock() }
+
+        while !closed && frames.count >= capacity {
+            condition.wait()
+        }
+        guard !closed else { return false }
+        frames.append(frame)
+        condition.broadcast()
+        return true
+    }
+
+    /// Blocks until a frame is ready. Returns nil once closed and drained.
+    func pop() -> RenderedFrame? {
+        condition.lock()
+        defer { condition.unlock() }
+
+        while !closed && frames.isEmpty {
+            condition.wait()
+        }
+        guard !frames.isEmpty else { return nil }
+        let frame = frames.removeFirst()
+        condition.broadcast()
+        return frame
+    }
+
+    /// Wake both sides: pushes fail from now on and pops drain what is left
+    func close() {
+        condition.lock()
+        closed = true
+        condition.broadcast()
+        condition.unlock()
+    }
+}
@@ -10,6 +10,21 @@ class CaptureEngine {
     private var screenRecorder: ScreenRecorder?
     private let lock = NSLock()
 
+    /// Live frame subscribers, kept across recordings
+    let frameSubscribers = FrameSubscribers()
+
+    /// Backpressure settings for the next recording
+    private var backpressure = BackpressureSettings()
+
+    /// Stats of the current recording, or of the last one once stopped
+    let stats = CaptureStats()
+
+    func setBackpressure(_ settings: BackpressureSettings) {
+        lock.lock()
+        defer { lock.unlock() }
+        backpressure = settings
+    }
+
     var isRecording: Bool {
         lock.lock()
         defer { lock.unlock() }
@@ -36,7 +51,10 @@ class CaptureEngine {
         let recorder = ScreenRecorder(
             filter: filter,
             outputPath: outputPath,
-            configuration: config
+            configuration: config,
+            frameSubscribers: frameSubscribers,
+            backpressure: backpressure,
+            stats: stats
         )
         screenRecorder = recorder
         lock.unlock()
@@ -408,20 +426,29 @@ public func rigidCaptureStartRegionRecording(
                 return
             }
 
-            // For region recording, we capture the full display
-            // Note: SCStreamConfiguration supports sourceRect for cropping in macOS 14+
+            // Crop to the region at the source (sourceRect), clamped to the display
+            let region = CGRect(x: Int(x), y: Int(y), width: Int(regionWidth), height: Int(regionHeight))
+                .intersection(CGRect(x: 0, y: 0, width: display.width, height: display.height))
+                .integral
+            guard !region.isNull, region.width > 0, region.height > 0 else {
+                result = 2 // RIGID_ERROR_INVALID_CONFIG
+                semaphore.signal()
+                return
+            }
+
             let filter = SCContentFilter(display: display, excludingWindows: [])
 
             let recordingConfig = RecordingConfiguration(
-                width: Int(regionWidth),
-                height: Int(regionHeight),
+                width: Int(region.width),
+                height: Int(region.height),
                 fps: Int(fps > 0 ? fps : 60),
                 bitrate: Int(bitrate > 0 ? bitrate : 20_000_000),
                 keyframeInterval: Int(keyframeInterval > 0 ? keyframeInterval : 60),
                 codec: videoCodecFromC(codec),
                 captureCursor: captureCursor,
                 captureAudio: captureAudio,
-                scaleFactor: CGFloat(scaleFactor > 0 ? scaleFactor : 2.0)
+                scaleFactor: CGFloat(scaleFactor > 0 ? scaleFactor : 2.0),
+                sourceRect: region
             )
 
             try await engine.startRecording(
@@ -516,6 +543,83 @@ public func rigidCaptureGetRecordingDurationMs(_ handle: UnsafeMutableRawPointer
     return engine.recordingDurationMs
 }
 
+// MARK: Backpressure and Statistics
+
+@_cdecl("rigid_capture_set_backpressure")
+public func rigidCaptureSetBackpressure(_ handle: UnsafeMutableRawPointer?, _ policy: Int32, _ queueDepth: UInt32) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 2
+    }
+
+    guard let handle = handle,
+          let policy = BackpressurePolicy(rawValue: policy) else {
+        return 2
+    }
+
+    var settings = BackpressureSettings()
+    settings.policy = policy
+    if queueDepth > 0 {
+        settings.queueDepth = Int(queueDepth)
+    }
+
+    let engine = Unmanaged<CaptureEngine>.fromOpaque(handle).takeUnretainedValue()
+    engine.setBackpressure(settings)
+    return 0
+}
+
+@_cdecl("rigid_capture_get_stats")
+public func rigidCaptureGetStats(_ handle: UnsafeMutableRawPointer?, _ stats: UnsafeMutableRawPointer?) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 2
+    }
+
+    guard let handle = handle, let stats = stats else {
+        return 2
+    }
+
+    let engine = Unmanaged<CaptureEngine>.fromOpaque(handle).takeUnretainedValue()
+    engine.stats.write(to: stats)
+    return 0
+}
+
+// MARK: Live Frames
+
+@_cdecl("rigid_capture_subscribe_frames")
+public func rigidCaptureSubscribeFrames(
+    _ handle: UnsafeMutableRawPointer?,
+    _ callback: CFrameCallback?,
+    _ context: UnsafeMutableRawPointer?,
+    _ subscriptionId: UnsafeMutablePointer<UInt64>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 2
+    }
+
+    guard let handle = handle,
+          let callback = callback,
+          let subscriptionId = subscriptionId else {
+        return 2
+    }
+
+    let engine = Unmanaged<CaptureEngine>.fromOpaque(handle).takeUnretainedValue()
+    subscriptionId.pointee = engine.frameSubscribers.subscribe(callback: callback, context: context)
+    return 0
+}
+
+@_cdecl("rigid_capture_unsubscribe_frames")
+public func rigidCaptureUnsubscribeFrames(_ handle: UnsafeMutableRawPointer?, _ subscriptionId: UInt64) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 2
+    }
+
+    guard let handle = handle else {
+        return 2
+    }
+
+    let engine = Unmanaged<CaptureEngine>.fromOpaque(handle).takeUnretainedValue()
+    return engine.frameSubscribers.unsubscribe(subscriptionId) ? 0 : 2
+}
+
 // MARK: Screenshot - Window
 
 @_cdecl("rigid_capture_screenshot_window")
@@ -667,6 +771,261 @@ public func rigidCaptureScreenshotRegion(
     return result
 }
 
+// MARK: Screenshot Session
+
+@_cdecl("rigid_screenshot_session_open")
+public func rigidScreenshotSessionOpen(
+    _ displayId: UInt32,
+    _ scaleFactor: Float,
+    _ captureCursor: Bool,
+    _ session: UnsafeMutablePointer<UnsafeMutableRawPointer?>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 6
+    }
+
+    guard let session = session else {
+        return 2
+    }
+
+    var result: Int32 = 0
+    let semaphore = DispatchSemaphore(value: 0)
+
+    Task {
+        do {
+            let opened = try await ScreenshotSession.open(
+                displayID: displayId,
+                scaleFactor: CGFloat(scaleFactor > 0 ? scaleFactor : 2.0),
+                captureCursor: captureCursor
+            )
+            session.pointee = Unmanaged.passRetained(opened).toOpaque()
+            result = 0
+        } catch let error as ScreenshotError {
+            result = error.errorCode
+        } catch {
+            result = 6
+        }
+        semaphore.signal()
+    }
+
+    semaphore.wait()
+    return result
+}
+
+@_cdecl("rigid_screenshot_session_capture")
+public func rigidScreenshotSessionCapture(
+    _ session: UnsafeMutableRawPointer?,
+    _ x: Int32,
+    _ y: Int32,
+    _ width: Int32,
+    _ height: Int32,
+    _ outputPath: UnsafePointer<CChar>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 6
+    }
+
+    guard let session = session,
+          let outputPath = outputPath else {
+        return 2
+    }
+
+    let screenshotSession = Unmanaged<ScreenshotSession>.fromOpaque(session).takeUnretainedValue()
+    let rect = width > 0 && height > 0
+        ? CGRect(x: CGFloat(x), y: CGFloat(y), width: CGFloat(width), height: CGFloat(height))
+        : nil
+
+    // No Task or semaphore: the frame is already in memory
+    do {
+        try screenshotSession.capture(rect: rect, outputPath: URL(fileURLWithPath: String(cString: outputPath)))
+        return 0
+    } catch let error as ScreenshotError {
+        return error.errorCode
+    } catch {
+        return 6
+    }
+}
+
+@_cdecl("rigid_screenshot_session_close")
+public func rigidScreenshotSessionClose(_ session: UnsafeMutableRawPointer?) {
+    guard let session = session else { return }
+    guard #available(macOS 12.3, *) else { return }
+
+    let screenshotSession = Unmanaged<ScreenshotSession>.fromOpaque(session).takeRetainedValue()
+    let semaphore = DispatchSemaphore(value: 0)
+    Task {
+        await screenshotSession.close()
+        semaphore.signal()
+    }
+    semaphore.wait()
+}
+
+// MARK: Screenshot Encoding
+
+@_cdecl("rigid_screenshot_set_encoding")
+public func rigidScreenshotSetEncoding(_ compression: Int32, _ background: Bool) -> Int32 {
+    guard let compression = ScreenshotCompression(rawValue: compression) else {
+        return 2 // RIGID_ERROR_INVALID_CONFIG
+    }
+    ScreenshotWriter.shared.setEncoding(compression: compression, background: background)
+    return 0
+}
+
+@_cdecl("rigid_screenshot_wait_for_writes")
+public func rigidScreenshotWaitForWrites() -> Int32 {
+    do {
+        try ScreenshotWriter.shared.waitForWrites()
+        return 0
+    } catch let error as ScreenshotError {
+        return error.errorCode
+    } catch {
+        return 6
+    }
+}
+
+// MARK: Screenshot Buffers
+
+/// Run `capture` and hand its image to the caller through `image`, with the
+/// caller's reference
+@available(macOS 12.3, *)
+private func captureToBuffer(
+    _ image: UnsafeMutablePointer<UnsafeMutableRawPointer?>,
+    _ capture: @escaping () async throws -> CapturedImage
+) -> Int32 {
+    var result: Int32 = 0
+    let semaphore = DispatchSemaphore(value: 0)
+
+    Task {
+        do {
+            image.pointee = Unmanaged.passRetained(try await capture()).toOpaque()
+            result = 0
+        } catch let error as ScreenshotError {
+            result = error.errorCode
+        } catch {
+            result = 6
+        }
+        semaphore.signal()
+    }
+
+    semaphore.wait()
+    return result
+}
+
+@_cdecl("rigid_capture_screenshot_window_to_buffer")
+public func rigidCaptureScreenshotWindowToBuffer(
+    _ windowId: UInt32,
+    _ scaleFactor: Float,
+    _ captureCursor: Bool,
+    _ image: UnsafeMutablePointer<UnsafeMutableRawPointer?>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 6
+    }
+
+    guard let image = image else {
+        return 2
+    }
+
+    let screenshotConfig = ScreenshotConfiguration(
+        scaleFactor: CGFloat(scaleFactor > 0 ? scaleFactor : 2.0),
+        captureCursor: captureCursor
+    )
+
+    return captureToBuffer(image) {
+        try await ScreenshotCapture.windowTarget(windowID: windowId, config: screenshotConfig).captureBuffer()
+    }
+}
+
+@_cdecl("rigid_capture_screenshot_display_to_buffer")
+public func rigidCaptureScreenshotDisplayToBuffer(
+    _ displayId: UInt32,
+    _ scaleFactor: Float,
+    _ captureCursor: Bool,
+    _ image: UnsafeMutablePointer<UnsafeMutableRawPointer?>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 6
+    }
+
+    guard let image = image else {
+        return 2
+    }
+
+    let screenshotConfig = ScreenshotConfiguration(
+        scaleFactor: CGFloat(scaleFactor > 0 ? scaleFactor : 2.0),
+        captureCursor: captureCursor
+    )
+
+    return captureToBuffer(image) {
+        try await ScreenshotCapture.displayTarget(displayID: displayId, config: screenshotConfig).captureBuffer()
+    }
+}
+
+@_cdecl("rigid_capture_screenshot_region_to_buffer")
+public func rigidCaptureScreenshotRegionToBuffer(
+    _ displayId: UInt32,
+    _ x: Int32,
+    _ y: Int32,
+    _ width: Int32,
+    _ height: Int32,
+    _ scaleFactor: Float,
+    _ captureCursor: Bool,
+    _ image: UnsafeMutablePointer<UnsafeMutableRawPointer?>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 6
+    }
+
+    guard let image = image, width > 0, height > 0 else {
+        return 2
+    }
+
+    let rect = CGRect(x: CGFloat(x), y: CGFloat(y), width: CGFloat(width), height: CGFloat(height))
+
+    let screenshotConfig = ScreenshotConfiguration(
+        scaleFactor: CGFloat(scaleFactor > 0 ? scaleFactor : 2.0),
+        captureCursor: captureCursor
+    )
+
+    return captureToBuffer(image) {
+        try await ScreenshotCapture.regionTarget(displayID: displayId, rect: rect, config: screenshotConfig)
+            .captureBuffer()
+    }
+}
+
+@_cdecl("rigid_screenshot_session_capture_to_buffer")
+public func rigidScreenshotSessionCaptureToBuffer(
+    _ session: UnsafeMutableRawPointer?,
+    _ x: Int32,
+    _ y: Int32,
+    _ width: Int32,
+    _ height: Int32,
+    _ image: UnsafeMutablePointer<UnsafeMutableRawPointer?>?
+) -> Int32 {
+    guard #available(macOS 12.3, *) else {
+        return 6
+    }
+
+    guard let session = session,
+          let image = image else {
+        return 2
+    }
+
+    let screenshotSession = Unmanaged<ScreenshotSession>.fromOpaque(session).takeUnretainedValue()
+    let rect = width > 0 && height > 0
+        ? CGRect(x: CGFloat(x), y: CGFloat(y), width: CGFloat(width), height: CGFloat(height))
+        : nil
+
+    do {
+        image.pointee = Unmanaged.passRetained(try screenshotSession.captureImage(rect: rect)).toOpaque()
+        return 0
+    } catch let error as ScreenshotError {
+        return error.errorCode
+    } catch {
+        return 6
+    }
+}
+
 // MARK: - Webcam Recording
 
 // Global webcam recorder instance (separate from screen capture)
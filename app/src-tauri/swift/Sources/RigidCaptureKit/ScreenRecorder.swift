@@ -15,6 +15,9 @@ struct RecordingConfiguration {
     let captureCursor: Bool
     let captureAudio: Bool
     let scaleFactor: CGFloat
+    /// Part of the display to capture, in points from its top-left corner;
+    /// nil for the whole filter content. width/height are then the region's.
+    var sourceRect: CGRect? = nil
 
     enum VideoCodec {
         case h264
@@ -59,8 +62,22 @@ class ScreenRecorder: NSObject {
     private let filter: SCContentFilter
     private let outputPath: URL
     private let configuration: RecordingConfiguration
+    private let frameSubscribers: FrameSubscribers?
+    private let backpressure: BackpressureSettings
+    private let stats: CaptureStats?
+
+    /// Frames waiting for the writer under the dropOldest policy, oldest first
+    private struct PendingFrame {
+        let imageBuffer: CVImageBuffer
+        let relativeTime: CMTime
+        let presentationTime: CMTime
+    }
 
+    private var streamConfig: SCStreamConfiguration?
+    private var pendingFrames: [PendingFrame] = []
+    private var governor: FrameRateGovernor
     private var frameCount: Int64 = 0
+    private var publishedFrameCount: UInt64 = 0
     private var startTime: CMTime?
     private var _isRecording: Bool = false
     private var recordingStartDate: Date?
@@ -78,11 +95,18 @@ class ScreenRecorder: NSObject {
     init(
         filter: SCContentFilter,
         outputPath: URL,
-        configuration: RecordingConfiguration
+        configuration: RecordingConfiguration,
+        frameSubscribers: FrameSubscribers? = nil,
+        backpressure: BackpressureSettings = BackpressureSettings(),
+        stats: CaptureStats? = nil
     ) {
         self.filter = filter
         self.outputPath = outputPath
         self.configuration = configuration
+        self.frameSubscribers = frameSubscribers
+        self.backpressure = backpressure
+        self.stats = stats
+        governor = FrameRateGovernor(targetFps: configuration.fps)
         super.init()
     }
 
@@ -91,8 +115,17 @@ class ScreenRecorder: NSObject {
         let streamConfig = SCStreamConfiguration()
 
         // Use backing pixel dimensions for Retina-correct capture
-        let pixelWidth = Int(CGFloat(configuration.width) * configuration.scaleFactor)
-        let pixelHeight = Int(CGFloat(configuration.height) * configuration.scaleFactor)
+        var pixelWidth = Int(CGFloat(configuration.width) * configuration.scaleFactor)
+        var pixelHeight = Int(CGFloat(configuration.height) * configuration.scaleFactor)
+
+        // Crop at the source, so only the region's pixels are captured,
+        // converted and encoded. Regions can have odd sizes, which 4:2:0
+        // encoders cannot take.
+        if let sourceRect = configuration.sourceRect {
+            streamConfig.sourceRect = sourceRect
+            pixelWidth &= ~1
+            pixelHeight &= ~1
+        }
 
         streamConfig.width = pixelWidth
         streamConfig.height = pixelHeight
@@ -102,7 +135,7 @@ class ScreenRecorder: NSObject {
         streamConfig.minimumFrameInterval = CMTime(value: 1, timescale: CMTimeScale(configuration.fps))
 
         // Buffer frames to prevent drops during encoding spikes
-        streamConfig.queueDepth = 8
+        streamConfig.queueDepth = backpressure.queueDepth
 
         // Capture settings
         streamConfig.showsCursor = configuration.captureCursor
@@ -118,7 +151,9 @@ class ScreenRecorder: NSObject {
             streamConfig.colorSpaceName = CGColorSpace.itur_709 as CFString
         }
 
-        // Create stream
+        // Create stream, keeping its configuration for adaptive frame rate changes
+        self.streamConfig = streamConfig
+        stats?.reset(fps: configuration.fps)
         stream = SCStream(filter: filter, configuration: streamConfig, delegate: self)
 
         // Setup asset writer for encoding
@@ -149,6 +184,9 @@ class ScreenRecorder: NSObject {
         try await stream?.stopCapture()
         stream = nil
 
+        // Frames still queued under dropOldest go to the writer before it closes
+        videoQueue.sync { flushPendingFrames() }
+
         // Mark inputs as finished
         videoInput?.markAsFinished()
         audioInput?.markAsFinished()
@@ -177,6 +215,7 @@ class ScreenRecorder: NSObject {
         try? FileManager.default.removeItem(at: outputPath)
 
         // Cleanup
+        videoQueue.sync { pendingFrames.removeAll() }
         assetWriter = nil
         videoInput = nil
         audioInput = nil
@@ -298,9 +337,7 @@ extension ScreenRecorder: SCStreamOutput {
     }
 
     private func handleVideoSample(_ sampleBuffer: CMSampleBuffer) {
-        guard let videoInput = videoInput,
-              videoInput.isReadyForMoreMediaData,
-              CMSampleBufferDataIsReady(sampleBuffer) else {
+        guard CMSampleBufferDataIsReady(sampleBuffer) else {
             return
         }
 
@@ -309,6 +346,8 @@ extension ScreenRecorder: SCStreamOutput {
             return
         }
 
+        let processingStart = ProcessInfo.processInfo.systemUptime
+
         // Get presentation timestamp from the capture
         let presentationTime = CMSampleBufferGetPresentationTimeStamp(sampleBuffer)
 
@@ -320,9 +359,87 @@ extension ScreenRecorder: SCStreamOutput {
         // Calculate relative time from recording start
         let relativeTime = CMTimeSubtract(presentationTime, startTime!)
 
-        // Append the pixel buffer with its timestamp
-        if pixelBufferAdaptor?.append(imageBuffer, withPresentationTime: relativeTime) == true {
-            frameCount += 1
+        // Live subscribers (preview, motion detection) get the same
+        // IOSurface-backed buffer the writer encodes, even when the writer
+        // skips this frame
+        if let frameSubscribers = frameSubscribers, !frameSubscribers.isEmpty {
+            let timestampUs = Int64(CMTimeGetSeconds(relativeTime) * 1_000_000)
+            frameSubscribers.publish(SharedFrame(pixelBuffer: imageBuffer, timestampUs: timestampUs,
+                                                 sequence: publishedFrameCount))
+            publishedFrameCount += 1
+        }
+
+        let frame = PendingFrame(imageBuffer: imageBuffer, relativeTime: relativeTime,
+                                 presentationTime: presentationTime)
+        var dropped = false
+        switch backpressure.policy {
+        case .dropNewest, .adaptiveFps:
+            dropped = !appendFrame(frame)
+        case .dropOldest:
+            // Queued frames go first so the file stays in capture order
+            appendPendingFrames()
+            if !pendingFrames.isEmpty || !appendFrame(frame) {
+                if pendingFrames.count >= backpressure.pendingCapacity {
+                    pendingFrames.removeFirst()
+                    dropped = true
+                }
+                pendingFrames.append(frame)
+            }
+        }
+        if dropped {
+            stats?.frameDropped()
+        }
+
+        if backpressure.policy == .adaptiveFps && governor.frameCaptured(dropped: dropped) {
+            updateFrameRate(governor.currentFps)
+        }
+
+        stats?.frameCaptured(processingSeconds: ProcessInfo.processInfo.systemUptime - processingStart)
+    }
+
+    /// Hand a frame to the writer. False when the writer is busy (or refused it).
+    private func appendFrame(_ frame: PendingFrame) -> Bool {
+        guard videoInput?.isReadyForMoreMediaData == true,
+              pixelBufferAdaptor?.append(frame.imageBuffer, withPresentationTime: frame.relativeTime) == true else {
+            return false
+        }
+        frameCount += 1
+        stats?.frameEncoded(presentationTime: frame.presentationTime)
+        return true
+    }
+
+    /// Append queued frames, oldest first, for as long as the writer takes them
+    private func appendPendingFrames() {
+        while let frame = pendingFrames.first, appendFrame(frame) {
+            pendingFrames.removeFirst()
+        }
+    }
+
+    /// On stop: give the writer a short while to take the queued frames,
+    /// counting whatever it does not take as dropped
+    private func flushPendingFrames() {
+        let deadline = ProcessInfo.processInfo.systemUptime + 0.5
+        while !pendingFrames.isEmpty && ProcessInfo.processInfo.systemUptime < deadline {
+            appendPendingFrames()
+            if !pendingFrames.isEmpty {
+                Thread.sleep(forTimeInterval: 0.002)
+            }
+        }
+        for _ in pendingFrames {
+            stats?.frameDropped()
+        }
+        pendingFrames.removeAll()
+    }
+
+    /// Ask SCStream for a new capture rate (adaptiveFps)
+    private func updateFrameRate(_ fps: Int) {
+        guard let stream = stream, let streamConfig = streamConfig else { return }
+        streamConfig.minimumFrameInterval = CMTime(value: 1, timescale: CMTimeScale(fps))
+        stats?.setCurrentFps(fps)
+        stream.updateConfiguration(streamConfig) { error in
+            if let error = error {
+                print("ScreenRecorder: Failed to change capture rate to \(fps) fps: \(error.localizedDescription)")
+            }
         }
     }
 
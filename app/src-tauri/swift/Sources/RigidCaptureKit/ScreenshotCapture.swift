@@ -1,7 +1,7 @@
 import Foundation
 import ScreenCaptureKit
 import CoreGraphics
-import AppKit
+import CoreMedia
 
 /// Configuration for screenshot capture
 struct ScreenshotConfiguration {
@@ -15,6 +15,8 @@ enum ScreenshotError: Error {
     case displayNotFound
     case captureFailed
     case cropFailed
+    case invalidRegion
+    case unsupportedFormat
     case encodingFailed
     case permissionDenied
 
@@ -24,6 +26,8 @@ enum ScreenshotError: Error {
         case .displayNotFound: return 8 // RIGID_ERROR_DISPLAY_NOT_FOUND
         case .captureFailed: return 6   // RIGID_ERROR_SCREENSHOT_FAILED
         case .cropFailed: return 6
+        case .invalidRegion: return 2  // RIGID_ERROR_INVALID_CONFIG
+        case .unsupportedFormat: return 2
         case .encodingFailed: return 6
         case .permissionDenied: return 1 // RIGID_ERROR_NOT_AUTHORIZED
         }
@@ -34,12 +38,83 @@ enum ScreenshotError: Error {
 @available(macOS 12.3, *)
 class ScreenshotCapture {
 
+    /// What to capture and how: ScreenCaptureKit's filter and configuration,
+    /// and the CoreGraphics capture macOS 12-13 use instead
+    struct Target {
+        let filter: SCContentFilter
+        let configuration: SCStreamConfiguration
+        let legacy: () -> CGImage?
+
+        func captureImage() async throws -> CGImage {
+            // Use SCScreenshotManager for single-frame capture (macOS 14+)
+            if #available(macOS 14.0, *) {
+                return try await SCScreenshotManager.captureImage(
+                    contentFilter: filter,
+                    configuration: configuration
+                )
+            }
+            guard let image = legacy() else {
+                throw ScreenshotError.captureFailed
+            }
+            return image
+        }
+
+        /// Into memory. On macOS 14 this keeps the pixel buffer
+        /// ScreenCaptureKit captured into, with no copy.
+        func captureBuffer() async throws -> CapturedImage {
+            if #available(macOS 14.0, *) {
+                let sample = try await SCScreenshotManager.captureSampleBuffer(
+                    contentFilter: filter,
+                    configuration: configuration
+                )
+                guard let pixelBuffer = CMSampleBufferGetImageBuffer(sample) else {
+                    throw ScreenshotError.captureFailed
+                }
+                return CapturedImage(pixelBuffer: pixelBuffer)
+            }
+            return try CapturedImage(image: try await captureImage())
+        }
+    }
+
     /// Capture a window at native backing resolution
     static func captureWindow(
         windowID: CGWindowID,
         outputPath: URL,
         config: ScreenshotConfiguration
     ) async throws {
+        try ScreenshotWriter.checkFormat(outputPath)
+        let target = try await windowTarget(windowID: windowID, config: config)
+        try saveImage(try await target.captureImage(), to: outputPath)
+    }
+
+    /// Capture a display at native backing resolution
+    static func captureDisplay(
+        displayID: CGDirectDisplayID,
+        outputPath: URL,
+        config: ScreenshotConfiguration
+    ) async throws {
+        try ScreenshotWriter.checkFormat(outputPath)
+        let target = try await displayTarget(displayID: displayID, config: config)
+        try saveImage(try await target.captureImage(), to: outputPath)
+    }
+
+    /// Capture a region of a display at native backing resolution. Only the
+    /// region is captured (sourceRect), so cost scales with its size rather
+    /// than the display's.
+    static func captureRegion(
+        displayID: CGDirectDisplayID,
+        rect: CGRect,
+        outputPath: URL,
+        config: ScreenshotConfiguration
+    ) async throws {
+        try ScreenshotWriter.checkFormat(outputPath)
+        let target = try await regionTarget(displayID: displayID, rect: rect, config: config)
+        try saveImage(try await target.captureImage(), to: outputPath)
+    }
+
+    // MARK: - Targets
+
+    static func windowTarget(windowID: CGWindowID, config: ScreenshotConfiguration) async throws -> Target {
         // Get shareable content to find our window
         let content = try await SCShareableContent.excludingDesktopWindows(false, onScreenWindowsOnly: true)
 
@@ -66,25 +141,15 @@ class ScreenshotCapture {
         }
         streamConfig.pixelFormat = kCVPixelFormatType_32BGRA
 
-        // Use SCScreenshotManager for single-frame capture (macOS 14+)
-        if #available(macOS 14.0, *) {
-            let image = try await SCScreenshotManager.captureImage(
-                contentFilter: filter,
-                configuration: streamConfig
-            )
-            try saveImage(image, to: outputPath)
-        } else {
-            // Fallback for macOS 12-13: Use CGWindowListCreateImage
-            try captureWindowLegacy(windowID: windowID, outputPath: outputPath, config: config)
+        // Fallback for macOS 12-13: Use CGWindowListCreateImage
+        return Target(filter: filter, configuration: streamConfig) {
+            // CGWindowListCreateImage options for high-quality capture
+            // .nominalResolution uses the backing scale factor
+            CGWindowListCreateImage(.null, .optionIncludingWindow, windowID, [.boundsIgnoreFraming, .nominalResolution])
         }
     }
 
-    /// Capture a display at native backing resolution
-    static func captureDisplay(
-        displayID: CGDirectDisplayID,
-        outputPath: URL,
-        config: ScreenshotConfiguration
-    ) async throws {
+    static func displayTarget(displayID: CGDirectDisplayID, config: ScreenshotConfiguration) async throws -> Target {
         let content = try await SCShareableContent.excludingDesktopWindows(false, onScreenWindowsOnly: true)
 
         guard let display = content.displays.first(where: { $0.displayID == displayID }) else {
@@ -108,144 +173,51 @@ class ScreenshotCapture {
         }
         streamConfig.pixelFormat = kCVPixelFormatType_32BGRA
 
-        if #available(macOS 14.0, *) {
-            let image = try await SCScreenshotManager.captureImage(
-                contentFilter: filter,
-                configuration: streamConfig
-            )
-            try saveImage(image, to: outputPath)
-        } else {
-            try captureDisplayLegacy(displayID: displayID, outputPath: outputPath, config: config)
-        }
+        // CGDisplayCreateImage captures at native resolution
+        return Target(filter: filter, configuration: streamConfig) { CGDisplayCreateImage(displayID) }
     }
 
-    /// Capture a region of a display at native backing resolution
-    static func captureRegion(
+    static func regionTarget(
         displayID: CGDirectDisplayID,
         rect: CGRect,
-        outputPath: URL,
         config: ScreenshotConfiguration
-    ) async throws {
+    ) async throws -> Target {
         let content = try await SCShareableContent.excludingDesktopWindows(false, onScreenWindowsOnly: true)
 
         guard let display = content.displays.first(where: { $0.displayID == displayID }) else {
             throw ScreenshotError.displayNotFound
         }
 
+        let region = rect
+            .intersection(CGRect(x: 0, y: 0, width: display.width, height: display.height))
+            .integral
+        guard !region.isNull, region.width > 0, region.height > 0 else {
+            throw ScreenshotError.invalidRegion
+        }
+
         let filter = SCContentFilter(display: display, excludingWindows: [])
 
         let streamConfig = SCStreamConfiguration()
 
-        // Capture at full display resolution
-        let fullWidth = Int(CGFloat(display.width) * config.scaleFactor)
-        let fullHeight = Int(CGFloat(display.height) * config.scaleFactor)
-
-        streamConfig.width = fullWidth
-        streamConfig.height = fullHeight
+        // Capture just the region, at its backing pixel size
+        streamConfig.sourceRect = region
+        streamConfig.width = Int(region.width * config.scaleFactor)
+        streamConfig.height = Int(region.height * config.scaleFactor)
         streamConfig.showsCursor = config.captureCursor
         if #available(macOS 13.0, *) {
             streamConfig.capturesAudio = false
         }
         streamConfig.pixelFormat = kCVPixelFormatType_32BGRA
 
-        if #available(macOS 14.0, *) {
-            let fullImage = try await SCScreenshotManager.captureImage(
-                contentFilter: filter,
-                configuration: streamConfig
-            )
-
-            // Crop to region at scaled coordinates
-            let scaledRect = CGRect(
-                x: rect.origin.x * config.scaleFactor,
-                y: rect.origin.y * config.scaleFactor,
-                width: rect.width * config.scaleFactor,
-                height: rect.height * config.scaleFactor
-            )
-
-            guard let croppedImage = fullImage.cropping(to: scaledRect) else {
-                throw ScreenshotError.cropFailed
-            }
-
-            try saveImage(croppedImage, to: outputPath)
-        } else {
-            try captureRegionLegacy(displayID: displayID, rect: rect, outputPath: outputPath, config: config)
-        }
-    }
-
-    // MARK: - Legacy implementations for macOS 12-13
-
-    private static func captureWindowLegacy(
-        windowID: CGWindowID,
-        outputPath: URL,
-        config: ScreenshotConfiguration
-    ) throws {
-        // CGWindowListCreateImage options for high-quality capture
-        // .nominalResolution uses the backing scale factor
-        let imageOption: CGWindowImageOption = [.boundsIgnoreFraming, .nominalResolution]
-
-        guard let cgImage = CGWindowListCreateImage(
-            .null,
-            .optionIncludingWindow,
-            windowID,
-            imageOption
-        ) else {
-            throw ScreenshotError.captureFailed
-        }
-
-        try saveImage(cgImage, to: outputPath)
-    }
-
-    private static func captureDisplayLegacy(
-        displayID: CGDirectDisplayID,
-        outputPath: URL,
-        config: ScreenshotConfiguration
-    ) throws {
-        // CGDisplayCreateImage captures at native resolution
-        guard let cgImage = CGDisplayCreateImage(displayID) else {
-            throw ScreenshotError.captureFailed
-        }
-
-        try saveImage(cgImage, to: outputPath)
-    }
-
-    private static func captureRegionLegacy(
-        displayID: CGDirectDisplayID,
-        rect: CGRect,
-        outputPath: URL,
-        config: ScreenshotConfiguration
-    ) throws {
-        guard let fullImage = CGDisplayCreateImage(displayID) else {
-            throw ScreenshotError.captureFailed
-        }
-
-        // Scale the rect to pixel coordinates
-        let scaledRect = CGRect(
-            x: rect.origin.x * config.scaleFactor,
-            y: rect.origin.y * config.scaleFactor,
-            width: rect.width * config.scaleFactor,
-            height: rect.height * config.scaleFactor
-        )
-
-        guard let croppedImage = fullImage.cropping(to: scaledRect) else {
-            throw ScreenshotError.cropFailed
-        }
-
-        try saveImage(croppedImage, to: outputPath)
+        // Copies only the rect (display points) at the display's native resolution
+        return Target(filter: filter, configuration: streamConfig) { CGDisplayCreateImage(displayID, rect: region) }
     }
 
     // MARK: - Image saving
 
-    /// Save CGImage to file as PNG
-    private static func saveImage(_ cgImage: CGImage, to url: URL) throws {
-        let bitmapRep = NSBitmapImageRep(cgImage: cgImage)
-
-        // PNG with maximum quality
-        let properties: [NSBitmapImageRep.PropertyKey: Any] = [:]
-
-        guard let pngData = bitmapRep.representation(using: .png, properties: properties) else {
-            throw ScreenshotError.encodingFailed
-        }
-
-        try pngData.write(to: url)
+    /// Save CGImage to file through ScreenshotWriter, in the format the
+    /// file's extension names
+    static func saveImage(_ cgImage: CGImage, to url: URL) throws {
+        try ScreenshotWriter.shared.write(cgImage, to: url)
     }
 }
@@ -0,0 +1,164 @@
+import Foundation
+import ScreenCaptureKit
+import CoreImage
+import CoreMedia
+import CoreVideo
+
+/// A display kept ready for repeated screenshots.
+///
+/// rigid_capture_screenshot_* look up shareable content and start a capture
+/// for every call. A session does that once: its SCStream stays running and
+/// keeps the latest frame, so capture() only crops and saves what is already
+/// in memory. SCStream delivers a new frame only when the screen changes,
+/// so the kept frame is always current, and an idle screen costs nothing.
+@available(macOS 12.3, *)
+final class ScreenshotSession: NSObject {
+    private let display: SCDisplay
+    private let scaleFactor: CGFloat
+    private let stream: SCStream
+    private let queue = DispatchQueue(label: "com.rigid.screenshot.session", qos: .userInteractive)
+    private let context = CIContext(options: [.cacheIntermediates: false])
+
+    private let lock = NSLock()
+    private let firstFrame = DispatchSemaphore(value: 0)
+    private var latestFrame: CVPixelBuffer?
+
+    /// Longest capture() waits for the stream's first frame
+    private static let firstFrameTimeout: DispatchTimeInterval = .milliseconds(500)
+
+    private init(display: SCDisplay, scaleFactor: CGFloat, captureCursor: Bool) {
+        self.display = display
+        self.scaleFactor = scaleFactor
+
+        let streamConfig = SCStreamConfiguration()
+        streamConfig.width = Int(CGFloat(display.width) * scaleFactor)
+        streamConfig.height = Int(CGFloat(display.height) * scaleFactor)
+        streamConfig.minimumFrameInterval = CMTime(value: 1, timescale: 60)
+        // The kept frame plus the two the stream may be filling
+        streamConfig.queueDepth = 3
+        streamConfig.showsCursor = captureCursor
+        streamConfig.pixelFormat = kCVPixelFormatType_32BGRA
+        if #available(macOS 13.0, *) {
+            streamConfig.capturesAudio = false
+        }
+
+        stream = SCStream(filter: SCContentFilter(display: display, excludingWindows: []),
+                          configuration: streamConfig, delegate: nil)
+        super.init()
+    }
+
+    /// Start a session on `displayID`
+    static func open(displayID: CGDirectDisplayID, scaleFactor: CGFloat,
+                     captureCursor: Bool) async throws -> ScreenshotSession {
+        let content = try await SCShareableContent.excludingDesktopWindows(false, onScreenWindowsOnly: true)
+
+        guard let display = content.displays.first(where: { $0.displayID == displayID }) else {
+            throw ScreenshotError.displayNotFound
+        }
+
+        let session = ScreenshotSession(display: display, scaleFactor: scaleFactor, captureCursor: captureCursor)
+        try session.stream.addStreamOutput(session, type: .screen, sampleHandlerQueue: session.queue)
+        try await session.stream.startCapture()
+        return session
+    }
+
+    func close() async {
+        try? await stream.stopCapture()
+        lock.lock()
+        latestFrame = nil
+        lock.unlock()
+    }
+
+    /// Save the display, or `rect` of it (points from the top-left, clamped
+    /// to the display) when given, through ScreenshotWriter
+    func capture(rect: CGRect?, outputPath: URL) throws {
+        try ScreenshotWriter.checkFormat(outputPath)
+
+        let (frame, pixelRect) = try currentFrame(rect: rect)
+        guard let cgImage = context.createCGImage(CIImage(cvPixelBuffer: frame), from: pixelRect) else {
+            throw ScreenshotError.captureFailed
+        }
+
+        try ScreenshotCapture.saveImage(cgImage, to: outputPath)
+    }
+
+    /// As capture, into memory. The area is copied out of the frame even when
+    /// it is all of it: a held image must not keep one of the few buffers
+    /// the stream captures into.
+    func captureImage(rect: CGRect?) throws -> CapturedImage {
+        let (frame, pixelRect) = try currentFrame(rect: rect)
+        let buffer = try CapturedImage.makePixelBuffer(width: Int(pixelRect.width), height: Int(pixelRect.height))
+
+        let image = CIImage(cvPixelBuffer: frame)
+            .cropped(to: pixelRect)
+            .transformed(by: CGAffineTransform(translationX: -pixelRect.minX, y: -pixelRect.minY))
+        // No color space: copy the pixels as captured
+        context.render(image, to: buffer, bounds: CGRect(origin: .zero, size: pixelRect.size), colorSpace: nil)
+        return CapturedImage(pixelBuffer: buffer)
+    }
+
+    /// The latest frame, and `rect` (as for capture) in its pixels, counting
+    /// y from the bottom as Core Image does
+    private func currentFrame(rect: CGRect?) throws -> (CVPixelBuffer, CGRect) {
+        guard let frame = currentFrame() else {
+            throw ScreenshotError.captureFailed
+        }
+
+        let bounds = CGRect(x: 0, y: 0, width: display.width, height: display.height)
+        let region = (rect ?? bounds).intersection(bounds).integral
+        guard !region.isNull, region.width > 0, region.height > 0 else {
+            throw ScreenshotError.invalidRegion
+        }
+
+        let pixelHeight = CGFloat(CVPixelBufferGetHeight(frame))
+        let pixelRect = CGRect(
+            x: region.minX * scaleFactor,
+            y: pixelHeight - region.maxY * scaleFactor,
+            width: region.width * scaleFactor,
+            height: region.height * scaleFactor
+        ).integral
+        return (frame, pixelRect)
+    }
+
+    /// The latest frame, waiting for the first one after open
+    private func currentFrame() -> CVPixelBuffer? {
+        lock.lock()
+        if let frame = latestFrame {
+            lock.unlock()
+            return frame
+        }
+        lock.unlock()
+
+        guard firstFrame.wait(timeout: .now() + Self.firstFrameTimeout) == .success else {
+            return nil
+        }
+        // Let later waiters through as well
+        firstFrame.signal()
+
+        lock.lock()
+        defer { lock.unlock() }
+        return latestFrame
+    }
+}
+
+// MARK: - SCStreamOutput
+@available(macOS 12.3, *)
+extension ScreenshotSession: SCStreamOutput {
+    func stream(_ stream: SCStream, didOutputSampleBuffer sampleBuffer: CMSampleBuffer, of type: SCStreamOutputType) {
+        // Idle frames (nothing changed) carry no image; keep the one we have
+        guard type == .screen,
+              CMSampleBufferDataIsReady(sampleBuffer),
+              let imageBuffer = CMSampleBufferGetImageBuffer(sampleBuffer) else {
+            return
+        }
+
+        lock.lock()
+        let isFirst = latestFrame == nil
+        latestFrame = imageBuffer
+        lock.unlock()
+
+        if isFirst {
+            firstFrame.signal()
+        }
+    }
+}
@@ -0,0 +1,259 @@
+import Foundation
+import CoreGraphics
+import ImageIO
+
+/// How hard screenshot encoders compress (RIGID_COMPRESSION_*)
+enum ScreenshotCompression: Int32 {
+    case fast = 0
+    case standard = 1
+    case smallest = 2
+}
+
+/// Screenshot file formats, named by the output path's extension
+enum ScreenshotFormat {
+    case png
+    case qoi
+    case webp
+
+    /// ".qoi" and ".webp" (in any case) name their formats; anything else is PNG
+    init(url: URL) {
+        switch url.pathExtension.lowercased() {
+        case "qoi": self = .qoi
+        case "webp": self = .webp
+        default: self = .png
+        }
+    }
+}
+
+/// Encodes screenshots into files; the encode stage behind the screenshot
+/// C API.
+///
+/// PNG goes through ImageIO, which is faster than NSBitmapImageRep and can
+/// skip the adaptive filter search for fast saves. QOI is encoded here. In
+/// the background, write() only queues the image, so the capture that made
+/// it returns at once and the next capture is not held up by this one's
+/// encode. Files are written atomically, so nothing reads a partial image.
+final class ScreenshotWriter {
+    static let shared = ScreenshotWriter()
+
+    /// Images queued in the background before write() waits for the
+    /// encoder to catch up, which bounds the memory a burst of captures holds
+    static let maxQueued = 4
+
+    private let queue = DispatchQueue(label: "com.rigid.screenshot.writer", qos: .utility)
+    private let pending = DispatchGroup()
+    private let slots = DispatchSemaphore(value: ScreenshotWriter.maxQueued)
+
+    private let lock = NSLock()
+    private var compression: ScreenshotCompression = .standard
+    private var background = false
+    /// First background failure since the last waitForWrites
+    private var failure: ScreenshotError?
+
+    /// ImageIO decodes WebP but has no encoder for it
+    static func checkFormat(_ url: URL) throws {
+        if ScreenshotFormat(url: url) == .webp {
+            throw ScreenshotError.unsupportedFormat
+        }
+    }
+
+    /// Settings for later writes; images already queued keep theirs
+    func setEncoding(compression: ScreenshotCompression, background: Bool) {
+        lock.lock()
+        self.compression = compression
+        self.background = background
+        lock.unlock()
+    }
+
+    /// Write `image` to `url` in the format its extension names. In the
+    /// background, failures surface from waitForWrites instead.
+    func write(_ image: CGImage, to url: URL) throws {
+        try Self.checkFormat(url)
+
+        lock.lock()
+        let compression = self.compression
+        let background = self.background
+        lock.unlock()
+
+        guard background else {
+            try Self.encode(image, to: url, compression: compression)
+            return
+        }
+
+        slots.wait()
+        pending.enter()
+        queue.async {
+            defer {
+                self.slots.signal()
+                self.pending.leave()
+            }
+            do {
+                try Self.encode(image, to: url, compression: compression)
+            } catch {
+                NSLog("ScreenshotWriter: cannot write %@: %@", url.path, "\(error)")
+                self.lock.lock()
+                if self.failure == nil {
+                    self.failure = error as? ScreenshotError ?? .encodingFailed
+                }
+                self.lock.unlock()
+            }
+        }
+    }
+
+    /// Write `image` to `url` at `compression` before returning, whatever
+    /// setEncoding says, for callers that pick their own level. Failures are
+    /// thrown here and never reach waitForWrites.
+    func writeNow(_ image: CGImage, to url: URL, compression: ScreenshotCompression) throws {
+        try Self.checkFormat(url)
+        try Self.encode(image, to: url, compression: compression)
+    }
+
+    /// Wait until every queued image is written. Throws the first
+    /// background failure since the last call.
+    func waitForWrites() throws {
+        pending.wait()
+
+        lock.lock()
+        let failure = self.failure
+        self.failure = nil
+        lock.unlock()
+
+        if let failure = failure {
+            throw failure
+        }
+    }
+
+    // MARK: - Encoding
+
+    private static func encode(_ image: CGImage, to url: URL, compression: ScreenshotCompression) throws {
+        let data: Data
+        switch ScreenshotFormat(url: url) {
+        case .png:
+            data = try encodePNG(image, compression: compression)
+        case .qoi:
+            data = try encodeQOI(image)
+        case .webp:
+            throw ScreenshotError.unsupportedFormat
+        }
+        do {
+            try data.write(to: url, options: .atomic)
+        } catch {
+            throw ScreenshotError.encodingFailed
+        }
+    }
+
+    private static func encodePNG(_ image: CGImage, compression: ScreenshotCompression) throws -> Data {
+        let data = NSMutableData()
+        guard let destination = CGImageDestinationCreateWithData(
+            data, "public.png" as CFString, 1, nil
+        ) else {
+            throw ScreenshotError.encodingFailed
+        }
+
+        // ImageIO has no deflate level; for fast saves it skips trying
+        // every filter per row and uses Sub, which suits screen content
+        var properties: [CFString: Any] = [:]
+        if compression == .fast {
+            properties[kCGImagePropertyPNGDictionary] = [
+                kCGImagePropertyPNGCompressionFilter: IMAGEIO_PNG_FILTER_SUB
+            ]
+        }
+
+        CGImageDestinationAddImage(destination, image, properties as CFDictionary)
+        guard CGImageDestinationFinalize(destination) else {
+            throw ScreenshotError.encodingFailed
+        }
+        return data as Data
+    }
+
+    /// 3-channel sRGB QOI (https://qoiformat.org): lossless, a single pass
+    /// with no entropy coding, so several times faster than PNG at the cost
+    /// of larger files
+    private static func encodeQOI(_ image: CGImage) throws -> Data {
+        let width = image.width
+        let height = image.height
+        guard width > 0, height > 0 else {
+            throw ScreenshotError.encodingFailed
+        }
+
+        // Draw into BGRA of a known layout; captured images are opaque
+        let bytesPerRow = width * 4
+        var pixels = [UInt8](repeating: 0, count: bytesPerRow * height)
+        let drawn = pixels.withUnsafeMutableBytes { buffer -> Bool in
+            guard let context = CGContext(
+                data: buffer.baseAddress, width: width, height: height,
+                bitsPerComponent: 8, bytesPerRow: bytesPerRow,
+                space: image.colorSpace ?? CGColorSpace(name: CGColorSpace.sRGB)!,
+                bitmapInfo: CGImageAlphaInfo.noneSkipFirst.rawValue | CGBitmapInfo.byteOrder32Little.rawValue
+            ) else {
+                return false
+            }
+            context.draw(image, in: CGRect(x: 0, y: 0, width: width, height: height))
+            return true
+        }
+        guard drawn else {
+            throw ScreenshotError.encodingFailed
+        }
+
+        var out = [UInt8]()
+        out.reserveCapacity(14 + width * height + 8)
+        out.append(contentsOf: Array("qoif".utf8))
+        for value in [UInt32(width), UInt32(height)] {
+            out.append(contentsOf: [UInt8(value >> 24), UInt8(truncatingIfNeeded: value >> 16),
+                                    UInt8(truncatingIfNeeded: value >> 8), UInt8(truncatingIfNeeded: value)])
+        }
+        out.append(3) // RGB
+        out.append(0) // sRGB with linear alpha
+
+        // Slots start out transparent black, which no opaque pixel matches
+        var index = [UInt32](repeating: 0, count: 64)
+        var filled = [Bool](repeating: false, count: 64)
+        var previous: UInt32 = 0 // RGB packed as 0x00RRGGBB
+        var run = 0
+
+        for i in stride(from: 0, to: pixels.count, by: 4) {
+            let r = pixels[i + 2], g = pixels[i + 1], b = pixels[i]
+            let pixel = UInt32(r) << 16 | UInt32(g) << 8 | UInt32(b)
+            if pixel == previous {
+                run += 1
+                if run == 62 {
+                    out.append(0xc0 | UInt8(run - 1))
+                    run = 0
+                }
+                continue
+            }
+            if run > 0 {
+                out.append(0xc0 | UInt8(run - 1))
+                run = 0
+            }
+
+            let slot = (Int(r) * 3 + Int(g) * 5 + Int(b) * 7 + 255 * 11) % 64
+            if filled[slot] && index[slot] == pixel {
+                out.append(UInt8(slot))
+            } else {
+                index[slot] = pixel
+                filled[slot] = true
+                let dr = Int(Int8(bitPattern: r &- UInt8(truncatingIfNeeded: previous >> 16)))
+                let dg = Int(Int8(bitPattern: g &- UInt8(truncatingIfNeeded: previous >> 8)))
+                let db = Int(Int8(bitPattern: b &- UInt8(truncatingIfNeeded: previous)))
+                let drDg = dr - dg
+                let dbDg = db - dg
+                if (-2...1).contains(dr) && (-2...1).contains(dg) && (-2...1).contains(db) {
+                    out.append(0x40 | UInt8((dr + 2) << 4 | (dg + 2) << 2 | (db + 2)))
+                } else if (-32...31).contains(dg) && (-8...7).contains(drDg) && (-8...7).contains(dbDg) {
+                    out.append(0x80 | UInt8(dg + 32))
+                    out.append(UInt8((drDg + 8) << 4 | (dbDg + 8)))
+                } else {
+                    out.append(contentsOf: [0xfe, r, g, b])
+                }
+            }
+            previous = pixel
+        }
+        if run > 0 {
+            out.append(0xc0 | UInt8(run - 1))
+        }
+
+        out.append(contentsOf: [0, 0, 0, 0, 0, 0, 0, 1])
+        return Data(out)
+    }
+}
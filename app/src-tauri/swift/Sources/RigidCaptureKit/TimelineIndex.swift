@@ -0,0 +1,69 @@
+import Foundation
+
+/// Items active over half-open [start, end) time ranges, looked up by time.
+///
+/// Built once per render. The timeline is cut at every start and end into
+/// segments with a fixed set of active items, so a lookup is a binary search
+/// plus the items actually on screen. Mirrors the Linux engine's TimelineIndex.
+struct TimelineIndex {
+
+    /// Sorted, unique interval starts and ends
+    private let boundaries: [Double]
+    /// segments[i] covers boundaries[i] ..< boundaries[i + 1]
+    private let segments: [[Int]]
+
+    /// `intervals[i]` is item i. Lookups return active items in this order,
+    /// so callers pass intervals already sorted by z-index.
+    init(intervals: [(startSec: Double, endSec: Double)]) {
+        let valid = intervals.filter { $0.endSec > $0.startSec }
+        let boundaries = Array(Set(valid.flatMap { [$0.startSec, $0.endSec] })).sorted()
+        self.boundaries = boundaries
+
+        guard boundaries.count >= 2 else {
+            segments = []
+            return
+        }
+
+        // Every item covers a contiguous run of segments; no boundary falls inside one
+        var segments = [[Int]](repeating: [], count: boundaries.count - 1)
+        for (item, interval) in intervals.enumerated() where interval.endSec > interval.startSec {
+            let first = TimelineIndex.firstIndex(in: boundaries, notBelow: interval.startSec)
+            let last = TimelineIndex.firstIndex(in: boundaries, notBelow: interval.endSec)
+            for segment in first..<last {
+                segments[segment].append(item)
+            }
+        }
+        self.segments = segments
+    }
+
+    /// Indices of the items with start <= timeSec < end, in input order
+    func active(at timeSec: Double) -> [Int] {
+        // First boundary after timeSec; the segment starts at the one before it
+        var low = 0
+        var high = boundaries.count
+        while low < high {
+            let mid = (low + high) / 2
+            if boundaries[mid] <= timeSec {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        guard low > 0 && low < boundaries.count else { return [] }
+        return segments[low - 1]
+    }
+
+    private static func firstIndex(in sorted: [Double], notBelow value: Double) -> Int {
+        var low = 0
+        var high = sorted.count
+        while low < high {
+            let mid = (low + high) / 2
+            if sorted[mid] < value {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        return low
+    }
+}
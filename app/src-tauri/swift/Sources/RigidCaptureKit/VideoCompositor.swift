@@ -486,9 +486,7 @@ class CustomVideoCompositor: NSObject, AVVideoCompositing {
 
         case .image:
             if let imagePath = bg.mediaPath ?? bg.imageUrl,
-               let nsImage = NSImage(contentsOfFile: imagePath),
-               let cgImage = nsImage.cgImage(forProposedRect: nil, context: nil, hints: nil) {
-                var image = CIImage(cgImage: cgImage)
+               var image = DecodedImageCache.shared.image(atPath: imagePath) {
                 // Scale to fill
                 let scaleX = size.width / image.extent.width
                 let scaleY = size.height / image.extent.height
@@ -798,7 +796,6 @@ class VideoCompositorEngine {
 
     func render(config: CompositorConfig, progress: CompositorProgressCallback?) async throws -> String {
         self.progressCallback = progress
-        self.isCancelled = false
 
         let outputURL = URL(fileURLWithPath: config.outputPath)
 
@@ -995,6 +992,132 @@ class VideoCompositorEngine {
         return config.outputPath
     }
 
+    /// Streams a video track's frames in presentation order with AVAssetReader.
+    ///
+    /// Export asks for monotonically increasing times, so decoding forward and
+    /// holding the current frame is far cheaper than a random-access seek per
+    /// output frame. The reader is only restarted when the requested time goes
+    /// backwards or jumps well ahead (in-points, speed changes, freeze frames).
+    ///
+    /// A frame stays up until the next frame's timestamp, not for one nominal
+    /// frame duration: recordings skip idle frames, so a frame can cover a
+    /// long gap. Internal rather than private so tests can drive it.
+    final class VideoFrameCursor {
+        /// Jumps shorter than this are decoded through rather than seeked
+        private static let forwardSeekThresholdSec = 2.0
+
+        private let asset: AVAsset
+        private let track: AVAssetTrack
+        private let orientation: CGImagePropertyOrientation
+        private let frameDurationSec: Double
+
+        private var reader: AVAssetReader?
+        private var output: AVAssetReaderTrackOutput?
+        /// Last frame with a timestamp at or before the requested time
+        private var current: (image: CIImage, ptsSec: Double)?
+        /// The frame after `current`, read but not shown yet
+        private var peeked: (pixelBuffer: CVPixelBuffer, ptsSec: Double)?
+        private var reachedEnd = false
+
+        /// Readers started so far; each one decodes from the previous keyframe
+        private(set) var readerStartCount = 0
+
+        init(asset: AVAsset, track: AVAssetTrack, preferredTransform: CGAffineTransform, frameRate: Double) {
+            self.asset = asset
+            self.track = track
+            self.orientation = VideoFrameCursor.orientation(for: preferredTransform)
+            self.frameDurationSec = 1.0 / frameRate
+        }
+
+        deinit {
+            reader?.cancelReading()
+        }
+
+        /// Frame shown at `sourceSec`, or nil if the track cannot be read.
+        /// Past the end of the track the last frame is held.
+        func image(at sourceSec: Double) -> CIImage? {
+            var sought = reader == nil || current.map { sourceSec < $0.ptsSec } ?? true
+            if !sought, let next = peek(), sourceSec > next.ptsSec + VideoFrameCursor.forwardSeekThresholdSec {
+                sought = true
+            }
+            if sought {
+                startReading(at: sourceSec)
+            }
+
+            // After a seek the first frame read covers sourceSec; otherwise only
+            // move on once the next frame's timestamp has been reached
+            while let next = peek(), sought || next.ptsSec <= sourceSec {
+                current = (CIImage(cvPixelBuffer: next.pixelBuffer).oriented(orientation), next.ptsSec)
+                peeked = nil
+                sought = false
+            }
+
+            return current?.image
+        }
+
+        /// The next frame in the stream, read once and kept until shown
+        private func peek() -> (pixelBuffer: CVPixelBuffer, ptsSec: Double)? {
+            if let peeked = peeked { return peeked }
+            guard !reachedEnd, let output = output else { return nil }
+
+            while let sample = output.copyNextSampleBuffer() {
+                guard let pixelBuffer = CMSampleBufferGetImageBuffer(sample) else { continue }
+                let ptsSec = CMTimeGetSeconds(CMSampleBufferGetPresentationTimeStamp(sample))
+                peeked = (pixelBuffer, ptsSec)
+                return peeked
+            }
+
+            reachedEnd = true
+            return nil
+        }
+
+        private func startReading(at sourceSec: Double) {
+            reader?.cancelReading()
+            reader = nil
+            output = nil
+            peeked = nil
+            reachedEnd = false
+            readerStartCount += 1
+
+            do {
+                let newReader = try AVAssetReader(asset: asset)
+                // Start one frame early so the frame covering sourceSec is not skipped
+                let startSec = max(sourceSec - frameDurationSec, 0)
+                newReader.timeRange = CMTimeRange(
+                    start: CMTime(seconds: startSec, preferredTimescale: 600),
+                    duration: .positiveInfinity
+                )
+
+                let trackOutput = AVAssetReaderTrackOutput(track: track, outputSettings: [
+                    kCVPixelBufferPixelFormatTypeKey as String: kCVPixelFormatType_32BGRA,
+                    kCVPixelBufferMetalCompatibilityKey as String: true
+                ])
+                // Frames are only read, so skip the defensive copy of each sample
+                trackOutput.alwaysCopiesSampleData = false
+                newReader.add(trackOutput)
+
+                guard newReader.startReading() else {
+                    print("VideoCompositor: Failed to start reader: \(newReader.error?.localizedDescription ?? "unknown error")")
+                    return
+                }
+                reader = newReader
+                output = trackOutput
+            } catch {
+                print("VideoCompositor: Failed to create reader: \(error)")
+            }
+        }
+
+        /// AVAssetImageGenerator applied the track transform for us; the reader does not
+        private static func orientation(for transform: CGAffineTransform) -> CGImagePropertyOrientation {
+            switch (transform.a, transform.b, transform.c, transform.d) {
+            case (0, 1, -1, 0): return .right
+            case (0, -1, 1, 0): return .left
+            case (-1, 0, 0, -1): return .down
+            default: return .up
+            }
+        }
+    }
+
     /// Video clip source - holds asset and track info for on-demand frame reading
     private class VideoClipSource {
         let clip: CompositorClip
@@ -1006,8 +1129,8 @@ class VideoCompositorEngine {
         let sourceFrameRate: Double
         let speed: Double  // Playback speed multiplier
 
-        // Use AVAssetImageGenerator for random access (simpler and works for our use case)
-        let imageGenerator: AVAssetImageGenerator
+        /// Sequential decoder; export requests frames in timeline order
+        let cursor: VideoFrameCursor
 
         init(clip: CompositorClip) async throws {
             self.clip = clip
@@ -1031,12 +1154,13 @@ class VideoCompositorEngine {
             let nominalFrameRate = try await track.load(.nominalFrameRate)
             self.sourceFrameRate = Double(nominalFrameRate > 0 ? nominalFrameRate : 30)
 
-            // Setup image generator with tolerance for performance
-            self.imageGenerator = AVAssetImageGenerator(asset: asset)
-            imageGenerator.appliesPreferredTrackTransform = true
-            // Allow some tolerance for much better performance
-            imageGenerator.requestedTimeToleranceBefore = CMTime(seconds: 0.1, preferredTimescale: 600)
-            imageGenerator.requestedTimeToleranceAfter = CMTime(seconds: 0.1, preferredTimescale: 600)
+            let preferredTransform = try await track.load(.preferredTransform)
+            self.cursor = VideoFrameCursor(
+                asset: asset,
+                track: track,
+                preferredTransform: preferredTransform,
+                frameRate: sourceFrameRate
+            )
 
             print("VideoCompositor: Initialized source for \(clip.sourcePath), frameRate: \(sourceFrameRate), speed: \(speed)")
         }
@@ -1053,6 +1177,78 @@ class VideoCompositorEngine {
         }
     }
 
+    /// What is on screen when, built once per export so each frame only
+    /// touches the clips and effects that are active (see TimelineIndex)
+    private struct CompositionTimeline {
+        /// Visual clips sorted by z-index, with their decoder for video clips
+        private let clips: [(clip: CompositorClip, source: VideoClipSource?)]
+        /// Sorted by z-index
+        private let pans: [CompositorPanClip]
+        /// Config order, which is the order zooms are applied in
+        private let zooms: [CompositorZoomClip]
+        /// Sorted by z-index
+        private let blurs: [CompositorBlurClip]
+
+        private let clipIndex: TimelineIndex
+        private let panIndex: TimelineIndex
+        private let zoomIndex: TimelineIndex
+        private let blurIndex: TimelineIndex
+
+        init(config: CompositorConfig, videoSources: [VideoClipSource]) {
+            let visualClips = CompositionTimeline.zOrdered(config.clips.filter { $0.sourceType != .audio }) { $0.zIndex }
+            clips = visualClips.map { clip in
+                // Match by both path and timeline position
+                let source = clip.sourceType == .video ? videoSources.first(where: {
+                    $0.clip.sourcePath == clip.sourcePath && $0.clip.startTimeMs == clip.startTimeMs
+                }) : nil
+                return (clip, source)
+            }
+            pans = CompositionTimeline.zOrdered(config.panClips ?? []) { $0.zIndex }
+            zooms = config.zoomClips ?? []
+            blurs = CompositionTimeline.zOrdered(config.blurClips ?? []) { $0.zIndex }
+
+            clipIndex = TimelineIndex(intervals: visualClips.map { CompositionTimeline.interval($0.startTimeMs, $0.durationMs) })
+            panIndex = TimelineIndex(intervals: pans.map { CompositionTimeline.interval($0.startTimeMs, $0.durationMs) })
+            zoomIndex = TimelineIndex(intervals: zooms.map { CompositionTimeline.interval($0.startTimeMs, $0.durationMs) })
+            blurIndex = TimelineIndex(intervals: blurs.map { CompositionTimeline.interval($0.startTimeMs, $0.durationMs) })
+        }
+
+        /// Active visual clips in z-order
+        func clips(at timeSec: Double) -> [(clip: CompositorClip, source: VideoClipSource?)] {
+            return clipIndex.active(at: timeSec).map { clips[$0] }
+        }
+
+        /// Active pans in z-order
+        func pans(at timeSec: Double) -> [CompositorPanClip] {
+            return panIndex.active(at: timeSec).map { pans[$0] }
+        }
+
+        func zooms(at timeSec: Double) -> [CompositorZoomClip] {
+            return zoomIndex.active(at: timeSec).map { zooms[$0] }
+        }
+
+        /// Active blurs in z-order
+        func blurs(at timeSec: Double) -> [CompositorBlurClip] {
+            return blurIndex.active(at: timeSec).map { blurs[$0] }
+        }
+
+        /// Stable sort, so equal z keeps config order
+        private static func zOrdered<T>(_ items: [T], zIndex: (T) -> Int) -> [T] {
+            return items.enumerated()
+                .sorted { a, b in
+                    let za = zIndex(a.element)
+                    let zb = zIndex(b.element)
+                    return za != zb ? za < zb : a.offset < b.offset
+                }
+                .map { $0.element }
+        }
+
+        private static func interval(_ startTimeMs: Int64, _ durationMs: Int64) -> (startSec: Double, endSec: Double) {
+            let startSec = Double(startTimeMs) / 1000.0
+            return (startSec, startSec + Double(durationMs) / 1000.0)
+        }
+    }
+
     /// Export by generating frames directly with full video support
     /// Uses DispatchGroup pattern for proper async coordination (proven approach from VideoIO/FYVideoCompressor)
     private func exportWithDirectFrameGeneration(
@@ -1083,6 +1279,8 @@ class VideoCompositorEngine {
         }
         print("VideoCompositor: Initialized \(videoSources.count) video sources")
 
+        let timeline = CompositionTimeline(config: config, videoSources: videoSources)
+
         // Create asset writer
         let writer = try AVAssetWriter(outputURL: outputURL, fileType: .mp4)
 
@@ -1154,6 +1352,9 @@ class VideoCompositorEngine {
         let frameDuration = CMTime(value: 1, timescale: CMTimeScale(config.frameRate))
         let outputSize = CGSize(width: config.width, height: config.height)
 
+        // The background is the same on every frame, so render it once
+        let background = renderStaticBackground(config.background, size: outputSize, ciContext: ciContext)
+
         print("VideoCompositor: Starting frame generation, totalFrames: \(totalFrames)")
 
         // Use DispatchGroup for proper coordination
@@ -1164,54 +1365,69 @@ class VideoCompositorEngine {
         var videoError: Error? = nil
         var framesWritten: Int64 = 0
 
-        // Video encoding
-        group.enter()
-        videoInput.requestMediaDataWhenReady(on: videoQueue) { [weak self] in
-            guard let self = self else {
-                videoInput.markAsFinished()
-                group.leave()
-                return
-            }
+        // Composite on its own queue, a few frames ahead of the writer, so the
+        // GPU renders frame N+1 while VideoToolbox encodes frame N
+        let composeQueue = DispatchQueue(label: "video.compositor.compose", qos: .userInitiated)
+        let renderedFrames = RenderedFrameQueue(capacity: 3)
 
-            while videoInput.isReadyForMoreMediaData && !self.isCancelled {
-                if framesWritten >= totalFrames {
-                    videoInput.markAsFinished()
-                    group.leave()
-                    return
-                }
+        composeQueue.async { [weak self] in
+            defer { renderedFrames.close() }
+            for frameIndex in 0..<totalFrames {
+                guard let self = self, !self.isCancelled else { return }
 
-                let presentationTime = CMTimeMultiply(frameDuration, multiplier: Int32(framesWritten))
-                let currentTimeSec = CMTimeGetSeconds(presentationTime)
-
-                autoreleasepool {
-                    // Create composite frame
-                    if let pixelBuffer = self.createCompositeFrameSync(
-                        timeSec: currentTimeSec,
+                let pixelBuffer: CVPixelBuffer? = autoreleasepool {
+                    let timeSec = CMTimeGetSeconds(CMTimeMultiply(frameDuration, multiplier: Int32(frameIndex)))
+                    return self.createCompositeFrameSync(
+                        timeSec: timeSec,
                         config: config,
                         outputSize: outputSize,
                         ciContext: ciContext,
                         adaptor: adaptor,
-                        videoSources: videoSources
-                    ) {
-                        if !adaptor.append(pixelBuffer, withPresentationTime: presentationTime) {
-                            print("VideoCompositor: Failed to append frame \(framesWritten)")
-                            if writer.status == .failed {
-                                videoError = writer.error
-                                videoInput.markAsFinished()
-                                group.leave()
-                                return
-                            }
-                        }
+                        timeline: timeline,
+                        background: background
+                    )
+                }
+                guard renderedFrames.push(.init(frameIndex: frameIndex, pixelBuffer: pixelBuffer)) else { return }
+            }
+        }
+
+        // Video encoding: append composited frames as the writer asks for them
+        var videoFinished = false
+        let finishVideo = {
+            guard !videoFinished else { return }
+            videoFinished = true
+            renderedFrames.close()
+            videoInput.markAsFinished()
+            group.leave()
+        }
+
+        group.enter()
+        videoInput.requestMediaDataWhenReady(on: videoQueue) { [weak self] in
+            while videoInput.isReadyForMoreMediaData && !videoFinished {
+                guard let self = self, !self.isCancelled, let frame = renderedFrames.pop() else {
+                    finishVideo()
+                    return
+                }
+
+                let presentationTime = CMTimeMultiply(frameDuration, multiplier: Int32(frame.frameIndex))
+                if let pixelBuffer = frame.pixelBuffer,
+                   !adaptor.append(pixelBuffer, withPresentationTime: presentationTime) {
+                    print("VideoCompositor: Failed to append frame \(frame.frameIndex)")
+                    if writer.status == .failed {
+                        videoError = writer.error
+                        finishVideo()
+                        return
                     }
                 }
 
-                framesWritten += 1
+                framesWritten = frame.frameIndex + 1
 
                 // Report progress
                 if framesWritten % 30 == 0 || framesWritten == totalFrames {
                     let progress = Float(framesWritten) / Float(totalFrames) * 100.0  // 0-100 percentage
+                    let written = framesWritten
                     DispatchQueue.main.async {
-                        self.progressCallback?(progress, framesWritten, totalFrames)
+                        self.progressCallback?(progress, written, totalFrames)
                     }
                 }
             }
@@ -1263,7 +1479,8 @@ class VideoCompositorEngine {
         outputSize: CGSize,
         ciContext: CIContext,
         adaptor: AVAssetWriterInputPixelBufferAdaptor,
-        videoSources: [VideoClipSource]
+        timeline: CompositionTimeline,
+        background: CIImage
     ) -> CVPixelBuffer? {
         // Get pixel buffer from pool
         guard let pool = adaptor.pixelBufferPool else {
@@ -1275,29 +1492,23 @@ class VideoCompositorEngine {
             return nil
         }
 
-        // Create background
-        var outputImage = createSimpleBackground(config.background, size: outputSize)
+        // Clips are composited over a clear image and the background goes in
+        // last, so it can be left out when an opaque clip covers the frame
+        let outputRect = CGRect(origin: .zero, size: outputSize)
+        var outputImage = CIImage.empty()
+        var backgroundOccluded = false
 
-        // Sort clips by z-index
-        let sortedClips = config.clips.sorted { $0.zIndex < $1.zIndex }
+        let activePans = timeline.pans(at: timeSec)
+        let activeZooms = timeline.zooms(at: timeSec)
 
-        // Composite each clip
-        for clip in sortedClips {
+        // Composite each active clip in z-order
+        for (clip, videoSource) in timeline.clips(at: timeSec) {
             let clipStartSec = Double(clip.startTimeMs) / 1000.0
-            let clipEndSec = clipStartSec + Double(clip.durationMs) / 1000.0
-
-            guard timeSec >= clipStartSec && timeSec < clipEndSec else {
-                continue
-            }
 
             var clipImage: CIImage?
 
             if clip.sourceType == .video {
-                // Find the source for this clip - match by both path and timeline position
-                if let source = videoSources.first(where: {
-                    $0.clip.sourcePath == clip.sourcePath &&
-                    $0.clip.startTimeMs == clip.startTimeMs
-                }) {
+                if let source = videoSource {
                     // Check if this is a freeze frame
                     let isFreezeFrame = clip.freezeFrame ?? false
                     let sourceTime: CMTime
@@ -1308,10 +1519,9 @@ class VideoCompositorEngine {
                     } else {
                         sourceTime = source.getSourceTime(at: timeSec)
                     }
-                    do {
-                        let cgImage = try source.imageGenerator.copyCGImage(at: sourceTime, actualTime: nil)
-                        clipImage = CIImage(cgImage: cgImage)
-                    } catch {
+                    if let image = source.cursor.image(at: CMTimeGetSeconds(sourceTime)) {
+                        clipImage = image
+                    } else {
                         // Frame not available, skip
                         print("VideoCompositor: Failed to get frame at \(CMTimeGetSeconds(sourceTime))s for \(clip.sourcePath)")
                     }
@@ -1319,10 +1529,7 @@ class VideoCompositorEngine {
                     print("VideoCompositor: No source found for video clip at \(timeSec)s, path: \(clip.sourcePath)")
                 }
             } else if clip.sourceType == .image {
-                if let nsImage = NSImage(contentsOfFile: clip.sourcePath),
-                   let cgImage = nsImage.cgImage(forProposedRect: nil, context: nil, hints: nil) {
-                    clipImage = CIImage(cgImage: cgImage)
-                }
+                clipImage = DecodedImageCache.shared.image(atPath: clip.sourcePath)
             }
 
             guard var image = clipImage else { continue }
@@ -1353,13 +1560,13 @@ class VideoCompositorEngine {
             }
 
             // Apply per-clip pan effects (before scaling/positioning)
-            if let panClips = config.panClips {
-                image = applyPanToClip(image: image, clip: clip, panClips: panClips, timeSec: timeSec)
+            if !activePans.isEmpty {
+                image = applyPanToClip(image: image, clip: clip, panClips: activePans, timeSec: timeSec)
             }
 
             // Apply per-clip zoom effects (before scaling/positioning)
-            if let zoomClips = config.zoomClips {
-                image = applyZoomToClip(image: image, clip: clip, zoomClips: zoomClips, timeSec: timeSec)
+            if !activeZooms.isEmpty {
+                image = applyZoomToClip(image: image, clip: clip, zoomClips: activeZooms, timeSec: timeSec)
             }
 
             // Apply scale
@@ -1478,12 +1685,25 @@ class VideoCompositorEngine {
                 ])
             }
 
-            outputImage = image.composited(over: outputImage)
+            // Opaque video filling the frame hides everything below it. The
+            // inset keeps the soft edge Core Image samples at an extent border out.
+            let isOpaque = clip.sourceType == .video && finalOpacity >= 1.0 && (clip.cornerRadius ?? 0) <= 0
+            if isOpaque && image.extent.insetBy(dx: 1, dy: 1).contains(outputRect) {
+                outputImage = image.cropped(to: outputRect)
+                backgroundOccluded = true
+            } else {
+                outputImage = image.composited(over: outputImage)
+            }
+        }
+
+        if !backgroundOccluded {
+            outputImage = outputImage.composited(over: background)
         }
 
         // Apply blur effects
-        if let blurClips = config.blurClips {
-            outputImage = applyBlurEffectsSimple(to: outputImage, blurClips: blurClips, timeSec: timeSec, outputSize: outputSize)
+        let activeBlurs = timeline.blurs(at: timeSec)
+        if !activeBlurs.isEmpty {
+            outputImage = applyBlurEffectsSimple(to: outputImage, blurClips: activeBlurs, timeSec: timeSec, outputSize: outputSize)
         }
 
         // Render to pixel buffer
@@ -1585,16 +1805,16 @@ class VideoCompositorEngine {
         return resultImage
     }
 
-    /// Apply pan effects to a specific clip image (per-track pan)
+    /// Apply pan effects to a specific clip image (per-track pan).
+    /// `panClips` must already be sorted by z-index.
     private func applyPanToClip(image: CIImage, clip: CompositorClip, panClips: [CompositorPanClip], timeSec: Double) -> CIImage {
         guard let trackId = clip.trackId else { return image }
 
         var resultImage = image
         let imageSize = image.extent.size
 
-        // Filter pan clips for this track and sort by z-index
+        // Filter pan clips for this track
         let relevantPans = panClips.filter { $0.targetTrackId == trackId }
-            .sorted(by: { $0.zIndex < $1.zIndex })
 
         for pan in relevantPans {
             let panStartSec = Double(pan.startTimeMs) / 1000.0
@@ -1692,10 +1912,11 @@ class VideoCompositorEngine {
         return resultImage
     }
 
+    /// `blurClips` must already be sorted by z-index
     private func applyBlurEffectsSimple(to image: CIImage, blurClips: [CompositorBlurClip], timeSec: Double, outputSize: CGSize) -> CIImage {
         var resultImage = image
 
-        for blur in blurClips.sorted(by: { $0.zIndex < $1.zIndex }) {
+        for blur in blurClips {
             let blurStartSec = Double(blur.startTimeMs) / 1000.0
             let blurEndSec = blurStartSec + Double(blur.durationMs) / 1000.0
 
@@ -1923,13 +2144,10 @@ class VideoCompositorEngine {
             guard currentSec >= clipStartSec && currentSec < clipEndSec else { continue }
 
             // Load image
-            guard let nsImage = NSImage(contentsOfFile: clip.sourcePath),
-                  let cgImage = nsImage.cgImage(forProposedRect: nil, context: nil, hints: nil) else {
+            guard var clipImage = DecodedImageCache.shared.image(atPath: clip.sourcePath) else {
                 continue
             }
 
-            var clipImage = CIImage(cgImage: cgImage)
-
             // Apply scale
             let scale = clip.scale ?? 0.8
             let scaledWidth = outputSize.width * CGFloat(scale)
@@ -2028,6 +2246,34 @@ class VideoCompositorEngine {
         return buffer
     }
 
+    /// Render the export background into a GPU-backed buffer once, so frames
+    /// composite over a finished bitmap instead of re-running the gradient or
+    /// image scaling filters. Falls back to the filter chain if the buffer
+    /// cannot be created.
+    private func renderStaticBackground(_ background: CompositorBackground?, size: CGSize, ciContext: CIContext) -> CIImage {
+        let image = createSimpleBackground(background, size: size)
+
+        let attributes: [String: Any] = [
+            kCVPixelBufferMetalCompatibilityKey as String: true,
+            kCVPixelBufferIOSurfacePropertiesKey as String: [:]
+        ]
+        var pixelBuffer: CVPixelBuffer?
+        let status = CVPixelBufferCreate(
+            kCFAllocatorDefault,
+            Int(size.width),
+            Int(size.height),
+            kCVPixelFormatType_32BGRA,
+            attributes as CFDictionary,
+            &pixelBuffer
+        )
+        guard status == kCVReturnSuccess, let buffer = pixelBuffer else {
+            return image
+        }
+
+        ciContext.render(image, to: buffer)
+        return CIImage(cvPixelBuffer: buffer)
+    }
+
     /// Simple background creator for direct generation
     private func createSimpleBackground(_ background: CompositorBackground?, size: CGSize) -> CIImage {
         guard let bg = background else {
@@ -2052,9 +2298,7 @@ class VideoCompositorEngine {
 
         case .image:
             if let imagePath = bg.mediaPath ?? bg.imageUrl,
-               let nsImage = NSImage(contentsOfFile: imagePath),
-               let cgImage = nsImage.cgImage(forProposedRect: nil, context: nil, hints: nil) {
-                var image = CIImage(cgImage: cgImage)
+               var image = DecodedImageCache.shared.image(atPath: imagePath) {
                 let scaleX = size.width / image.extent.width
                 let scaleY = size.height / image.extent.height
                 let scale = max(scaleX, scaleY)
@@ -2310,12 +2554,20 @@ class VideoCompositorEngine {
     func cancel() {
         isCancelled = true
     }
+
+    /// Clear a previous cancel() so the engine can render again. Called on the
+    /// caller's thread before the render's Task starts, so a cancel() issued
+    /// right after starting is never lost.
+    func resetCancellation() {
+        isCancelled = false
+    }
 }
 
 // MARK: - C API
-
-private var globalCompositorEngine: VideoCompositorEngine?
-private let compositorLock = NSLock()
+//
+// Each handle owns one VideoCompositorEngine, so several exports can render
+// concurrently and be cancelled independently. A running render keeps its
+// engine alive, so destroying a handle mid-render is safe.
 
 /// Progress callback from C
 public typealias CProgressCallback = @convention(c) (UnsafePointer<CChar>?, Float, Int64, Int64) -> Void
@@ -2323,10 +2575,34 @@ public typealias CProgressCallback = @convention(c) (UnsafePointer<CChar>?, Floa
 /// Completion callback from C
 public typealias CCompletionCallback = @convention(c) (UnsafePointer<CChar>?, Int32, UnsafePointer<CChar>?) -> Void
 
+@available(macOS 12.0, *)
+private func compositorEngine(from handle: UnsafeMutableRawPointer) -> VideoCompositorEngine {
+    return Unmanaged<VideoCompositorEngine>.fromOpaque(handle).takeUnretainedValue()
+}
+
+/// Create a compositor handle
+@_cdecl("rigid_compositor_create")
+public func rigidCompositorCreate() -> UnsafeMutableRawPointer? {
+    guard #available(macOS 12.0, *) else {
+        return nil
+    }
+    let engine = VideoCompositorEngine()
+    return Unmanaged.passRetained(engine).toOpaque()
+}
+
+/// Destroy a compositor handle
+@_cdecl("rigid_compositor_destroy")
+public func rigidCompositorDestroy(_ handle: UnsafeMutableRawPointer?) {
+    guard let handle = handle else { return }
+    guard #available(macOS 12.0, *) else { return }
+    Unmanaged<VideoCompositorEngine>.fromOpaque(handle).release()
+}
+
 /// Start a video composition render
 /// Returns 0 on success, error code on failure
 @_cdecl("rigid_compositor_render")
 public func rigidCompositorRender(
+    _ handle: UnsafeMutableRawPointer?,
     _ exportId: UnsafePointer<CChar>?,
     _ configJson: UnsafePointer<CChar>?,
     _ progressCallback: CProgressCallback?
@@ -2335,7 +2611,7 @@ public func rigidCompositorRender(
         return 2 // RIGID_ERROR_INVALID_CONFIG
     }
 
-    guard let configJson = configJson else {
+    guard let handle = handle, let configJson = configJson else {
         return 2
     }
 
@@ -2348,10 +2624,8 @@ public func rigidCompositorRender(
         return 2
     }
 
-    compositorLock.lock()
-    let engine = VideoCompositorEngine()
-    globalCompositorEngine = engine
-    compositorLock.unlock()
+    let engine = compositorEngine(from: handle)
+    engine.resetCancellation()
 
     var result: Int32 = 0
     let semaphore = DispatchSemaphore(value: 0)
@@ -2367,10 +2641,6 @@ public func rigidCompositorRender(
             result = 3 // RIGID_ERROR_RECORDING_FAILED
         }
 
-        compositorLock.lock()
-        globalCompositorEngine = nil
-        compositorLock.unlock()
-
         semaphore.signal()
     }
 
@@ -2382,6 +2652,7 @@ public func rigidCompositorRender(
 /// Returns immediately, use progress callback to track status
 @_cdecl("rigid_compositor_render_async")
 public func rigidCompositorRenderAsync(
+    _ handle: UnsafeMutableRawPointer?,
     _ exportId: UnsafePointer<CChar>?,
     _ configJson: UnsafePointer<CChar>?,
     _ progressCallback: CProgressCallback?,
@@ -2391,7 +2662,7 @@ public func rigidCompositorRenderAsync(
         return 2
     }
 
-    guard let configJson = configJson else {
+    guard let handle = handle, let configJson = configJson else {
         return 2
     }
 
@@ -2404,10 +2675,9 @@ public func rigidCompositorRenderAsync(
         return 2
     }
 
-    compositorLock.lock()
-    let engine = VideoCompositorEngine()
-    globalCompositorEngine = engine
-    compositorLock.unlock()
+    // The task holds a strong reference, so the engine outlives rigid_compositor_destroy
+    let engine = compositorEngine(from: handle)
+    engine.resetCancellation()
 
     Task {
         do {
@@ -2420,20 +2690,15 @@ public func rigidCompositorRenderAsync(
             let errorMsg = error.localizedDescription
             completionCallback?(exportIdString, 3, errorMsg)
         }
-
-        compositorLock.lock()
-        globalCompositorEngine = nil
-        compositorLock.unlock()
     }
 
     return 0
 }
 
-/// Cancel an in-progress render
+/// Cancel the in-progress render on a handle
 @_cdecl("rigid_compositor_cancel")
-public func rigidCompositorCancel() {
-    compositorLock.lock()
-    globalCompositorEngine?.cancel()
-    globalCompositorEngine = nil
-    compositorLock.unlock()
+public func rigidCompositorCancel(_ handle: UnsafeMutableRawPointer?) {
+    guard let handle = handle else { return }
+    guard #available(macOS 12.0, *) else { return }
+    compositorEngine(from: handle).cancel()
 }
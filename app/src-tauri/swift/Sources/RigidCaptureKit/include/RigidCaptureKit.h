@@ -4,6 +4,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Error codes
 typedef enum {
     RIGID_SUCCESS = 0,
@@ -110,7 +114,11 @@ int32_t rigid_capture_start_display_recording(
 // Recording - Region
 // ============================================================================
 
-// Start recording a region of a display
+// Start recording a region of a display. The region is cropped at the capture
+// source, so only its pixels are captured and encoded. x/y/width/height are
+// display points from the top-left corner (pixels on Linux) and are clamped
+// to the display; a region outside it returns RIGID_ERROR_INVALID_CONFIG.
+// Odd pixel sizes are rounded down to even for the encoder.
 int32_t rigid_capture_start_region_recording(
     RigidCaptureHandle handle,
     uint32_t display_id,
@@ -144,6 +152,84 @@ bool rigid_capture_is_recording(RigidCaptureHandle handle);
 // Get duration of current recording in milliseconds
 int64_t rigid_capture_get_recording_duration_ms(RigidCaptureHandle handle);
 
+// ============================================================================
+// Backpressure and statistics
+// ============================================================================
+
+// What a recording does when the encoder cannot keep up (passed as int32_t)
+#define RIGID_BACKPRESSURE_DROP_NEWEST 0   // Skip frames arriving while the encoder is busy (default)
+#define RIGID_BACKPRESSURE_DROP_OLDEST 1   // Queue frames for the encoder; a full queue drops its oldest
+#define RIGID_BACKPRESSURE_ADAPTIVE_FPS 2  // Drop newest and lower the capture rate while frames drop,
+                                           // raising it back once the encoder keeps up
+
+// Set the backpressure policy and capture queue depth (frames the capture
+// source buffers, 0 = default 8) for the next recording on this handle
+int32_t rigid_capture_set_backpressure(RigidCaptureHandle handle, int32_t policy, uint32_t queue_depth);
+
+// Statistics of the current recording, or of the last one once stopped
+typedef struct {
+    uint64_t frames_captured;       // Delivered by the capture source
+    uint64_t frames_encoded;        // Handed to the encoder
+    uint64_t frames_dropped;        // Captured but never encoded
+    double current_fps;             // Capture rate currently requested
+    double encoder_latency_avg_ms;  // From capture to the encoder taking the frame
+    double encoder_latency_max_ms;
+    double processing_avg_ms;       // Time spent handling each frame on the capture thread
+    double processing_max_ms;
+} RigidCaptureStats;
+
+// Fill `stats`; all zero before the first recording
+int32_t rigid_capture_get_stats(RigidCaptureHandle handle, RigidCaptureStats* stats);
+
+// ============================================================================
+// Live frames
+// ============================================================================
+
+// A captured frame shared by every subscriber without copying. macOS hands
+// out the capture's IOSurface-backed pixel buffer; Linux hands out a slot of
+// a ring of mmap'd buffers. Either way the pixels are read-only and stay
+// valid until the last reference is released.
+typedef void* RigidFrameRef;
+
+// Read-only view of a frame
+typedef struct {
+    const uint8_t* pixels;  // BGRA, top-left origin
+    int32_t width;
+    int32_t height;
+    int32_t stride;         // Bytes per row
+    int64_t timestamp_us;   // Since the first frame of the recording
+    uint64_t sequence;      // Frame number within the recording
+} RigidFrameView;
+
+// Called on the capture thread for every captured frame, before it is
+// encoded. The frame is only valid during the call unless the subscriber
+// takes a reference with rigid_frame_retain. Keep the call short, and hold
+// frames for a few frame intervals at most: the capture reuses buffers
+// once released, and drops frames while every buffer is still held.
+// Must not subscribe or unsubscribe from inside the callback.
+typedef void (*RigidFrameCallback)(void* context, RigidFrameRef frame);
+
+// Receive live frames from recordings on this handle. Subscriptions outlive
+// individual recordings. Writes an id for rigid_capture_unsubscribe_frames.
+int32_t rigid_capture_subscribe_frames(
+    RigidCaptureHandle handle,
+    RigidFrameCallback callback,
+    void* context,
+    uint64_t* subscription_id
+);
+
+// Stop a subscription. No callback for it runs after this returns.
+int32_t rigid_capture_unsubscribe_frames(RigidCaptureHandle handle, uint64_t subscription_id);
+
+// Take another reference to a frame; returns the same frame
+RigidFrameRef rigid_frame_retain(RigidFrameRef frame);
+
+// Drop a reference taken with rigid_frame_retain
+void rigid_frame_release(RigidFrameRef frame);
+
+// Fill `view` for a frame. Returns false for a null frame.
+bool rigid_frame_get_view(RigidFrameRef frame, RigidFrameView* view);
+
 // ============================================================================
 // Screenshot - Window
 // ============================================================================
@@ -172,7 +258,10 @@ int32_t rigid_capture_screenshot_display(
 // Screenshot - Region
 // ============================================================================
 
-// Capture a screenshot of a region
+// Capture a screenshot of a region. Only the region is captured at the source
+// (never the whole display), in display points from the top-left corner
+// (pixels on Linux), clamped to the display; a region outside it returns
+// RIGID_ERROR_INVALID_CONFIG.
 int32_t rigid_capture_screenshot_region(
     uint32_t display_id,
     int32_t x,
@@ -184,6 +273,145 @@ int32_t rigid_capture_screenshot_region(
     bool capture_cursor
 );
 
+// ============================================================================
+// Screenshot Session
+// ============================================================================
+
+// A display kept ready for repeated screenshots (e.g. a screenshot hotkey).
+// Opening looks up the display and starts capturing once; each capture then
+// saves the latest frame, which is already in memory, instead of paying for
+// the lookup and capture setup the one-shot functions above do every time.
+typedef void* RigidScreenshotSessionHandle;
+
+// Open a session on `display_id`. On success `*session` is set; close it
+// with rigid_screenshot_session_close.
+int32_t rigid_screenshot_session_open(
+    uint32_t display_id,
+    float scale_factor,
+    bool capture_cursor,
+    RigidScreenshotSessionHandle* session
+);
+
+// Save the display, or the region x/y/width/height of it when width and
+// height are > 0 (as rigid_capture_screenshot_region), to output_path
+int32_t rigid_screenshot_session_capture(
+    RigidScreenshotSessionHandle session,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    const char* output_path
+);
+
+// Stop capturing and free the session
+void rigid_screenshot_session_close(RigidScreenshotSessionHandle session);
+
+// ============================================================================
+// Screenshot Encoding
+// ============================================================================
+
+// Every screenshot function picks the file format from output_path's
+// extension: ".qoi" (lossless, encodes several times faster than PNG),
+// ".webp" (lossless, where the platform has an encoder; otherwise the
+// capture returns RIGID_ERROR_INVALID_CONFIG), and PNG for anything else.
+
+// How hard encoders compress (passed as int32_t)
+#define RIGID_COMPRESSION_FAST 0      // Quick to write, larger files; for immediate saves
+#define RIGID_COMPRESSION_DEFAULT 1   // (default)
+#define RIGID_COMPRESSION_SMALLEST 2  // Slowest, smallest files
+
+// Set the compression level for later screenshots, and whether they are
+// encoded in the background. In the background a capture returns once the
+// pixels are grabbed; the file appears (whole, never partly written) when
+// encoding finishes, and encoding failures are reported by
+// rigid_screenshot_wait_for_writes. Applies process-wide.
+int32_t rigid_screenshot_set_encoding(int32_t compression, bool background);
+
+// Wait until every screenshot queued so far is on disk. Returns the error of
+// the first background write that failed since the last call, if any.
+int32_t rigid_screenshot_wait_for_writes(void);
+
+// ============================================================================
+// Screenshot Buffers
+// ============================================================================
+
+// A screenshot kept in memory, for callers that show it before (or instead
+// of) saving it, without encoding it to disk and decoding it back.
+// Reference counted: a capture returns one reference, which the caller drops
+// with rigid_image_release. The pixels are read-only. On macOS they are
+// the capture's own pixel buffer wherever possible.
+typedef void* RigidImageRef;
+
+// Pixel layouts of RigidImageView.format
+#define RIGID_PIXEL_FORMAT_BGRA8 0  // 8-bit BGRA, opaque
+
+// Read-only view of an image
+typedef struct {
+    const uint8_t* pixels;  // Top-left origin
+    int32_t width;
+    int32_t height;
+    int32_t stride;         // Bytes per row
+    int32_t format;         // RIGID_PIXEL_FORMAT_*
+} RigidImageView;
+
+// As rigid_capture_screenshot_window/display/region, into memory. On
+// success `*image` is set.
+int32_t rigid_capture_screenshot_window_to_buffer(
+    uint32_t window_id,
+    float scale_factor,
+    bool capture_cursor,
+    RigidImageRef* image
+);
+
+int32_t rigid_capture_screenshot_display_to_buffer(
+    uint32_t display_id,
+    float scale_factor,
+    bool capture_cursor,
+    RigidImageRef* image
+);
+
+int32_t rigid_capture_screenshot_region_to_buffer(
+    uint32_t display_id,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    float scale_factor,
+    bool capture_cursor,
+    RigidImageRef* image
+);
+
+// As rigid_screenshot_session_capture, into memory
+int32_t rigid_screenshot_session_capture_to_buffer(
+    RigidScreenshotSessionHandle session,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    RigidImageRef* image
+);
+
+// Take another reference to an image; returns the same image
+RigidImageRef rigid_image_retain(RigidImageRef image);
+
+// Drop a reference; the last one frees the image
+void rigid_image_release(RigidImageRef image);
+
+// Fill `view` for an image. Returns false for a null image.
+bool rigid_image_get_view(RigidImageRef image, RigidImageView* view);
+
+// Encode an image to output_path as the screenshot functions do (format by
+// extension, settings from rigid_screenshot_set_encoding). In the background
+// this returns at once; the encoder keeps its own reference, so the caller
+// may release the image right away.
+int32_t rigid_image_save(RigidImageRef image, const char* output_path);
+
+// Encode an image to output_path at `compression` (RIGID_COMPRESSION_*) and
+// return once it is on disk, whatever rigid_screenshot_set_encoding says.
+// Callers that pick their own level cannot change each other's, and the
+// result is this save's alone.
+int32_t rigid_image_save_now(RigidImageRef image, const char* output_path, int32_t compression);
+
 // ============================================================================
 // Video Compositor
 // ============================================================================
@@ -196,10 +424,22 @@ typedef void (*RigidCompositorProgressCallback)(const char* export_id, float per
 // Parameters: export_id, error_code (0=success), output_path_or_error
 typedef void (*RigidCompositorCompletionCallback)(const char* export_id, int32_t error_code, const char* output_path_or_error);
 
+// Opaque handle to a compositor engine. Each handle runs one render at a
+// time; use one handle per export to render several exports concurrently.
+typedef void* RigidCompositorHandle;
+
+// Create a new compositor instance
+RigidCompositorHandle rigid_compositor_create(void);
+
+// Destroy a compositor instance. A render still in progress on the handle
+// keeps running to completion; call rigid_compositor_cancel first to stop it.
+void rigid_compositor_destroy(RigidCompositorHandle handle);
+
 // Render a video composition synchronously
 // config_json: JSON string containing CompositorConfig
 // Returns 0 on success, error code on failure
 int32_t rigid_compositor_render(
+    RigidCompositorHandle handle,
     const char* export_id,
     const char* config_json,
     RigidCompositorProgressCallback progress_callback
@@ -208,13 +448,55 @@ int32_t rigid_compositor_render(
 // Render a video composition asynchronously
 // Returns immediately, calls completion callback when done
 int32_t rigid_compositor_render_async(
+    RigidCompositorHandle handle,
+    const char* export_id,
+    const char* config_json,
+    RigidCompositorProgressCallback progress_callback,
+    RigidCompositorCompletionCallback completion_callback
+);
+
+// Cancel the in-progress render on a handle
+void rigid_compositor_cancel(RigidCompositorHandle handle);
+
+// ============================================================================
+// Render Queue
+// ============================================================================
+
+// Opaque handle to a render queue: a bounded pool of compositor workers
+typedef void* RigidRenderQueueHandle;
+
+// Create a render queue running at most max_concurrent_jobs exports at once.
+// core_budget is the number of CPU threads shared between running exports
+// (0 = all hardware threads); each export gets an equal share.
+RigidRenderQueueHandle rigid_render_queue_create(int32_t max_concurrent_jobs, int32_t core_budget);
+
+// Destroy a render queue, cancelling queued and running exports
+void rigid_render_queue_destroy(RigidRenderQueueHandle queue);
+
+// Queue an export. Higher priority runs first; equal priorities run in
+// submission order. progress_callback reports 0% when the export leaves the
+// queue and starts rendering; completion_callback is always called once.
+// Returns 0 if queued, error code otherwise.
+int32_t rigid_render_queue_submit(
+    RigidRenderQueueHandle queue,
     const char* export_id,
     const char* config_json,
+    int32_t priority,
     RigidCompositorProgressCallback progress_callback,
     RigidCompositorCompletionCallback completion_callback
 );
 
-// Cancel an in-progress render
-void rigid_compositor_cancel(void);
+// Cancel a queued or running export. Returns false if the id is unknown.
+bool rigid_render_queue_cancel(RigidRenderQueueHandle queue, const char* export_id);
+
+// Number of exports waiting for a worker
+int32_t rigid_render_queue_depth(RigidRenderQueueHandle queue);
+
+// Number of exports currently rendering
+int32_t rigid_render_queue_running(RigidRenderQueueHandle queue);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // RIGID_CAPTURE_KIT_H
@@ -0,0 +1,141 @@
+import AVFoundation
+import CoreImage
+import XCTest
+
+@testable import RigidCaptureKit
+
+final class VideoFrameCursorTests: XCTestCase {
+    private static let frameRate: Int32 = 30
+    private static let size = 64
+
+    /// Frames 0-2, then nothing until 20-21: a recording that skipped idle
+    /// frames, as ScreenRecorder writes them
+    private static let frameIndices = [0, 1, 2, 20, 21]
+
+    /// Gray level of the frame written at output frame `index`
+    private static func level(of index: Int) -> Int {
+        20 + index * 9
+    }
+
+    /// Middle of output frame `index`
+    private static func midFrame(_ index: Int) -> Double {
+        (Double(index) + 0.5) / Double(frameRate)
+    }
+
+    private var url: URL!
+    private let context = CIContext(options: [.workingColorSpace: NSNull()])
+
+    override func setUp() async throws {
+        url = FileManager.default.temporaryDirectory
+            .appendingPathComponent("gapped-\(UUID().uuidString).mp4")
+        try await writeGappedVideo(to: url)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: url)
+    }
+
+    func testHoldsFramesAcrossTimestampGaps() async throws {
+        let cursor = try await makeCursor()
+
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(0))), 0)
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(2))), 2)
+
+        // Inside the gap the last frame stays up; the next one is not shown
+        // early and the reader is not restarted to look for it
+        let startsBeforeGap = cursor.readerStartCount
+        for index in 3..<20 {
+            XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(index))), 2, "frame \(index)")
+        }
+        XCTAssertEqual(cursor.readerStartCount, startsBeforeGap)
+
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(20))), 20)
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(21))), 21)
+        // Past the end the last frame is held
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(40))), 21)
+        XCTAssertEqual(cursor.readerStartCount, startsBeforeGap)
+
+        // Backwards seeks land on the frame shown at that time
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(10))), 2)
+        XCTAssertEqual(shownIndex(cursor.image(at: Self.midFrame(1))), 1)
+    }
+
+    private func makeCursor() async throws -> VideoCompositorEngine.VideoFrameCursor {
+        let asset = AVURLAsset(url: url, options: [AVURLAssetPreferPreciseDurationAndTimingKey: true])
+        let track = try XCTUnwrap(try await asset.loadTracks(withMediaType: .video).first)
+        return VideoCompositorEngine.VideoFrameCursor(
+            asset: asset,
+            track: track,
+            preferredTransform: .identity,
+            frameRate: Double(Self.frameRate)
+        )
+    }
+
+    /// Index of the written frame `image` shows, or -1
+    private func shownIndex(_ image: CIImage?) -> Int {
+        guard let image = image else { return -1 }
+        var pixel = [UInt8](repeating: 0, count: 4)
+        let center = CGRect(x: Self.size / 2, y: Self.size / 2, width: 1, height: 1)
+        context.render(image, toBitmap: &pixel, rowBytes: 4, bounds: center, format: .BGRA8, colorSpace: nil)
+
+        let level = Int(pixel[1])
+        return Self.frameIndices.first { abs(level - Self.level(of: $0)) <= 4 } ?? -1
+    }
+
+    private func writeGappedVideo(to url: URL) async throws {
+        let writer = try AVAssetWriter(outputURL: url, fileType: .mp4)
+        let input = AVAssetWriterInput(mediaType: .video, outputSettings: [
+            AVVideoCodecKey: AVVideoCodecType.h264,
+            AVVideoWidthKey: Self.size,
+            AVVideoHeightKey: Self.size
+        ])
+        input.expectsMediaDataInRealTime = false
+        let adaptor = AVAssetWriterInputPixelBufferAdaptor(assetWriterInput: input, sourcePixelBufferAttributes: [
+            kCVPixelBufferPixelFormatTypeKey as String: kCVPixelFormatType_32BGRA,
+            kCVPixelBufferWidthKey as String: Self.size,
+            kCVPixelBufferHeightKey as String: Self.size
+        ])
+        writer.add(input)
+
+        XCTAssertTrue(writer.startWriting(), writer.error?.localizedDescription ?? "")
+        writer.startSession(atSourceTime: .zero)
+
+        for index in Self.frameIndices {
+            while !input.isReadyForMoreMediaData {
+                try await Task.sleep(nanoseconds: 5_000_000)
+            }
+            let pixelBuffer = try makeGrayBuffer(level: Self.level(of: index), pool: adaptor.pixelBufferPool)
+            let pts = CMTime(value: CMTimeValue(index), timescale: Self.frameRate)
+            XCTAssertTrue(adaptor.append(pixelBuffer, withPresentationTime: pts), writer.error?.localizedDescription ?? "")
+        }
+
+        input.markAsFinished()
+        let lastIndex = Self.frameIndices.last ?? 0
+        writer.endSession(atSourceTime: CMTime(value: CMTimeValue(lastIndex + 1), timescale: Self.frameRate))
+        await writer.finishWriting()
+        XCTAssertEqual(writer.status, .completed, writer.error?.localizedDescription ?? "")
+    }
+
+    private func makeGrayBuffer(level: Int, pool: CVPixelBufferPool?) throws -> CVPixelBuffer {
+        let pool = try XCTUnwrap(pool)
+        var buffer: CVPixelBuffer?
+        CVPixelBufferPoolCreatePixelBuffer(nil, pool, &buffer)
+        let pixelBuffer = try XCTUnwrap(buffer)
+
+        CVPixelBufferLockBaseAddress(pixelBuffer, [])
+        defer { CVPixelBufferUnlockBaseAddress(pixelBuffer, []) }
+
+        let base = try XCTUnwrap(CVPixelBufferGetBaseAddress(pixelBuffer)).assumingMemoryBound(to: UInt8.self)
+        let rowBytes = CVPixelBufferGetBytesPerRow(pixelBuffer)
+        for y in 0..<Self.size {
+            for x in 0..<Self.size {
+                let pixel = base + y * rowBytes + x * 4
+                pixel[0] = UInt8(level)
+                pixel[1] = UInt8(level)
+                pixel[2] = UInt8(level)
+                pixel[3] = 255
+            }
+        }
+        return pixelBuffer
+    }
+}
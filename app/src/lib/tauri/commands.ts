@@ -756,6 +756,12 @@ export interface ExportComplete {
   error: string | null;
 }
 
+/** Number of queued and running exports on the native render queue */
+export interface RenderQueueStatus {
+  queued: number;
+  running: number;
+}
+
 // Demo rendering commands
 export const demoRender = {
   render: (config: RenderDemoConfig) =>
@@ -767,6 +773,15 @@ export const demoRender = {
   /** Render using native AVFoundation compositor (macOS only, much faster) */
   renderNative: (exportId: string, config: RenderDemoConfig) =>
     invoke<string>('render_demo_native', { exportId, config }),
+  /** Queue a native render; at most two run at once, highest priority first */
+  queueNative: (exportId: string, config: RenderDemoConfig, priority?: number) =>
+    invoke<string>('queue_render_native', { exportId, config, priority: priority ?? null }),
+  /** Number of queued and running native renders */
+  queueStatus: () =>
+    invoke<RenderQueueStatus>('get_render_queue_status'),
+  /** Cancel a queued or running native render; it still emits export-complete */
+  cancelNative: (exportId: string) =>
+    invoke<boolean>('cancel_render_native', { exportId }),
 };
 
 // Diagram commands (mind maps, user flows, dependency graphs)
@@ -995,6 +1010,8 @@ const nativeCaptureRaw = {
     options: {
       retina_capture?: boolean | null;
       capture_cursor?: boolean | null;
+      format?: string | null;
+      compression?: string | null;
     } | null
   ) =>
     invoke<Screenshot>('capture_native_screenshot', {
@@ -1251,6 +1268,8 @@ export const nativeCapture = {
         const nativeOpts = options.native ? {
           retina_capture: options.native.retinaCapture ?? null,
           capture_cursor: options.native.captureCursor ?? null,
+          format: options.native.format ?? null,
+          compression: options.native.compression ?? null,
         } : null;
 
         return await nativeCaptureRaw.captureScreenshot(
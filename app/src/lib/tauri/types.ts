@@ -775,6 +775,10 @@ export interface NativeScreenshotOptions {
   retinaCapture?: boolean | null;
   /** Include cursor in capture (default: false) */
   captureCursor?: boolean | null;
+  /** File format (default: png); webp only on Linux builds with libwebp */
+  format?: 'png' | 'qoi' | 'webp' | null;
+  /** Encoder effort (default: default) */
+  compression?: 'fast' | 'default' | 'smallest' | null;
 }
 
 /** Window info from native ScreenCaptureKit */
@@ -7535,9 +7535,10 @@ function ExportModal({
         })(),
       };
 
-      // Start background render using native AVFoundation compositor (macOS)
-      // Falls back to FFmpeg on other platforms
-      await demoRender.renderNative(exportId, config);
+      // Queue a background render on the native compositor, which waits
+      // while two other exports are rendering; falls back to FFmpeg on
+      // platforms without one
+      await demoRender.queueNative(exportId, config);
     } catch (err) {
       console.error("Export failed:", err);
       setExportError(err instanceof Error ? err.message : String(err));
@@ -7548,6 +7549,13 @@ function ExportModal({
     onClose();
   };
 
+  const handleCancelExport = async () => {
+    if (!currentExportId) return;
+    const { demoRender } = await import("@/lib/tauri/commands");
+    // The cancelled export reports its failure through export-complete
+    await demoRender.cancelNative(currentExportId);
+  };
+
   const handleReset = () => {
     if (currentExportId) {
       clearExport(currentExportId);
@@ -7678,8 +7686,14 @@ function ExportModal({
               </div>
             </div>
 
-            {/* Continue in background button */}
+            {/* Cancel and continue in background buttons */}
             <div className="flex gap-3 mt-6">
+              <button
+                onClick={handleCancelExport}
+                className="flex-1 h-10 border border-[var(--border-default)] text-[var(--text-primary)] font-medium hover:bg-[var(--surface-hover)]"
+              >
+                Cancel
+              </button>
               <button
                 onClick={handleContinueInBackground}
                 className="flex-1 h-10 bg-[var(--text-primary)] text-[var(--text-inverse)] font-medium hover:opacity-90"